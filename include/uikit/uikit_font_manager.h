@@ -24,12 +24,105 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/* bucket i of the open latency histogram counts opens under 2^i ms that don't
+ * fit a lower bucket, the last bucket also counts everything slower
+ */
+#define VG_FONT_LATENCY_BUCKET_CNT 8
+
+/* style flag, OR-ed with LV_FREETYPE_FONT_STYLE: every size of the font is
+ * rendered from one distance field per glyph, no font is opened per size.
+ * Ignored without UIKIT_FONT_USE_SDF.
+ */
+#define VG_FONT_STYLE_SDF 0x8000
+
 /**********************
  *      TYPEDEFS
  **********************/
 
 typedef void* vg_font_path_handle_t;
 
+typedef struct {
+    uint32_t refer_hit_cnt; /* requests served by an already open font */
+    uint32_t cache_hit_cnt; /* fonts reused from the font cache */
+    uint32_t cache_miss_cnt;
+    uint32_t cache_evict_cnt;
+    uint32_t cache_promote_cnt; /* fonts kept as reused by the 2Q cache policy */
+    uint32_t refer_cnt; /* open fonts */
+    uint32_t rec_cnt; /* fonts handed out by vg_font_create, including fallbacks */
+    uint32_t emoji_font_cnt; /* open emoji fonts, included in refer_cnt */
+    uint32_t open_cnt; /* lv_freetype_font_create calls */
+    uint32_t open_fail_cnt;
+    uint32_t open_time_sum; /* ms */
+    uint32_t open_time_max; /* ms */
+    uint32_t open_latency_hist[VG_FONT_LATENCY_BUCKET_CNT];
+    uint32_t emoji_image_hit_cnt; /* decoded emoji cache */
+    uint32_t emoji_image_miss_cnt;
+    size_t cache_mem_size; /* memory held by the font cache, its sizes and the faces only it holds */
+    uint32_t face_cnt; /* open freetype faces, shared by the sizes of a font file and style */
+    size_t face_mem_size; /* heap taken by opening them, each face counted once */
+    uint32_t text_hit_cnt; /* text metrics cache */
+    uint32_t text_miss_cnt;
+    uint32_t file_cnt; /* font files open through the font file map */
+    size_t file_mapped_size; /* mapped bytes of these files */
+    uint32_t outline_hit_cnt; /* shared outline cache */
+    uint32_t outline_miss_cnt;
+    size_t outline_mem_size;
+    uint32_t sdf_hit_cnt; /* distance field cache of the SDF fonts */
+    uint32_t sdf_miss_cnt;
+    size_t sdf_mem_size;
+    uint32_t glyph_store_hit_cnt; /* compressed glyph store */
+    uint32_t glyph_store_miss_cnt;
+    size_t glyph_store_mem_size;
+    size_t glyph_store_raw_size; /* A8 size of the stored glyphs */
+} vg_font_stats_t;
+
+typedef enum {
+    VG_FONT_CACHE_POLICY_LRU, /* least recently put back fonts are closed first */
+    VG_FONT_CACHE_POLICY_2Q, /* fonts put back once are closed before the reused ones */
+} vg_font_cache_policy_t;
+
+typedef enum {
+    VG_FONT_TRIM_LEVEL_CACHE, /* close the cached fonts that nothing references */
+    VG_FONT_TRIM_LEVEL_GLYPH, /* also flush the glyph and emoji caches of the fonts in use */
+} vg_font_trim_level_t;
+
+typedef enum {
+    VG_FONT_OUTLINE_OP_MOVE, /* 1 point */
+    VG_FONT_OUTLINE_OP_LINE, /* 1 point */
+    VG_FONT_OUTLINE_OP_QUAD, /* control point, end point */
+    VG_FONT_OUTLINE_OP_CUBIC, /* 2 control points, end point */
+    VG_FONT_OUTLINE_OP_END,
+} vg_font_outline_op_t;
+
+/* glyph outline shared by all sizes of a font face */
+typedef struct {
+    const uint8_t* op_arr; /* vg_font_outline_op_t */
+    uint32_t op_cnt;
+    const int16_t* point_arr; /* x, y pairs in 26.6 pixels at the reference size, y up */
+    uint32_t point_cnt;
+    int32_t scale; /* font size / reference size, 16.16 fixed point */
+    void* handle; /* owned by the font manager */
+} vg_font_outline_t;
+
+/**
+ * Font creation callback, called on the UI thread.
+ * @param font the created font, NULL or LV_FONT_DEFAULT on failure like vg_font_create.
+ * @param user_data custom parameter.
+ */
+typedef void (*vg_font_create_cb_t)(lv_font_t* font, void* user_data);
+
+typedef struct {
+    const char* name; /* font name.eg:"simhei" */
+    uint16_t size; /* font size.eg:16 */
+    uint16_t style; /* font style. see LV_FREETYPE_FONT_STYLE for details, SDF fonts are skipped */
+} vg_font_preload_item_t;
+
+typedef struct {
+    const char* name; /* font name.eg:"simhei" */
+    uint16_t size; /* font size.eg:16 */
+    uint16_t style; /* font style. see LV_FREETYPE_FONT_STYLE for details */
+} vg_font_request_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -41,24 +134,64 @@ void vg_font_init(void);
 
 /**
  * destory font library and free resource.
+ * It can be called with or without the LVGL lock, the pending vg_font_create_async
+ * requests are answered with a failure from the calling thread.
  */
 void vg_font_deinit(void);
 
 /**
  * create font.
+ * It can be called from any thread once vg_font_init is done.
  * @param name font name.eg:"simhei".
  * @param size font size.eg:16.
- * @param style font style. see LV_FREETYPE_FONT_STYLE for details.
+ * @param style font style. see LV_FREETYPE_FONT_STYLE for details, VG_FONT_STYLE_SDF can be OR-ed in.
  * @return lvgl font pointer.
  */
 lv_font_t* vg_font_create(const char* name, uint16_t size, uint16_t style);
 
+/**
+ * create font asynchronously.
+ * The font file is looked up and opened on a worker thread without the LVGL
+ * lock, the font is delivered to cb on the UI thread by an LVGL timer. The
+ * callback owns the font and destroys it with vg_font_destroy.
+ * @param name font name.eg:"simhei", copied before return.
+ * @param size font size.eg:16.
+ * @param style font style. see LV_FREETYPE_FONT_STYLE for details.
+ * @param cb called once with the font if the request was queued.
+ * @param user_data custom parameter.
+ * @return true if the request was queued.
+ */
+bool vg_font_create_async(const char* name, uint16_t size, uint16_t style, vg_font_create_cb_t cb, void* user_data);
+
+/**
+ * create several fonts in one call.
+ * The requests are grouped by name, each font file is found once and opened
+ * once for all its sizes, identical requests share the same font data.
+ * @param reqs font requests.
+ * @param out return the fonts in the order of reqs, NULL or LV_FONT_DEFAULT on
+ *            failure like vg_font_create. Each one is destroyed by vg_font_destroy.
+ * @param n number of fonts.
+ * @return number of fonts created.
+ */
+size_t vg_font_create_batch(const vg_font_request_t* reqs, lv_font_t** out, size_t n);
+
 /**
  * destroy font.
+ * It can be called from any thread, not while the font is still in use.
  * @param delfont lvgl font pointer.
  */
 void vg_font_destroy(lv_font_t* delfont);
 
+/**
+ * preload fonts in background.
+ * The fonts are opened on a worker thread and kept in the font cache,
+ * the following vg_font_create calls with the same parameters hit the cache.
+ * @param list fonts to preload, copied before return.
+ * @param n number of fonts.
+ * @return number of fonts queued.
+ */
+size_t vg_font_preload(const vg_font_preload_item_t* list, size_t n);
+
 /**
  * set font default path.
  * @param path font find path.eg:"./xxx/".note:must have '/' in end.
@@ -80,6 +213,107 @@ vg_font_path_handle_t vg_font_add_path(const char* name, const char* path);
  */
 bool vg_font_remove_path(vg_font_path_handle_t handle);
 
+/**
+ * set the memory budget of the font cache.
+ * @param size budget in bytes, 0 means the cache is only limited by entry count.
+ */
+void vg_font_set_cache_mem_budget(size_t size);
+
+/**
+ * set the replacement policy of the font cache, the default is chosen by
+ * UIKIT_FONT_CACHE_POLICY. The cached fonts are kept.
+ * @param policy replacement policy.
+ */
+void vg_font_set_cache_policy(vg_font_cache_policy_t policy);
+
+/**
+ * get the memory held by the font cache.
+ * @param cur_size current usage in bytes, can be NULL.
+ * @param peak_size peak usage in bytes, can be NULL.
+ */
+void vg_font_get_cache_mem_usage(size_t* cur_size, size_t* peak_size);
+
+/**
+ * get the font manager statistics, counters accumulate since vg_font_init.
+ * @param stats statistics.
+ */
+void vg_font_get_stats(vg_font_stats_t* stats);
+
+/**
+ * get the size of a text, same result as lv_text_get_size. The results of
+ * fonts created by vg_font_create are cached until the font is destroyed,
+ * so laying out the same strings again doesn't walk the glyphs.
+ * @param size_res return the text size.
+ * @param text text to measure.
+ * @param font pointer to font.
+ * @param letter_space letter space.
+ * @param line_space line space.
+ * @param max_width max width of a line, the text is wrapped to it.
+ * @param flag text flags, eg: LV_TEXT_FLAG_EXPAND.
+ */
+void vg_font_get_text_size(lv_point_t* size_res, const char* text, const lv_font_t* font, int32_t letter_space,
+    int32_t line_space, int32_t max_width, lv_text_flag_t flag);
+
+/**
+ * get the size of a text and where its lines start, as lv_label wraps it.
+ * Cached like vg_font_get_text_size.
+ * @param size_res return the text size, can be NULL.
+ * @param text text to measure.
+ * @param font pointer to font.
+ * @param letter_space letter space.
+ * @param line_space line space.
+ * @param max_width max width of a line, the text is wrapped to it.
+ * @param flag text flags, eg: LV_TEXT_FLAG_EXPAND.
+ * @param line_start return the byte offset of each line, can be NULL.
+ * @param line_max size of line_start.
+ * @return number of lines, can be greater than line_max.
+ */
+uint32_t vg_font_get_text_lines(lv_point_t* size_res, const char* text, const lv_font_t* font, int32_t letter_space,
+    int32_t line_space, int32_t max_width, lv_text_flag_t flag, uint32_t* line_start, uint32_t line_max);
+
+/**
+ * get the outline of a glyph from the shared outline cache.
+ * Outlines are stored once per font face and style, the sizes only differ in
+ * outline->scale. Only fonts created in outline mode have outlines.
+ * @param font font created by vg_font_create.
+ * @param letter unicode letter.
+ * @param outline return the outline, release it with vg_font_release_glyph_outline.
+ * @return true if the glyph has an outline.
+ */
+bool vg_font_get_glyph_outline(const lv_font_t* font, uint32_t letter, vg_font_outline_t* outline);
+
+/**
+ * release an outline got by vg_font_get_glyph_outline.
+ * @param outline the outline.
+ */
+void vg_font_release_glyph_outline(vg_font_outline_t* outline);
+
+#if LV_USE_VECTOR_GRAPHIC
+/**
+ * append an outline to a vector path, scaled to its font size.
+ * @param outline the outline.
+ * @param path vector path to append to.
+ * @param pos pen position on the baseline.
+ */
+void vg_font_outline_to_path(const vg_font_outline_t* outline, lv_vector_path_t* path, const lv_fpoint_t* pos);
+#endif /* LV_USE_VECTOR_GRAPHIC */
+
+/**
+ * give font memory back, eg: when the app goes to the background or the
+ * system is low on memory. Fonts in use stay valid, the flushed glyphs are
+ * rendered again on demand. Takes the LVGL lock at the glyph level.
+ * @param level how much to release.
+ */
+void vg_font_trim(vg_font_trim_level_t level);
+
+/**
+ * save the fonts and letters drawn so far, vg_font_init opens and renders
+ * them in the background on the next boot. It is saved on vg_font_deinit too,
+ * call it at a quiet point, eg: after the first screen is shown.
+ * @return return true if the profile is saved or up to date.
+ */
+bool vg_font_save_usage_profile(void);
+
 /**********************
  *      MACROS
  **********************/
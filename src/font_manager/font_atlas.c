@@ -0,0 +1,258 @@
+/**
+ * @file font_atlas.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_atlas.h"
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+
+#include "font_hash.h"
+#include "font_utils.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_atlas_t {
+    const uint8_t* data; /* whole atlas file */
+    size_t data_size;
+    bool is_mapped; /* data is mmap-ed, otherwise lv_malloc-ed */
+    const font_atlas_header_t* header;
+    const font_atlas_glyph_t* glyph_arr;
+    const uint8_t* bitmap;
+} font_atlas_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool font_atlas_load(font_atlas_t* atlas, const char* path);
+static void font_atlas_unload(font_atlas_t* atlas);
+static bool font_atlas_check(font_atlas_t* atlas, const char* font_path, uint16_t size, uint16_t style);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_atlas_t* font_atlas_open(const char* name, const char* font_path, uint16_t size, uint16_t style)
+{
+    LV_ASSERT_NULL(name);
+    LV_ASSERT_NULL(font_path);
+
+    char path[PATH_MAX];
+    int len = lv_snprintf(path, sizeof(path), "%s/%s_%d_%d.atlas",
+        UIKIT_FONT_ATLAS_PATH, name, size, style);
+    if (len >= (int)sizeof(path)) {
+        LV_LOG_WARN("path truncation detected, len = %d", len);
+        return NULL;
+    }
+
+    if (access(path, F_OK) != 0) {
+        LV_LOG_INFO("no atlas: %s", path);
+        return NULL;
+    }
+
+    font_atlas_t* atlas = lv_malloc(sizeof(font_atlas_t));
+    LV_ASSERT_MALLOC(atlas);
+    if (!atlas) {
+        LV_LOG_ERROR("malloc failed for font_atlas_t");
+        return NULL;
+    }
+    lv_memzero(atlas, sizeof(font_atlas_t));
+
+    if (!font_atlas_load(atlas, path)) {
+        lv_free(atlas);
+        return NULL;
+    }
+
+    if (!font_atlas_check(atlas, font_path, size, style)) {
+        LV_LOG_WARN("atlas: %s is invalid or out of date", path);
+        font_atlas_unload(atlas);
+        lv_free(atlas);
+        return NULL;
+    }
+
+    LV_LOG_INFO("atlas: %s open OK, %" LV_PRIu32 " glyphs", path, atlas->header->glyph_cnt);
+    return atlas;
+}
+
+void font_atlas_close(font_atlas_t* atlas)
+{
+    LV_ASSERT_NULL(atlas);
+
+    font_atlas_unload(atlas);
+    lv_free(atlas);
+}
+
+const font_atlas_glyph_t* font_atlas_find_glyph(const font_atlas_t* atlas, uint32_t unicode)
+{
+    LV_ASSERT_NULL(atlas);
+
+    /* binary search, the glyph table is sorted by unicode */
+    uint32_t low = 0;
+    uint32_t high = atlas->header->glyph_cnt;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const font_atlas_glyph_t* glyph = &atlas->glyph_arr[mid];
+        if (glyph->unicode == unicode) {
+            return glyph;
+        }
+
+        if (glyph->unicode < unicode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+const uint8_t* font_atlas_get_bitmap(const font_atlas_t* atlas, const font_atlas_glyph_t* glyph)
+{
+    LV_ASSERT_NULL(atlas);
+    LV_ASSERT_NULL(glyph);
+
+    uint64_t bitmap_end = (uint64_t)glyph->bitmap_offset + (uint32_t)glyph->box_w * glyph->box_h;
+    if (bitmap_end > atlas->header->bitmap_size) {
+        LV_LOG_WARN("glyph U+%" LV_PRIX32 " bitmap out of range", glyph->unicode);
+        return NULL;
+    }
+
+    return atlas->bitmap + glyph->bitmap_offset;
+}
+
+bool font_atlas_get_fingerprint(const char* font_path, uint32_t* fingerprint)
+{
+    LV_ASSERT_NULL(font_path);
+    LV_ASSERT_NULL(fingerprint);
+
+    /* hash the file size, the head and the tail of the file,
+     * cheap enough to run on each font creation
+     */
+    int fd = open(font_path, O_RDONLY);
+    if (fd < 0) {
+        LV_LOG_WARN("can't open font file: %s", font_path);
+        return false;
+    }
+
+    bool retval = false;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        goto failed;
+    }
+
+    uint32_t file_size = st.st_size;
+    uint32_t hash = font_hash_data(FONT_HASH_INIT, &file_size, sizeof(file_size));
+
+    uint8_t buf[FONT_ATLAS_FINGERPRINT_CHUNK];
+    size_t chunk = LV_MIN(file_size, sizeof(buf));
+
+    if (read(fd, buf, chunk) != (ssize_t)chunk) {
+        goto failed;
+    }
+    hash = font_hash_data(hash, buf, chunk);
+
+    if (lseek(fd, file_size - chunk, SEEK_SET) < 0 || read(fd, buf, chunk) != (ssize_t)chunk) {
+        goto failed;
+    }
+    hash = font_hash_data(hash, buf, chunk);
+
+    *fingerprint = hash;
+    retval = true;
+
+failed:
+    close(fd);
+    return retval;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool font_atlas_load(font_atlas_t* atlas, const char* path)
+{
+    /* glyph bitmaps are paged in on demand when the file is mapped */
+    if (!font_utils_file_map(path, &atlas->data, &atlas->data_size, &atlas->is_mapped)) {
+        LV_LOG_ERROR("can't load atlas: %s", path);
+        return false;
+    }
+
+    if (atlas->data_size < sizeof(font_atlas_header_t)) {
+        LV_LOG_ERROR("bad atlas size: %s", path);
+        font_atlas_unload(atlas);
+        return false;
+    }
+
+    return true;
+}
+
+static void font_atlas_unload(font_atlas_t* atlas)
+{
+    if (!atlas->data) {
+        return;
+    }
+
+    font_utils_file_unmap(atlas->data, atlas->data_size, atlas->is_mapped);
+    atlas->data = NULL;
+}
+
+static bool font_atlas_check(font_atlas_t* atlas, const char* font_path, uint16_t size, uint16_t style)
+{
+    const font_atlas_header_t* header = (const font_atlas_header_t*)atlas->data;
+
+    if (header->magic != FONT_ATLAS_MAGIC || header->version != FONT_ATLAS_VERSION) {
+        LV_LOG_WARN("bad magic: 0x%" LV_PRIx32 " or version: %d", header->magic, header->version);
+        return false;
+    }
+
+    if (header->size != size || header->style != style) {
+        LV_LOG_WARN("size/style mismatch: %d/%d != %d/%d", header->size, header->style, size, style);
+        return false;
+    }
+
+    uint64_t glyph_end = (uint64_t)header->glyph_offset + (uint64_t)header->glyph_cnt * sizeof(font_atlas_glyph_t);
+    uint64_t bitmap_end = (uint64_t)header->bitmap_offset + header->bitmap_size;
+    if (header->header_size < sizeof(font_atlas_header_t)
+        || glyph_end > atlas->data_size
+        || bitmap_end > atlas->data_size
+        || header->glyph_offset % sizeof(uint32_t) != 0) {
+        LV_LOG_WARN("bad layout");
+        return false;
+    }
+
+    uint32_t fingerprint;
+    if (!font_atlas_get_fingerprint(font_path, &fingerprint) || fingerprint != header->fingerprint) {
+        LV_LOG_WARN("font file changed");
+        return false;
+    }
+
+    atlas->header = header;
+    atlas->glyph_arr = (const font_atlas_glyph_t*)(atlas->data + header->glyph_offset);
+    atlas->bitmap = atlas->data + header->bitmap_offset;
+
+    return true;
+}
+
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
@@ -0,0 +1,121 @@
+/**
+ * @file font_atlas.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_ATLAS_H
+#define FONT_MANAGER_FONT_ATLAS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* "UGAT" */
+#define FONT_ATLAS_MAGIC 0x54414755
+#define FONT_ATLAS_VERSION 1
+
+/* bytes hashed at each end of the font file to build the fingerprint */
+#define FONT_ATLAS_FINGERPRINT_CHUNK 1024
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* on-disk layout, little endian, generated by tools/font_atlas_gen.py */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t fingerprint; /* font file fingerprint */
+    uint16_t size; /* font size */
+    uint16_t style; /* font style */
+    int16_t line_height;
+    int16_t base_line;
+    uint32_t glyph_cnt;
+    uint32_t glyph_offset; /* offset of the glyph table from the file start */
+    uint32_t bitmap_offset; /* offset of the bitmaps from the file start */
+    uint32_t bitmap_size;
+} font_atlas_header_t;
+
+/* glyph table entry, sorted by unicode */
+typedef struct {
+    uint32_t unicode;
+    uint32_t bitmap_offset; /* A8 bitmap, box_w * box_h bytes, from bitmap section start */
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint16_t reserved;
+} font_atlas_glyph_t;
+
+typedef struct _font_atlas_t font_atlas_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Open the glyph atlas of a font.
+ * @param name font name, used to build the atlas file name.
+ * @param font_path font file path, used to check the atlas is up to date.
+ * @param size font size.
+ * @param style font style.
+ * @return pointer to the atlas, NULL if there is no valid atlas.
+ */
+font_atlas_t* font_atlas_open(const char* name, const char* font_path, uint16_t size, uint16_t style);
+
+/**
+ * Close a glyph atlas.
+ * @param atlas pointer to the atlas.
+ */
+void font_atlas_close(font_atlas_t* atlas);
+
+/**
+ * Find a glyph in the atlas.
+ * @param atlas pointer to the atlas.
+ * @param unicode unicode of the glyph.
+ * @return pointer to the glyph, NULL if not found.
+ */
+const font_atlas_glyph_t* font_atlas_find_glyph(const font_atlas_t* atlas, uint32_t unicode);
+
+/**
+ * Get the A8 bitmap of a glyph.
+ * @param atlas pointer to the atlas.
+ * @param glyph pointer to the glyph.
+ * @return pointer to the bitmap, NULL if the glyph is corrupted.
+ */
+const uint8_t* font_atlas_get_bitmap(const font_atlas_t* atlas, const font_atlas_glyph_t* glyph);
+
+/**
+ * Calculate the fingerprint of a font file.
+ * @param font_path font file path.
+ * @param fingerprint return the fingerprint.
+ * @return return true on success.
+ */
+bool font_atlas_get_fingerprint(const char* font_path, uint32_t* fingerprint);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_ATLAS_H */
@@ -23,19 +23,47 @@ typedef struct {
     lv_freetype_info_t ft_info;
     char name[UIKIT_FONT_NAME_MAX];
     lv_font_t* font;
+    size_t mem_size;
 } font_cache_t;
 
+/* key of a font that is not cached, remembered by the 2Q policy */
+typedef struct {
+    lv_freetype_info_t ft_info;
+    char name[UIKIT_FONT_NAME_MAX];
+} font_cache_ghost_t;
+
 typedef struct _font_cache_manager_t {
-    lv_ll_t cache_ll;
+    lv_ll_t cache_ll; /* protected by lock, the LRU list, or the protected queue of 2Q */
+    lv_ll_t in_ll; /* 2Q probation queue, fonts put back without being reused */
+    lv_ll_t ghost_ll; /* 2Q keys of the reused fonts and of the fonts evicted on probation */
+    lv_mutex_t lock;
+    font_cache_close_cb_t close_cb;
+    void* user_data;
+    vg_font_cache_policy_t policy;
     uint32_t max_size;
+    uint32_t in_max_size;
+    size_t max_mem_size;
+    size_t cur_mem_size; /* the cached fonts and the shared memory only they hold */
+    size_t shared_mem_size;
+    size_t peak_mem_size;
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t evict_cnt;
+    uint32_t promote_cnt;
 } font_cache_manager_t;
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
-static void font_cache_close(font_cache_manager_t* manager, font_cache_t* cache);
-static void font_cache_manager_remove_tail(font_cache_manager_t* manager);
+static void font_cache_manager_insert(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info,
+    size_t mem_size, bool is_preload);
+static void font_cache_close_all(font_cache_manager_t* manager, lv_ll_t* cache_ll);
+static void font_cache_manager_fit(font_cache_manager_t* manager, uint32_t max_size, size_t reserve_mem_size,
+    bool reserve_in, lv_ll_t* evict_ll);
+static font_cache_t* font_cache_find(lv_ll_t* cache_ll, const lv_freetype_info_t* ft_info);
+static void font_cache_ghost_add(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info);
+static bool font_cache_ghost_remove(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info);
 
 /**********************
  *  STATIC VARIABLES
@@ -49,8 +77,11 @@ static void font_cache_manager_remove_tail(font_cache_manager_t* manager);
  *   GLOBAL FUNCTIONS
  **********************/
 
-font_cache_manager_t* font_cache_manager_create(uint32_t max_size)
+font_cache_manager_t* font_cache_manager_create(uint32_t max_size, size_t max_mem_size, vg_font_cache_policy_t policy,
+    font_cache_close_cb_t close_cb, void* user_data)
 {
+    LV_ASSERT_NULL(close_cb);
+
     font_cache_manager_t* manager = lv_malloc(sizeof(font_cache_manager_t));
     LV_ASSERT_MALLOC(manager);
     if (!manager) {
@@ -60,9 +91,20 @@ font_cache_manager_t* font_cache_manager_create(uint32_t max_size)
     lv_memzero(manager, sizeof(font_cache_manager_t));
 
     _lv_ll_init(&manager->cache_ll, sizeof(font_cache_t));
+    _lv_ll_init(&manager->in_ll, sizeof(font_cache_t));
+    _lv_ll_init(&manager->ghost_ll, sizeof(font_cache_ghost_t));
+    lv_mutex_init(&manager->lock);
+    manager->close_cb = close_cb;
+    manager->user_data = user_data;
+    manager->policy = policy;
     manager->max_size = max_size;
+    manager->max_mem_size = max_mem_size;
 
-    LV_LOG_INFO("success");
+    /* a quarter of the entries for the fonts on probation, as 2Q suggests */
+    manager->in_max_size = LV_MAX(max_size / 4, 1);
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32 ", max_mem_size: %" LV_PRIu32 ", policy: %d",
+        max_size, (uint32_t)max_mem_size, policy);
     return manager;
 }
 
@@ -70,64 +112,229 @@ void font_cache_manager_delete(font_cache_manager_t* manager)
 {
     LV_ASSERT_NULL(manager);
 
-    lv_ll_t* cache_ll = &manager->cache_ll;
-
-    font_cache_t* cache = _lv_ll_get_head(cache_ll);
-
     /* clear all cache */
-    while (cache != NULL) {
-        font_cache_t* cache_next = _lv_ll_get_next(cache_ll, cache);
-        font_cache_close(manager, cache);
-        cache = cache_next;
-    }
+    font_cache_close_all(manager, &manager->cache_ll);
+    font_cache_close_all(manager, &manager->in_ll);
+    _lv_ll_clear(&manager->ghost_ll);
+    manager->cur_mem_size = 0;
 
+    lv_mutex_delete(&manager->lock);
     lv_free(manager);
 
     LV_LOG_INFO("success");
 }
 
-lv_font_t* font_cache_manager_get_reuse(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info)
+lv_font_t* font_cache_manager_get_reuse(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info, size_t* mem_size)
 {
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(ft_info);
 
-    lv_ll_t* cache_ll = &manager->cache_ll;
-
     LV_LOG_INFO("font: %s(%d) searching...", ft_info->name, ft_info->size);
 
-    font_cache_t* cache;
-    _LV_LL_READ(cache_ll, cache)
-    {
-        /* match font */
-        if (font_utils_ft_info_is_equal(ft_info, &cache->ft_info)) {
-            lv_font_t* font = cache->font;
-            LV_LOG_INFO("cache hit");
+    lv_mutex_lock(&manager->lock);
+
+    lv_ll_t* cache_ll = &manager->cache_ll;
+    font_cache_t* cache = font_cache_find(cache_ll, ft_info);
+    if (!cache) {
+        cache_ll = &manager->in_ll;
+        cache = font_cache_find(cache_ll, ft_info);
+    }
+
+    if (cache) {
+        lv_font_t* font = cache->font;
+        LV_LOG_INFO("cache hit");
 
-            /* remove reused cache */
-            _lv_ll_remove(cache_ll, cache);
-            lv_free(cache);
-            return font;
+        if (mem_size) {
+            *mem_size = cache->mem_size;
         }
+        manager->cur_mem_size -= cache->mem_size;
+        manager->hit_cnt++;
+
+        /* the font is reused, it goes to the protected queue when put back */
+        font_cache_ghost_add(manager, &cache->ft_info);
+
+        /* remove reused cache */
+        _lv_ll_remove(cache_ll, cache);
+        lv_mutex_unlock(&manager->lock);
+        lv_free(cache);
+        return font;
     }
 
+    manager->miss_cnt++;
+    lv_mutex_unlock(&manager->lock);
+
     LV_LOG_INFO("cache miss");
 
     return NULL;
 }
 
-void font_cache_manager_set_reuse(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info)
+void font_cache_manager_set_reuse(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info, size_t mem_size)
+{
+    font_cache_manager_insert(manager, font, ft_info, mem_size, false);
+}
+
+void font_cache_manager_set_preload(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info,
+    size_t mem_size)
+{
+    font_cache_manager_insert(manager, font, ft_info, mem_size, true);
+}
+
+void font_cache_manager_set_max_mem_size(font_cache_manager_t* manager, size_t max_mem_size)
+{
+    LV_ASSERT_NULL(manager);
+
+    lv_ll_t evict_ll;
+    _lv_ll_init(&evict_ll, sizeof(font_cache_t));
+
+    lv_mutex_lock(&manager->lock);
+    manager->max_mem_size = max_mem_size;
+    font_cache_manager_fit(manager, manager->max_size, 0, false, &evict_ll);
+    LV_LOG_INFO("max_mem_size: %" LV_PRIu32 ", cur_mem_size: %" LV_PRIu32,
+        (uint32_t)max_mem_size, (uint32_t)manager->cur_mem_size);
+    lv_mutex_unlock(&manager->lock);
+
+    font_cache_close_all(manager, &evict_ll);
+}
+
+void font_cache_manager_set_shared_mem_size(font_cache_manager_t* manager, size_t shared_mem_size)
+{
+    LV_ASSERT_NULL(manager);
+
+    lv_ll_t evict_ll;
+    _lv_ll_init(&evict_ll, sizeof(font_cache_t));
+
+    lv_mutex_lock(&manager->lock);
+
+    bool is_grown = shared_mem_size > manager->shared_mem_size;
+    manager->cur_mem_size = manager->cur_mem_size - manager->shared_mem_size + shared_mem_size;
+    manager->shared_mem_size = shared_mem_size;
+    manager->peak_mem_size = LV_MAX(manager->peak_mem_size, manager->cur_mem_size);
+
+    /* shrinking never evicts, the fonts closing now may call back here */
+    if (is_grown) {
+        font_cache_manager_fit(manager, manager->max_size, 0, false, &evict_ll);
+    }
+
+    LV_LOG_INFO("shared_mem_size: %" LV_PRIu32 ", cur_mem_size: %" LV_PRIu32,
+        (uint32_t)shared_mem_size, (uint32_t)manager->cur_mem_size);
+    lv_mutex_unlock(&manager->lock);
+
+    font_cache_close_all(manager, &evict_ll);
+}
+
+void font_cache_manager_set_policy(font_cache_manager_t* manager, vg_font_cache_policy_t policy)
+{
+    LV_ASSERT_NULL(manager);
+
+    lv_mutex_lock(&manager->lock);
+
+    if (policy != manager->policy) {
+        /* the fonts on probation are the least valuable ones for LRU too */
+        font_cache_t* cache;
+        while ((cache = _lv_ll_get_head(&manager->in_ll)) != NULL) {
+            _lv_ll_chg_list(&manager->in_ll, &manager->cache_ll, cache, false);
+        }
+
+        _lv_ll_clear(&manager->ghost_ll);
+        manager->policy = policy;
+    }
+
+    LV_LOG_INFO("policy: %d", policy);
+    lv_mutex_unlock(&manager->lock);
+}
+
+void font_cache_manager_get_mem_usage(font_cache_manager_t* manager, size_t* cur_size, size_t* peak_size)
+{
+    LV_ASSERT_NULL(manager);
+
+    lv_mutex_lock(&manager->lock);
+
+    if (cur_size) {
+        *cur_size = manager->cur_mem_size;
+    }
+
+    if (peak_size) {
+        *peak_size = manager->peak_mem_size;
+    }
+
+    lv_mutex_unlock(&manager->lock);
+}
+
+void font_cache_manager_get_stats(font_cache_manager_t* manager, font_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(stats);
+
+    lv_mutex_lock(&manager->lock);
+    stats->hit_cnt = manager->hit_cnt;
+    stats->miss_cnt = manager->miss_cnt;
+    stats->evict_cnt = manager->evict_cnt;
+    stats->promote_cnt = manager->promote_cnt;
+    stats->entry_cnt = _lv_ll_get_len(&manager->cache_ll) + _lv_ll_get_len(&manager->in_ll);
+    stats->cur_mem_size = manager->cur_mem_size;
+    stats->peak_mem_size = manager->peak_mem_size;
+    lv_mutex_unlock(&manager->lock);
+}
+
+size_t font_cache_manager_clear(font_cache_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+
+    lv_ll_t evict_ll;
+    _lv_ll_init(&evict_ll, sizeof(font_cache_t));
+
+    lv_mutex_lock(&manager->lock);
+    size_t mem_size = manager->cur_mem_size;
+    font_cache_manager_fit(manager, 0, 0, false, &evict_ll);
+    lv_mutex_unlock(&manager->lock);
+
+    font_cache_close_all(manager, &evict_ll);
+
+    LV_LOG_INFO("released %" LV_PRIu32 " bytes", (uint32_t)mem_size);
+    return mem_size;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void font_cache_manager_insert(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info,
+    size_t mem_size, bool is_preload)
 {
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(ft_info);
 
-    lv_ll_t* cache_ll = &manager->cache_ll;
+    lv_ll_t evict_ll;
+    _lv_ll_init(&evict_ll, sizeof(font_cache_t));
 
-    /* check cached size */
-    if (_lv_ll_get_len(cache_ll) >= manager->max_size) {
-        LV_LOG_INFO("cache full, remove tail cache...");
-        font_cache_manager_remove_tail(manager);
+    lv_mutex_lock(&manager->lock);
+
+    /* the font alone exceeds the budget, no need to keep it */
+    if (manager->max_mem_size && mem_size > manager->max_mem_size) {
+        LV_LOG_INFO("font: %s(%d) size %" LV_PRIu32 " > budget %" LV_PRIu32 ", close it",
+            ft_info->name, ft_info->size, (uint32_t)mem_size, (uint32_t)manager->max_mem_size);
+        lv_mutex_unlock(&manager->lock);
+
+        manager->close_cb(manager->user_data, font);
+        return;
     }
 
+    /* 2Q: fonts seen before are protected, the others wait on probation.
+     * A preload is asked for ahead of its use, the next preloads would evict
+     * it from the small probation queue before it is ever used.
+     */
+    lv_ll_t* cache_ll = &manager->cache_ll;
+    if (manager->policy == VG_FONT_CACHE_POLICY_2Q) {
+        if (font_cache_ghost_remove(manager, ft_info)) {
+            manager->promote_cnt++;
+        } else if (!is_preload) {
+            cache_ll = &manager->in_ll;
+        }
+    }
+
+    /* make room for the new font */
+    font_cache_manager_fit(manager, manager->max_size - 1, mem_size, cache_ll == &manager->in_ll, &evict_ll);
+
     /* record reuse font */
     font_cache_t* cache = _lv_ll_ins_head(cache_ll);
     LV_ASSERT_MALLOC(cache);
@@ -139,29 +346,135 @@ void font_cache_manager_set_reuse(font_cache_manager_t* manager, lv_font_t* font
     cache->font = font;
     cache->ft_info = *ft_info;
     cache->ft_info.name = cache->name;
+    cache->mem_size = mem_size;
+
+    manager->cur_mem_size += mem_size;
+    manager->peak_mem_size = LV_MAX(manager->peak_mem_size, manager->cur_mem_size);
 
-    LV_LOG_INFO("insert font: %s(%d) to reuse list", ft_info->name, ft_info->size);
+    LV_LOG_INFO("insert font: %s(%d) size %" LV_PRIu32 " to %s list, total %" LV_PRIu32,
+        ft_info->name, ft_info->size, (uint32_t)mem_size, cache_ll == &manager->in_ll ? "probation" : "reuse",
+        (uint32_t)manager->cur_mem_size);
+
+    lv_mutex_unlock(&manager->lock);
+
+    /* close the evicted fonts without blocking other cache users */
+    font_cache_close_all(manager, &evict_ll);
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
+static void font_cache_close_all(font_cache_manager_t* manager, lv_ll_t* cache_ll)
+{
+    font_cache_t* cache;
+    while ((cache = _lv_ll_get_head(cache_ll)) != NULL) {
+        LV_LOG_INFO("font: %s(%d) close", cache->ft_info.name, cache->ft_info.size);
+        manager->close_cb(manager->user_data, cache->font);
+        _lv_ll_remove(cache_ll, cache);
+        lv_free(cache);
+    }
+}
 
-static void font_cache_close(font_cache_manager_t* manager, font_cache_t* cache)
+static void font_cache_manager_fit(font_cache_manager_t* manager, uint32_t max_size, size_t reserve_mem_size,
+    bool reserve_in, lv_ll_t* evict_ll)
 {
-    LV_ASSERT_NULL(manager);
-    LV_ASSERT_NULL(cache);
+    lv_ll_t* in_ll = &manager->in_ll;
+    size_t max_mem_size = manager->max_mem_size;
+
+    while (true) {
+        uint32_t in_len = _lv_ll_get_len(in_ll);
+        uint32_t len = in_len + _lv_ll_get_len(&manager->cache_ll);
+        bool over_size = len > max_size;
+        bool over_mem = max_mem_size && manager->cur_mem_size + reserve_mem_size > max_mem_size;
+        if (len == 0 || (!over_size && !over_mem)) {
+            break;
+        }
+
+        /* the probation queue pays first while over its share, a scan of
+         * one-off fonts can't flush the reused ones
+         */
+        lv_ll_t* cache_ll = &manager->cache_ll;
+        if (in_len && (in_len + reserve_in > manager->in_max_size || _lv_ll_is_empty(cache_ll))) {
+            cache_ll = in_ll;
+        }
 
-    LV_LOG_INFO("font: %s(%d) close", cache->ft_info.name, cache->ft_info.size);
-    lv_freetype_font_delete(cache->font);
+        /* the caller closes the evicted fonts after unlocking */
+        LV_LOG_INFO("cache full, remove tail cache...");
+        font_cache_t* tail = _lv_ll_get_tail(cache_ll);
+        if (cache_ll == in_ll) {
+            font_cache_ghost_add(manager, &tail->ft_info);
+        }
+        manager->cur_mem_size -= tail->mem_size;
+        manager->evict_cnt++;
+        _lv_ll_chg_list(cache_ll, evict_ll, tail, true);
+    }
+}
+
+static font_cache_t* font_cache_find(lv_ll_t* cache_ll, const lv_freetype_info_t* ft_info)
+{
+    font_cache_t* cache;
+    _LV_LL_READ(cache_ll, cache)
+    {
+        if (font_utils_ft_info_is_equal(ft_info, &cache->ft_info)) {
+            return cache;
+        }
+    }
 
-    _lv_ll_remove(&manager->cache_ll, cache);
-    lv_free(cache);
+    return NULL;
 }
 
-static void font_cache_manager_remove_tail(font_cache_manager_t* manager)
+static font_cache_ghost_t* font_cache_ghost_find(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info)
 {
-    font_cache_t* tail = _lv_ll_get_tail(&manager->cache_ll);
-    LV_ASSERT_NULL(tail);
-    font_cache_close(manager, tail);
+    font_cache_ghost_t* ghost;
+    _LV_LL_READ(&manager->ghost_ll, ghost)
+    {
+        if (font_utils_ft_info_is_equal(ft_info, &ghost->ft_info)) {
+            return ghost;
+        }
+    }
+
+    return NULL;
+}
+
+static void font_cache_ghost_add(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info)
+{
+    if (manager->policy != VG_FONT_CACHE_POLICY_2Q) {
+        return;
+    }
+
+    lv_ll_t* ghost_ll = &manager->ghost_ll;
+    font_cache_ghost_t* ghost = font_cache_ghost_find(manager, ft_info);
+    if (ghost) {
+        _lv_ll_move_before(ghost_ll, ghost, _lv_ll_get_head(ghost_ll));
+        return;
+    }
+
+    /* remember as many keys as fonts, the oldest are forgotten */
+    while (_lv_ll_get_len(ghost_ll) >= manager->max_size) {
+        ghost = _lv_ll_get_tail(ghost_ll);
+        _lv_ll_remove(ghost_ll, ghost);
+        lv_free(ghost);
+    }
+
+    ghost = _lv_ll_ins_head(ghost_ll);
+    LV_ASSERT_MALLOC(ghost);
+    if (!ghost) {
+        LV_LOG_WARN("malloc failed for font_cache_ghost_t");
+        return;
+    }
+    lv_memzero(ghost, sizeof(font_cache_ghost_t));
+
+    strncpy(ghost->name, ft_info->name, sizeof(ghost->name));
+    ghost->name[sizeof(ghost->name) - 1] = '\0';
+    ghost->ft_info = *ft_info;
+    ghost->ft_info.name = ghost->name;
+}
+
+static bool font_cache_ghost_remove(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info)
+{
+    font_cache_ghost_t* ghost = font_cache_ghost_find(manager, ft_info);
+    if (!ghost) {
+        return false;
+    }
+
+    _lv_ll_remove(&manager->ghost_ll, ghost);
+    lv_free(ghost);
+    return true;
 }
@@ -14,6 +14,7 @@ extern "C" {
  *      INCLUDES
  *********************/
 
+#include "uikit/uikit_font_manager.h"
 #include <lvgl/lvgl.h>
 
 /*********************
@@ -31,6 +32,23 @@ extern "C" {
 typedef struct _lv_freetype_info_t lv_freetype_info_t;
 typedef struct _font_cache_manager_t font_cache_manager_t;
 
+/**
+ * Close a font the cache lets go, called without the cache lock.
+ * @param user_data custom parameter.
+ * @param font the font.
+ */
+typedef void (*font_cache_close_cb_t)(void* user_data, lv_font_t* font);
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t evict_cnt;
+    uint32_t promote_cnt; /* fonts put back to the 2Q protected queue */
+    uint32_t entry_cnt;
+    size_t cur_mem_size;
+    size_t peak_mem_size;
+} font_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -38,9 +56,14 @@ typedef struct _font_cache_manager_t font_cache_manager_t;
 /**
  * Create font cache manager.
  * @param max_size cache size.
+ * @param max_mem_size memory budget in bytes, 0 means unlimited.
+ * @param policy replacement policy.
+ * @param close_cb close the evicted fonts.
+ * @param user_data custom parameter of close_cb.
  * @return pointer to font cache manager.
  */
-font_cache_manager_t* font_cache_manager_create(uint32_t max_size);
+font_cache_manager_t* font_cache_manager_create(uint32_t max_size, size_t max_mem_size, vg_font_cache_policy_t policy,
+    font_cache_close_cb_t close_cb, void* user_data);
 
 /**
  * Delete font cache manager.
@@ -52,16 +75,72 @@ void font_cache_manager_delete(font_cache_manager_t* manager);
  * Get a reusable font.
  * @param manager pointer to font cache manager.
  * @param ft_info font info.
+ * @param mem_size return the memory charged for the font, can be NULL.
  * @return returns true on success.
  */
-lv_font_t* font_cache_manager_get_reuse(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info);
+lv_font_t* font_cache_manager_get_reuse(font_cache_manager_t* manager, const lv_freetype_info_t* ft_info, size_t* mem_size);
 
 /**
  * Set fonts to be reused.
  * @param manager pointer to font cache manager.
  * @param ft_info font info.
+ * @param mem_size memory held by the font, without what it shares with others.
+ */
+void font_cache_manager_set_reuse(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info, size_t mem_size);
+
+/**
+ * Set a font opened ahead of its use, the 2Q policy protects it at once.
+ * @param manager pointer to font cache manager.
+ * @param font the font.
+ * @param ft_info font info.
+ * @param mem_size memory held by the font, without what it shares with others.
+ */
+void font_cache_manager_set_preload(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info,
+    size_t mem_size);
+
+/**
+ * Set the memory budget, evict fonts until the cache fits.
+ * @param manager pointer to font cache manager.
+ * @param max_mem_size memory budget in bytes, 0 means unlimited.
+ */
+void font_cache_manager_set_max_mem_size(font_cache_manager_t* manager, size_t max_mem_size);
+
+/**
+ * Set the memory the cached fonts share and only they hold, such as their faces.
+ * It counts toward the budget once, fonts are evicted when it grows.
+ * @param manager pointer to font cache manager.
+ * @param shared_mem_size shared memory in bytes.
+ */
+void font_cache_manager_set_shared_mem_size(font_cache_manager_t* manager, size_t shared_mem_size);
+
+/**
+ * Set the replacement policy, the cached fonts are kept.
+ * @param manager pointer to font cache manager.
+ * @param policy replacement policy.
+ */
+void font_cache_manager_set_policy(font_cache_manager_t* manager, vg_font_cache_policy_t policy);
+
+/**
+ * Get the memory held by the cached fonts.
+ * @param manager pointer to font cache manager.
+ * @param cur_size return the current usage in bytes, can be NULL.
+ * @param peak_size return the peak usage in bytes, can be NULL.
+ */
+void font_cache_manager_get_mem_usage(font_cache_manager_t* manager, size_t* cur_size, size_t* peak_size);
+
+/**
+ * Get the cache statistics.
+ * @param manager pointer to font cache manager.
+ * @param stats return the statistics.
+ */
+void font_cache_manager_get_stats(font_cache_manager_t* manager, font_cache_stats_t* stats);
+
+/**
+ * Close all cached fonts.
+ * @param manager pointer to font cache manager.
+ * @return return the memory released in bytes.
  */
-void font_cache_manager_set_reuse(font_cache_manager_t* manager, lv_font_t* font, const lv_freetype_info_t* ft_info);
+size_t font_cache_manager_clear(font_cache_manager_t* manager);
 
 /**********************
  *      MACROS
@@ -0,0 +1,311 @@
+/**
+ * @file font_cfg.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_cfg.h"
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+#include "font_utils.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool font_cfg_attach(font_cfg_t* cfg);
+static bool font_cfg_check_table(size_t data_size, uint32_t offset, uint32_t cnt, size_t item_size);
+static const font_cfg_seq_t* font_cfg_find_seq_child(const font_cfg_t* cfg, uint32_t child_index, uint32_t child_cnt,
+    uint32_t unicode);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define FONT_CFG_CHECK_STR(offset) ((offset) < header->str_size)
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+bool font_cfg_open(font_cfg_t* cfg, const char* path)
+{
+    LV_ASSERT_NULL(cfg);
+    LV_ASSERT_NULL(path);
+    lv_memzero(cfg, sizeof(font_cfg_t));
+
+    if (!font_utils_file_map(path, &cfg->data, &cfg->data_size, &cfg->is_mapped)) {
+        return false;
+    }
+
+    if (!font_cfg_attach(cfg)) {
+        LV_LOG_WARN("config: %s is invalid", path);
+        font_cfg_close(cfg);
+        return false;
+    }
+
+    LV_LOG_INFO("config: %s open OK", path);
+    return true;
+}
+
+bool font_cfg_load_json(font_cfg_t* cfg, const char* path)
+{
+    LV_ASSERT_NULL(cfg);
+    LV_ASSERT_NULL(path);
+    lv_memzero(cfg, sizeof(font_cfg_t));
+
+    font_utils_json_obj_t* json_obj = font_utils_json_obj_create(path);
+    if (!json_obj) {
+        return false;
+    }
+
+    size_t size;
+    uint8_t* data = font_utils_json_compile_cfg(json_obj, &size);
+    font_utils_json_obj_delete(json_obj);
+
+    if (!data) {
+        LV_LOG_WARN("config: %s compile failed", path);
+        return false;
+    }
+
+    cfg->data = data;
+    cfg->data_size = size;
+    cfg->is_mapped = false;
+
+    if (!font_cfg_attach(cfg)) {
+        font_cfg_close(cfg);
+        return false;
+    }
+
+    LV_LOG_INFO("config: %s load OK", path);
+    return true;
+}
+
+void font_cfg_close(font_cfg_t* cfg)
+{
+    LV_ASSERT_NULL(cfg);
+
+    if (cfg->data) {
+        font_utils_file_unmap(cfg->data, cfg->data_size, cfg->is_mapped);
+    }
+
+    lv_memzero(cfg, sizeof(font_cfg_t));
+}
+
+const font_cfg_family_t* font_cfg_find_family(const font_cfg_t* cfg, const char* name)
+{
+    LV_ASSERT_NULL(cfg);
+    LV_ASSERT_NULL(name);
+
+    if (!cfg->header) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < cfg->header->family_cnt; i++) {
+        const font_cfg_family_t* family = &cfg->family_arr[i];
+        if (strcmp(name, font_cfg_get_str(cfg, family->font_name)) == 0) {
+            return family;
+        }
+    }
+
+    return NULL;
+}
+
+bool font_cfg_emoji_has_unicode(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji, uint32_t unicode)
+{
+    LV_ASSERT_NULL(cfg);
+    LV_ASSERT_NULL(emoji);
+
+    const font_cfg_range_t* range_arr = &cfg->range_arr[emoji->range_index];
+    uint32_t low = 0;
+    uint32_t high = emoji->range_cnt;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const font_cfg_range_t* range = &range_arr[mid];
+        if (unicode < range->begin) {
+            high = mid;
+        } else if (unicode > range->end) {
+            low = mid + 1;
+        } else {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const font_cfg_seq_t* font_cfg_emoji_match_seq(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    const uint32_t* unicode_arr, uint32_t unicode_cnt)
+{
+    LV_ASSERT_NULL(cfg);
+    LV_ASSERT_NULL(emoji);
+    LV_ASSERT_NULL(unicode_arr);
+
+    const font_cfg_seq_t* match = NULL;
+    uint32_t child_index = emoji->seq_index;
+    uint32_t child_cnt = emoji->seq_cnt;
+
+    for (uint32_t i = 0; i < unicode_cnt && child_cnt; i++) {
+        const font_cfg_seq_t* node = font_cfg_find_seq_child(cfg, child_index, child_cnt, unicode_arr[i]);
+        if (!node) {
+            break;
+        }
+
+        /* keep the longest sequence that has an image */
+        if (node->image != FONT_CFG_SEQ_NO_IMAGE) {
+            match = node;
+        }
+
+        child_index = node->child_index;
+        child_cnt = node->child_cnt;
+    }
+
+    return match;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static const font_cfg_seq_t* font_cfg_find_seq_child(const font_cfg_t* cfg, uint32_t child_index, uint32_t child_cnt,
+    uint32_t unicode)
+{
+    const font_cfg_seq_t* child_arr = &cfg->seq_arr[child_index];
+    uint32_t low = 0;
+    uint32_t high = child_cnt;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const font_cfg_seq_t* node = &child_arr[mid];
+        if (node->unicode == unicode) {
+            return node;
+        }
+
+        if (node->unicode < unicode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+static bool font_cfg_attach(font_cfg_t* cfg)
+{
+    if (cfg->data_size < sizeof(font_cfg_header_t)) {
+        LV_LOG_WARN("bad size: %" LV_PRIu32, (uint32_t)cfg->data_size);
+        return false;
+    }
+
+    const font_cfg_header_t* header = (const font_cfg_header_t*)cfg->data;
+
+    if (header->magic != FONT_CFG_MAGIC || header->version != FONT_CFG_VERSION) {
+        LV_LOG_WARN("bad magic: 0x%" LV_PRIx32 " or version: %d", header->magic, header->version);
+        return false;
+    }
+
+    /* the tables are used in place, check the layout once */
+    if (header->header_size < sizeof(font_cfg_header_t)
+        || !font_cfg_check_table(cfg->data_size, header->emoji_offset, header->emoji_cnt, sizeof(font_cfg_emoji_t))
+        || !font_cfg_check_table(cfg->data_size, header->family_offset, header->family_cnt, sizeof(font_cfg_family_t))
+        || !font_cfg_check_table(cfg->data_size, header->fallback_offset, header->fallback_cnt, sizeof(uint32_t))
+        || !font_cfg_check_table(cfg->data_size, header->cover_offset, header->fallback_cnt, sizeof(font_cfg_cover_t))
+        || !font_cfg_check_table(cfg->data_size, header->range_offset, header->range_cnt, sizeof(font_cfg_range_t))
+        || !font_cfg_check_table(cfg->data_size, header->seq_offset, header->seq_cnt, sizeof(font_cfg_seq_t))
+        || !font_cfg_check_table(cfg->data_size, header->str_offset, header->str_size, sizeof(char))) {
+        LV_LOG_WARN("bad layout");
+        return false;
+    }
+
+    cfg->emoji_arr = (const font_cfg_emoji_t*)(cfg->data + header->emoji_offset);
+    cfg->family_arr = (const font_cfg_family_t*)(cfg->data + header->family_offset);
+    cfg->fallback_arr = (const uint32_t*)(cfg->data + header->fallback_offset);
+    cfg->cover_arr = (const font_cfg_cover_t*)(cfg->data + header->cover_offset);
+    cfg->range_arr = (const font_cfg_range_t*)(cfg->data + header->range_offset);
+    cfg->seq_arr = (const font_cfg_seq_t*)(cfg->data + header->seq_offset);
+    cfg->str_table = (const char*)(cfg->data + header->str_offset);
+
+    /* the string table must end with a terminator, so every offset is a valid string */
+    if (header->str_size && cfg->str_table[header->str_size - 1] != '\0') {
+        LV_LOG_WARN("string table not terminated");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->emoji_cnt; i++) {
+        const font_cfg_emoji_t* emoji = &cfg->emoji_arr[i];
+        if (!FONT_CFG_CHECK_STR(emoji->font_name)
+            || !FONT_CFG_CHECK_STR(emoji->path)
+            || !FONT_CFG_CHECK_STR(emoji->ext)
+            || (uint64_t)emoji->path + emoji->path_len >= header->str_size
+            || (uint64_t)emoji->ext + emoji->ext_len >= header->str_size
+            || (uint64_t)emoji->range_index + emoji->range_cnt > header->range_cnt
+            || (uint64_t)emoji->seq_index + emoji->seq_cnt > header->seq_cnt) {
+            LV_LOG_WARN("bad emoji[%" LV_PRIu32 "]", i);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->family_cnt; i++) {
+        const font_cfg_family_t* family = &cfg->family_arr[i];
+        if (!FONT_CFG_CHECK_STR(family->font_name)
+            || (uint64_t)family->fallback_index + family->fallback_cnt > header->fallback_cnt) {
+            LV_LOG_WARN("bad font family[%" LV_PRIu32 "]", i);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->seq_cnt; i++) {
+        const font_cfg_seq_t* seq = &cfg->seq_arr[i];
+
+        /* children always follow their parent, so walking the trie terminates */
+        if ((uint64_t)seq->child_index + seq->child_cnt > header->seq_cnt
+            || (seq->child_cnt && seq->child_index <= i)
+            || (seq->image != FONT_CFG_SEQ_NO_IMAGE && !FONT_CFG_CHECK_STR(seq->image))) {
+            LV_LOG_WARN("bad sequence[%" LV_PRIu32 "]", i);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->fallback_cnt; i++) {
+        const font_cfg_cover_t* cover = &cfg->cover_arr[i];
+        if (!FONT_CFG_CHECK_STR(cfg->fallback_arr[i])
+            || (uint64_t)cover->range_index + cover->range_cnt > header->range_cnt) {
+            LV_LOG_WARN("bad fallback[%" LV_PRIu32 "]", i);
+            return false;
+        }
+    }
+
+    cfg->header = header;
+
+    LV_LOG_INFO("%" LV_PRIu32 " emoji, %" LV_PRIu32 " font families",
+        header->emoji_cnt, header->family_cnt);
+    return true;
+}
+
+static bool font_cfg_check_table(size_t data_size, uint32_t offset, uint32_t cnt, size_t item_size)
+{
+    if (item_size > 1 && offset % sizeof(uint32_t) != 0) {
+        return false;
+    }
+
+    return (uint64_t)offset + (uint64_t)cnt * item_size <= data_size;
+}
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
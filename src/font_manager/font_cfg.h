@@ -0,0 +1,243 @@
+/**
+ * @file font_cfg.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_CFG_H
+#define FONT_MANAGER_FONT_CFG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* "UFCF" */
+#define FONT_CFG_MAGIC 0x46434655
+#define FONT_CFG_VERSION 4
+
+/* font_cfg_family_t::flags, render the family from distance fields */
+#define FONT_CFG_FAMILY_FLAG_SDF (1 << 0)
+
+/* font_cfg_seq_t::image of a node that only continues longer sequences */
+#define FONT_CFG_SEQ_NO_IMAGE 0xFFFFFFFF
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* on-disk layout, little endian, generated by tools/font_cfg_gen.py.
+ * All strings are offsets into the NUL-terminated string table.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t emoji_cnt;
+    uint32_t emoji_offset; /* offset of the emoji table from the file start */
+    uint32_t family_cnt;
+    uint32_t family_offset; /* offset of the font-family table from the file start */
+    uint32_t fallback_cnt;
+    uint32_t fallback_offset; /* offset of the fallback name table from the file start */
+    uint32_t cover_offset; /* offset of the fallback coverage table, fallback_cnt entries */
+    uint32_t range_cnt;
+    uint32_t range_offset; /* offset of the unicode range table from the file start */
+    uint32_t seq_cnt;
+    uint32_t seq_offset; /* offset of the emoji sequence trie from the file start */
+    uint32_t str_offset; /* offset of the string table from the file start */
+    uint32_t str_size;
+} font_cfg_header_t;
+
+typedef struct {
+    uint32_t font_name;
+    uint32_t path;
+    uint32_t ext;
+    uint16_t path_len;
+    uint16_t ext_len;
+    struct {
+        uint16_t min;
+        uint16_t max;
+    } match_size;
+    uint32_t range_index; /* first entry in the range table */
+    uint32_t range_cnt;
+    uint32_t seq_index; /* first root node in the sequence trie */
+    uint32_t seq_cnt;
+} font_cfg_emoji_t;
+
+/* unicode range, the ranges of an emoji or a fallback are sorted and don't overlap */
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+} font_cfg_range_t;
+
+/* unicode coverage of a fallback, no range means it may cover any unicode */
+typedef struct {
+    uint32_t range_index; /* first entry in the range table */
+    uint32_t range_cnt;
+} font_cfg_cover_t;
+
+/* sequence trie node, the children of a node are contiguous and sorted by unicode */
+typedef struct {
+    uint32_t unicode;
+    uint32_t child_index; /* first child in the sequence trie */
+    uint32_t child_cnt;
+    uint32_t image; /* image name offset, or FONT_CFG_SEQ_NO_IMAGE */
+} font_cfg_seq_t;
+
+typedef struct {
+    uint32_t font_name;
+    uint32_t fallback_index; /* first entry in the fallback name table */
+    uint32_t fallback_cnt;
+    uint32_t flags; /* FONT_CFG_FAMILY_FLAG_* */
+} font_cfg_family_t;
+
+/* font configuration view, embedded by the owner */
+typedef struct {
+    const uint8_t* data; /* whole image */
+    size_t data_size;
+    bool is_mapped; /* data is mmap-ed, otherwise lv_malloc-ed */
+    const font_cfg_header_t* header;
+    const font_cfg_emoji_t* emoji_arr;
+    const font_cfg_family_t* family_arr;
+    const uint32_t* fallback_arr; /* string offsets */
+    const font_cfg_cover_t* cover_arr; /* parallel to fallback_arr */
+    const font_cfg_range_t* range_arr;
+    const font_cfg_seq_t* seq_arr;
+    const char* str_table;
+} font_cfg_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Open a precompiled binary font configuration, the file is mapped, not parsed.
+ * @param cfg pointer to font configuration.
+ * @param path binary file path.
+ * @return return true if the file is valid.
+ */
+bool font_cfg_open(font_cfg_t* cfg, const char* path);
+
+/**
+ * Compile a json font configuration into an in-memory image.
+ * @param cfg pointer to font configuration.
+ * @param path json file path.
+ * @return return true on success.
+ */
+bool font_cfg_load_json(font_cfg_t* cfg, const char* path);
+
+/**
+ * Close a font configuration.
+ * @param cfg pointer to font configuration.
+ */
+void font_cfg_close(font_cfg_t* cfg);
+
+/**
+ * Check whether a font configuration is loaded.
+ * @param cfg pointer to font configuration.
+ * @return return true if loaded.
+ */
+static inline bool font_cfg_is_loaded(const font_cfg_t* cfg)
+{
+    return cfg->header != NULL;
+}
+
+/**
+ * Get a string of the string table.
+ * @param cfg pointer to font configuration.
+ * @param offset string offset.
+ * @return pointer to the string.
+ */
+static inline const char* font_cfg_get_str(const font_cfg_t* cfg, uint32_t offset)
+{
+    return cfg->str_table + offset;
+}
+
+/**
+ * Get the emoji count.
+ * @param cfg pointer to font configuration.
+ * @return emoji count.
+ */
+static inline uint32_t font_cfg_get_emoji_count(const font_cfg_t* cfg)
+{
+    return cfg->header ? cfg->header->emoji_cnt : 0;
+}
+
+/**
+ * Find a font family by name.
+ * @param cfg pointer to font configuration.
+ * @param name font family name.
+ * @return pointer to the font family, NULL if not found.
+ */
+const font_cfg_family_t* font_cfg_find_family(const font_cfg_t* cfg, const char* name);
+
+/**
+ * Check whether a unicode is covered by the ranges of an emoji, binary search.
+ * @param cfg pointer to font configuration.
+ * @param emoji pointer to the emoji.
+ * @param unicode unicode to check.
+ * @return return true if covered.
+ */
+bool font_cfg_emoji_has_unicode(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji, uint32_t unicode);
+
+/**
+ * Find the longest emoji sequence that has an image and prefixes a unicode string.
+ * @param cfg pointer to font configuration.
+ * @param emoji pointer to the emoji.
+ * @param unicode_arr unicode string.
+ * @param unicode_cnt unicode count.
+ * @return pointer to the trie node of the sequence, NULL if none matches.
+ */
+const font_cfg_seq_t* font_cfg_emoji_match_seq(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    const uint32_t* unicode_arr, uint32_t unicode_cnt);
+
+/**
+ * Get a fallback font name of a font family.
+ * @param cfg pointer to font configuration.
+ * @param family pointer to the font family.
+ * @param index fallback index, less than family->fallback_cnt.
+ * @return fallback font name.
+ */
+static inline const char* font_cfg_get_fallback(const font_cfg_t* cfg, const font_cfg_family_t* family, uint32_t index)
+{
+    return font_cfg_get_str(cfg, cfg->fallback_arr[family->fallback_index + index]);
+}
+
+/**
+ * Get the unicode ranges a fallback font of a font family covers.
+ * @param cfg pointer to font configuration.
+ * @param family pointer to the font family.
+ * @param index fallback index, less than family->fallback_cnt.
+ * @param range_cnt return the number of ranges, 0 if the fallback may cover any unicode.
+ * @return sorted ranges, NULL if range_cnt is 0.
+ */
+static inline const font_cfg_range_t* font_cfg_get_fallback_ranges(const font_cfg_t* cfg,
+    const font_cfg_family_t* family, uint32_t index, uint32_t* range_cnt)
+{
+    const font_cfg_cover_t* cover = &cfg->cover_arr[family->fallback_index + index];
+    *range_cnt = cover->range_cnt;
+    return cover->range_cnt ? &cfg->range_arr[cover->range_index] : NULL;
+}
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_CFG_H */
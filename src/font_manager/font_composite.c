@@ -0,0 +1,561 @@
+/**
+ * @file font_composite.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_composite.h"
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_COMPOSITE_MAP_MIN 64
+
+/* map entry: letter << 8 | slot, 0 is a free entry */
+#define FONT_COMPOSITE_SLOT_BITS 8
+#define FONT_COMPOSITE_SLOT_MASK 0xFF
+
+/* slot of a letter no member covers, members are stored from 1 */
+#define FONT_COMPOSITE_SLOT_NONE FONT_COMPOSITE_SLOT_MASK
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    lv_font_t* font; /* NULL until a glyph needs it, doesn't change once set */
+    const char* name;
+    const font_cfg_range_t* range_arr; /* NULL for any unicode */
+    uint32_t range_cnt;
+    bool is_wanted; /* a lookup stopped at it while closed */
+    bool is_failed; /* the open failed, not tried again */
+} font_composite_member_t;
+
+/* the font manager hands out &font, dsc leads back here */
+typedef struct {
+    lv_font_t font;
+
+    /* a leaf lock, no other lock is taken under it */
+    lv_mutex_t lock; /* the map, the member fonts and flags, and the flags below */
+    uint32_t* map_arr; /* open addressing, map_cap entries */
+    uint32_t map_cap; /* power of 2 */
+    uint32_t map_cnt;
+    uint32_t map_max;
+    uint32_t open_index; /* the member being opened */
+    bool is_wanted; /* a member is wanted */
+    bool is_opening; /* font_composite_publish is due */
+    bool is_deleted; /* deleted while opening, freed by font_composite_publish */
+    lv_font_t* opened_font; /* the member font_composite_open_next opened, not published yet */
+
+    uint16_t size;
+    uint16_t style;
+    font_composite_open_cb_t open_cb;
+    font_composite_close_cb_t close_cb;
+    font_composite_want_cb_t want_cb;
+    void* user_data;
+    uint32_t member_cnt;
+    font_composite_member_t member_arr[]; /* followed by the ranges and the names */
+} font_composite_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool font_composite_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next);
+static const void* font_composite_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+static bool font_composite_member_covers(const font_composite_member_t* member, uint32_t letter);
+static void font_composite_free(font_composite_t* composite);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+lv_font_t* font_composite_create(const font_composite_member_cfg_t member_arr[], uint32_t member_cnt, uint16_t size,
+    uint16_t style, uint32_t map_max, font_composite_open_cb_t open_cb, font_composite_close_cb_t close_cb,
+    font_composite_want_cb_t want_cb, void* user_data)
+{
+    LV_ASSERT_NULL(member_arr);
+    LV_ASSERT_NULL(open_cb);
+    LV_ASSERT_NULL(close_cb);
+    LV_ASSERT_NULL(want_cb);
+
+    if (member_cnt == 0 || member_cnt > FONT_COMPOSITE_MEMBER_MAX || map_max == 0) {
+        LV_LOG_WARN("invalid member_cnt: %" LV_PRIu32 ", map_max: %" LV_PRIu32, member_cnt, map_max);
+        return NULL;
+    }
+
+    size_t name_size = 0;
+    uint32_t range_cnt = 0;
+    for (uint32_t i = 0; i < member_cnt; i++) {
+        name_size += strlen(member_arr[i].name) + 1;
+        range_cnt += member_arr[i].range_cnt;
+    }
+
+    size_t alloc_size = sizeof(font_composite_t) + member_cnt * sizeof(font_composite_member_t)
+        + range_cnt * sizeof(font_cfg_range_t) + name_size;
+    font_composite_t* composite = lv_malloc(alloc_size);
+    LV_ASSERT_MALLOC(composite);
+    if (!composite) {
+        LV_LOG_ERROR("malloc failed for font_composite_t");
+        return NULL;
+    }
+    lv_memzero(composite, alloc_size);
+
+    /* grown on demand, the load stays under 3/4 */
+    composite->map_cap = FONT_COMPOSITE_MAP_MIN;
+    composite->map_max = map_max;
+    composite->map_arr = lv_malloc(composite->map_cap * sizeof(uint32_t));
+    LV_ASSERT_MALLOC(composite->map_arr);
+    if (!composite->map_arr) {
+        LV_LOG_ERROR("malloc failed for codepoint map");
+        lv_free(composite);
+        return NULL;
+    }
+    lv_memzero(composite->map_arr, composite->map_cap * sizeof(uint32_t));
+
+    font_cfg_range_t* range = (font_cfg_range_t*)&composite->member_arr[member_cnt];
+    char* name = (char*)(range + range_cnt);
+    for (uint32_t i = 0; i < member_cnt; i++) {
+        font_composite_member_t* member = &composite->member_arr[i];
+        size_t name_len = strlen(member_arr[i].name) + 1;
+        lv_memcpy(name, member_arr[i].name, name_len);
+        member->name = name;
+        name += name_len;
+
+        if (member_arr[i].range_cnt) {
+            lv_memcpy(range, member_arr[i].range_arr, member_arr[i].range_cnt * sizeof(font_cfg_range_t));
+            member->range_arr = range;
+            member->range_cnt = member_arr[i].range_cnt;
+            range += member_arr[i].range_cnt;
+        }
+    }
+
+    composite->member_cnt = member_cnt;
+    composite->size = size;
+    composite->style = style;
+    composite->open_cb = open_cb;
+    composite->close_cb = close_cb;
+    composite->want_cb = want_cb;
+    composite->user_data = user_data;
+    lv_mutex_init(&composite->lock);
+
+    /* the primary font lays out the lines, the metrics are filled by the members opened */
+    lv_font_t* font = &composite->font;
+
+    /* letter_next is passed on, each member applies its own kerning setting */
+    font->kerning = LV_FONT_KERNING_NORMAL;
+
+    font->get_glyph_dsc = font_composite_get_glyph_dsc_cb;
+    font->get_glyph_bitmap = font_composite_get_glyph_bitmap_cb;
+
+    /* the bitmap callback resolves the glyph to the member, which releases it */
+    font->release_glyph = NULL;
+    font->dsc = composite;
+
+    LV_LOG_INFO("success, member_cnt: %" LV_PRIu32 ", map_max: %" LV_PRIu32, member_cnt, map_max);
+    return font;
+}
+
+void font_composite_delete(lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT(font_composite_is_composite(font));
+
+    font_composite_t* composite = (font_composite_t*)font->dsc;
+
+    lv_mutex_lock(&composite->lock);
+    bool is_opening = composite->is_opening;
+    composite->is_deleted = true;
+    lv_mutex_unlock(&composite->lock);
+
+    if (is_opening) {
+        LV_LOG_INFO("member opening, freed by font_composite_publish");
+        return;
+    }
+
+    font_composite_free(composite);
+}
+
+bool font_composite_start_open(lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT(font_composite_is_composite(font));
+
+    font_composite_t* composite = (font_composite_t*)font->dsc;
+
+    lv_mutex_lock(&composite->lock);
+    bool retval = false;
+    if (composite->is_wanted && !composite->is_opening && !composite->is_deleted) {
+        /* the first one in fallback order, the others are picked up by the next calls */
+        composite->is_wanted = false;
+        for (uint32_t i = 0; i < composite->member_cnt; i++) {
+            font_composite_member_t* member = &composite->member_arr[i];
+            if (!member->is_wanted) {
+                continue;
+            }
+
+            /* marked again while it was being opened */
+            if (member->font || member->is_failed) {
+                member->is_wanted = false;
+                continue;
+            }
+
+            if (retval) {
+                composite->is_wanted = true;
+                break;
+            }
+
+            member->is_wanted = false;
+            composite->open_index = i;
+            composite->is_opening = true;
+            retval = true;
+        }
+    }
+    lv_mutex_unlock(&composite->lock);
+
+    return retval;
+}
+
+void font_composite_open_next(lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT(font_composite_is_composite(font));
+
+    font_composite_t* composite = (font_composite_t*)font->dsc;
+
+    lv_mutex_lock(&composite->lock);
+    LV_ASSERT(composite->is_opening);
+    const font_composite_member_t* member = &composite->member_arr[composite->open_index];
+    bool is_deleted = composite->is_deleted;
+    lv_mutex_unlock(&composite->lock);
+
+    /* nobody waits for it, font_composite_publish frees it */
+    if (is_deleted) {
+        return;
+    }
+
+    /* no lock held, it may map the font file */
+    LV_LOG_INFO("open member: %s(%d)", member->name, composite->size);
+    lv_font_t* member_font = composite->open_cb(composite->user_data, member->name, composite->size, composite->style);
+    if (!member_font) {
+        LV_LOG_WARN("member %s(%d) open failed, skipped", member->name, composite->size);
+    }
+
+    lv_mutex_lock(&composite->lock);
+    composite->opened_font = member_font;
+    lv_mutex_unlock(&composite->lock);
+}
+
+void font_composite_publish(lv_font_t* font, bool cancelled)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT(font_composite_is_composite(font));
+
+    font_composite_t* composite = (font_composite_t*)font->dsc;
+
+    lv_mutex_lock(&composite->lock);
+    LV_ASSERT(composite->is_opening);
+    font_composite_member_t* member = &composite->member_arr[composite->open_index];
+    lv_font_t* member_font = composite->opened_font;
+    composite->opened_font = NULL;
+    bool is_deleted = composite->is_deleted;
+    bool is_dropped = cancelled || is_deleted;
+    if (is_dropped) {
+        /* the member is tried again on the next miss */
+        composite->is_opening = false;
+    }
+    lv_mutex_unlock(&composite->lock);
+
+    if (is_dropped) {
+        if (member_font) {
+            composite->close_cb(composite->user_data, member_font);
+        }
+
+        if (is_deleted) {
+            font_composite_free(composite);
+        }
+        return;
+    }
+
+    /* under the LVGL lock, the layout reads the line metrics */
+    if (member_font) {
+        if (font->line_height == 0) {
+            font->subpx = member_font->subpx;
+            font->underline_position = member_font->underline_position;
+            font->underline_thickness = member_font->underline_thickness;
+        }
+        font->line_height = LV_MAX(font->line_height, member_font->line_height);
+        font->base_line = LV_MAX(font->base_line, member_font->base_line);
+    }
+
+    lv_mutex_lock(&composite->lock);
+    member->font = member_font;
+    member->is_failed = member_font == NULL;
+    composite->is_opening = false;
+    is_deleted = composite->is_deleted;
+    lv_mutex_unlock(&composite->lock);
+
+    if (is_deleted) {
+        font_composite_free(composite);
+        return;
+    }
+
+    /* the glyphs the lookups missed are laid out and drawn again */
+    lv_obj_report_style_change(NULL);
+}
+
+void* font_composite_get_user_data(const lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT(font_composite_is_composite(font));
+
+    const font_composite_t* composite = (const font_composite_t*)font->dsc;
+    return composite->user_data;
+}
+
+bool font_composite_is_composite(const lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    return font->get_glyph_dsc == font_composite_get_glyph_dsc_cb;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static inline uint32_t font_composite_hash(uint32_t letter)
+{
+    /* Fibonacci hashing, neighbouring codepoints land apart */
+    return letter * 2654435761u;
+}
+
+/* slot of the letter, 0 if it wasn't looked up yet */
+static uint32_t font_composite_map_find(const font_composite_t* composite, uint32_t letter)
+{
+    uint32_t mask = composite->map_cap - 1;
+    for (uint32_t i = font_composite_hash(letter) & mask;; i = (i + 1) & mask) {
+        uint32_t entry = composite->map_arr[i];
+        if (entry == 0) {
+            return 0;
+        }
+
+        if (entry >> FONT_COMPOSITE_SLOT_BITS == letter) {
+            return entry & FONT_COMPOSITE_SLOT_MASK;
+        }
+    }
+}
+
+static void font_composite_map_put(uint32_t* map_arr, uint32_t map_cap, uint32_t entry)
+{
+    uint32_t mask = map_cap - 1;
+    uint32_t i = font_composite_hash(entry >> FONT_COMPOSITE_SLOT_BITS) & mask;
+    while (map_arr[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    map_arr[i] = entry;
+}
+
+static bool font_composite_map_grow(font_composite_t* composite)
+{
+    uint32_t map_cap = composite->map_cap * 2;
+    uint32_t* map_arr = lv_malloc(map_cap * sizeof(uint32_t));
+    if (!map_arr) {
+        LV_LOG_WARN("malloc failed for %" LV_PRIu32 " map entries", map_cap);
+        return false;
+    }
+    lv_memzero(map_arr, map_cap * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < composite->map_cap; i++) {
+        if (composite->map_arr[i]) {
+            font_composite_map_put(map_arr, map_cap, composite->map_arr[i]);
+        }
+    }
+
+    lv_free(composite->map_arr);
+    composite->map_arr = map_arr;
+    composite->map_cap = map_cap;
+    return true;
+}
+
+static void font_composite_map_insert(font_composite_t* composite, uint32_t letter, uint32_t slot)
+{
+    /* not a unicode codepoint, asked again on every lookup */
+    if (letter > UINT32_MAX >> FONT_COMPOSITE_SLOT_BITS) {
+        return;
+    }
+
+    /* the codepoints of a few screens fill it, start over with the next ones */
+    if (composite->map_cnt >= composite->map_max) {
+        LV_LOG_INFO("codepoint map full, %" LV_PRIu32 " entries dropped", composite->map_cnt);
+        lv_memzero(composite->map_arr, composite->map_cap * sizeof(uint32_t));
+        composite->map_cnt = 0;
+    }
+
+    /* keep at least one free entry, the lookups stop there */
+    if ((composite->map_cnt + 1) * 4 > composite->map_cap * 3 && !font_composite_map_grow(composite)
+        && composite->map_cnt + 1 >= composite->map_cap) {
+        return;
+    }
+
+    font_composite_map_put(composite->map_arr, composite->map_cap, letter << FONT_COMPOSITE_SLOT_BITS | slot);
+    composite->map_cnt++;
+}
+
+static bool font_composite_member_covers(const font_composite_member_t* member, uint32_t letter)
+{
+    if (!member->range_arr) {
+        return true;
+    }
+
+    uint32_t low = 0;
+    uint32_t high = member->range_cnt;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const font_cfg_range_t* range = &member->range_arr[mid];
+        if (letter < range->begin) {
+            high = mid;
+        } else if (letter > range->end) {
+            low = mid + 1;
+        } else {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t font_composite_probe(font_composite_t* composite, lv_font_glyph_dsc_t* dsc, uint32_t letter,
+    uint32_t letter_next)
+{
+    /* first lookup, ask the members covering it in order like a fallback
+     * chain, and stop at the first one that isn't open yet
+     */
+    uint32_t slot = FONT_COMPOSITE_SLOT_NONE;
+    font_composite_member_t* wanted = NULL;
+    for (uint32_t i = 0; i < composite->member_cnt; i++) {
+        font_composite_member_t* member = &composite->member_arr[i];
+        if (!font_composite_member_covers(member, letter)) {
+            continue;
+        }
+
+        lv_mutex_lock(&composite->lock);
+        const lv_font_t* member_font = member->font;
+        bool is_failed = member->is_failed;
+        lv_mutex_unlock(&composite->lock);
+
+        if (is_failed) {
+            continue;
+        }
+
+        if (!member_font) {
+            wanted = member;
+            break;
+        }
+
+        /* asked without the lock, the member's callbacks take their own */
+        uint32_t next = member_font->kerning == LV_FONT_KERNING_NONE ? 0 : letter_next;
+        if (member_font->get_glyph_dsc(member_font, dsc, letter, next) && !dsc->is_placeholder) {
+            slot = i + 1;
+            break;
+        }
+    }
+
+    bool is_first_want = false;
+    lv_mutex_lock(&composite->lock);
+    if (!wanted) {
+        font_composite_map_insert(composite, letter, slot);
+    } else {
+        /* not recorded until the member is open */
+        is_first_want = !composite->is_wanted;
+        wanted->is_wanted = true;
+        composite->is_wanted = true;
+    }
+    lv_mutex_unlock(&composite->lock);
+
+    if (is_first_want) {
+        composite->want_cb(composite->user_data);
+    }
+
+    return slot;
+}
+
+static uint32_t font_composite_find(font_composite_t* composite, uint32_t letter)
+{
+    lv_mutex_lock(&composite->lock);
+    uint32_t slot = font_composite_map_find(composite, letter);
+    lv_mutex_unlock(&composite->lock);
+    return slot;
+}
+
+static bool font_composite_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    font_composite_t* composite = (font_composite_t*)font->dsc;
+
+    uint32_t slot = font_composite_find(composite, letter);
+    if (slot == 0) {
+        /* the member that covers it filled dsc */
+        return font_composite_probe(composite, dsc, letter, letter_next) != FONT_COMPOSITE_SLOT_NONE;
+    }
+
+    if (slot == FONT_COMPOSITE_SLOT_NONE) {
+        return false;
+    }
+
+    /* the member was set before its slot was recorded */
+    const lv_font_t* member = composite->member_arr[slot - 1].font;
+    uint32_t next = member->kerning == LV_FONT_KERNING_NONE ? 0 : letter_next;
+    return member->get_glyph_dsc(member, dsc, letter, next);
+}
+
+static const void* font_composite_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    font_composite_t* composite = (font_composite_t*)dsc->resolved_font->dsc;
+
+    uint32_t slot = font_composite_find(composite, letter);
+    if (slot == 0) {
+        /* the map started over since the metrics were read */
+        lv_font_glyph_dsc_t probe_dsc;
+        lv_memzero(&probe_dsc, sizeof(probe_dsc));
+        slot = font_composite_probe(composite, &probe_dsc, letter, 0);
+    }
+
+    if (slot == FONT_COMPOSITE_SLOT_NONE) {
+        return NULL;
+    }
+
+    /* the member reads its own dsc, and releases the glyph later */
+    const lv_font_t* member = composite->member_arr[slot - 1].font;
+    dsc->resolved_font = member;
+    return member->get_glyph_bitmap(dsc, letter, draw_buf);
+}
+
+static void font_composite_free(font_composite_t* composite)
+{
+    for (uint32_t i = 0; i < composite->member_cnt; i++) {
+        if (composite->member_arr[i].font) {
+            composite->close_cb(composite->user_data, composite->member_arr[i].font);
+        }
+    }
+
+    lv_mutex_delete(&composite->lock);
+    lv_free(composite->map_arr);
+    lv_free(composite);
+}
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
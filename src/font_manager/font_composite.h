@@ -0,0 +1,151 @@
+/**
+ * @file font_composite.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_COMPOSITE_H
+#define FONT_MANAGER_FONT_COMPOSITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_cfg.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* members of a composite font, the map stores the index in a byte */
+#define FONT_COMPOSITE_MEMBER_MAX 254
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* member of a composite font, in fallback order */
+typedef struct {
+    const char* name;
+    const font_cfg_range_t* range_arr; /* sorted unicode ranges it covers, NULL for any unicode */
+    uint32_t range_cnt;
+} font_composite_member_cfg_t;
+
+/**
+ * Open a member font, called by font_composite_open_next off the draw path.
+ * @param user_data custom parameter.
+ * @param name member font name.
+ * @param size font size.
+ * @param style font style.
+ * @return member font, NULL on failure, the member isn't asked again.
+ */
+typedef lv_font_t* (*font_composite_open_cb_t)(void* user_data, const char* name, uint16_t size, uint16_t style);
+
+/**
+ * Close a font opened by font_composite_open_cb_t.
+ * @param user_data custom parameter.
+ * @param font member font.
+ */
+typedef void (*font_composite_close_cb_t)(void* user_data, lv_font_t* font);
+
+/**
+ * Tell that a member is wanted, font_composite_start_open should be called.
+ * Runs in a glyph callback on any thread, no lock held, it must not take the
+ * LVGL lock.
+ * @param user_data custom parameter.
+ */
+typedef void (*font_composite_want_cb_t)(void* user_data);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a composite font that serves each glyph from the first member
+ * covering it. The member of a codepoint is found by asking the members whose
+ * ranges contain it in order on its first lookup, then kept in a map, later
+ * lookups go to the member directly. No member is opened before a glyph needs
+ * it: a lookup that reaches a closed member marks it, font_composite_start_open
+ * picks it up off the draw path, font_composite_open_next opens it on a worker
+ * and font_composite_publish hands it to the lookups on the UI thread.
+ * Until then the glyph isn't drawn, it shows up with the layout refresh one
+ * frame or more after the miss.
+ * The glyph callbacks take only the composite's own lock, they can run on
+ * any thread.
+ * @param member_arr members in fallback order, the names and ranges are copied.
+ * @param member_cnt number of members, up to FONT_COMPOSITE_MEMBER_MAX.
+ * @param size font size of the members.
+ * @param style font style of the members.
+ * @param map_max maximum codepoints kept in the map, the map starts over when full.
+ * @param open_cb open a member.
+ * @param close_cb close a member.
+ * @param want_cb called when the font starts waiting for a member.
+ * @param user_data custom parameter of the callbacks.
+ * @return pointer to composite font, NULL on failure.
+ */
+lv_font_t* font_composite_create(const font_composite_member_cfg_t member_arr[], uint32_t member_cnt, uint16_t size,
+    uint16_t style, uint32_t map_max, font_composite_open_cb_t open_cb, font_composite_close_cb_t close_cb,
+    font_composite_want_cb_t want_cb, void* user_data);
+
+/**
+ * Delete a composite font and close the members opened. If a member is being
+ * opened, the font is freed by font_composite_publish instead.
+ * @param font pointer to composite font.
+ */
+void font_composite_delete(lv_font_t* font);
+
+/**
+ * Check if a glyph waits for a member that isn't open yet, and mark the first
+ * such member as being opened. Must not be called from a glyph callback.
+ * @param font pointer to composite font.
+ * @return true if font_composite_open_next then font_composite_publish must be called.
+ */
+bool font_composite_start_open(lv_font_t* font);
+
+/**
+ * Open the member marked by font_composite_start_open, the lookups don't see
+ * it until font_composite_publish. It takes no lock but the composite's own.
+ * @param font pointer to composite font.
+ */
+void font_composite_open_next(lv_font_t* font);
+
+/**
+ * Hand the member opened by font_composite_open_next to the lookups, update
+ * the line metrics and refresh the layout, so the glyphs it covers are drawn.
+ * Must be called under the LVGL lock unless cancelled.
+ * @param font pointer to composite font.
+ * @param cancelled true to drop the mark and close the member opened, if any.
+ */
+void font_composite_publish(lv_font_t* font, bool cancelled);
+
+/**
+ * Get the user data the composite font was created with.
+ * @param font pointer to composite font.
+ * @return custom parameter of the callbacks.
+ */
+void* font_composite_get_user_data(const lv_font_t* font);
+
+/**
+ * Check if a font is a composite font.
+ * @param font pointer to font.
+ * @return true if the font was created by font_composite_create.
+ */
+bool font_composite_is_composite(const lv_font_t* font);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_COMPOSITE_H */
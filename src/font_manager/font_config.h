@@ -62,6 +62,153 @@ extern "C" {
 #define UIKIT_FONT_CACHE_SIZE 8
 #endif
 
+#if defined(CONFIG_UIKIT_FONT_CACHE_MEM_SIZE)
+#define UIKIT_FONT_CACHE_MEM_SIZE CONFIG_UIKIT_FONT_CACHE_MEM_SIZE
+#else
+#define UIKIT_FONT_CACHE_MEM_SIZE 0
+#endif
+
+/* 0: LRU, 1: 2Q, see vg_font_cache_policy_t */
+#if defined(CONFIG_UIKIT_FONT_CACHE_POLICY)
+#define UIKIT_FONT_CACHE_POLICY CONFIG_UIKIT_FONT_CACHE_POLICY
+#else
+#define UIKIT_FONT_CACHE_POLICY 1
+#endif
+
+/* FONT_TEXT_CACHE */
+
+#if defined(CONFIG_UIKIT_FONT_TEXT_CACHE_SIZE)
+#define UIKIT_FONT_TEXT_CACHE_SIZE CONFIG_UIKIT_FONT_TEXT_CACHE_SIZE
+#else
+#define UIKIT_FONT_TEXT_CACHE_SIZE 0
+#endif
+
+/* FONT_ASCII_METRICS */
+
+#if defined(CONFIG_UIKIT_FONT_USE_ASCII_METRICS)
+#define UIKIT_FONT_USE_ASCII_METRICS CONFIG_UIKIT_FONT_USE_ASCII_METRICS
+#else
+#define UIKIT_FONT_USE_ASCII_METRICS 0
+#endif
+
+/* FONT_ATLAS */
+
+#if defined(CONFIG_UIKIT_FONT_USE_GLYPH_ATLAS)
+#define UIKIT_FONT_USE_GLYPH_ATLAS CONFIG_UIKIT_FONT_USE_GLYPH_ATLAS
+#else
+#define UIKIT_FONT_USE_GLYPH_ATLAS 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_ATLAS_PATH)
+#define UIKIT_FONT_ATLAS_PATH CONFIG_UIKIT_FONT_ATLAS_PATH
+#else
+#define UIKIT_FONT_ATLAS_PATH "/data/font/atlas"
+#endif
+
+/* FONT_FILE */
+
+#if defined(CONFIG_UIKIT_FONT_USE_FILE_MAP)
+#define UIKIT_FONT_USE_FILE_MAP CONFIG_UIKIT_FONT_USE_FILE_MAP
+#else
+#define UIKIT_FONT_USE_FILE_MAP 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_FILE_MAP_LETTER)
+#define UIKIT_FONT_FILE_MAP_LETTER CONFIG_UIKIT_FONT_FILE_MAP_LETTER
+#else
+#define UIKIT_FONT_FILE_MAP_LETTER 'U'
+#endif
+
+/* FONT_GLYPH_STORE */
+
+#if defined(CONFIG_UIKIT_FONT_GLYPH_STORE_SIZE)
+#define UIKIT_FONT_GLYPH_STORE_SIZE CONFIG_UIKIT_FONT_GLYPH_STORE_SIZE
+#else
+#define UIKIT_FONT_GLYPH_STORE_SIZE 0
+#endif
+
+/* FONT_USAGE */
+
+#if defined(CONFIG_UIKIT_FONT_USE_USAGE_PROFILE)
+#define UIKIT_FONT_USE_USAGE_PROFILE CONFIG_UIKIT_FONT_USE_USAGE_PROFILE
+#else
+#define UIKIT_FONT_USE_USAGE_PROFILE 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_USAGE_PROFILE_PATH)
+#define UIKIT_FONT_USAGE_PROFILE_PATH CONFIG_UIKIT_FONT_USAGE_PROFILE_PATH
+#else
+#define UIKIT_FONT_USAGE_PROFILE_PATH "/data/font/usage.bin"
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_USAGE_PROFILE_FONT_MAX)
+#define UIKIT_FONT_USAGE_PROFILE_FONT_MAX CONFIG_UIKIT_FONT_USAGE_PROFILE_FONT_MAX
+#else
+#define UIKIT_FONT_USAGE_PROFILE_FONT_MAX 8
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_USAGE_PROFILE_GLYPH_MAX)
+#define UIKIT_FONT_USAGE_PROFILE_GLYPH_MAX CONFIG_UIKIT_FONT_USAGE_PROFILE_GLYPH_MAX
+#else
+#define UIKIT_FONT_USAGE_PROFILE_GLYPH_MAX 1024
+#endif
+
+/* FONT_OUTLINE */
+
+#if defined(CONFIG_UIKIT_FONT_OUTLINE_CACHE_SIZE)
+#define UIKIT_FONT_OUTLINE_CACHE_SIZE CONFIG_UIKIT_FONT_OUTLINE_CACHE_SIZE
+#else
+#define UIKIT_FONT_OUTLINE_CACHE_SIZE 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_OUTLINE_REF_SIZE)
+#define UIKIT_FONT_OUTLINE_REF_SIZE CONFIG_UIKIT_FONT_OUTLINE_REF_SIZE
+#else
+#define UIKIT_FONT_OUTLINE_REF_SIZE 128
+#endif
+
+/* FONT_SDF */
+
+#if defined(CONFIG_UIKIT_FONT_USE_SDF)
+#define UIKIT_FONT_USE_SDF CONFIG_UIKIT_FONT_USE_SDF
+#else
+#define UIKIT_FONT_USE_SDF 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_SDF_REF_SIZE)
+#define UIKIT_FONT_SDF_REF_SIZE CONFIG_UIKIT_FONT_SDF_REF_SIZE
+#else
+#define UIKIT_FONT_SDF_REF_SIZE 48
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_SDF_SPREAD)
+#define UIKIT_FONT_SDF_SPREAD CONFIG_UIKIT_FONT_SDF_SPREAD
+#else
+#define UIKIT_FONT_SDF_SPREAD 4
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_SDF_CACHE_SIZE)
+#define UIKIT_FONT_SDF_CACHE_SIZE CONFIG_UIKIT_FONT_SDF_CACHE_SIZE
+#else
+#define UIKIT_FONT_SDF_CACHE_SIZE 131072
+#endif
+
+/* FONT_WORKER */
+
+#if defined(CONFIG_UIKIT_FONT_WORKER_STACKSIZE)
+#define UIKIT_FONT_WORKER_STACKSIZE CONFIG_UIKIT_FONT_WORKER_STACKSIZE
+#else
+#define UIKIT_FONT_WORKER_STACKSIZE 16384
+#endif
+
+/* FONT_PROFILER */
+
+#if defined(CONFIG_UIKIT_FONT_PROFILER)
+#define UIKIT_FONT_PROFILER CONFIG_UIKIT_FONT_PROFILER
+#else
+#define UIKIT_FONT_PROFILER 0
+#endif
+
 /* FONT_FAMILY */
 
 #if defined(CONFIG_UIKIT_FONT_USE_FONT_FAMILY)
@@ -70,12 +217,24 @@ extern "C" {
 #define UIKIT_FONT_USE_FONT_FAMILY 0
 #endif
 
+#if defined(CONFIG_UIKIT_FONT_FAMILY_MAP_SIZE)
+#define UIKIT_FONT_FAMILY_MAP_SIZE CONFIG_UIKIT_FONT_FAMILY_MAP_SIZE
+#else
+#define UIKIT_FONT_FAMILY_MAP_SIZE 0
+#endif
+
 #if defined(CONFIG_UIKIT_FONT_CONFIG_FILE_PATH)
 #define UIKIT_FONT_CONFIG_FILE_PATH CONFIG_UIKIT_FONT_CONFIG_FILE_PATH
 #else
 #define UIKIT_FONT_CONFIG_FILE_PATH "/etc/font_config.json"
 #endif
 
+#if defined(CONFIG_UIKIT_FONT_CONFIG_BIN_PATH)
+#define UIKIT_FONT_CONFIG_BIN_PATH CONFIG_UIKIT_FONT_CONFIG_BIN_PATH
+#else
+#define UIKIT_FONT_CONFIG_BIN_PATH "/etc/font_config.bin"
+#endif
+
 /* FONT_EMOJI */
 
 #if defined(CONFIG_UIKIT_FONT_USE_EMOJI)
@@ -84,6 +243,18 @@ extern "C" {
 #define UIKIT_FONT_USE_EMOJI 0
 #endif
 
+#if defined(CONFIG_UIKIT_FONT_USE_EMOJI_PACK)
+#define UIKIT_FONT_USE_EMOJI_PACK CONFIG_UIKIT_FONT_USE_EMOJI_PACK
+#else
+#define UIKIT_FONT_USE_EMOJI_PACK 0
+#endif
+
+#if defined(CONFIG_UIKIT_FONT_EMOJI_CACHE_SIZE)
+#define UIKIT_FONT_EMOJI_CACHE_SIZE CONFIG_UIKIT_FONT_EMOJI_CACHE_SIZE
+#else
+#define UIKIT_FONT_EMOJI_CACHE_SIZE 0
+#endif
+
 #if defined(CONFIG_UIKIT_FONT_EMOJI_HEADER)
 #define UIKIT_FONT_EMOJI_HEADER CONFIG_UIKIT_FONT_EMOJI_HEADER
 #else
@@ -102,6 +273,18 @@ extern "C" {
  *      MACROS
  **********************/
 
+#if UIKIT_FONT_PROFILER
+#define FONT_PROFILER_BEGIN LV_PROFILER_BEGIN
+#define FONT_PROFILER_END LV_PROFILER_END
+#define FONT_PROFILER_BEGIN_TAG(tag) LV_PROFILER_BEGIN_TAG(tag)
+#define FONT_PROFILER_END_TAG(tag) LV_PROFILER_END_TAG(tag)
+#else
+#define FONT_PROFILER_BEGIN
+#define FONT_PROFILER_END
+#define FONT_PROFILER_BEGIN_TAG(tag)
+#define FONT_PROFILER_END_TAG(tag)
+#endif /* UIKIT_FONT_PROFILER */
+
 #ifdef __cplusplus
 } /*extern "C"*/
 #endif
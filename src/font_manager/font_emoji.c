@@ -13,6 +13,9 @@
 
 #if UIKIT_FONT_USE_EMOJI
 
+#include "font_emoji_cache.h"
+#include "font_emoji_pack.h"
+#include "font_hash.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -20,23 +23,72 @@
  *      DEFINES
  *********************/
 
+/* initial bucket count of the per-font image table */
+#define FONT_EMOJI_IMAGE_HASH_SIZE 16
+
+/* sequence images are cached beyond the unicode space, keyed by trie node */
+#define FONT_EMOJI_SEQ_KEY(cfg, seq) (0x110000 + (uint32_t)((seq) - (cfg)->seq_arr))
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+#if UIKIT_FONT_USE_EMOJI_PACK
+/* packed emoji of a config entry, opened on first use */
+typedef struct {
+    font_emoji_pack_t* pack;
+    bool is_checked;
+} font_emoji_pack_slot_t;
+
+/* image descriptor handed to lv_imgfont, the pixels stay in the pack */
+typedef struct {
+    font_hash_node_t hash_node; /* keyed by unicode */
+    lv_image_dsc_t dsc;
+    int16_t ofs_y;
+} font_emoji_image_t;
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
 typedef struct _font_emoji_manager_t {
-    font_emoji_config_t* config;
+    const font_cfg_t* cfg; /* owned by the font manager */
+#if UIKIT_FONT_USE_EMOJI_PACK
+    font_emoji_pack_slot_t* pack_slot_arr; /* one per emoji config entry */
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    font_emoji_cache_t* cache; /* decoded per-file emoji */
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
 } font_emoji_manager_t;
 
+/* context of an emoji font */
+typedef struct {
+    font_emoji_manager_t* manager;
+    const font_cfg_emoji_t* emoji;
+    uint16_t height;
+#if UIKIT_FONT_USE_EMOJI_PACK
+    const font_emoji_pack_t* pack;
+    const font_emoji_pack_variant_t* variant;
+    font_hash_t image_hash; /* font_emoji_image_t of the requested emoji */
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+} font_emoji_font_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
-static bool generate_path(font_emoji_t* emoji, uint32_t unicode, char* path,
-    uint16_t len);
+static bool generate_path(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    uint32_t unicode, char* path, uint16_t len);
+static bool generate_seq_path(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    const font_cfg_seq_t* seq, char* path, uint16_t len);
 static const void* get_imgfont_path(const lv_font_t* font, uint32_t unicode,
     uint32_t unicode_next, lv_coord_t* offset_y,
     void* user_data);
+static const void* get_file_image(font_emoji_font_t* emoji_font, uint32_t unicode, const font_cfg_seq_t* seq);
+static bool is_seq_component(uint32_t unicode);
+#if UIKIT_FONT_USE_EMOJI_PACK
+static font_emoji_pack_t* get_pack(font_emoji_manager_t* manager, uint32_t index);
+static const lv_image_dsc_t* get_pack_image(font_emoji_font_t* emoji_font, uint32_t unicode,
+    lv_coord_t* offset_y);
+static void free_pack_images(font_emoji_font_t* emoji_font);
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
 
 /**********************
  *  STATIC VARIABLES
@@ -51,25 +103,40 @@ static const void* get_imgfont_path(const lv_font_t* font, uint32_t unicode,
  **********************/
 
 font_emoji_manager_t*
-font_emoji_manager_create(font_utils_json_obj_t* json_obj)
+font_emoji_manager_create(const font_cfg_t* cfg)
 {
-    LV_ASSERT_NULL(json_obj);
+    LV_ASSERT_NULL(cfg);
 
-    font_emoji_config_t* config = font_utils_json_get_emoji_config(json_obj);
-    if (!config) {
-        LV_LOG_WARN("emoji config parse failed");
+    if (!font_cfg_get_emoji_count(cfg)) {
+        LV_LOG_WARN("no emoji configured");
         return NULL;
     }
 
     font_emoji_manager_t* manager = lv_malloc(sizeof(font_emoji_manager_t));
     LV_ASSERT_MALLOC(manager);
     if (!manager) {
-        font_utils_json_emoji_config_free(config);
         LV_LOG_ERROR("malloc failed for font_emoji_manager_t");
         return NULL;
     }
     lv_memzero(manager, sizeof(font_emoji_manager_t));
-    manager->config = config;
+    manager->cfg = cfg;
+
+#if UIKIT_FONT_USE_EMOJI_PACK
+    size_t slot_size = sizeof(font_emoji_pack_slot_t) * font_cfg_get_emoji_count(cfg);
+    manager->pack_slot_arr = lv_malloc(slot_size);
+    LV_ASSERT_MALLOC(manager->pack_slot_arr);
+    if (!manager->pack_slot_arr) {
+        LV_LOG_ERROR("malloc failed for pack_slot_arr");
+        lv_free(manager);
+        return NULL;
+    }
+    lv_memzero(manager->pack_slot_arr, slot_size);
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    /* without the cache, emoji are decoded through the lvgl image cache */
+    manager->cache = font_emoji_cache_create(UIKIT_FONT_EMOJI_CACHE_SIZE);
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
 
     LV_LOG_INFO("success");
     return manager;
@@ -79,7 +146,22 @@ void font_emoji_manager_delete(font_emoji_manager_t* manager)
 {
     LV_ASSERT_NULL(manager);
 
-    font_utils_json_emoji_config_free(manager->config);
+#if UIKIT_FONT_USE_EMOJI_PACK
+    uint32_t emoji_cnt = font_cfg_get_emoji_count(manager->cfg);
+    for (uint32_t i = 0; i < emoji_cnt; i++) {
+        if (manager->pack_slot_arr[i].pack) {
+            font_emoji_pack_close(manager->pack_slot_arr[i].pack);
+        }
+    }
+    lv_free(manager->pack_slot_arr);
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    if (manager->cache) {
+        font_emoji_cache_delete(manager->cache);
+    }
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
+
     lv_free(manager);
 }
 
@@ -89,21 +171,48 @@ lv_font_t* font_emoji_manager_create_font(font_emoji_manager_t* manager,
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(name);
 
-    font_emoji_config_t* config = manager->config;
+    const font_cfg_t* cfg = manager->cfg;
+    uint32_t emoji_cnt = font_cfg_get_emoji_count(cfg);
 
-    for (int i = 0; i < config->emoji_arr_size; i++) {
-        font_emoji_t* emoji = &config->emoji_arr[i];
+    for (uint32_t i = 0; i < emoji_cnt; i++) {
+        const font_cfg_emoji_t* emoji = &cfg->emoji_arr[i];
 
         /* match name and height */
-        if (strcmp(name, emoji->font_name) == 0 && height >= emoji->match_size.min && height <= emoji->match_size.max) {
-            lv_font_t* imgfont = lv_imgfont_create(height, get_imgfont_path, NULL);
+        if (strcmp(name, font_cfg_get_str(cfg, emoji->font_name)) == 0 && height >= emoji->match_size.min && height <= emoji->match_size.max) {
+            font_emoji_font_t* emoji_font = lv_malloc(sizeof(font_emoji_font_t));
+            LV_ASSERT_MALLOC(emoji_font);
+            if (!emoji_font) {
+                LV_LOG_ERROR("malloc failed for font_emoji_font_t");
+                return NULL;
+            }
+            lv_memzero(emoji_font, sizeof(font_emoji_font_t));
+            emoji_font->manager = manager;
+            emoji_font->emoji = emoji;
+            emoji_font->height = height;
+
+#if UIKIT_FONT_USE_EMOJI_PACK
+            font_emoji_pack_t* pack = get_pack(manager, i);
+            if (pack && font_hash_init(&emoji_font->image_hash, FONT_EMOJI_IMAGE_HASH_SIZE)) {
+                emoji_font->pack = pack;
+                emoji_font->variant = font_emoji_pack_get_variant(pack, height);
+                LV_LOG_INFO("emoji: %s(%d) use packed size %d", name, height, emoji_font->variant->size);
+            }
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
+            lv_font_t* imgfont = lv_imgfont_create(height, get_imgfont_path, emoji_font);
             LV_ASSERT_NULL(imgfont);
             if (!imgfont) {
                 LV_LOG_ERROR("emoji create failed");
+#if UIKIT_FONT_USE_EMOJI_PACK
+                if (emoji_font->pack) {
+                    font_hash_deinit(&emoji_font->image_hash);
+                }
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+                lv_free(emoji_font);
                 return NULL;
             }
 
-            imgfont->user_data = emoji;
+            imgfont->user_data = emoji_font;
 
             LV_LOG_INFO("emoji: %s(%d) create OK", name, height);
 
@@ -121,15 +230,51 @@ void font_emoji_manager_delete_font(font_emoji_manager_t* manager,
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(font);
 
+    font_emoji_font_t* emoji_font = font->user_data;
     lv_imgfont_destroy(font);
+
+#if UIKIT_FONT_USE_EMOJI_PACK
+    if (emoji_font->pack) {
+        free_pack_images(emoji_font);
+    }
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
+    lv_free(emoji_font);
+}
+
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+
+bool font_emoji_manager_get_cache_stats(font_emoji_manager_t* manager, font_emoji_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(stats);
+
+    if (!manager->cache) {
+        lv_memzero(stats, sizeof(font_emoji_cache_stats_t));
+        return false;
+    }
+
+    font_emoji_cache_get_stats(manager->cache, stats);
+    return true;
+}
+
+void font_emoji_manager_clear_cache(font_emoji_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+
+    if (manager->cache) {
+        font_emoji_cache_clear(manager->cache);
+    }
 }
 
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
-static bool generate_path(font_emoji_t* emoji, uint32_t unicode, char* path,
-    uint16_t len)
+static bool generate_path(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    uint32_t unicode, char* path, uint16_t len)
 {
     /* Using the following method is more than
      * 10 times faster than the 'snprintf' method
@@ -145,7 +290,7 @@ static bool generate_path(font_emoji_t* emoji, uint32_t unicode, char* path,
     }
 
     /* Copy base path, no terminator required */
-    lv_memcpy(path, emoji->path, emoji->path_len);
+    lv_memcpy(path, font_cfg_get_str(cfg, emoji->path), emoji->path_len);
     path += emoji->path_len;
 
     /* Generate number string (unicode-range: 0 ~ 0x10FFFF) */
@@ -153,7 +298,27 @@ static bool generate_path(font_emoji_t* emoji, uint32_t unicode, char* path,
     path += strlen(path);
 
     /* Copy the extension, including the terminator */
-    lv_memcpy(path, emoji->ext, emoji->ext_len + 1);
+    lv_memcpy(path, font_cfg_get_str(cfg, emoji->ext), emoji->ext_len + 1);
+
+    return true;
+}
+
+static bool generate_seq_path(const font_cfg_t* cfg, const font_cfg_emoji_t* emoji,
+    const font_cfg_seq_t* seq, char* path, uint16_t len)
+{
+    const char* image = font_cfg_get_str(cfg, seq->image);
+    size_t image_len = strlen(image);
+
+    if (emoji->path_len + image_len + emoji->ext_len + 1 > len) {
+        LV_LOG_ERROR("buf len(%d) too small for sequence image: %s", len, image);
+        return false;
+    }
+
+    lv_memcpy(path, font_cfg_get_str(cfg, emoji->path), emoji->path_len);
+    path += emoji->path_len;
+    lv_memcpy(path, image, image_len);
+    path += image_len;
+    lv_memcpy(path, font_cfg_get_str(cfg, emoji->ext), emoji->ext_len + 1);
 
     return true;
 }
@@ -162,18 +327,164 @@ static const void* get_imgfont_path(const lv_font_t* font, uint32_t unicode,
     uint32_t unicode_next, lv_coord_t* offset_y,
     void* user_data)
 {
-    LV_UNUSED(unicode_next);
+    LV_UNUSED(font);
+
+    font_emoji_font_t* emoji_font = user_data;
+    LV_ASSERT_NULL(emoji_font);
+    const font_cfg_t* cfg = emoji_font->manager->cfg;
+    const font_cfg_emoji_t* emoji = emoji_font->emoji;
+
+    /* lv_imgfont looks only one codepoint ahead, so at most a pair is matched */
+    if (emoji->seq_cnt) {
+        uint32_t unicode_arr[2] = { unicode, unicode_next };
+        const font_cfg_seq_t* seq = font_cfg_emoji_match_seq(cfg, emoji, unicode_arr, unicode_next ? 2 : 1);
+        if (seq) {
+            return get_file_image(emoji_font, unicode, seq);
+        }
+    }
 
-    font_emoji_t* emoji = font->user_data;
-    LV_ASSERT_NULL(emoji);
+    if (is_seq_component(unicode) || !font_cfg_emoji_has_unicode(cfg, emoji, unicode)) {
+        return NULL;
+    }
 
-    if (unicode >= emoji->unicode_range.begin && unicode <= emoji->unicode_range.end) {
-        static char path[PATH_MAX];
-        generate_path(emoji, unicode, path, sizeof(path));
-        return path;
+#if UIKIT_FONT_USE_EMOJI_PACK
+    /* in-memory image, no file access */
+    if (emoji_font->pack) {
+        const lv_image_dsc_t* dsc = get_pack_image(emoji_font, unicode, offset_y);
+        if (dsc) {
+            return dsc;
+        }
     }
+#else
+    LV_UNUSED(offset_y);
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
 
-    return NULL;
+    return get_file_image(emoji_font, unicode, NULL);
+}
+
+static const void* get_file_image(font_emoji_font_t* emoji_font, uint32_t unicode, const font_cfg_seq_t* seq)
+{
+    const font_cfg_t* cfg = emoji_font->manager->cfg;
+
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    uint32_t key = seq ? FONT_EMOJI_SEQ_KEY(cfg, seq) : unicode;
+    font_emoji_cache_t* cache = emoji_font->manager->cache;
+    if (cache) {
+        const lv_image_dsc_t* dsc = font_emoji_cache_find(cache, key, emoji_font->height);
+        if (dsc) {
+            return dsc;
+        }
+    }
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
+
+    static char path[PATH_MAX];
+    bool retval = seq ? generate_seq_path(cfg, emoji_font->emoji, seq, path, sizeof(path))
+                      : generate_path(cfg, emoji_font->emoji, unicode, path, sizeof(path));
+    if (!retval) {
+        return NULL;
+    }
+
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    /* decode once, later draws don't depend on the lvgl image cache */
+    if (cache) {
+        const lv_image_dsc_t* dsc = font_emoji_cache_add(cache, key, emoji_font->height, path);
+        if (dsc) {
+            return dsc;
+        }
+    }
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
+
+    return path;
+}
+
+static bool is_seq_component(uint32_t unicode)
+{
+    /* joiners, selectors, modifiers and tags only shape a sequence */
+    return unicode == 0x200D /* zero width joiner */
+        || unicode == 0x20E3 /* combining enclosing keycap */
+        || (unicode >= 0xFE0E && unicode <= 0xFE0F) /* variation selectors */
+        || (unicode >= 0x1F3FB && unicode <= 0x1F3FF) /* skin tone modifiers */
+        || (unicode >= 0xE0020 && unicode <= 0xE007F); /* tags */
 }
 
+#if UIKIT_FONT_USE_EMOJI_PACK
+
+static font_emoji_pack_t* get_pack(font_emoji_manager_t* manager, uint32_t index)
+{
+    font_emoji_pack_slot_t* slot = &manager->pack_slot_arr[index];
+    if (slot->is_checked) {
+        return slot->pack;
+    }
+    slot->is_checked = true;
+
+    const font_cfg_t* cfg = manager->cfg;
+    const font_cfg_emoji_t* emoji = &cfg->emoji_arr[index];
+
+    char path[PATH_MAX];
+    int len = lv_snprintf(path, sizeof(path), "%s%s" FONT_EMOJI_PACK_EXT,
+        font_cfg_get_str(cfg, emoji->path), font_cfg_get_str(cfg, emoji->font_name));
+    if (len >= (int)sizeof(path)) {
+        LV_LOG_WARN("path truncation detected, len = %d", len);
+        return NULL;
+    }
+
+    slot->pack = font_emoji_pack_open(path);
+    return slot->pack;
+}
+
+static const lv_image_dsc_t* get_pack_image(font_emoji_font_t* emoji_font, uint32_t unicode,
+    lv_coord_t* offset_y)
+{
+    /* the descriptor address must stay stable, lvgl caches images by source */
+    font_emoji_image_t* image = NULL;
+    font_hash_node_t* node = font_hash_first(&emoji_font->image_hash, unicode);
+    if (node) {
+        image = FONT_HASH_ENTRY(node, font_emoji_image_t, hash_node);
+    } else {
+        const font_emoji_pack_glyph_t* glyph = font_emoji_pack_find_glyph(emoji_font->pack, emoji_font->variant, unicode);
+        if (!glyph) {
+            return NULL;
+        }
+
+        image = lv_malloc(sizeof(font_emoji_image_t));
+        LV_ASSERT_MALLOC(image);
+        if (!image) {
+            LV_LOG_ERROR("malloc failed for font_emoji_image_t");
+            return NULL;
+        }
+
+        if (!font_emoji_pack_get_image(emoji_font->pack, glyph, &image->dsc)) {
+            lv_free(image);
+            return NULL;
+        }
+
+        image->ofs_y = glyph->ofs_y;
+        font_hash_insert(&emoji_font->image_hash, &image->hash_node, unicode);
+    }
+
+    *offset_y = image->ofs_y;
+    return &image->dsc;
+}
+
+static void free_pack_images(font_emoji_font_t* emoji_font)
+{
+    font_hash_t* table = &emoji_font->image_hash;
+    for (uint32_t i = 0; i < table->bucket_cnt; i++) {
+        font_hash_node_t* node = table->buckets[i];
+        while (node) {
+            font_hash_node_t* next = node->next;
+            font_emoji_image_t* image = FONT_HASH_ENTRY(node, font_emoji_image_t, hash_node);
+            lv_image_cache_drop(&image->dsc);
+            lv_free(image);
+            node = next;
+        }
+        table->buckets[i] = NULL;
+    }
+
+    table->node_cnt = 0;
+    font_hash_deinit(table);
+}
+
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
 #endif /* UIKIT_FONT_USE_EMOJI */
@@ -14,6 +14,8 @@ extern "C" {
  *      INCLUDES
  *********************/
 
+#include "font_cfg.h"
+#include "font_emoji_cache.h"
 #include "font_utils.h"
 #include <lvgl/lvgl.h>
 
@@ -39,10 +41,10 @@ typedef struct _font_emoji_manager_t font_emoji_manager_t;
 
 /**
  * Create emoji font manager.
- * @param json_obj points to a json parsing object.
+ * @param cfg pointer to font configuration, must outlive the emoji manager.
  * @return pointer to font emoji manager.
  */
-font_emoji_manager_t* font_emoji_manager_create(font_utils_json_obj_t* json_obj);
+font_emoji_manager_t* font_emoji_manager_create(const font_cfg_t* cfg);
 
 /**
  * Delete emoji font manager.
@@ -66,6 +68,24 @@ lv_font_t* font_emoji_manager_create_font(font_emoji_manager_t* manager, const c
  */
 void font_emoji_manager_delete_font(font_emoji_manager_t* manager, lv_font_t* font);
 
+#if (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+
+/**
+ * Get the statistics of the decoded emoji cache.
+ * @param manager pointer to font emoji manager.
+ * @param stats return the statistics.
+ * @return return true if the cache is available.
+ */
+bool font_emoji_manager_get_cache_stats(font_emoji_manager_t* manager, font_emoji_cache_stats_t* stats);
+
+/**
+ * Drop the decoded emoji images, call it between display refreshes.
+ * @param manager pointer to font emoji manager.
+ */
+void font_emoji_manager_clear_cache(font_emoji_manager_t* manager);
+
+#endif /* UIKIT_FONT_EMOJI_CACHE_SIZE */
+
 /**********************
  *      MACROS
  **********************/
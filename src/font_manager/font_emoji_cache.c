@@ -0,0 +1,315 @@
+/**
+ * @file font_emoji_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_emoji_cache.h"
+
+#if UIKIT_FONT_USE_EMOJI && (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+
+#include "font_hash.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_EMOJI_CACHE_HASH_SIZE 32
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    font_hash_node_t hash_node; /* keyed by (unicode, height) */
+    lv_image_dsc_t dsc; /* handed to lv_imgfont, describes draw_buf */
+    lv_draw_buf_t* draw_buf;
+    uint32_t unicode;
+    uint16_t height;
+} font_emoji_cache_entry_t;
+
+typedef struct _font_emoji_cache_t {
+    lv_ll_t entry_ll; /* LRU order, most recently used at the head */
+    font_hash_t entry_hash;
+    lv_display_t* disp; /* display whose refresh trims the cache */
+    font_emoji_cache_stats_t stats;
+} font_emoji_cache_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static uint32_t font_emoji_cache_hash(uint32_t unicode, uint16_t height);
+static lv_draw_buf_t* font_emoji_cache_decode(const char* path);
+static void font_emoji_cache_convert_rgb565a8(lv_draw_buf_t* dst, const lv_draw_buf_t* src);
+static void font_emoji_cache_remove(font_emoji_cache_t* cache, font_emoji_cache_entry_t* entry);
+static void font_emoji_cache_trim(font_emoji_cache_t* cache);
+static void font_emoji_cache_refr_start_cb(lv_event_t* e);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_emoji_cache_t* font_emoji_cache_create(size_t max_size)
+{
+    font_emoji_cache_t* cache = lv_malloc(sizeof(font_emoji_cache_t));
+    LV_ASSERT_MALLOC(cache);
+    if (!cache) {
+        LV_LOG_ERROR("malloc failed for font_emoji_cache_t");
+        return NULL;
+    }
+    lv_memzero(cache, sizeof(font_emoji_cache_t));
+
+    if (!font_hash_init(&cache->entry_hash, FONT_EMOJI_CACHE_HASH_SIZE)) {
+        lv_free(cache);
+        return NULL;
+    }
+
+    _lv_ll_init(&cache->entry_ll, sizeof(font_emoji_cache_entry_t));
+    cache->stats.max_size = max_size;
+
+    /* images handed out this frame are drawn later, trim only between frames */
+    cache->disp = lv_display_get_default();
+    if (cache->disp) {
+        lv_display_add_event_cb(cache->disp, font_emoji_cache_refr_start_cb, LV_EVENT_REFR_START, cache);
+    } else {
+        LV_LOG_WARN("no display, the cache is trimmed on insertion");
+    }
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32, (uint32_t)max_size);
+    return cache;
+}
+
+void font_emoji_cache_delete(font_emoji_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    if (cache->disp) {
+        lv_display_remove_event_cb_with_user_data(cache->disp, font_emoji_cache_refr_start_cb, cache);
+    }
+
+    font_emoji_cache_entry_t* entry;
+    while ((entry = _lv_ll_get_head(&cache->entry_ll)) != NULL) {
+        font_emoji_cache_remove(cache, entry);
+    }
+
+    font_hash_deinit(&cache->entry_hash);
+    lv_free(cache);
+}
+
+const lv_image_dsc_t* font_emoji_cache_find(font_emoji_cache_t* cache, uint32_t unicode, uint16_t height)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&cache->entry_hash, font_emoji_cache_hash(unicode, height), node)
+    {
+        font_emoji_cache_entry_t* entry = FONT_HASH_ENTRY(node, font_emoji_cache_entry_t, hash_node);
+        if (entry->unicode == unicode && entry->height == height) {
+            /* move to head */
+            if (entry != _lv_ll_get_head(&cache->entry_ll)) {
+                _lv_ll_move_before(&cache->entry_ll, entry, _lv_ll_get_head(&cache->entry_ll));
+            }
+            cache->stats.hit_cnt++;
+            return &entry->dsc;
+        }
+    }
+
+    cache->stats.miss_cnt++;
+    return NULL;
+}
+
+const lv_image_dsc_t* font_emoji_cache_add(font_emoji_cache_t* cache, uint32_t unicode, uint16_t height,
+    const char* path)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(path);
+
+    lv_draw_buf_t* draw_buf = font_emoji_cache_decode(path);
+    if (!draw_buf) {
+        return NULL;
+    }
+
+    font_emoji_cache_entry_t* entry = _lv_ll_ins_head(&cache->entry_ll);
+    LV_ASSERT_MALLOC(entry);
+    if (!entry) {
+        LV_LOG_ERROR("malloc failed for font_emoji_cache_entry_t");
+        lv_draw_buf_destroy(draw_buf);
+        return NULL;
+    }
+    lv_memzero(entry, sizeof(font_emoji_cache_entry_t));
+
+    entry->draw_buf = draw_buf;
+    entry->unicode = unicode;
+    entry->height = height;
+    entry->dsc.header = draw_buf->header;
+    entry->dsc.data_size = draw_buf->data_size;
+    entry->dsc.data = draw_buf->data;
+    font_hash_insert(&cache->entry_hash, &entry->hash_node, font_emoji_cache_hash(unicode, height));
+
+    cache->stats.entry_cnt++;
+    cache->stats.cur_size += draw_buf->data_size;
+
+    LV_LOG_INFO("U+%" LV_PRIX32 "(%d) cached, %" LV_PRIu32 " bytes",
+        unicode, height, draw_buf->data_size);
+
+    if (!cache->disp) {
+        font_emoji_cache_trim(cache);
+    }
+
+    return &entry->dsc;
+}
+
+void font_emoji_cache_get_stats(const font_emoji_cache_t* cache, font_emoji_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(stats);
+
+    *stats = cache->stats;
+}
+
+void font_emoji_cache_clear(font_emoji_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_emoji_cache_entry_t* entry;
+    while ((entry = _lv_ll_get_tail(&cache->entry_ll)) != NULL) {
+        font_emoji_cache_remove(cache, entry);
+        cache->stats.evict_cnt++;
+    }
+
+    LV_LOG_INFO("cleared");
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t font_emoji_cache_hash(uint32_t unicode, uint16_t height)
+{
+    return font_hash_mix(unicode, height);
+}
+
+static lv_draw_buf_t* font_emoji_cache_decode(const char* path)
+{
+    /* decode outside of the lvgl image cache, the result is kept here */
+    lv_image_decoder_args_t args;
+    lv_memzero(&args, sizeof(args));
+    args.no_cache = true;
+
+    lv_image_decoder_dsc_t decoder_dsc;
+    if (lv_image_decoder_open(&decoder_dsc, path, &args) != LV_RESULT_OK) {
+        LV_LOG_WARN("decode failed: %s", path);
+        return NULL;
+    }
+
+    const lv_draw_buf_t* decoded = decoder_dsc.decoded;
+    if (!decoded) {
+        LV_LOG_WARN("no decoded data: %s", path);
+        lv_image_decoder_close(&decoder_dsc);
+        return NULL;
+    }
+
+    /* keep the pixels in the display format, RGB565A8 also saves a quarter of the memory */
+    lv_display_t* disp = lv_display_get_default();
+    bool to_rgb565a8 = disp
+        && lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565
+        && decoded->header.cf == LV_COLOR_FORMAT_ARGB8888;
+
+    lv_color_format_t cf = to_rgb565a8 ? LV_COLOR_FORMAT_RGB565A8 : decoded->header.cf;
+    lv_draw_buf_t* draw_buf = lv_draw_buf_create(decoded->header.w, decoded->header.h, cf, 0);
+    LV_ASSERT_MALLOC(draw_buf);
+    if (!draw_buf) {
+        LV_LOG_ERROR("malloc failed for draw_buf");
+        lv_image_decoder_close(&decoder_dsc);
+        return NULL;
+    }
+
+    if (to_rgb565a8) {
+        font_emoji_cache_convert_rgb565a8(draw_buf, decoded);
+    } else {
+        uint32_t line_size = LV_MIN(decoded->header.stride, draw_buf->header.stride);
+        for (uint32_t y = 0; y < decoded->header.h; y++) {
+            lv_memcpy(draw_buf->data + y * draw_buf->header.stride,
+                decoded->data + y * decoded->header.stride, line_size);
+        }
+    }
+
+    lv_image_decoder_close(&decoder_dsc);
+    return draw_buf;
+}
+
+static void font_emoji_cache_convert_rgb565a8(lv_draw_buf_t* dst, const lv_draw_buf_t* src)
+{
+    uint32_t w = src->header.w;
+    uint32_t h = src->header.h;
+    uint32_t stride = dst->header.stride;
+
+    /* RGB565 plane, then the A8 plane with half the stride */
+    uint8_t* alpha_plane = dst->data + stride * h;
+    uint32_t alpha_stride = stride / 2;
+
+    for (uint32_t y = 0; y < h; y++) {
+        const uint8_t* src_px = src->data + y * src->header.stride;
+        uint16_t* rgb = (uint16_t*)(dst->data + y * stride);
+        uint8_t* alpha = alpha_plane + y * alpha_stride;
+
+        for (uint32_t x = 0; x < w; x++) {
+            /* ARGB8888 is stored as B, G, R, A */
+            uint8_t b = src_px[0];
+            uint8_t g = src_px[1];
+            uint8_t r = src_px[2];
+            rgb[x] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            alpha[x] = src_px[3];
+            src_px += 4;
+        }
+    }
+}
+
+static void font_emoji_cache_remove(font_emoji_cache_t* cache, font_emoji_cache_entry_t* entry)
+{
+    /* lvgl may still hold the image as a variable source */
+    lv_image_cache_drop(&entry->dsc);
+
+    cache->stats.cur_size -= entry->draw_buf->data_size;
+    cache->stats.entry_cnt--;
+
+    lv_draw_buf_destroy(entry->draw_buf);
+    font_hash_remove(&cache->entry_hash, &entry->hash_node);
+    _lv_ll_remove(&cache->entry_ll, entry);
+    lv_free(entry);
+}
+
+static void font_emoji_cache_trim(font_emoji_cache_t* cache)
+{
+    /* evict from the tail, the least recently used */
+    while (cache->stats.cur_size > cache->stats.max_size) {
+        font_emoji_cache_entry_t* entry = _lv_ll_get_tail(&cache->entry_ll);
+        if (!entry) {
+            break;
+        }
+
+        LV_LOG_INFO("evict U+%" LV_PRIX32 "(%d)", entry->unicode, entry->height);
+        font_emoji_cache_remove(cache, entry);
+        cache->stats.evict_cnt++;
+    }
+}
+
+static void font_emoji_cache_refr_start_cb(lv_event_t* e)
+{
+    font_emoji_cache_t* cache = lv_event_get_user_data(e);
+    font_emoji_cache_trim(cache);
+}
+
+#endif /* UIKIT_FONT_USE_EMOJI && UIKIT_FONT_EMOJI_CACHE_SIZE */
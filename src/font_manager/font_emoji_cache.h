@@ -0,0 +1,102 @@
+/**
+ * @file font_emoji_cache.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_EMOJI_CACHE_H
+#define FONT_MANAGER_FONT_EMOJI_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_EMOJI && (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_emoji_cache_t font_emoji_cache_t;
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t evict_cnt;
+    uint32_t entry_cnt;
+    size_t cur_size; /* pixel bytes held */
+    size_t max_size;
+} font_emoji_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create an emoji bitmap cache.
+ * @param max_size maximum pixel bytes to hold.
+ * @return pointer to emoji cache.
+ */
+font_emoji_cache_t* font_emoji_cache_create(size_t max_size);
+
+/**
+ * Delete an emoji bitmap cache.
+ * @param cache pointer to emoji cache.
+ */
+void font_emoji_cache_delete(font_emoji_cache_t* cache);
+
+/**
+ * Find the decoded image of an emoji.
+ * @param cache pointer to emoji cache.
+ * @param unicode emoji unicode.
+ * @param height emoji font height.
+ * @return pointer to the image, NULL if not cached. It stays valid until the
+ *         cache is trimmed at the start of the next display refresh.
+ */
+const lv_image_dsc_t* font_emoji_cache_find(font_emoji_cache_t* cache, uint32_t unicode, uint16_t height);
+
+/**
+ * Decode an emoji image and add it to the cache.
+ * @param cache pointer to emoji cache.
+ * @param unicode emoji unicode.
+ * @param height emoji font height.
+ * @param path image file path.
+ * @return pointer to the image, NULL if decoding failed. Same lifetime as font_emoji_cache_find.
+ */
+const lv_image_dsc_t* font_emoji_cache_add(font_emoji_cache_t* cache, uint32_t unicode, uint16_t height,
+    const char* path);
+
+/**
+ * Get the cache statistics.
+ * @param cache pointer to emoji cache.
+ * @param stats return the statistics.
+ */
+void font_emoji_cache_get_stats(const font_emoji_cache_t* cache, font_emoji_cache_stats_t* stats);
+
+/**
+ * Drop all decoded images, they are decoded again on the next use.
+ * @param cache pointer to emoji cache.
+ */
+void font_emoji_cache_clear(font_emoji_cache_t* cache);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_EMOJI && UIKIT_FONT_EMOJI_CACHE_SIZE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_EMOJI_CACHE_H */
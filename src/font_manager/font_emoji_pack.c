@@ -0,0 +1,210 @@
+/**
+ * @file font_emoji_pack.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_emoji_pack.h"
+
+#if UIKIT_FONT_USE_EMOJI_PACK
+
+#include "font_utils.h"
+#include <unistd.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_emoji_pack_t {
+    const uint8_t* data; /* whole pack file */
+    size_t data_size;
+    bool is_mapped; /* data is mmap-ed, otherwise lv_malloc-ed */
+    const font_emoji_pack_header_t* header;
+    const font_emoji_pack_variant_t* variant_arr;
+    const uint8_t* pixel_data;
+} font_emoji_pack_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool font_emoji_pack_check(font_emoji_pack_t* pack);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_emoji_pack_t* font_emoji_pack_open(const char* path)
+{
+    LV_ASSERT_NULL(path);
+
+    if (access(path, F_OK) != 0) {
+        LV_LOG_INFO("no emoji pack: %s", path);
+        return NULL;
+    }
+
+    font_emoji_pack_t* pack = lv_malloc(sizeof(font_emoji_pack_t));
+    LV_ASSERT_MALLOC(pack);
+    if (!pack) {
+        LV_LOG_ERROR("malloc failed for font_emoji_pack_t");
+        return NULL;
+    }
+    lv_memzero(pack, sizeof(font_emoji_pack_t));
+
+    /* pixel data is paged in on demand when the file is mapped */
+    if (!font_utils_file_map(path, &pack->data, &pack->data_size, &pack->is_mapped)) {
+        LV_LOG_ERROR("can't load emoji pack: %s", path);
+        lv_free(pack);
+        return NULL;
+    }
+
+    if (!font_emoji_pack_check(pack)) {
+        LV_LOG_WARN("emoji pack: %s is invalid", path);
+        font_emoji_pack_close(pack);
+        return NULL;
+    }
+
+    LV_LOG_INFO("emoji pack: %s open OK, %" LV_PRIu32 " variants", path, pack->header->variant_cnt);
+    return pack;
+}
+
+void font_emoji_pack_close(font_emoji_pack_t* pack)
+{
+    LV_ASSERT_NULL(pack);
+
+    font_utils_file_unmap(pack->data, pack->data_size, pack->is_mapped);
+    lv_free(pack);
+}
+
+const font_emoji_pack_variant_t* font_emoji_pack_get_variant(const font_emoji_pack_t* pack, uint16_t height)
+{
+    LV_ASSERT_NULL(pack);
+
+    /* variants are sorted by size, keep the last one that fits */
+    const font_emoji_pack_variant_t* variant = &pack->variant_arr[0];
+    for (uint32_t i = 1; i < pack->header->variant_cnt; i++) {
+        if (pack->variant_arr[i].size > height) {
+            break;
+        }
+        variant = &pack->variant_arr[i];
+    }
+
+    return variant;
+}
+
+const font_emoji_pack_glyph_t* font_emoji_pack_find_glyph(const font_emoji_pack_t* pack,
+    const font_emoji_pack_variant_t* variant, uint32_t unicode)
+{
+    LV_ASSERT_NULL(pack);
+    LV_ASSERT_NULL(variant);
+
+    const font_emoji_pack_glyph_t* glyph_arr = (const font_emoji_pack_glyph_t*)(pack->data + variant->glyph_offset);
+
+    /* binary search, the glyph table is sorted by unicode */
+    uint32_t low = 0;
+    uint32_t high = variant->glyph_cnt;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const font_emoji_pack_glyph_t* glyph = &glyph_arr[mid];
+        if (glyph->unicode == unicode) {
+            return glyph;
+        }
+
+        if (glyph->unicode < unicode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+bool font_emoji_pack_get_image(const font_emoji_pack_t* pack, const font_emoji_pack_glyph_t* glyph,
+    lv_image_dsc_t* dsc)
+{
+    LV_ASSERT_NULL(pack);
+    LV_ASSERT_NULL(glyph);
+    LV_ASSERT_NULL(dsc);
+
+    uint32_t size = (uint32_t)glyph->stride * glyph->h;
+    uint64_t data_end = (uint64_t)glyph->data_offset + size;
+    if (data_end > pack->header->data_size) {
+        LV_LOG_WARN("emoji U+%" LV_PRIX32 " data out of range", glyph->unicode);
+        return false;
+    }
+
+    lv_memzero(dsc, sizeof(lv_image_dsc_t));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.cf = pack->header->color_format;
+    dsc->header.w = glyph->w;
+    dsc->header.h = glyph->h;
+    dsc->header.stride = glyph->stride;
+    dsc->data_size = size;
+    dsc->data = pack->pixel_data + glyph->data_offset;
+    return true;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool font_emoji_pack_check(font_emoji_pack_t* pack)
+{
+    if (pack->data_size < sizeof(font_emoji_pack_header_t)) {
+        LV_LOG_WARN("bad size: %" LV_PRIu32, (uint32_t)pack->data_size);
+        return false;
+    }
+
+    const font_emoji_pack_header_t* header = (const font_emoji_pack_header_t*)pack->data;
+
+    if (header->magic != FONT_EMOJI_PACK_MAGIC || header->version != FONT_EMOJI_PACK_VERSION) {
+        LV_LOG_WARN("bad magic: 0x%" LV_PRIx32 " or version: %d", header->magic, header->version);
+        return false;
+    }
+
+    uint64_t variant_end = (uint64_t)header->variant_offset + (uint64_t)header->variant_cnt * sizeof(font_emoji_pack_variant_t);
+    uint64_t data_end = (uint64_t)header->data_offset + header->data_size;
+    if (header->header_size < sizeof(font_emoji_pack_header_t)
+        || header->variant_cnt == 0
+        || variant_end > pack->data_size
+        || data_end > pack->data_size
+        || header->variant_offset % sizeof(uint32_t) != 0
+        || header->data_offset % sizeof(uint32_t) != 0) {
+        LV_LOG_WARN("bad layout");
+        return false;
+    }
+
+    const font_emoji_pack_variant_t* variant_arr = (const font_emoji_pack_variant_t*)(pack->data + header->variant_offset);
+    for (uint32_t i = 0; i < header->variant_cnt; i++) {
+        const font_emoji_pack_variant_t* variant = &variant_arr[i];
+        uint64_t glyph_end = (uint64_t)variant->glyph_offset + (uint64_t)variant->glyph_cnt * sizeof(font_emoji_pack_glyph_t);
+        if (glyph_end > pack->data_size || variant->glyph_offset % sizeof(uint32_t) != 0) {
+            LV_LOG_WARN("bad variant[%" LV_PRIu32 "]", i);
+            return false;
+        }
+    }
+
+    pack->header = header;
+    pack->variant_arr = variant_arr;
+    pack->pixel_data = pack->data + header->data_offset;
+
+    return true;
+}
+
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
@@ -0,0 +1,126 @@
+/**
+ * @file font_emoji_pack.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_EMOJI_PACK_H
+#define FONT_MANAGER_FONT_EMOJI_PACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_EMOJI_PACK
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* "UEPK" */
+#define FONT_EMOJI_PACK_MAGIC 0x4B504555
+#define FONT_EMOJI_PACK_VERSION 1
+
+/* pack file extension, the pack is looked up as <path><font-name>.epk */
+#define FONT_EMOJI_PACK_EXT ".epk"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* on-disk layout, little endian, generated by tools/font_emoji_pack_gen.py */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t color_format; /* lv_color_format_t of all pixel data */
+    uint8_t reserved[3];
+    uint32_t variant_cnt;
+    uint32_t variant_offset; /* offset of the variant table from the file start */
+    uint32_t data_offset; /* offset of the pixel data from the file start */
+    uint32_t data_size;
+} font_emoji_pack_header_t;
+
+/* one rendering size, sorted by size */
+typedef struct {
+    uint16_t size; /* emoji height in pixels */
+    uint16_t reserved;
+    uint32_t glyph_cnt;
+    uint32_t glyph_offset; /* offset of the glyph table from the file start */
+} font_emoji_pack_variant_t;
+
+/* glyph table entry, sorted by unicode */
+typedef struct {
+    uint32_t unicode;
+    uint32_t data_offset; /* from pixel data start, 4 bytes aligned */
+    uint16_t w;
+    uint16_t h;
+    uint16_t stride;
+    int16_t ofs_y;
+} font_emoji_pack_glyph_t;
+
+typedef struct _font_emoji_pack_t font_emoji_pack_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Open an emoji pack.
+ * @param path pack file path.
+ * @return pointer to the pack, NULL if there is no valid pack.
+ */
+font_emoji_pack_t* font_emoji_pack_open(const char* path);
+
+/**
+ * Close an emoji pack.
+ * @param pack pointer to the pack.
+ */
+void font_emoji_pack_close(font_emoji_pack_t* pack);
+
+/**
+ * Get the variant that best fits a font height:
+ * the largest one not taller than the height, otherwise the smallest one.
+ * @param pack pointer to the pack.
+ * @param height font height.
+ * @return pointer to the variant.
+ */
+const font_emoji_pack_variant_t* font_emoji_pack_get_variant(const font_emoji_pack_t* pack, uint16_t height);
+
+/**
+ * Find a glyph in a variant.
+ * @param pack pointer to the pack.
+ * @param variant pointer to the variant.
+ * @param unicode unicode of the glyph.
+ * @return pointer to the glyph, NULL if not found.
+ */
+const font_emoji_pack_glyph_t* font_emoji_pack_find_glyph(const font_emoji_pack_t* pack,
+    const font_emoji_pack_variant_t* variant, uint32_t unicode);
+
+/**
+ * Describe the pixel data of a glyph as an image, without copying.
+ * @param pack pointer to the pack.
+ * @param glyph pointer to the glyph.
+ * @param dsc image descriptor to fill.
+ * @return return true if the glyph is valid.
+ */
+bool font_emoji_pack_get_image(const font_emoji_pack_t* pack, const font_emoji_pack_glyph_t* glyph,
+    lv_image_dsc_t* dsc);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_EMOJI_PACK */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_EMOJI_PACK_H */
@@ -0,0 +1,441 @@
+/**
+ * @file font_file.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_file.h"
+
+#if UIKIT_FONT_USE_FILE_MAP
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* font file shared by all open handles */
+typedef struct _font_file_t {
+    const uint8_t* data; /* mapped file, NULL if the file system can't map it */
+    size_t size;
+    int ref_cnt; /* open handles and acquires */
+    char path[];
+} font_file_t;
+
+/* lv_fs file handle, it keeps its manager alive */
+typedef struct {
+    struct _font_file_manager_t* manager;
+    font_file_t* file;
+    int fd; /* streaming fallback of an unmapped file, otherwise -1 */
+    uint32_t pos;
+} font_file_handle_t;
+
+typedef struct _font_file_manager_t {
+    lv_mutex_t lock; /* file_ll and is_deleted */
+    lv_ll_t file_ll;
+    char letter;
+    bool is_deleted; /* deleted with files open, freed by the last release */
+} font_file_manager_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static font_file_t* font_file_acquire(font_file_manager_t* manager, const char* path);
+static void font_file_release(font_file_manager_t* manager, font_file_t* file);
+static void font_file_manager_free(font_file_manager_t* manager);
+static void* font_file_open_cb(lv_fs_drv_t* drv, const char* path, lv_fs_mode_t mode);
+static lv_fs_res_t font_file_close_cb(lv_fs_drv_t* drv, void* file_p);
+static lv_fs_res_t font_file_read_cb(lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br);
+static lv_fs_res_t font_file_seek_cb(lv_fs_drv_t* drv, void* file_p, uint32_t pos, lv_fs_whence_t whence);
+static lv_fs_res_t font_file_tell_cb(lv_fs_drv_t* drv, void* file_p, uint32_t* pos_p);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/* lv_fs drivers can't be unregistered, the driver outlives the manager */
+static lv_fs_drv_t font_file_drv;
+static bool font_file_drv_registered;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_file_manager_t* font_file_manager_create(char letter)
+{
+    if (font_file_drv_registered ? font_file_drv.letter != letter : lv_fs_get_drv(letter) != NULL) {
+        LV_LOG_WARN("drive letter '%c' is taken, font files are not mapped", letter);
+        return NULL;
+    }
+
+    font_file_manager_t* manager = lv_malloc(sizeof(font_file_manager_t));
+    LV_ASSERT_MALLOC(manager);
+    if (!manager) {
+        LV_LOG_ERROR("malloc failed for font_file_manager_t");
+        return NULL;
+    }
+    lv_memzero(manager, sizeof(font_file_manager_t));
+
+    lv_mutex_init(&manager->lock);
+    _lv_ll_init(&manager->file_ll, sizeof(font_file_t*));
+    manager->letter = letter;
+
+    if (!font_file_drv_registered) {
+        lv_fs_drv_init(&font_file_drv);
+        font_file_drv.letter = letter;
+        font_file_drv.open_cb = font_file_open_cb;
+        font_file_drv.close_cb = font_file_close_cb;
+        font_file_drv.read_cb = font_file_read_cb;
+        font_file_drv.seek_cb = font_file_seek_cb;
+        font_file_drv.tell_cb = font_file_tell_cb;
+        lv_fs_drv_register(&font_file_drv);
+        font_file_drv_registered = true;
+    }
+
+    font_file_drv.user_data = manager;
+
+    LV_LOG_INFO("success, letter: %c", letter);
+    return manager;
+}
+
+void font_file_manager_delete(font_file_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+
+    /* later opens through the driver fail, or go to the next manager */
+    if (font_file_drv.user_data == manager) {
+        font_file_drv.user_data = NULL;
+    }
+
+    lv_mutex_lock(&manager->lock);
+
+    /* the open handles still read the files, the last close frees the manager */
+    if (!_lv_ll_is_empty(&manager->file_ll)) {
+        LV_LOG_WARN("%" LV_PRIu32 " font files still open, delete deferred", _lv_ll_get_len(&manager->file_ll));
+        manager->is_deleted = true;
+        lv_mutex_unlock(&manager->lock);
+        return;
+    }
+
+    lv_mutex_unlock(&manager->lock);
+
+    font_file_manager_free(manager);
+}
+
+bool font_file_manager_make_path(font_file_manager_t* manager, const char* path, char* buf, size_t len)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(buf);
+
+    int ret = lv_snprintf(buf, len, "%c:%s", manager->letter, path);
+    if (ret < 0 || (size_t)ret >= len) {
+        LV_LOG_WARN("path too long: %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+font_file_t* font_file_manager_acquire(font_file_manager_t* manager, const char* path)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(path);
+
+    return font_file_acquire(manager, path);
+}
+
+void font_file_manager_release(font_file_manager_t* manager, font_file_t* file)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(file);
+
+    font_file_release(manager, file);
+}
+
+void font_file_manager_get_usage(font_file_manager_t* manager, uint32_t* file_cnt, size_t* mapped_size)
+{
+    LV_ASSERT_NULL(manager);
+
+    uint32_t cnt = 0;
+    size_t size = 0;
+
+    lv_mutex_lock(&manager->lock);
+
+    font_file_t** file_p;
+    _LV_LL_READ(&manager->file_ll, file_p)
+    {
+        cnt++;
+        size += (*file_p)->data ? (*file_p)->size : 0;
+    }
+
+    lv_mutex_unlock(&manager->lock);
+
+    if (file_cnt) {
+        *file_cnt = cnt;
+    }
+
+    if (mapped_size) {
+        *mapped_size = size;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static font_file_t* font_file_open(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LV_LOG_WARN("can't open file: %s", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0 || (uint64_t)st.st_size > UINT32_MAX) {
+        LV_LOG_ERROR("bad file size: %s", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t path_len = strlen(path) + 1;
+    font_file_t* file = lv_malloc(sizeof(font_file_t) + path_len);
+    LV_ASSERT_MALLOC(file);
+    if (!file) {
+        LV_LOG_ERROR("malloc failed for font_file_t");
+        close(fd);
+        return NULL;
+    }
+    lv_memzero(file, sizeof(font_file_t));
+    lv_memcpy(file->path, path, path_len);
+    file->size = st.st_size;
+
+    /* pages are loaded on demand and shared with the page cache */
+    void* addr = mmap(NULL, file->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr != MAP_FAILED) {
+        file->data = addr;
+    } else {
+        LV_LOG_INFO("mmap failed, stream file: %s", path);
+    }
+
+    close(fd);
+
+    LV_LOG_INFO("open %s, size: %" LV_PRIu32 ", mapped: %d", path, (uint32_t)file->size, file->data != NULL);
+    return file;
+}
+
+static font_file_t* font_file_acquire(font_file_manager_t* manager, const char* path)
+{
+    lv_mutex_lock(&manager->lock);
+
+    font_file_t** file_p;
+    _LV_LL_READ(&manager->file_ll, file_p)
+    {
+        if (strcmp((*file_p)->path, path) == 0) {
+            font_file_t* file = *file_p;
+            file->ref_cnt++;
+            lv_mutex_unlock(&manager->lock);
+            return file;
+        }
+    }
+
+    font_file_t* file = NULL;
+    file_p = _lv_ll_ins_head(&manager->file_ll);
+    LV_ASSERT_MALLOC(file_p);
+    if (!file_p) {
+        LV_LOG_ERROR("malloc failed for font file node");
+        goto unlock;
+    }
+
+    file = font_file_open(path);
+    if (!file) {
+        _lv_ll_remove(&manager->file_ll, file_p);
+        lv_free(file_p);
+        goto unlock;
+    }
+
+    file->ref_cnt = 1;
+    *file_p = file;
+
+unlock:
+    lv_mutex_unlock(&manager->lock);
+    return file;
+}
+
+static void font_file_release(font_file_manager_t* manager, font_file_t* file)
+{
+    lv_mutex_lock(&manager->lock);
+
+    if (--file->ref_cnt > 0) {
+        lv_mutex_unlock(&manager->lock);
+        return;
+    }
+
+    font_file_t** file_p;
+    _LV_LL_READ(&manager->file_ll, file_p)
+    {
+        if (*file_p == file) {
+            _lv_ll_remove(&manager->file_ll, file_p);
+            lv_free(file_p);
+            break;
+        }
+    }
+
+    bool is_orphan = manager->is_deleted && _lv_ll_is_empty(&manager->file_ll);
+
+    lv_mutex_unlock(&manager->lock);
+
+    LV_LOG_INFO("close %s", file->path);
+
+    if (file->data) {
+        munmap((void*)file->data, file->size);
+    }
+    lv_free(file);
+
+    if (is_orphan) {
+        font_file_manager_free(manager);
+    }
+}
+
+static void font_file_manager_free(font_file_manager_t* manager)
+{
+    lv_mutex_delete(&manager->lock);
+    lv_free(manager);
+
+    LV_LOG_INFO("success");
+}
+
+static void* font_file_open_cb(lv_fs_drv_t* drv, const char* path, lv_fs_mode_t mode)
+{
+    font_file_manager_t* manager = drv->user_data;
+    if (!manager || mode != LV_FS_MODE_RD) {
+        return NULL;
+    }
+
+    font_file_handle_t* handle = lv_malloc(sizeof(font_file_handle_t));
+    LV_ASSERT_MALLOC(handle);
+    if (!handle) {
+        LV_LOG_ERROR("malloc failed for font_file_handle_t");
+        return NULL;
+    }
+    lv_memzero(handle, sizeof(font_file_handle_t));
+    handle->manager = manager;
+    handle->fd = -1;
+
+    handle->file = font_file_acquire(manager, path);
+    if (!handle->file) {
+        lv_free(handle);
+        return NULL;
+    }
+
+    if (!handle->file->data) {
+        handle->fd = open(path, O_RDONLY);
+        if (handle->fd < 0) {
+            LV_LOG_WARN("can't open file: %s", path);
+            font_file_release(manager, handle->file);
+            lv_free(handle);
+            return NULL;
+        }
+    }
+
+    return handle;
+}
+
+static lv_fs_res_t font_file_close_cb(lv_fs_drv_t* drv, void* file_p)
+{
+    LV_UNUSED(drv);
+
+    font_file_handle_t* handle = file_p;
+
+    if (handle->fd >= 0) {
+        close(handle->fd);
+    }
+
+    /* the driver may point to a newer manager by now */
+    font_file_release(handle->manager, handle->file);
+
+    lv_free(handle);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t font_file_read_cb(lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br)
+{
+    LV_UNUSED(drv);
+
+    font_file_handle_t* handle = file_p;
+    const font_file_t* file = handle->file;
+
+    btr = LV_MIN(btr, file->size - handle->pos);
+
+    if (file->data) {
+        lv_memcpy(buf, file->data + handle->pos, btr);
+    } else {
+        ssize_t ret = pread(handle->fd, buf, btr, handle->pos);
+        if (ret < 0) {
+            *br = 0;
+            return LV_FS_RES_FS_ERR;
+        }
+        btr = ret;
+    }
+
+    handle->pos += btr;
+    *br = btr;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t font_file_seek_cb(lv_fs_drv_t* drv, void* file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+    LV_UNUSED(drv);
+
+    font_file_handle_t* handle = file_p;
+    size_t new_pos;
+
+    switch (whence) {
+    case LV_FS_SEEK_SET:
+        new_pos = pos;
+        break;
+    case LV_FS_SEEK_CUR:
+        new_pos = (size_t)handle->pos + pos;
+        break;
+    case LV_FS_SEEK_END:
+        new_pos = handle->file->size + pos;
+        break;
+    default:
+        return LV_FS_RES_INV_PARAM;
+    }
+
+    if (new_pos > handle->file->size) {
+        return LV_FS_RES_INV_PARAM;
+    }
+
+    handle->pos = new_pos;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t font_file_tell_cb(lv_fs_drv_t* drv, void* file_p, uint32_t* pos_p)
+{
+    LV_UNUSED(drv);
+
+    font_file_handle_t* handle = file_p;
+    *pos_p = handle->pos;
+    return LV_FS_RES_OK;
+}
+
+#endif /* UIKIT_FONT_USE_FILE_MAP */
@@ -0,0 +1,99 @@
+/**
+ * @file font_file.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_FILE_H
+#define FONT_MANAGER_FONT_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_FILE_MAP
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_file_manager_t font_file_manager_t;
+
+typedef struct _font_file_t font_file_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create the font file manager and register its lv_fs driver. Freetype opens
+ * font files through the driver, each file is mapped once and shared by all
+ * the faces, sizes and styles reading it.
+ * @param letter lv_fs drive letter.
+ * @return pointer to font file manager, NULL if the letter is taken.
+ */
+font_file_manager_t* font_file_manager_create(char letter);
+
+/**
+ * Delete the font file manager. New opens through the driver fail at once,
+ * the files still open stay readable and the last close frees the manager.
+ * @param manager pointer to font file manager.
+ */
+void font_file_manager_delete(font_file_manager_t* manager);
+
+/**
+ * Make the lv_fs path that opens a font file through the manager.
+ * @param manager pointer to font file manager.
+ * @param path font file path.
+ * @param buf return the lv_fs path.
+ * @param len buffer size.
+ * @return return true on success.
+ */
+bool font_file_manager_make_path(font_file_manager_t* manager, const char* path, char* buf, size_t len);
+
+/**
+ * Open and map a font file ahead of freetype, so the open through the driver
+ * finds it mapped and does no file access. The file stays open until the
+ * matching font_file_manager_release.
+ * @param manager pointer to font file manager.
+ * @param path font file path.
+ * @return the font file, NULL if it can't be opened.
+ */
+font_file_t* font_file_manager_acquire(font_file_manager_t* manager, const char* path);
+
+/**
+ * Release a font file got by font_file_manager_acquire.
+ * @param manager pointer to font file manager.
+ * @param file the font file.
+ */
+void font_file_manager_release(font_file_manager_t* manager, font_file_t* file);
+
+/**
+ * Get the font files in use.
+ * @param manager pointer to font file manager.
+ * @param file_cnt return the number of open files, can be NULL.
+ * @param mapped_size return the mapped bytes, can be NULL.
+ */
+void font_file_manager_get_usage(font_file_manager_t* manager, uint32_t* file_cnt, size_t* mapped_size);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_FILE_H */
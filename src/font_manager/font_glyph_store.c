@@ -0,0 +1,394 @@
+/**
+ * @file font_glyph_store.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_glyph_store.h"
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+
+#include "font_hash.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_GLYPH_STORE_HASH_SIZE 128
+
+/* longest run of one RLE4 token */
+#define FONT_GLYPH_STORE_RUN_MAX 16
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef enum {
+    FONT_GLYPH_STORE_FORMAT_A4, /* two pixels per byte, high nibble first */
+    FONT_GLYPH_STORE_FORMAT_RLE4, /* one token per run: (run length - 1) << 4 | alpha */
+} font_glyph_store_format_t;
+
+typedef struct _font_glyph_store_entry_t {
+    font_hash_node_t hash_node; /* keyed by (owner, glyph_index) */
+    struct _font_glyph_store_entry_t* prev; /* LRU order, most recently used at the head */
+    struct _font_glyph_store_entry_t* next;
+    const void* owner;
+    uint32_t glyph_index;
+    uint16_t box_w;
+    uint16_t box_h;
+    uint8_t format;
+    uint32_t data_size;
+    uint8_t data[];
+} font_glyph_store_entry_t;
+
+typedef struct _font_glyph_store_t {
+    font_hash_t glyph_hash;
+    font_glyph_store_entry_t* head;
+    font_glyph_store_entry_t* tail;
+    font_glyph_store_stats_t stats;
+} font_glyph_store_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static font_glyph_store_entry_t* font_glyph_store_find(font_glyph_store_t* store, const void* owner, uint32_t glyph_index);
+static uint32_t font_glyph_store_encode_rle4(const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h, uint8_t* out);
+static void font_glyph_store_encode_a4(const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h, uint8_t* out);
+static void font_glyph_store_decode(const font_glyph_store_entry_t* entry, lv_draw_buf_t* draw_buf);
+static void font_glyph_store_evict(font_glyph_store_t* store, size_t mem_size);
+static void font_glyph_store_remove(font_glyph_store_t* store, font_glyph_store_entry_t* entry);
+static void font_glyph_store_link_head(font_glyph_store_t* store, font_glyph_store_entry_t* entry);
+static void font_glyph_store_unlink(font_glyph_store_t* store, font_glyph_store_entry_t* entry);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/* 8 bit alpha to 4 bit, rounded, 0 and 255 are exact */
+#define FONT_GLYPH_STORE_A4(a8) ((uint8_t)(((a8) + 8) / 17))
+
+#define FONT_GLYPH_STORE_KEY_HASH(owner, glyph_index) font_hash_mix(font_hash_ptr(owner), (glyph_index))
+
+#define FONT_GLYPH_STORE_MEM_SIZE(entry) (sizeof(font_glyph_store_entry_t) + (entry)->data_size)
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_glyph_store_t* font_glyph_store_create(size_t max_size)
+{
+    font_glyph_store_t* store = lv_malloc(sizeof(font_glyph_store_t));
+    LV_ASSERT_MALLOC(store);
+    if (!store) {
+        LV_LOG_ERROR("malloc failed for font_glyph_store_t");
+        return NULL;
+    }
+    lv_memzero(store, sizeof(font_glyph_store_t));
+
+    if (!font_hash_init(&store->glyph_hash, FONT_GLYPH_STORE_HASH_SIZE)) {
+        LV_LOG_ERROR("hash table init failed");
+        lv_free(store);
+        return NULL;
+    }
+
+    store->stats.max_size = max_size;
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32, (uint32_t)max_size);
+    return store;
+}
+
+void font_glyph_store_delete(font_glyph_store_t* store)
+{
+    LV_ASSERT_NULL(store);
+
+    font_glyph_store_clear(store);
+    font_hash_deinit(&store->glyph_hash);
+    lv_free(store);
+
+    LV_LOG_INFO("success");
+}
+
+bool font_glyph_store_get(font_glyph_store_t* store, const void* owner, uint32_t glyph_index,
+    uint16_t box_w, uint16_t box_h, lv_draw_buf_t* draw_buf)
+{
+    LV_ASSERT_NULL(store);
+    LV_ASSERT_NULL(draw_buf);
+
+    font_glyph_store_entry_t* entry = font_glyph_store_find(store, owner, glyph_index);
+    if (!entry) {
+        store->stats.miss_cnt++;
+        return false;
+    }
+
+    /* a flushed font may rasterize the glyph differently, store it again */
+    if (entry->box_w != box_w || entry->box_h != box_h) {
+        font_glyph_store_remove(store, entry);
+        store->stats.miss_cnt++;
+        return false;
+    }
+
+    store->stats.hit_cnt++;
+    if (entry != store->head) {
+        font_glyph_store_unlink(store, entry);
+        font_glyph_store_link_head(store, entry);
+    }
+
+    font_glyph_store_decode(entry, draw_buf);
+    return true;
+}
+
+void font_glyph_store_put(font_glyph_store_t* store, const void* owner, uint32_t glyph_index,
+    const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h)
+{
+    LV_ASSERT_NULL(store);
+    LV_ASSERT_NULL(src);
+
+    uint32_t pixel_cnt = (uint32_t)box_w * box_h;
+    if (pixel_cnt == 0 || font_glyph_store_find(store, owner, glyph_index)) {
+        return;
+    }
+
+    /* anti-aliased glyphs are mostly runs of empty and solid pixels */
+    uint32_t a4_size = (pixel_cnt + 1) / 2;
+    uint32_t rle_size = font_glyph_store_encode_rle4(src, stride, box_w, box_h, NULL);
+    uint8_t format = rle_size < a4_size ? FONT_GLYPH_STORE_FORMAT_RLE4 : FONT_GLYPH_STORE_FORMAT_A4;
+    uint32_t data_size = LV_MIN(rle_size, a4_size);
+
+    size_t mem_size = sizeof(font_glyph_store_entry_t) + data_size;
+    if (mem_size > store->stats.max_size) {
+        LV_LOG_INFO("glyph %" LV_PRIu32 " (%dx%d) is larger than the store", glyph_index, box_w, box_h);
+        return;
+    }
+
+    font_glyph_store_evict(store, mem_size);
+
+    font_glyph_store_entry_t* entry = lv_malloc(mem_size);
+    LV_ASSERT_MALLOC(entry);
+    if (!entry) {
+        LV_LOG_ERROR("malloc failed for font_glyph_store_entry_t");
+        return;
+    }
+    lv_memzero(entry, sizeof(font_glyph_store_entry_t));
+
+    entry->owner = owner;
+    entry->glyph_index = glyph_index;
+    entry->box_w = box_w;
+    entry->box_h = box_h;
+    entry->format = format;
+    entry->data_size = data_size;
+
+    if (format == FONT_GLYPH_STORE_FORMAT_RLE4) {
+        font_glyph_store_encode_rle4(src, stride, box_w, box_h, entry->data);
+    } else {
+        font_glyph_store_encode_a4(src, stride, box_w, box_h, entry->data);
+    }
+
+    font_hash_insert(&store->glyph_hash, &entry->hash_node, FONT_GLYPH_STORE_KEY_HASH(owner, glyph_index));
+    font_glyph_store_link_head(store, entry);
+
+    store->stats.cur_size += mem_size;
+    store->stats.raw_size += pixel_cnt;
+    store->stats.glyph_cnt++;
+}
+
+void font_glyph_store_drop_font(font_glyph_store_t* store, const void* owner)
+{
+    LV_ASSERT_NULL(store);
+
+    font_glyph_store_entry_t* entry = store->head;
+    while (entry) {
+        font_glyph_store_entry_t* next = entry->next;
+        if (entry->owner == owner) {
+            font_glyph_store_remove(store, entry);
+        }
+        entry = next;
+    }
+}
+
+size_t font_glyph_store_clear(font_glyph_store_t* store)
+{
+    LV_ASSERT_NULL(store);
+
+    size_t cur_size = store->stats.cur_size;
+
+    while (store->tail) {
+        font_glyph_store_remove(store, store->tail);
+    }
+
+    return cur_size;
+}
+
+void font_glyph_store_get_stats(const font_glyph_store_t* store, font_glyph_store_stats_t* stats)
+{
+    LV_ASSERT_NULL(store);
+    LV_ASSERT_NULL(stats);
+
+    *stats = store->stats;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static font_glyph_store_entry_t* font_glyph_store_find(font_glyph_store_t* store, const void* owner, uint32_t glyph_index)
+{
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&store->glyph_hash, FONT_GLYPH_STORE_KEY_HASH(owner, glyph_index), node)
+    {
+        font_glyph_store_entry_t* entry = FONT_HASH_ENTRY(node, font_glyph_store_entry_t, hash_node);
+        if (entry->owner == owner && entry->glyph_index == glyph_index) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t font_glyph_store_encode_rle4(const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h, uint8_t* out)
+{
+    /* runs continue across lines, out is NULL to get the size only */
+    uint32_t size = 0;
+    uint8_t run_value = 0;
+    uint32_t run_len = 0;
+
+    for (uint32_t y = 0; y < box_h; y++) {
+        const uint8_t* line = src + y * stride;
+        for (uint32_t x = 0; x < box_w; x++) {
+            uint8_t value = FONT_GLYPH_STORE_A4(line[x]);
+            if (run_len > 0 && (value != run_value || run_len == FONT_GLYPH_STORE_RUN_MAX)) {
+                if (out) {
+                    out[size] = (uint8_t)((run_len - 1) << 4 | run_value);
+                }
+                size++;
+                run_len = 0;
+            }
+
+            run_value = value;
+            run_len++;
+        }
+    }
+
+    if (run_len > 0) {
+        if (out) {
+            out[size] = (uint8_t)((run_len - 1) << 4 | run_value);
+        }
+        size++;
+    }
+
+    return size;
+}
+
+static void font_glyph_store_encode_a4(const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h, uint8_t* out)
+{
+    uint32_t i = 0;
+    for (uint32_t y = 0; y < box_h; y++) {
+        const uint8_t* line = src + y * stride;
+        for (uint32_t x = 0; x < box_w; x++) {
+            uint8_t value = FONT_GLYPH_STORE_A4(line[x]);
+            if (i & 1) {
+                out[i >> 1] |= value;
+            } else {
+                out[i >> 1] = (uint8_t)(value << 4);
+            }
+            i++;
+        }
+    }
+}
+
+static void font_glyph_store_decode(const font_glyph_store_entry_t* entry, lv_draw_buf_t* draw_buf)
+{
+    /* straight into the draw buffer of the glyph, it may be wider */
+    uint32_t stride = draw_buf->header.stride;
+    uint8_t* line = draw_buf->data;
+    uint32_t x = 0;
+
+    if (entry->format == FONT_GLYPH_STORE_FORMAT_A4) {
+        uint32_t pixel_cnt = (uint32_t)entry->box_w * entry->box_h;
+        for (uint32_t i = 0; i < pixel_cnt; i++) {
+            uint8_t byte = entry->data[i >> 1];
+            uint8_t value = (i & 1) ? (byte & 0x0F) : (byte >> 4);
+            line[x] = value * 17;
+            if (++x == entry->box_w) {
+                x = 0;
+                line += stride;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < entry->data_size; i++) {
+        uint8_t token = entry->data[i];
+        uint8_t alpha = (token & 0x0F) * 17;
+        uint32_t run_len = (token >> 4) + 1;
+
+        while (run_len > 0) {
+            uint32_t len = LV_MIN(run_len, (uint32_t)entry->box_w - x);
+            lv_memset(line + x, alpha, len);
+            run_len -= len;
+            x += len;
+            if (x == entry->box_w) {
+                x = 0;
+                line += stride;
+            }
+        }
+    }
+}
+
+static void font_glyph_store_evict(font_glyph_store_t* store, size_t mem_size)
+{
+    while (store->tail && store->stats.cur_size + mem_size > store->stats.max_size) {
+        font_glyph_store_remove(store, store->tail);
+        store->stats.evict_cnt++;
+    }
+}
+
+static void font_glyph_store_remove(font_glyph_store_t* store, font_glyph_store_entry_t* entry)
+{
+    store->stats.cur_size -= FONT_GLYPH_STORE_MEM_SIZE(entry);
+    store->stats.raw_size -= (size_t)entry->box_w * entry->box_h;
+    store->stats.glyph_cnt--;
+
+    font_hash_remove(&store->glyph_hash, &entry->hash_node);
+    font_glyph_store_unlink(store, entry);
+    lv_free(entry);
+}
+
+static void font_glyph_store_link_head(font_glyph_store_t* store, font_glyph_store_entry_t* entry)
+{
+    entry->prev = NULL;
+    entry->next = store->head;
+    if (store->head) {
+        store->head->prev = entry;
+    } else {
+        store->tail = entry;
+    }
+    store->head = entry;
+}
+
+static void font_glyph_store_unlink(font_glyph_store_t* store, font_glyph_store_entry_t* entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        store->head = entry->next;
+    }
+
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        store->tail = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
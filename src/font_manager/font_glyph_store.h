@@ -0,0 +1,119 @@
+/**
+ * @file font_glyph_store.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_GLYPH_STORE_H
+#define FONT_MANAGER_FONT_GLYPH_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_glyph_store_t font_glyph_store_t;
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t evict_cnt;
+    uint32_t glyph_cnt;
+    size_t cur_size;
+    size_t max_size;
+    size_t raw_size; /* A8 size of the stored glyphs */
+} font_glyph_store_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a compressed glyph store. The A8 glyph bitmaps are kept as 4 bit
+ * alpha, packed or run-length encoded whichever is smaller, and decoded
+ * into the draw buffer of the glyph. The caller serializes the calls.
+ * @param max_size maximum bytes to hold.
+ * @return pointer to glyph store.
+ */
+font_glyph_store_t* font_glyph_store_create(size_t max_size);
+
+/**
+ * Delete a glyph store.
+ * @param store pointer to glyph store.
+ */
+void font_glyph_store_delete(font_glyph_store_t* store);
+
+/**
+ * Decode a stored glyph.
+ * @param store pointer to glyph store.
+ * @param owner the font the glyph belongs to.
+ * @param glyph_index glyph index in the font.
+ * @param box_w glyph width.
+ * @param box_h glyph height.
+ * @param draw_buf A8 buffer to decode into, at least box_w x box_h.
+ * @return return true if the glyph was stored and decoded.
+ */
+bool font_glyph_store_get(font_glyph_store_t* store, const void* owner, uint32_t glyph_index,
+    uint16_t box_w, uint16_t box_h, lv_draw_buf_t* draw_buf);
+
+/**
+ * Compress and store a glyph, the least recently used glyphs are evicted
+ * to make room.
+ * @param store pointer to glyph store.
+ * @param owner the font the glyph belongs to.
+ * @param glyph_index glyph index in the font.
+ * @param src A8 bitmap.
+ * @param stride bytes per line of the bitmap.
+ * @param box_w glyph width.
+ * @param box_h glyph height.
+ */
+void font_glyph_store_put(font_glyph_store_t* store, const void* owner, uint32_t glyph_index,
+    const uint8_t* src, uint32_t stride, uint16_t box_w, uint16_t box_h);
+
+/**
+ * Drop the glyphs of a font, call it before the font is deleted.
+ * @param store pointer to glyph store.
+ * @param owner the font.
+ */
+void font_glyph_store_drop_font(font_glyph_store_t* store, const void* owner);
+
+/**
+ * Drop all glyphs.
+ * @param store pointer to glyph store.
+ * @return bytes released.
+ */
+size_t font_glyph_store_clear(font_glyph_store_t* store);
+
+/**
+ * Get the store statistics.
+ * @param store pointer to glyph store.
+ * @param stats return the statistics.
+ */
+void font_glyph_store_get_stats(const font_glyph_store_t* store, font_glyph_store_stats_t* stats);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_GLYPH_STORE_H */
@@ -0,0 +1,220 @@
+/**
+ * @file font_hash.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_hash.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_HASH_FNV_PRIME 16777619u
+
+/* grow when the average chain length exceeds this value */
+#define FONT_HASH_MAX_LOAD 2
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static void font_hash_resize(font_hash_t* table, uint32_t bucket_cnt);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define FONT_HASH_BUCKET(table, key_hash) ((table)->buckets[(key_hash) & ((table)->bucket_cnt - 1)])
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+bool font_hash_init(font_hash_t* table, uint32_t bucket_cnt)
+{
+    LV_ASSERT_NULL(table);
+    lv_memzero(table, sizeof(font_hash_t));
+
+    /* round up to a power of two */
+    uint32_t cnt = 1;
+    while (cnt < bucket_cnt) {
+        cnt <<= 1;
+    }
+
+    size_t size = sizeof(font_hash_node_t*) * cnt;
+    table->buckets = lv_malloc(size);
+    LV_ASSERT_MALLOC(table->buckets);
+    if (!table->buckets) {
+        LV_LOG_ERROR("malloc failed for buckets");
+        return false;
+    }
+    lv_memzero(table->buckets, size);
+    table->bucket_cnt = cnt;
+
+    return true;
+}
+
+void font_hash_deinit(font_hash_t* table)
+{
+    LV_ASSERT_NULL(table);
+
+    if (table->node_cnt) {
+        LV_LOG_WARN("%" LV_PRIu32 " nodes still in table", table->node_cnt);
+    }
+
+    if (table->buckets) {
+        lv_free(table->buckets);
+    }
+
+    lv_memzero(table, sizeof(font_hash_t));
+}
+
+void font_hash_insert(font_hash_t* table, font_hash_node_t* node, uint32_t key_hash)
+{
+    LV_ASSERT_NULL(table);
+    LV_ASSERT_NULL(node);
+    LV_ASSERT_NULL(table->buckets);
+
+    if (table->node_cnt >= table->bucket_cnt * FONT_HASH_MAX_LOAD) {
+        font_hash_resize(table, table->bucket_cnt * 2);
+    }
+
+    font_hash_node_t** bucket = &FONT_HASH_BUCKET(table, key_hash);
+    node->hash = key_hash;
+    node->next = *bucket;
+    *bucket = node;
+    table->node_cnt++;
+}
+
+bool font_hash_remove(font_hash_t* table, font_hash_node_t* node)
+{
+    LV_ASSERT_NULL(table);
+    LV_ASSERT_NULL(node);
+
+    font_hash_node_t** cur = &FONT_HASH_BUCKET(table, node->hash);
+    while (*cur) {
+        if (*cur == node) {
+            *cur = node->next;
+            node->next = NULL;
+            table->node_cnt--;
+            return true;
+        }
+        cur = &(*cur)->next;
+    }
+
+    return false;
+}
+
+font_hash_node_t* font_hash_first(const font_hash_t* table, uint32_t key_hash)
+{
+    LV_ASSERT_NULL(table);
+
+    font_hash_node_t* node = FONT_HASH_BUCKET(table, key_hash);
+    while (node && node->hash != key_hash) {
+        node = node->next;
+    }
+
+    return node;
+}
+
+font_hash_node_t* font_hash_next(const font_hash_node_t* node)
+{
+    LV_ASSERT_NULL(node);
+
+    uint32_t key_hash = node->hash;
+    font_hash_node_t* next = node->next;
+    while (next && next->hash != key_hash) {
+        next = next->next;
+    }
+
+    return next;
+}
+
+uint32_t font_hash_str(const char* str)
+{
+    LV_ASSERT_NULL(str);
+
+    uint32_t hash = FONT_HASH_INIT;
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= FONT_HASH_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint32_t font_hash_data(uint32_t hash, const void* data, size_t len)
+{
+    LV_ASSERT_NULL(data);
+
+    const uint8_t* p = data;
+    while (len--) {
+        hash ^= *p++;
+        hash *= FONT_HASH_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint32_t font_hash_ptr(const void* ptr)
+{
+    /* drop the alignment bits, then scramble (murmur3 finalizer) */
+    uint32_t hash = (uint32_t)((uintptr_t)ptr >> 3);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+uint32_t font_hash_mix(uint32_t hash, uint32_t value)
+{
+    hash ^= value + 0x9e3779b9u + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void font_hash_resize(font_hash_t* table, uint32_t bucket_cnt)
+{
+    size_t size = sizeof(font_hash_node_t*) * bucket_cnt;
+    font_hash_node_t** buckets = lv_malloc(size);
+    if (!buckets) {
+        /* keep the old buckets, lookups just get slower */
+        LV_LOG_WARN("malloc failed, keep %" LV_PRIu32 " buckets", table->bucket_cnt);
+        return;
+    }
+    lv_memzero(buckets, size);
+
+    for (uint32_t i = 0; i < table->bucket_cnt; i++) {
+        font_hash_node_t* node = table->buckets[i];
+        while (node) {
+            font_hash_node_t* next = node->next;
+            font_hash_node_t** bucket = &buckets[node->hash & (bucket_cnt - 1)];
+            node->next = *bucket;
+            *bucket = node;
+            node = next;
+        }
+    }
+
+    lv_free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_cnt = bucket_cnt;
+
+    LV_LOG_INFO("resize to %" LV_PRIu32 " buckets", bucket_cnt);
+}
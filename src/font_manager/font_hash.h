@@ -0,0 +1,151 @@
+/**
+ * @file font_hash.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_HASH_H
+#define FONT_MANAGER_FONT_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include <lvgl/lvgl.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* initial value of font_hash_data */
+#define FONT_HASH_INIT 2166136261u
+
+/* Get the structure that embeds a hash node */
+#define FONT_HASH_ENTRY(node, type, member) \
+    ((type*)((uint8_t*)(node) - offsetof(type, member)))
+
+/* Iterate over the nodes that share the given key hash */
+#define FONT_HASH_FOREACH(table, key_hash, node)           \
+    for ((node) = font_hash_first((table), (key_hash)); \
+         (node) != NULL;                                \
+         (node) = font_hash_next((node)))
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* intrusive hash node, embedded in the user structure */
+typedef struct _font_hash_node_t {
+    struct _font_hash_node_t* next; /* next node in the same bucket */
+    uint32_t hash; /* full key hash */
+} font_hash_node_t;
+
+/* chained hash table, the bucket count is always a power of two */
+typedef struct {
+    font_hash_node_t** buckets;
+    uint32_t bucket_cnt;
+    uint32_t node_cnt;
+} font_hash_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Initialize a hash table.
+ * @param table pointer to hash table.
+ * @param bucket_cnt initial bucket count, rounded up to a power of two.
+ * @return return true if the initialization was successful.
+ */
+bool font_hash_init(font_hash_t* table, uint32_t bucket_cnt);
+
+/**
+ * Deinitialize a hash table. The nodes are owned by the caller and are not freed.
+ * @param table pointer to hash table.
+ */
+void font_hash_deinit(font_hash_t* table);
+
+/**
+ * Insert a node, the table grows automatically when it gets crowded.
+ * @param table pointer to hash table.
+ * @param node pointer to the node to insert.
+ * @param key_hash hash of the node key.
+ */
+void font_hash_insert(font_hash_t* table, font_hash_node_t* node, uint32_t key_hash);
+
+/**
+ * Remove a node.
+ * @param table pointer to hash table.
+ * @param node pointer to the node to remove.
+ * @return return true if the node was found and removed.
+ */
+bool font_hash_remove(font_hash_t* table, font_hash_node_t* node);
+
+/**
+ * Get the first node matching a key hash.
+ * @param table pointer to hash table.
+ * @param key_hash hash of the key.
+ * @return pointer to the node, NULL if not found.
+ */
+font_hash_node_t* font_hash_first(const font_hash_t* table, uint32_t key_hash);
+
+/**
+ * Get the next node that has the same key hash.
+ * @param node pointer to the current node.
+ * @return pointer to the node, NULL if not found.
+ */
+font_hash_node_t* font_hash_next(const font_hash_node_t* node);
+
+/**
+ * Get the number of nodes in a hash table.
+ * @param table pointer to hash table.
+ * @return node count.
+ */
+static inline uint32_t font_hash_get_count(const font_hash_t* table)
+{
+    return table->node_cnt;
+}
+
+/**
+ * Hash a string (FNV-1a).
+ * @param str string.
+ * @return hash value.
+ */
+uint32_t font_hash_str(const char* str);
+
+/**
+ * Hash a block of data (FNV-1a).
+ * @param hash initial hash value, FONT_HASH_INIT or the result of a previous call.
+ * @param data pointer to data.
+ * @param len data length in bytes.
+ * @return hash value.
+ */
+uint32_t font_hash_data(uint32_t hash, const void* data, size_t len);
+
+/**
+ * Hash a pointer value.
+ * @param ptr pointer.
+ * @return hash value.
+ */
+uint32_t font_hash_ptr(const void* ptr);
+
+/**
+ * Mix a value into a hash.
+ * @param hash current hash value.
+ * @param value value to mix in.
+ * @return new hash value.
+ */
+uint32_t font_hash_mix(uint32_t hash, uint32_t value);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_HASH_H */
@@ -7,9 +7,23 @@
  *      INCLUDES
  *********************/
 #include "font_manager.h"
+#include "font_atlas.h"
 #include "font_cache.h"
+#include "font_cfg.h"
+#include "font_composite.h"
 #include "font_emoji.h"
+#include "font_file.h"
+#include "font_hash.h"
+#include "font_outline.h"
+#include "font_path_cache.h"
+#include "font_sdf.h"
+#include "font_text_cache.h"
+#include "font_glyph_store.h"
+#include "font_usage.h"
 #include "font_utils.h"
+#include "font_worker.h"
+#include <lvgl/src/libs/freetype/lv_freetype_private.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -19,35 +33,156 @@
  *********************/
 
 #define IS_EMOJI_NAME(name) (strstr((name), UIKIT_FONT_EMOJI_HEADER) == (name))
+#define IS_SDF_STYLE(style) (((style) & VG_FONT_STYLE_SDF) != 0)
+
+/* initial bucket count of the lookup tables, they grow on demand */
+#define FONT_MANAGER_NAME_HASH_SIZE 16
+#define FONT_MANAGER_REFER_HASH_SIZE 32
+#define FONT_MANAGER_REC_HASH_SIZE 64
+
+/* how often the glyph misses of the composite fonts are polled without a display, in ms */
+#define FONT_MANAGER_COMPOSITE_PERIOD 50
+
+/* how often the results of the worker are handed back to the UI thread, in ms */
+#define FONT_MANAGER_UI_PERIOD 10
+
+/* lines of an uncached text measured on the stack, longer texts need a heap buffer */
+#define FONT_MANAGER_TEXT_STACK_LINE_CNT 16
+
+/* ASCII glyph metrics table */
+#define FONT_ASCII_GLYPH_CNT 128
+#define FONT_ASCII_FIRST_PRINTABLE 0x20
+#define FONT_ASCII_LAST_PRINTABLE 0x7E
+
+/* get the record node of a font created by font_manager_create_font */
+#define FONT_REC_NODE(font_p) FONT_HASH_ENTRY((font_p), font_rec_node_t, font)
 
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* result of a worker job, handed back to the UI thread */
+typedef struct {
+    font_worker_job_cb_t done_cb;
+    void* user_data;
+    bool is_ready; /* the job is finished */
+} font_manager_done_t;
+
+/* glyph metrics of an ASCII character */
+typedef struct {
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint8_t bpp;
+    uint8_t is_valid; /* the glyph exists and isn't a placeholder */
+    uint32_t glyph_index;
+} font_ascii_glyph_t;
+
+/* interned font name */
+typedef struct _font_name_node_t {
+    font_hash_node_t hash_node; /* name_hash node, keyed by string */
+    int ref_cnt; /* reference count */
+    char name[]; /* name buffer */
+} font_name_node_t;
+
+typedef bool (*font_manager_glyph_dsc_cb_t)(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next);
+typedef const void* (*font_manager_glyph_bitmap_cb_t)(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+typedef void (*font_manager_release_glyph_cb_t)(const lv_font_t* font, lv_font_glyph_dsc_t* dsc);
+
+/* freetype face, lv_freetype shares one between the sizes of a (path, style) */
+typedef struct _font_face_node_t {
+    int ref_cnt; /* open freetype fonts on the face */
+    int cache_cnt; /* of which are in the font cache */
+    size_t mem_size; /* heap taken by the first open, the face and its first size */
+    uint16_t style;
+    char path[]; /* font file path */
+} font_face_node_t;
+
+/* open freetype font */
+typedef struct _font_ft_node_t {
+    lv_font_t* font;
+    font_face_node_t* face;
+    bool is_cached; /* held by the font cache */
+} font_ft_node_t;
+
 /* freetype font reference node */
 typedef struct _font_refer_node_t {
     lv_font_t* font_p; /* lv_freetype gen font */
-    lv_freetype_info_t ft_info; /* freetype font info */
-    char name[UIKIT_FONT_NAME_MAX]; /* name buffer */
+    lv_freetype_info_t ft_info; /* freetype font info, name is interned */
+    font_hash_node_t hash_node; /* refer_hash node, keyed by (name, size, style) */
+    size_t mem_size; /* memory held by the freetype size, its face is charged apart */
     int ref_cnt; /* reference count */
+
+    /* glyph callbacks of the records, set before the node is published and
+     * called under ft_lock
+     */
+    lv_mutex_t* ft_lock;
+    font_manager_glyph_dsc_cb_t glyph_dsc_cb;
+    font_manager_glyph_bitmap_cb_t glyph_bitmap_cb;
+    font_manager_release_glyph_cb_t release_glyph_cb;
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    font_atlas_t* atlas; /* pre-rasterized glyphs */
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if UIKIT_FONT_USE_ASCII_METRICS
+    /* built by the first record and read by the glyph hooks, both under ft_lock */
+    font_ascii_glyph_t* ascii_arr; /* FONT_ASCII_GLYPH_CNT entries, NULL until built */
+    bool ascii_checked; /* the table was built or failed to */
+    bool ascii_has_kerning; /* the face has a kerning table, kerned pairs skip the table */
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    font_glyph_store_t* glyph_store; /* compressed bitmaps, NULL if the font doesn't use it */
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    font_usage_t* usage; /* usage recorder, NULL if the font isn't recorded */
+    font_usage_font_t* usage_font; /* usage record of the font */
+    font_manager_glyph_bitmap_cb_t usage_bitmap_cb; /* bitmap callback behind the recorder */
+    bool is_warm; /* warmed up, goes to the protected cache list once dropped, under refer_lock */
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
 } font_refer_node_t;
 
 /* lvgl font record node */
 typedef struct _font_rec_node_t {
     lv_font_t font; /* lvgl font info */
     font_refer_node_t* refer_node_p; /* referenced freetype resource */
+    font_hash_node_t hash_node; /* rec_hash node, keyed by font address */
 } font_rec_node_t;
 
-/* font manager object */
+/* font manager object, each lock guards the members listed next to it.
+ * ft_lock is always taken last: it serializes freetype and the glyph caches,
+ * the glyph callbacks of the records take it and nothing else, and no font
+ * file is resolved or mapped under it. The only other nesting is the text
+ * measurement, rec_lock then ft_lock. None of them is held while taking lv_lock.
+ * The composite fonts and the font cache have their own leaf locks, the faces
+ * charge the font cache under ft_lock.
+ */
 typedef struct vg_font_manager_t {
+    lv_mutex_t refer_lock; /* refer_ll, refer_hash, name_hash and the refer_node ref_cnt */
     lv_ll_t refer_ll; /* freetype font record list */
+    font_hash_t refer_hash; /* index of refer_ll */
+    font_hash_t name_hash; /* interned font names */
+
+    lv_mutex_t rec_lock; /* rec_ll, rec_hash and text_cache */
     lv_ll_t rec_ll; /* lvgl font record list */
+    font_hash_t rec_hash; /* index of rec_ll */
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    font_text_cache_t* text_cache; /* text metrics of the record fonts */
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+    lv_mutex_t path_lock; /* path_ll, base_path, def_path and path_cache */
     lv_ll_t path_ll; /* font path record list */
     char base_path[PATH_MAX]; /* font base path */
     char def_path[PATH_MAX];
+    font_path_cache_t* path_cache; /* resolved font paths */
 
 #if UIKIT_FONT_USE_FONT_FAMILY
-    font_family_config_t* font_family_config;
+    font_cfg_t font_cfg; /* emoji and font-family configuration */
 #endif /* UIKIT_FONT_USE_FONT_FAMILY */
 
 #if UIKIT_FONT_USE_EMOJI
@@ -56,7 +191,58 @@ typedef struct vg_font_manager_t {
 
 #if (UIKIT_FONT_CACHE_SIZE > 0)
     font_cache_manager_t* cache_manager;
+    size_t cache_face_mem_size; /* faces only the cached fonts hold, used under ft_lock */
 #endif /* UIKIT_FONT_CACHE_SIZE */
+
+    void* ft_memory; /* FT_Memory shared by the faces, counts what each open takes, used under ft_lock */
+
+#if UIKIT_FONT_USE_FILE_MAP
+    font_file_manager_t* file_manager; /* mapped font files, NULL to let freetype open them */
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    font_outline_cache_t* outline_cache; /* glyph outlines shared by all sizes, used under ft_lock */
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    font_glyph_store_t* glyph_store; /* compressed glyph bitmaps of the freetype fonts, used under ft_lock */
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    font_usage_t* usage; /* fonts and letters drawn since boot, used under ft_lock */
+    uint32_t usage_saved_cnt; /* glyphs in the last saved profile, used under ft_lock */
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+#if UIKIT_FONT_USE_SDF
+    font_sdf_cache_t* sdf_cache; /* distance fields of the SDF fonts, used under ft_lock */
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+    lv_ll_t composite_ll; /* lv_font_t* of the composite fonts, protected by rec_lock */
+    lv_display_t* composite_disp; /* its refreshes pick up their glyph misses */
+    lv_timer_t* composite_timer; /* polls them instead while there is no display */
+    bool is_composite_wanted; /* a composite waits for a member, protected by ui_lock */
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+
+    lv_ll_t face_ll; /* font_face_node_t*, used under ft_lock */
+    lv_ll_t ft_font_ll; /* font_ft_node_t of the open freetype fonts, used under ft_lock */
+    lv_mutex_t ft_lock; /* freetype, the emoji manager, the faces and the glyph caches above */
+
+    font_worker_t* worker; /* background jobs, created on demand under refer_lock */
+    bool is_exiting; /* protected by refer_lock, no job is posted once set */
+
+    /* the jobs never take lv_lock, their results are run by ui_timer */
+    lv_mutex_t ui_lock; /* done_ll, a leaf lock */
+    lv_ll_t done_ll; /* font_manager_done_t, in posting order */
+    lv_timer_t* ui_timer; /* paused while done_ll is empty */
+    uint32_t refer_hit_cnt; /* protected by refer_lock */
+
+    lv_mutex_t stats_lock; /* the freetype open counters below */
+    uint32_t open_cnt;
+    uint32_t open_fail_cnt;
+    uint32_t open_time_sum;
+    uint32_t open_time_max;
+    uint32_t open_latency_hist[VG_FONT_LATENCY_BUCKET_CNT];
 } font_manager_t;
 
 struct _font_path_t {
@@ -64,16 +250,101 @@ struct _font_path_t {
     char* path;
 };
 
+/* font preload job */
+typedef struct {
+    font_manager_t* manager;
+    lv_freetype_info_t ft_info;
+    char name[]; /* name buffer */
+} font_preload_job_t;
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+/* font warm-up job */
+typedef struct {
+    font_manager_t* manager;
+    lv_freetype_info_t ft_info;
+    uint32_t letter_cnt;
+    uint32_t letter_arr[]; /* followed by the name */
+} font_warm_job_t;
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
 static const char* font_manager_get_path(font_manager_t* manager, const char* name);
+static const char* font_manager_search_custom_path(font_manager_t* manager, const char* name);
+static const char* font_manager_lookup_path(font_manager_t* manager, const char* name);
+static bool font_manager_resolve_path(font_manager_t* manager, const char* name, char* path, size_t len);
 static void font_manager_remove_path_all(font_manager_t* manager);
 static bool font_manager_check_resource(font_manager_t* manager);
-static font_refer_node_t* font_manager_request_font(font_manager_t* manager, const lv_freetype_info_t* ft_info);
+static void font_manager_ui_timer_cb(lv_timer_t* timer);
+static void font_manager_cancel_done(font_manager_t* manager);
+static font_refer_node_t* font_manager_request_font(font_manager_t* manager, const lv_freetype_info_t* ft_info, const char* path);
+static lv_font_t* font_manager_add_rec(font_manager_t* manager, font_refer_node_t* refer_node);
+static const lv_freetype_info_t* font_manager_adjust_info(font_manager_t* manager, const lv_freetype_info_t* ft_info,
+    lv_freetype_info_t* buf);
+static int font_manager_batch_compare(const lv_freetype_info_t* a, const lv_freetype_info_t* b);
 static bool font_manager_drop_font(font_manager_t* manager, font_refer_node_t* refer_node);
 static font_rec_node_t* font_manager_search_rec_node(font_manager_t* manager, lv_font_t* font);
+static const char* font_manager_intern_name(font_manager_t* manager, const char* name);
+static void font_manager_preload_job_cb(void* user_data, bool cancelled);
+static void font_manager_init_glyph_hooks(font_refer_node_t* refer_node);
+static bool font_manager_locked_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next);
+static const void* font_manager_locked_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+static void font_manager_locked_release_glyph_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc);
+static void* font_manager_acquire_file(font_manager_t* manager, const char* path);
+static void font_manager_release_file(font_manager_t* manager, void* file);
+static void font_manager_close_freetype_cb(void* user_data, lv_font_t* font);
+static bool font_manager_is_freetype_node(const font_refer_node_t* refer_node);
+static void font_manager_flush_glyph_cache(font_manager_t* manager);
+#if UIKIT_FONT_USE_SDF && UIKIT_FONT_USE_FONT_FAMILY
+static bool font_manager_is_sdf_family(font_manager_t* manager, const char* name);
+#endif /* UIKIT_FONT_USE_SDF && UIKIT_FONT_USE_FONT_FAMILY */
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+static lv_font_t* font_manager_create_font_composite(font_manager_t* manager, const font_cfg_family_t* font_family,
+    const lv_freetype_info_t* ft_info);
+static void font_manager_delete_font_composite(font_manager_t* manager, lv_font_t* font);
+static void font_manager_composite_want_cb(void* user_data);
+static void font_manager_composite_timer_cb(lv_timer_t* timer);
+static void font_manager_composite_refr_cb(lv_event_t* e);
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+#if UIKIT_FONT_USE_ASCII_METRICS
+static void font_manager_init_ascii_metrics(font_manager_t* manager, font_rec_node_t* rec_node);
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+static uint32_t font_manager_measure_text(font_manager_t* manager, const font_text_key_t* key, uint32_t epoch,
+    lv_point_t* size, uint32_t* line_start, uint32_t line_max);
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+static void font_manager_release_name(font_manager_t* manager, const char* name);
+static void font_manager_record_open(font_manager_t* manager, uint32_t elaps, bool success);
+static lv_font_t* font_manager_open_freetype(font_manager_t* manager, const char* path, const lv_freetype_info_t* ft_info,
+    lv_freetype_font_render_mode_t render_mode, size_t* mem_size);
+static void font_manager_close_freetype(font_manager_t* manager, lv_font_t* font);
+static void font_manager_remove_face(font_manager_t* manager, font_face_node_t* face);
+static font_ft_node_t* font_manager_find_ft_node(font_manager_t* manager, const lv_font_t* font);
+static void font_manager_charge_face(font_manager_t* manager, const font_face_node_t* face, bool was_cache_only);
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+static void font_manager_set_cached(font_manager_t* manager, lv_font_t* font, bool is_cached);
+#endif /* UIKIT_FONT_CACHE_SIZE */
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0) || UIKIT_FONT_USE_SDF
+static void font_manager_close_ref_font_cb(void* user_data, lv_font_t* font);
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE || UIKIT_FONT_USE_SDF */
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+static lv_font_t* font_manager_outline_open_cb(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style);
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+#if UIKIT_FONT_USE_SDF
+static lv_font_t* font_manager_sdf_open_cb(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style);
+#endif /* UIKIT_FONT_USE_SDF */
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+static const void* font_manager_store_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+#if UIKIT_FONT_USE_USAGE_PROFILE
+static void font_manager_warm_load_job_cb(void* user_data, bool cancelled);
+static void font_manager_warm_font_job_cb(void* user_data, bool cancelled);
+static const void* font_manager_usage_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
 
 /**********************
  *  STATIC VARIABLES
@@ -96,26 +367,109 @@ font_manager_t* font_manager_create(void)
     _lv_ll_init(&manager->refer_ll, sizeof(font_refer_node_t));
     _lv_ll_init(&manager->rec_ll, sizeof(font_rec_node_t));
     _lv_ll_init(&manager->path_ll, sizeof(font_path_t));
+    _lv_ll_init(&manager->face_ll, sizeof(font_face_node_t*));
+    _lv_ll_init(&manager->ft_font_ll, sizeof(font_ft_node_t));
+    _lv_ll_init(&manager->done_ll, sizeof(font_manager_done_t));
+
+    if (!font_hash_init(&manager->name_hash, FONT_MANAGER_NAME_HASH_SIZE)
+        || !font_hash_init(&manager->refer_hash, FONT_MANAGER_REFER_HASH_SIZE)
+        || !font_hash_init(&manager->rec_hash, FONT_MANAGER_REC_HASH_SIZE)) {
+        LV_LOG_ERROR("hash table init failed");
+        font_hash_deinit(&manager->name_hash);
+        font_hash_deinit(&manager->refer_hash);
+        font_hash_deinit(&manager->rec_hash);
+        lv_free(manager);
+        return NULL;
+    }
+
+    manager->path_cache = font_path_cache_create();
+    if (!manager->path_cache) {
+        font_hash_deinit(&manager->name_hash);
+        font_hash_deinit(&manager->refer_hash);
+        font_hash_deinit(&manager->rec_hash);
+        lv_free(manager);
+        return NULL;
+    }
+
+    lv_mutex_init(&manager->refer_lock);
+    lv_mutex_init(&manager->rec_lock);
+    lv_mutex_init(&manager->path_lock);
+    lv_mutex_init(&manager->stats_lock);
+    lv_mutex_init(&manager->ft_lock);
+    lv_mutex_init(&manager->ui_lock);
 
 #if UIKIT_FONT_USE_FONT_FAMILY
-    /* Open the font configuration file */
-    font_utils_json_obj_t* json_obj = font_utils_json_obj_create(UIKIT_FONT_CONFIG_FILE_PATH);
-    if (json_obj) {
+    /* Map the precompiled font configuration, parse the json only if it is absent */
+    if (font_cfg_open(&manager->font_cfg, UIKIT_FONT_CONFIG_BIN_PATH)
+        || font_cfg_load_json(&manager->font_cfg, UIKIT_FONT_CONFIG_FILE_PATH)) {
 
 #if UIKIT_FONT_USE_EMOJI
-        manager->emoji_manager = font_emoji_manager_create(json_obj);
+        manager->emoji_manager = font_emoji_manager_create(&manager->font_cfg);
 #endif /* UIKIT_FONT_USE_EMOJI */
-
-        manager->font_family_config = font_utils_json_get_font_family_config(json_obj);
-
-        font_utils_json_obj_delete(json_obj);
     }
 #endif /* UIKIT_FONT_USE_FONT_FAMILY */
 
 #if (UIKIT_FONT_CACHE_SIZE > 0)
-    manager->cache_manager = font_cache_manager_create(UIKIT_FONT_CACHE_SIZE);
+    manager->cache_manager = font_cache_manager_create(UIKIT_FONT_CACHE_SIZE, UIKIT_FONT_CACHE_MEM_SIZE,
+        UIKIT_FONT_CACHE_POLICY, font_manager_close_freetype_cb, manager);
 #endif /* UIKIT_FONT_CACHE_SIZE */
 
+#if UIKIT_FONT_USE_FILE_MAP
+    manager->file_manager = font_file_manager_create(UIKIT_FONT_FILE_MAP_LETTER);
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    manager->text_cache = font_text_cache_create(UIKIT_FONT_TEXT_CACHE_SIZE);
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    manager->glyph_store = font_glyph_store_create(UIKIT_FONT_GLYPH_STORE_SIZE);
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    manager->usage = font_usage_create(UIKIT_FONT_USAGE_PROFILE_FONT_MAX, UIKIT_FONT_USAGE_PROFILE_GLYPH_MAX);
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+    /* the timers are made here, the fonts may be created on the worker */
+    lv_lock();
+    manager->ui_timer = lv_timer_create(font_manager_ui_timer_cb, FONT_MANAGER_UI_PERIOD, manager);
+    LV_ASSERT_MALLOC(manager->ui_timer);
+    if (manager->ui_timer) {
+        lv_timer_pause(manager->ui_timer);
+    }
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+    _lv_ll_init(&manager->composite_ll, sizeof(lv_font_t*));
+    manager->composite_timer = lv_timer_create(font_manager_composite_timer_cb, FONT_MANAGER_COMPOSITE_PERIOD,
+        manager);
+    LV_ASSERT_MALLOC(manager->composite_timer);
+
+    /* the draws that miss a glyph end with the refresh, nothing runs while no glyph is missed */
+    manager->composite_disp = lv_display_get_default();
+    if (manager->composite_disp) {
+        lv_display_add_event_cb(manager->composite_disp, font_manager_composite_refr_cb, LV_EVENT_REFR_READY, manager);
+        lv_display_add_event_cb(manager->composite_disp, font_manager_composite_refr_cb, LV_EVENT_DELETE, manager);
+        if (manager->composite_timer) {
+            lv_timer_pause(manager->composite_timer);
+        }
+    } else {
+        LV_LOG_WARN("no display, the glyph misses are polled");
+    }
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+    lv_unlock();
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    lv_lock();
+    manager->outline_cache = font_outline_cache_create(UIKIT_FONT_OUTLINE_CACHE_SIZE, UIKIT_FONT_OUTLINE_REF_SIZE,
+        font_manager_outline_open_cb, font_manager_close_ref_font_cb, manager);
+    lv_unlock();
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#if UIKIT_FONT_USE_SDF
+    manager->sdf_cache = font_sdf_cache_create(UIKIT_FONT_SDF_CACHE_SIZE, UIKIT_FONT_SDF_REF_SIZE,
+        UIKIT_FONT_SDF_SPREAD, font_manager_sdf_open_cb, font_manager_close_ref_font_cb, manager);
+#endif /* UIKIT_FONT_USE_SDF */
+
     LV_LOG_INFO("success");
     return manager;
 }
@@ -124,30 +478,127 @@ bool font_manager_delete(font_manager_t* manager)
 {
     LV_ASSERT_NULL(manager);
 
+    /* no job is posted from now on, the worker is joined outside the lock */
+    lv_mutex_lock(&manager->refer_lock);
+    manager->is_exiting = true;
+    font_worker_t* worker = manager->worker;
+    manager->worker = NULL;
+    lv_mutex_unlock(&manager->refer_lock);
+
+    /* Finish the background jobs before checking the resource */
+    if (worker) {
+        font_worker_delete(worker);
+    }
+
+    /* their results are cancelled in the caller's context */
+    font_manager_cancel_done(manager);
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    font_manager_save_usage_profile(manager);
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
     /* Resource leak check */
     if (font_manager_check_resource(manager)) {
         LV_LOG_ERROR("Unfreed resource detected, delete failed!");
         return false;
     }
 
-#if UIKIT_FONT_USE_FONT_FAMILY
-    if (manager->font_family_config) {
-        font_utils_json_font_family_free(manager->font_family_config);
+    lv_lock();
+    if (manager->ui_timer) {
+        lv_timer_delete(manager->ui_timer);
+    }
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+    if (manager->composite_disp) {
+        lv_display_remove_event_cb_with_user_data(manager->composite_disp, font_manager_composite_refr_cb, manager);
     }
 
+    if (manager->composite_timer) {
+        lv_timer_delete(manager->composite_timer);
+    }
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+    lv_unlock();
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
 #if UIKIT_FONT_USE_EMOJI
     if (manager->emoji_manager) {
         font_emoji_manager_delete(manager->emoji_manager);
     }
 #endif /* UIKIT_FONT_USE_EMOJI */
 
+    font_cfg_close(&manager->font_cfg);
+
 #endif /* UIKIT_FONT_USE_FONT_FAMILY */
 
 #if (UIKIT_FONT_CACHE_SIZE > 0)
     font_cache_manager_delete(manager->cache_manager);
 #endif /* UIKIT_FONT_CACHE_SIZE */
 
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    if (manager->text_cache) {
+        font_text_cache_delete(manager->text_cache);
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    if (manager->glyph_store) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_glyph_store_delete(manager->glyph_store);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    if (manager->usage) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_usage_delete(manager->usage);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    /* the reference fonts read their files too */
+    if (manager->outline_cache) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_outline_cache_delete(manager->outline_cache);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#if UIKIT_FONT_USE_SDF
+    /* the reference fonts read their files too */
+    if (manager->sdf_cache) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_sdf_cache_delete(manager->sdf_cache);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if UIKIT_FONT_USE_FILE_MAP
+    /* after the cache, the cached fonts still read their files */
+    if (manager->file_manager) {
+        font_file_manager_delete(manager->file_manager);
+    }
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+
+    /* all freetype fonts are closed, and their faces with them */
+    LV_ASSERT(_lv_ll_is_empty(&manager->ft_font_ll));
+    LV_ASSERT(_lv_ll_is_empty(&manager->face_ll));
+
     font_manager_remove_path_all(manager);
+    font_path_cache_delete(manager->path_cache);
+
+    font_hash_deinit(&manager->name_hash);
+    font_hash_deinit(&manager->refer_hash);
+    font_hash_deinit(&manager->rec_hash);
+
+    lv_mutex_delete(&manager->refer_lock);
+    lv_mutex_delete(&manager->rec_lock);
+    lv_mutex_delete(&manager->path_lock);
+    lv_mutex_delete(&manager->stats_lock);
+    lv_mutex_delete(&manager->ft_lock);
+    lv_mutex_delete(&manager->ui_lock);
 
     lv_free(manager);
 
@@ -160,9 +611,14 @@ void font_manager_set_base_path(font_manager_t* manager, const char* base_path)
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(base_path);
     size_t max_len = sizeof(manager->base_path);
+
+    lv_mutex_lock(&manager->path_lock);
     strncpy(manager->base_path, base_path, max_len);
     manager->base_path[max_len - 1] = '\0';
-    LV_LOG_USER("%s", manager->base_path);
+    font_path_cache_clear(manager->path_cache);
+    lv_mutex_unlock(&manager->path_lock);
+
+    LV_LOG_USER("%s", base_path);
 }
 
 font_path_t* font_manager_add_path(font_manager_t* manager, const char* name, const char* path)
@@ -171,9 +627,12 @@ font_path_t* font_manager_add_path(font_manager_t* manager, const char* name, co
     LV_ASSERT_NULL(name);
     LV_ASSERT_NULL(path);
 
+    lv_mutex_lock(&manager->path_lock);
+
     const char* old_path = font_manager_get_path(manager, name);
     if (strcmp(path, old_path) == 0) {
         LV_LOG_WARN("name: %s, path: %s already exists", name, old_path);
+        lv_mutex_unlock(&manager->path_lock);
         return NULL;
     }
 
@@ -190,6 +649,10 @@ font_path_t* font_manager_add_path(font_manager_t* manager, const char* name, co
     LV_ASSERT_MALLOC(font_path->path);
     lv_memcpy(font_path->path, path, path_len);
 
+    font_path_cache_clear(manager->path_cache);
+
+    lv_mutex_unlock(&manager->path_lock);
+
     LV_LOG_USER("name: %s, path: %s add success", name, path);
     return font_path;
 }
@@ -198,6 +661,8 @@ bool font_manager_remove_path(font_manager_t* manager, font_path_t* handle)
 {
     LV_ASSERT_NULL(manager);
 
+    lv_mutex_lock(&manager->path_lock);
+
     font_path_t* font_path;
     _LV_LL_READ(&manager->path_ll, font_path)
     {
@@ -207,10 +672,14 @@ bool font_manager_remove_path(font_manager_t* manager, font_path_t* handle)
             lv_free(font_path->name);
             lv_free(font_path->path);
             lv_free(font_path);
+            font_path_cache_clear(manager->path_cache);
+            lv_mutex_unlock(&manager->path_lock);
             return true;
         }
     }
 
+    lv_mutex_unlock(&manager->path_lock);
+
     LV_LOG_WARN("handle %p is invalid", handle);
     return false;
 }
@@ -220,25 +689,115 @@ lv_font_t* font_manager_create_font(font_manager_t* manager, const lv_freetype_i
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(ft_info);
 
+    FONT_PROFILER_BEGIN;
+
+    lv_freetype_info_t info_buf;
+    ft_info = font_manager_adjust_info(manager, ft_info, &info_buf);
+
     /* Request freetype font */
-    font_refer_node_t* refer_node = font_manager_request_font(manager, ft_info);
+    font_refer_node_t* refer_node = font_manager_request_font(manager, ft_info, NULL);
     if (!refer_node) {
+        FONT_PROFILER_END;
         return NULL;
     }
 
-    /* Add font record node */
-    font_rec_node_t* rec_node = _lv_ll_ins_head(&manager->rec_ll);
-    LV_ASSERT_MALLOC(rec_node);
-    lv_memzero(rec_node, sizeof(font_rec_node_t));
+    lv_font_t* font = font_manager_add_rec(manager, refer_node);
 
-    /* copy freetype_font data */
-    rec_node->font = *refer_node->font_p;
+    FONT_PROFILER_END;
+    return font;
+}
 
-    /* record reference node */
-    rec_node->refer_node_p = refer_node;
+size_t font_manager_create_font_batch(font_manager_t* manager, const lv_freetype_info_t* ft_info_arr,
+    lv_font_t** font_arr, size_t cnt)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(ft_info_arr);
+    LV_ASSERT_NULL(font_arr);
 
-    LV_LOG_INFO("success");
-    return &rec_node->font;
+    if (cnt == 0) {
+        return 0;
+    }
+
+    FONT_PROFILER_BEGIN;
+
+    uint32_t* order = lv_malloc(sizeof(uint32_t) * cnt);
+    LV_ASSERT_MALLOC(order);
+    if (!order) {
+        LV_LOG_ERROR("malloc failed for order");
+        FONT_PROFILER_END;
+        return 0;
+    }
+
+    /* group the requests by name then size, a screen asks for a handful of
+     * files at several sizes, the insertion sort is cheap at that count
+     */
+    uint32_t valid_cnt = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        const lv_freetype_info_t* ft_info = &ft_info_arr[i];
+        font_arr[i] = NULL;
+        if (ft_info->name == NULL || ft_info->size == 0) {
+            LV_LOG_WARN("ft_info[%" LV_PRIu32 "] param error", (uint32_t)i);
+            continue;
+        }
+
+        uint32_t j = valid_cnt++;
+        while (j > 0 && font_manager_batch_compare(&ft_info_arr[order[j - 1]], ft_info) > 0) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint32_t)i;
+    }
+
+    char path[PATH_MAX];
+    const char* path_name = NULL;
+    bool has_path = false;
+    font_refer_node_t* prev_node = NULL;
+    size_t created = 0;
+
+    for (uint32_t k = 0; k < valid_cnt; k++) {
+        const lv_freetype_info_t* ft_info = &ft_info_arr[order[k]];
+        font_refer_node_t* refer_node = NULL;
+
+        if (k > 0 && prev_node && font_manager_batch_compare(&ft_info_arr[order[k - 1]], ft_info) == 0) {
+            /* same request, the previous font holds a reference on the node */
+            lv_mutex_lock(&manager->refer_lock);
+            prev_node->ref_cnt++;
+            manager->refer_hit_cnt++;
+            lv_mutex_unlock(&manager->refer_lock);
+            refer_node = prev_node;
+        } else {
+            /* resolve the file once for all the sizes of a name */
+            if (!path_name || strcmp(path_name, ft_info->name) != 0) {
+                path_name = ft_info->name;
+                has_path = !IS_EMOJI_NAME(ft_info->name)
+                    && font_manager_resolve_path(manager, ft_info->name, path, sizeof(path));
+            }
+
+            lv_freetype_info_t info_buf;
+            const lv_freetype_info_t* req_info = font_manager_adjust_info(manager, ft_info, &info_buf);
+            refer_node = font_manager_request_font(manager, req_info, has_path ? path : NULL);
+        }
+
+        prev_node = NULL;
+        if (!refer_node) {
+            continue;
+        }
+
+        lv_font_t* font = font_manager_add_rec(manager, refer_node);
+        if (!font) {
+            continue;
+        }
+
+        font_arr[order[k]] = font;
+        prev_node = refer_node;
+        created++;
+    }
+
+    lv_free(order);
+
+    FONT_PROFILER_END;
+    LV_LOG_INFO("%" LV_PRIu32 "/%" LV_PRIu32 " fonts created", (uint32_t)created, (uint32_t)cnt);
+    return created;
 }
 
 bool font_manager_delete_font(font_manager_t* manager, lv_font_t* font)
@@ -246,341 +805,1940 @@ bool font_manager_delete_font(font_manager_t* manager, lv_font_t* font)
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(font);
 
+    FONT_PROFILER_BEGIN;
+
+    lv_mutex_lock(&manager->rec_lock);
+
     /* check font is created by font manager */
     font_rec_node_t* rec_node = font_manager_search_rec_node(manager, font);
     if (!rec_node) {
+        lv_mutex_unlock(&manager->rec_lock);
         LV_LOG_WARN("No record found for font: %p(%d),"
                     " it was not created by font manager",
             font, (int)font->line_height);
+        FONT_PROFILER_END;
         return false;
     }
 
+    /* unlink rec_node, a concurrent delete of the same font finds nothing */
+    font_hash_remove(&manager->rec_hash, &rec_node->hash_node);
+    _lv_ll_remove(&manager->rec_ll, rec_node);
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    /* the address may be reused by the next font */
+    if (manager->text_cache) {
+        font_text_cache_drop_font(manager->text_cache, font);
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+    lv_mutex_unlock(&manager->rec_lock);
+
     /* return freetype font resource */
     bool retval = font_manager_drop_font(manager, rec_node->refer_node_p);
     LV_ASSERT(retval);
 
-    /* free rec_node */
-    _lv_ll_remove(&manager->rec_ll, rec_node);
     lv_free(rec_node);
 
+    FONT_PROFILER_END;
     LV_LOG_INFO("success");
     return retval;
 }
 
-#if UIKIT_FONT_USE_FONT_FAMILY
-
-lv_font_t* font_manager_create_font_family(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+size_t font_manager_preload(font_manager_t* manager, const lv_freetype_info_t* ft_info_arr, size_t cnt)
 {
     LV_ASSERT_NULL(manager);
-    LV_ASSERT_NULL(ft_info);
+    LV_ASSERT_NULL(ft_info_arr);
 
-    if (!manager->font_family_config) {
-        LV_LOG_WARN("No font_family_config detected");
-        return NULL;
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    if (cnt > UIKIT_FONT_CACHE_SIZE) {
+        LV_LOG_WARN("preload %" LV_PRIu32 " fonts > cache size %d, the first ones will be evicted",
+            (uint32_t)cnt, UIKIT_FONT_CACHE_SIZE);
     }
 
-    lv_font_t* start_font = NULL;
-    lv_font_t* cur_font = NULL;
-    lv_freetype_info_t ft_info_tmp = *ft_info;
+    size_t queued = 0;
+    for (size_t i = 0; i < cnt; i++) {
+        const lv_freetype_info_t* ft_info = &ft_info_arr[i];
+        LV_ASSERT_NULL(ft_info->name);
+
+        /* one job per font, so the UI thread fallback runs one font per period */
+        size_t name_len = strlen(ft_info->name) + 1;
+        font_preload_job_t* job = lv_malloc(sizeof(font_preload_job_t) + name_len);
+        LV_ASSERT_MALLOC(job);
+        if (!job) {
+            LV_LOG_ERROR("malloc failed for font_preload_job_t");
+            break;
+        }
 
-    int font_family_arr_size = manager->font_family_config->font_family_arr_size;
-    for (int font_index = 0; font_index < font_family_arr_size; font_index++) {
-        font_family_t* font_family = &manager->font_family_config->font_family_arr[font_index];
-
-        /* match font */
-        if (strcmp(ft_info->name, font_family->font_name) == 0) {
-            LV_LOG_INFO("matched font-family: %s", ft_info->name);
-
-            /* add fallback */
-            int fallback_arr_size = font_family->fallback_arr_size;
-            for (int fallback_index = 0; fallback_index < fallback_arr_size; fallback_index++) {
-                font_family_fallback_t* fallback = &font_family->fallback_arr[fallback_index];
-
-                ft_info_tmp.name = fallback->font_name;
-
-                /* create fallback font */
-                lv_font_t* font = font_manager_create_font(manager, &ft_info_tmp);
-                if (!font) {
-                    LV_LOG_INFO("%s(%d) <- %s(%d) create failed, continue...",
-                        ft_info->name, ft_info->size,
-                        ft_info_tmp.name, ft_info->size);
-                    continue;
-                }
-
-                /* save start_font for reture value */
-                if (!start_font) {
-                    start_font = font;
-                }
-
-                if (cur_font) {
-                    /*append fallback*/
-                    cur_font->fallback = font;
-                }
-                cur_font = font;
-            }
+        job->manager = manager;
+        job->ft_info = *ft_info;
+        job->ft_info.name = job->name;
+        lv_memcpy(job->name, ft_info->name, name_len);
 
+        if (!font_manager_post_job(manager, font_manager_preload_job_cb, job)) {
+            lv_free(job);
             break;
         }
+
+        queued++;
     }
 
-    return start_font;
+    LV_LOG_INFO("%" LV_PRIu32 "/%" LV_PRIu32 " fonts queued", (uint32_t)queued, (uint32_t)cnt);
+    return queued;
+#else
+    LV_UNUSED(ft_info_arr);
+    LV_UNUSED(cnt);
+    LV_LOG_WARN("font cache is disabled, nothing to preload");
+    return 0;
+#endif /* UIKIT_FONT_CACHE_SIZE */
 }
 
-void font_manager_delete_font_family(font_manager_t* manager, lv_font_t* font)
+bool font_manager_post_job(font_manager_t* manager, font_worker_job_cb_t cb, void* user_data)
 {
-    LV_ASSERT_NULL(font);
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(cb);
 
-    const lv_font_t* f = font;
-    while (f) {
-        const lv_font_t* fallback = f->fallback;
-        font_manager_delete_font(manager, (lv_font_t*)f);
-        f = fallback;
+    lv_mutex_lock(&manager->refer_lock);
+    if (manager->is_exiting) {
+        lv_mutex_unlock(&manager->refer_lock);
+        LV_LOG_WARN("font manager is exiting");
+        return false;
     }
-}
+    if (!manager->worker) {
+        manager->worker = font_worker_create();
+    }
+    font_worker_t* worker = manager->worker;
+    lv_mutex_unlock(&manager->refer_lock);
 
-#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+    if (!worker) {
+        return false;
+    }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
+    return font_worker_post(worker, cb, user_data);
+}
 
-static const char* font_manager_generate_def_path(font_manager_t* manager, const char* name)
+bool font_manager_post_ui_job(font_manager_t* manager, font_worker_job_cb_t cb, font_worker_job_cb_t done_cb,
+    void* user_data)
 {
-    int len = lv_snprintf(
-        manager->def_path,
-        sizeof(manager->def_path),
-        "%s/%s." UIKIT_FONT_EXT_NAME,
-        manager->base_path,
-        name);
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(cb);
+    LV_ASSERT_NULL(done_cb);
 
-    if (len >= sizeof(manager->def_path)) {
-        LV_LOG_WARN("path truncation detected, len = %d", len);
+    if (!manager->ui_timer) {
+        LV_LOG_WARN("UI timer not ready");
+        return false;
     }
 
-    return manager->def_path;
-}
+    /* the entry is made first, the job can't fail to hand its result back */
+    lv_mutex_lock(&manager->ui_lock);
+    font_manager_done_t* done = _lv_ll_ins_tail(&manager->done_ll);
+    LV_ASSERT_MALLOC(done);
+    if (done) {
+        done->done_cb = done_cb;
+        done->user_data = user_data;
+        done->is_ready = false;
+    }
+    lv_mutex_unlock(&manager->ui_lock);
 
-static const char* font_manager_get_path(font_manager_t* manager, const char* name)
-{
-    font_path_t* font_path;
-    _LV_LL_READ(&manager->path_ll, font_path)
-    {
-        if (strcmp(name, font_path->name) == 0) {
-            return font_path->path;
-        }
+    if (!done) {
+        LV_LOG_ERROR("malloc failed for font_manager_done_t");
+        return false;
+    }
+
+    if (!font_manager_post_job(manager, cb, user_data)) {
+        lv_mutex_lock(&manager->ui_lock);
+        _lv_ll_remove(&manager->done_ll, done);
+        lv_mutex_unlock(&manager->ui_lock);
+        lv_free(done);
+        return false;
     }
 
-    return font_manager_generate_def_path(manager, name);
+    /* the timer pauses itself once done_ll is empty */
+    lv_lock();
+    lv_timer_resume(manager->ui_timer);
+    lv_unlock();
+    return true;
 }
 
-static void font_manager_remove_path_all(font_manager_t* manager)
+void font_manager_post_done(font_manager_t* manager, void* user_data)
 {
-    font_path_t* font_path;
-    _LV_LL_READ(&manager->path_ll, font_path)
+    LV_ASSERT_NULL(manager);
+
+    lv_mutex_lock(&manager->ui_lock);
+    font_manager_done_t* done;
+    _LV_LL_READ(&manager->done_ll, done)
     {
-        LV_LOG_USER("remove %s", font_path->name);
-        lv_free(font_path->name);
-        lv_free(font_path->path);
+        if (done->user_data == user_data && !done->is_ready) {
+            done->is_ready = true;
+            break;
+        }
     }
-
-    _lv_ll_clear(&manager->path_ll);
+    lv_mutex_unlock(&manager->ui_lock);
 }
 
-static bool font_manager_check_font_file(font_manager_t* manager, const char* name)
+void font_manager_set_cache_mem_budget(font_manager_t* manager, size_t max_mem_size)
 {
     LV_ASSERT_NULL(manager);
-    LV_ASSERT_NULL(name);
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    font_cache_manager_set_max_mem_size(manager->cache_manager, max_mem_size);
+#else
+    LV_UNUSED(max_mem_size);
+    LV_LOG_WARN("font cache is disabled");
+#endif /* UIKIT_FONT_CACHE_SIZE */
+}
 
-    const char* path = font_manager_get_path(manager, name);
+void font_manager_set_cache_policy(font_manager_t* manager, vg_font_cache_policy_t policy)
+{
+    LV_ASSERT_NULL(manager);
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    font_cache_manager_set_policy(manager->cache_manager, policy);
+#else
+    LV_UNUSED(policy);
+    LV_LOG_WARN("font cache is disabled");
+#endif /* UIKIT_FONT_CACHE_SIZE */
+}
 
-    /* Check if font file exists */
-    int ret = access(path, F_OK);
-    if (ret != 0) {
-        LV_LOG_WARN("Can't access font file: %s", path);
-        return false;
+void font_manager_get_cache_mem_usage(font_manager_t* manager, size_t* cur_size, size_t* peak_size)
+{
+    LV_ASSERT_NULL(manager);
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    font_cache_manager_get_mem_usage(manager->cache_manager, cur_size, peak_size);
+#else
+    if (cur_size) {
+        *cur_size = 0;
     }
-
-    LV_LOG_INFO("font: %s access OK", path);
-    return true;
+    if (peak_size) {
+        *peak_size = 0;
+    }
+#endif /* UIKIT_FONT_CACHE_SIZE */
 }
 
-static bool font_manager_check_resource(font_manager_t* manager)
+void font_manager_get_stats(font_manager_t* manager, vg_font_stats_t* stats)
 {
     LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(stats);
 
-    /* Check the recorded font */
-    lv_ll_t* rec_ll = &manager->rec_ll;
-    int rec_ll_len = _lv_ll_get_len(rec_ll);
-    if (rec_ll_len) {
-        LV_LOG_WARN("lvgl font resource[%d]:", rec_ll_len);
+    lv_memzero(stats, sizeof(vg_font_stats_t));
 
-        font_rec_node_t* node;
-        _LV_LL_READ(rec_ll, node)
-        {
-            LV_LOG_WARN("Font: %p(%d) -> ref: %s(%d)",
-                node,
-                (int)node->font.line_height,
-                node->refer_node_p->ft_info.name,
-                node->refer_node_p->ft_info.size);
+    /* each group is consistent on its own, not with the others */
+    lv_mutex_lock(&manager->refer_lock);
+    stats->refer_hit_cnt = manager->refer_hit_cnt;
+    stats->refer_cnt = _lv_ll_get_len(&manager->refer_ll);
+#if UIKIT_FONT_USE_EMOJI
+    font_refer_node_t* refer_node;
+    _LV_LL_READ(&manager->refer_ll, refer_node)
+    {
+        if (IS_EMOJI_NAME(refer_node->ft_info.name)) {
+            stats->emoji_font_cnt++;
         }
     }
+#endif /* UIKIT_FONT_USE_EMOJI */
+    lv_mutex_unlock(&manager->refer_lock);
 
-    /* Check the recorded font resources created by freetype */
-    lv_ll_t* refer_ll = &manager->refer_ll;
-    int refer_ll_len = _lv_ll_get_len(refer_ll);
-    if (refer_ll_len) {
-        LV_LOG_WARN("freetype font resource[%d]:", refer_ll_len);
+    lv_mutex_lock(&manager->rec_lock);
+    stats->rec_cnt = _lv_ll_get_len(&manager->rec_ll);
+    lv_mutex_unlock(&manager->rec_lock);
 
-        font_refer_node_t* node;
-        _LV_LL_READ(refer_ll, node)
-        {
-            LV_LOG_WARN("Font: %s(%d), ref cnt = %d",
-                node->ft_info.name,
-                node->ft_info.size,
-                node->ref_cnt);
-        }
-    }
+    lv_mutex_lock(&manager->stats_lock);
+    stats->open_cnt = manager->open_cnt;
+    stats->open_fail_cnt = manager->open_fail_cnt;
+    stats->open_time_sum = manager->open_time_sum;
+    stats->open_time_max = manager->open_time_max;
+    lv_memcpy(stats->open_latency_hist, manager->open_latency_hist, sizeof(stats->open_latency_hist));
+    lv_mutex_unlock(&manager->stats_lock);
 
-    /* Check resource leak */
-    bool has_resource = (rec_ll_len || refer_ll_len);
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    font_cache_stats_t cache_stats;
+    font_cache_manager_get_stats(manager->cache_manager, &cache_stats);
+    stats->cache_hit_cnt = cache_stats.hit_cnt;
+    stats->cache_miss_cnt = cache_stats.miss_cnt;
+    stats->cache_evict_cnt = cache_stats.evict_cnt;
+    stats->cache_promote_cnt = cache_stats.promote_cnt;
+    stats->cache_mem_size = cache_stats.cur_mem_size;
+#endif /* UIKIT_FONT_CACHE_SIZE */
 
-    return has_resource;
-}
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    if (manager->text_cache) {
+        font_text_cache_stats_t text_stats;
+        lv_mutex_lock(&manager->rec_lock);
+        font_text_cache_get_stats(manager->text_cache, &text_stats);
+        lv_mutex_unlock(&manager->rec_lock);
+        stats->text_hit_cnt = text_stats.hit_cnt;
+        stats->text_miss_cnt = text_stats.miss_cnt;
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
 
-static font_rec_node_t* font_manager_search_rec_node(font_manager_t* manager, lv_font_t* font)
-{
-    LV_ASSERT_NULL(manager);
-    LV_ASSERT_NULL(font);
+#if UIKIT_FONT_USE_FILE_MAP
+    if (manager->file_manager) {
+        font_file_manager_get_usage(manager->file_manager, &stats->file_cnt, &stats->file_mapped_size);
+    }
+#endif /* UIKIT_FONT_USE_FILE_MAP */
 
-    font_rec_node_t* rec_node;
-    _LV_LL_READ(&manager->rec_ll, rec_node)
+    /* each face counts once, the sizes on it are charged to their fonts */
+    lv_mutex_lock(&manager->ft_lock);
+    font_face_node_t** face_p;
+    _LV_LL_READ(&manager->face_ll, face_p)
     {
-        if (font == &rec_node->font) {
-            LV_LOG_INFO("font: %p(%" LV_PRId32 ") matched", font, font->line_height);
-            return rec_node;
+        stats->face_cnt++;
+        stats->face_mem_size += (*face_p)->mem_size;
+    }
+    lv_mutex_unlock(&manager->ft_lock);
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    if (manager->outline_cache) {
+        font_outline_cache_stats_t outline_stats;
+        lv_mutex_lock(&manager->ft_lock);
+        font_outline_cache_get_stats(manager->outline_cache, &outline_stats);
+        lv_mutex_unlock(&manager->ft_lock);
+        stats->outline_hit_cnt = outline_stats.hit_cnt;
+        stats->outline_miss_cnt = outline_stats.miss_cnt;
+        stats->outline_mem_size = outline_stats.cur_size;
+    }
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#if UIKIT_FONT_USE_SDF
+    if (manager->sdf_cache) {
+        font_sdf_cache_stats_t sdf_stats;
+        lv_mutex_lock(&manager->ft_lock);
+        font_sdf_cache_get_stats(manager->sdf_cache, &sdf_stats);
+        lv_mutex_unlock(&manager->ft_lock);
+        stats->sdf_hit_cnt = sdf_stats.hit_cnt;
+        stats->sdf_miss_cnt = sdf_stats.miss_cnt;
+        stats->sdf_mem_size = sdf_stats.cur_size;
+    }
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    if (manager->glyph_store) {
+        font_glyph_store_stats_t store_stats;
+        lv_mutex_lock(&manager->ft_lock);
+        font_glyph_store_get_stats(manager->glyph_store, &store_stats);
+        lv_mutex_unlock(&manager->ft_lock);
+        stats->glyph_store_hit_cnt = store_stats.hit_cnt;
+        stats->glyph_store_miss_cnt = store_stats.miss_cnt;
+        stats->glyph_store_mem_size = store_stats.cur_size;
+        stats->glyph_store_raw_size = store_stats.raw_size;
+    }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_EMOJI && (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+    /* the emoji cache is used while rendering, under ft_lock */
+    if (manager->emoji_manager) {
+        font_emoji_cache_stats_t emoji_stats;
+        lv_mutex_lock(&manager->ft_lock);
+        bool has_cache = font_emoji_manager_get_cache_stats(manager->emoji_manager, &emoji_stats);
+        lv_mutex_unlock(&manager->ft_lock);
+        if (has_cache) {
+            stats->emoji_image_hit_cnt = emoji_stats.hit_cnt;
+            stats->emoji_image_miss_cnt = emoji_stats.miss_cnt;
         }
     }
+#endif /* UIKIT_FONT_USE_EMOJI && UIKIT_FONT_EMOJI_CACHE_SIZE */
+}
 
-    return NULL;
+uint32_t font_manager_get_text_lines(font_manager_t* manager, const lv_font_t* font, const char* text,
+    int32_t letter_space, int32_t line_space, int32_t max_width, lv_text_flag_t flag,
+    lv_point_t* size, uint32_t* line_start, uint32_t line_max)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(font);
+    LV_ASSERT_NULL(text);
+    LV_ASSERT_NULL(size);
+
+    uint32_t line_cnt;
+
+    /* the glyph callbacks of the record fonts take ft_lock themselves */
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    font_text_key_t key = {
+        .font = font,
+        .text = text,
+        .letter_space = letter_space,
+        .line_space = line_space,
+        .max_width = max_width,
+        .flag = flag,
+    };
+
+    /* cache only the fonts that font_manager_delete_font drops, under the
+     * same lock, so no result outlives its font
+     */
+    lv_mutex_lock(&manager->rec_lock);
+    bool is_cached = manager->text_cache && font_manager_search_rec_node(manager, (lv_font_t*)font);
+    uint32_t epoch = 0;
+    if (is_cached) {
+        if (font_text_cache_lookup(manager->text_cache, &key, size, line_start, line_max, &line_cnt)) {
+            lv_mutex_unlock(&manager->rec_lock);
+            return line_cnt;
+        }
+        epoch = font_text_cache_get_epoch(manager->text_cache);
+    }
+    lv_mutex_unlock(&manager->rec_lock);
+
+    if (is_cached) {
+        /* the glyph walk runs unlocked, the result is dropped if the font changed meanwhile */
+        return font_manager_measure_text(manager, &key, epoch, size, line_start, line_max);
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+    line_cnt = font_utils_get_text_lines(font, text, letter_space, line_space, max_width, flag,
+        size, line_start, line_max);
+
+    return line_cnt;
 }
 
-static font_refer_node_t* font_manager_search_refer_node(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+bool font_manager_get_glyph_outline(font_manager_t* manager, const lv_font_t* font, uint32_t letter,
+    vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(font);
+    LV_ASSERT_NULL(outline);
+
+    lv_memzero(outline, sizeof(vg_font_outline_t));
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    if (!manager->outline_cache) {
+        return false;
+    }
+
+    /* the name is interned and lives as long as the font */
+    lv_mutex_lock(&manager->rec_lock);
+    font_rec_node_t* rec_node = font_manager_search_rec_node(manager, (lv_font_t*)font);
+    const font_refer_node_t* refer_node = rec_node ? rec_node->refer_node_p : NULL;
+    lv_freetype_info_t ft_info;
+    if (refer_node) {
+        ft_info = refer_node->ft_info;
+    }
+    lv_mutex_unlock(&manager->rec_lock);
+
+    /* the reference face may be opened, its file is mapped before ft_lock */
+    char path[PATH_MAX];
+    if (!refer_node || !font_manager_is_freetype_node(refer_node)
+        || !font_manager_resolve_path(manager, ft_info.name, path, sizeof(path))) {
+        return false;
+    }
+    void* file = font_manager_acquire_file(manager, path);
+
+    lv_mutex_lock(&manager->ft_lock);
+    bool retval = lv_freetype_is_outline_font(refer_node->font_p)
+        && font_outline_cache_get(manager->outline_cache, ft_info.name, path, ft_info.style, letter, outline);
+    lv_mutex_unlock(&manager->ft_lock);
+
+    font_manager_release_file(manager, file);
+
+    if (retval) {
+        outline->scale = ((int32_t)ft_info.size << 16) / UIKIT_FONT_OUTLINE_REF_SIZE;
+    }
+
+    return retval;
+#else
+    LV_UNUSED(letter);
+    return false;
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+}
+
+void font_manager_release_glyph_outline(font_manager_t* manager, vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(outline);
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    if (manager->outline_cache && outline->handle) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_outline_cache_release(manager->outline_cache, outline);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+}
+
+void font_manager_trim(font_manager_t* manager, vg_font_trim_level_t level)
+{
+    LV_ASSERT_NULL(manager);
+
+    FONT_PROFILER_BEGIN;
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    if (manager->text_cache) {
+        lv_mutex_lock(&manager->rec_lock);
+        font_text_cache_clear(manager->text_cache);
+        lv_mutex_unlock(&manager->rec_lock);
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    /* unreferenced fonts go first, they also share faces with the fonts in use */
+    size_t mem_size = font_cache_manager_clear(manager->cache_manager);
+    LV_LOG_INFO("font cache released %" LV_PRIu32 " bytes", (uint32_t)mem_size);
+#endif /* UIKIT_FONT_CACHE_SIZE */
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+    /* outlines are taken again on demand, the ones in use are kept */
+    if (manager->outline_cache) {
+        lv_mutex_lock(&manager->ft_lock);
+        size_t outline_size = font_outline_cache_clear(manager->outline_cache);
+        lv_mutex_unlock(&manager->ft_lock);
+        LV_LOG_INFO("outline cache released %" LV_PRIu32 " bytes", (uint32_t)outline_size);
+    }
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+    if (level >= VG_FONT_TRIM_LEVEL_GLYPH) {
+        font_manager_flush_glyph_cache(manager);
+
+#if UIKIT_FONT_USE_SDF
+        if (manager->sdf_cache) {
+            lv_mutex_lock(&manager->ft_lock);
+            size_t sdf_size = font_sdf_cache_clear(manager->sdf_cache);
+            lv_mutex_unlock(&manager->ft_lock);
+            LV_LOG_INFO("SDF cache released %" LV_PRIu32 " bytes", (uint32_t)sdf_size);
+        }
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+        if (manager->glyph_store) {
+            lv_mutex_lock(&manager->ft_lock);
+            size_t store_size = font_glyph_store_clear(manager->glyph_store);
+            lv_mutex_unlock(&manager->ft_lock);
+            LV_LOG_INFO("glyph store released %" LV_PRIu32 " bytes", (uint32_t)store_size);
+        }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_EMOJI && (UIKIT_FONT_EMOJI_CACHE_SIZE > 0)
+        if (manager->emoji_manager) {
+            lv_mutex_lock(&manager->ft_lock);
+            font_emoji_manager_clear_cache(manager->emoji_manager);
+            lv_mutex_unlock(&manager->ft_lock);
+        }
+#endif /* UIKIT_FONT_USE_EMOJI && UIKIT_FONT_EMOJI_CACHE_SIZE */
+    }
+
+    FONT_PROFILER_END;
+}
+
+void font_manager_warm_up(font_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    /* the profile is read on the worker too */
+    if (manager->usage && !font_manager_post_job(manager, font_manager_warm_load_job_cb, manager)) {
+        LV_LOG_WARN("warm-up not queued");
+    }
+#else
+    LV_UNUSED(manager);
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+}
+
+bool font_manager_save_usage_profile(font_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    if (!manager->usage) {
+        return false;
+    }
+
+    /* a boot that drew nothing new keeps the last profile */
+    lv_mutex_lock(&manager->ft_lock);
+    uint32_t glyph_cnt = font_usage_get_glyph_cnt(manager->usage);
+    bool is_changed = glyph_cnt != manager->usage_saved_cnt;
+    size_t size = 0;
+    uint8_t* data = is_changed ? font_usage_serialize(manager->usage, &size) : NULL;
+    lv_mutex_unlock(&manager->ft_lock);
+
+    if (!is_changed) {
+        LV_LOG_INFO("usage profile unchanged");
+        return true;
+    }
+
+    if (!data) {
+        return false;
+    }
+
+    /* the file is written without ft_lock */
+    bool retval = font_usage_write(UIKIT_FONT_USAGE_PROFILE_PATH, data, size);
+    lv_free(data);
+
+    if (retval) {
+        lv_mutex_lock(&manager->ft_lock);
+        manager->usage_saved_cnt = glyph_cnt;
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+
+    return retval;
+#else
+    LV_UNUSED(manager);
+    LV_LOG_WARN("usage profile is disabled");
+    return false;
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+}
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+lv_font_t* font_manager_create_font_family(font_manager_t* manager, const lv_freetype_info_t* ft_info)
 {
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(ft_info);
 
-    font_refer_node_t* refer_node;
-    _LV_LL_READ(&manager->refer_ll, refer_node)
+    if (!font_cfg_is_loaded(&manager->font_cfg)) {
+        LV_LOG_WARN("No font config detected");
+        return NULL;
+    }
+
+    lv_font_t* start_font = NULL;
+#if (UIKIT_FONT_FAMILY_MAP_SIZE == 0)
+    lv_font_t* cur_font = NULL;
+#endif /* UIKIT_FONT_FAMILY_MAP_SIZE */
+    lv_freetype_info_t ft_info_tmp = *ft_info;
+
+    /* match font */
+    const font_cfg_family_t* font_family = font_cfg_find_family(&manager->font_cfg, ft_info->name);
+    if (font_family) {
+        LV_LOG_INFO("matched font-family: %s", ft_info->name);
+
+        /* the fallbacks are rendered like the family */
+        if (font_family->flags & FONT_CFG_FAMILY_FLAG_SDF) {
+            ft_info_tmp.style |= VG_FONT_STYLE_SDF;
+        }
+
+#if (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+        /* one font dispatching each glyph to its fallback */
+        start_font = font_manager_create_font_composite(manager, font_family, &ft_info_tmp);
+#else
+        /* add fallback */
+        for (uint32_t fallback_index = 0; fallback_index < font_family->fallback_cnt; fallback_index++) {
+            ft_info_tmp.name = font_cfg_get_fallback(&manager->font_cfg, font_family, fallback_index);
+
+            /* create fallback font */
+            lv_font_t* font = font_manager_create_font(manager, &ft_info_tmp);
+            if (!font) {
+                LV_LOG_INFO("%s(%d) <- %s(%d) create failed, continue...",
+                    ft_info->name, ft_info->size,
+                    ft_info_tmp.name, ft_info->size);
+                continue;
+            }
+
+            /* save start_font for reture value */
+            if (!start_font) {
+                start_font = font;
+            }
+
+            if (cur_font) {
+                /*append fallback*/
+                cur_font->fallback = font;
+            }
+            cur_font = font;
+        }
+#endif /* UIKIT_FONT_FAMILY_MAP_SIZE */
+    }
+
+    return start_font;
+}
+
+void font_manager_delete_font_family(font_manager_t* manager, lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+
+#if (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+    if (font_composite_is_composite(font)) {
+        /* closes the members opened */
+        font_manager_delete_font_composite(manager, font);
+        return;
+    }
+#endif /* UIKIT_FONT_FAMILY_MAP_SIZE */
+
+    const lv_font_t* f = font;
+    while (f) {
+        const lv_font_t* fallback = f->fallback;
+        font_manager_delete_font(manager, (lv_font_t*)f);
+        f = fallback;
+    }
+}
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static const char* font_manager_generate_def_path(font_manager_t* manager, const char* name)
+{
+    int len = lv_snprintf(
+        manager->def_path,
+        sizeof(manager->def_path),
+        "%s/%s." UIKIT_FONT_EXT_NAME,
+        manager->base_path,
+        name);
+
+    if (len >= sizeof(manager->def_path)) {
+        LV_LOG_WARN("path truncation detected, len = %d", len);
+    }
+
+    return manager->def_path;
+}
+
+static const char* font_manager_get_path(font_manager_t* manager, const char* name)
+{
+    const char* path = font_manager_search_custom_path(manager, name);
+    return path ? path : font_manager_generate_def_path(manager, name);
+}
+
+static void font_manager_remove_path_all(font_manager_t* manager)
+{
+    font_path_t* font_path;
+    _LV_LL_READ(&manager->path_ll, font_path)
     {
-        if (font_utils_ft_info_is_equal(ft_info, &refer_node->ft_info)) {
-            LV_LOG_INFO("font: %s(%d) matched", ft_info->name, ft_info->size);
-            return refer_node;
+        LV_LOG_USER("remove %s", font_path->name);
+        lv_free(font_path->name);
+        lv_free(font_path->path);
+    }
+
+    _lv_ll_clear(&manager->path_ll);
+}
+
+static const char* font_manager_search_custom_path(font_manager_t* manager, const char* name)
+{
+    font_path_t* font_path;
+    _LV_LL_READ(&manager->path_ll, font_path)
+    {
+        if (strcmp(name, font_path->name) == 0) {
+            return font_path->path;
         }
     }
 
     return NULL;
 }
 
-static lv_font_t* font_manager_create_font_warpper(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+static void font_manager_scan_base_path(font_manager_t* manager)
 {
-    lv_font_t* font = NULL;
-#if UIKIT_FONT_USE_EMOJI
-    /* match emoji */
-    if (IS_EMOJI_NAME(ft_info->name)) {
-        if (!manager->emoji_manager) {
-            LV_LOG_WARN("emoji manager not ready");
-            return NULL;
+    /* One directory scan replaces an access() call per font name */
+    DIR* dir = opendir(manager->base_path);
+    if (!dir) {
+        LV_LOG_WARN("Can't open font directory: %s", manager->base_path);
+        font_path_cache_set_complete(manager->path_cache, false);
+        return;
+    }
+
+    const char* ext = "." UIKIT_FONT_EXT_NAME;
+    size_t ext_len = strlen(ext);
+    bool complete = true;
+    uint32_t cnt = 0;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len <= ext_len || strcmp(entry->d_name + len - ext_len, ext) != 0) {
+            continue;
         }
 
-        lv_font_t* emoji_font = font_emoji_manager_create_font(manager->emoji_manager, ft_info->name, ft_info->size);
-        if (!emoji_font) {
-            LV_LOG_INFO("emoji %s(%d) create failed",
-                ft_info->name,
-                ft_info->size);
-            return NULL;
+        char name[NAME_MAX + 1];
+        lv_memcpy(name, entry->d_name, len - ext_len);
+        name[len - ext_len] = '\0';
+
+        /* custom paths take precedence, they are resolved on demand */
+        if (font_manager_search_custom_path(manager, name)) {
+            continue;
         }
-        return emoji_font;
+
+        const char* path = font_manager_generate_def_path(manager, name);
+        if (!font_path_cache_set(manager->path_cache, name, path)) {
+            complete = false;
+            break;
+        }
+        cnt++;
     }
-#endif /* UIKIT_FONT_USE_EMOJI */
 
-    /* create freetype font */
-#if (UIKIT_FONT_CACHE_SIZE > 0)
-    font = font_cache_manager_get_reuse(manager->cache_manager, ft_info);
-    /* get reuse font from cache */
-    if (font) {
-        return font;
+    closedir(dir);
+    font_path_cache_set_complete(manager->path_cache, complete);
+    LV_LOG_INFO("%s: %" LV_PRIu32 " font files found", manager->base_path, cnt);
+}
+
+static const char* font_manager_lookup_path(font_manager_t* manager, const char* name)
+{
+    /* path_lock is held, the result lives in the path cache */
+
+    const char* path;
+    if (font_path_cache_get(manager->path_cache, name, &path) != FONT_PATH_CACHE_MISS) {
+        return path;
     }
-    /* cache miss */
-#endif /* UIKIT_FONT_CACHE_SIZE */
-    if (!font_manager_check_font_file(manager, ft_info->name)) {
-        return NULL;
+
+    if (!font_path_cache_is_scanned(manager->path_cache)) {
+        font_manager_scan_base_path(manager);
+        if (font_path_cache_get(manager->path_cache, name, &path) != FONT_PATH_CACHE_MISS) {
+            return path;
+        }
     }
 
-    /* generate full file path */
-    const char* path = font_manager_get_path(manager, ft_info->name);
+    path = font_manager_search_custom_path(manager, name);
+    bool exists;
+    if (path) {
+        exists = (access(path, F_OK) == 0);
+    } else {
+        path = font_manager_generate_def_path(manager, name);
 
-    font = lv_freetype_font_create(path, CONFIG_UIKIT_FONT_CREATE_TYPE, ft_info->size, ft_info->style);
+        /* a complete scan already knows every file of the base path */
+        exists = !font_path_cache_is_complete(manager->path_cache) && access(path, F_OK) == 0;
+    }
 
-    if (!font) {
-        LV_LOG_ERROR("Freetype font init failed, name: %s, weight: %d, style: %d",
-            ft_info->name, ft_info->size, ft_info->style);
+    if (!exists) {
+        /* logged once, the result is cached until the paths change */
+        LV_LOG_WARN("Can't access font file: %s", path);
+        font_path_cache_set(manager->path_cache, name, NULL);
         return NULL;
     }
-    return font;
+
+    LV_LOG_INFO("font: %s access OK", path);
+    return font_path_cache_set(manager->path_cache, name, path);
+}
+
+static bool font_manager_resolve_path(font_manager_t* manager, const char* name, char* path, size_t len)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(name);
+    LV_ASSERT_NULL(path);
+
+    /* copy the path out, the cache may be cleared once the lock is released */
+    lv_mutex_lock(&manager->path_lock);
+
+    const char* cached_path = font_manager_lookup_path(manager, name);
+    bool retval = cached_path && strlen(cached_path) < len;
+    if (retval) {
+        strcpy(path, cached_path);
+    } else if (cached_path) {
+        LV_LOG_WARN("path too long: %s", cached_path);
+    }
+
+    lv_mutex_unlock(&manager->path_lock);
+    return retval;
+}
+
+static bool font_manager_check_resource(font_manager_t* manager)
+{
+    LV_ASSERT_NULL(manager);
+
+    /* Check the recorded font */
+    lv_ll_t* rec_ll = &manager->rec_ll;
+    int rec_ll_len = _lv_ll_get_len(rec_ll);
+    if (rec_ll_len) {
+        LV_LOG_WARN("lvgl font resource[%d]:", rec_ll_len);
+
+        font_rec_node_t* node;
+        _LV_LL_READ(rec_ll, node)
+        {
+            LV_LOG_WARN("Font: %p(%d) -> ref: %s(%d)",
+                node,
+                (int)node->font.line_height,
+                node->refer_node_p->ft_info.name,
+                node->refer_node_p->ft_info.size);
+        }
+    }
+
+    /* Check the recorded font resources created by freetype */
+    lv_ll_t* refer_ll = &manager->refer_ll;
+    int refer_ll_len = _lv_ll_get_len(refer_ll);
+    if (refer_ll_len) {
+        LV_LOG_WARN("freetype font resource[%d]:", refer_ll_len);
+
+        font_refer_node_t* node;
+        _LV_LL_READ(refer_ll, node)
+        {
+            LV_LOG_WARN("Font: %s(%d), ref cnt = %d",
+                node->ft_info.name,
+                node->ft_info.size,
+                node->ref_cnt);
+        }
+    }
+
+    /* Check resource leak */
+    bool has_resource = (rec_ll_len || refer_ll_len);
+
+    return has_resource;
+}
+
+static uint32_t font_manager_refer_hash(const char* name, uint16_t size, uint16_t style)
+{
+    /* name is interned, so hash the address instead of the string */
+    uint32_t hash = font_hash_ptr(name);
+    hash = font_hash_mix(hash, size);
+    hash = font_hash_mix(hash, style);
+    return hash;
+}
+
+static font_name_node_t* font_manager_search_name_node(font_manager_t* manager, const char* name, uint32_t hash)
+{
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&manager->name_hash, hash, node)
+    {
+        font_name_node_t* name_node = FONT_HASH_ENTRY(node, font_name_node_t, hash_node);
+        if (strcmp(name, name_node->name) == 0) {
+            return name_node;
+        }
+    }
+
+    return NULL;
+}
+
+static const char* font_manager_intern_name(font_manager_t* manager, const char* name)
+{
+    uint32_t hash = font_hash_str(name);
+    font_name_node_t* name_node = font_manager_search_name_node(manager, name, hash);
+    if (name_node) {
+        name_node->ref_cnt++;
+        return name_node->name;
+    }
+
+    size_t name_len = strlen(name) + 1;
+    name_node = lv_malloc(sizeof(font_name_node_t) + name_len);
+    LV_ASSERT_MALLOC(name_node);
+    if (!name_node) {
+        LV_LOG_ERROR("malloc failed for font_name_node_t");
+        return NULL;
+    }
+    lv_memzero(name_node, sizeof(font_name_node_t));
+    lv_memcpy(name_node->name, name, name_len);
+    name_node->ref_cnt = 1;
+
+    font_hash_insert(&manager->name_hash, &name_node->hash_node, hash);
+    return name_node->name;
+}
+
+static void font_manager_release_name(font_manager_t* manager, const char* name)
+{
+    font_name_node_t* name_node = (font_name_node_t*)(name - offsetof(font_name_node_t, name));
+    LV_ASSERT(name_node->ref_cnt > 0);
+
+    name_node->ref_cnt--;
+    if (name_node->ref_cnt > 0) {
+        return;
+    }
+
+    font_hash_remove(&manager->name_hash, &name_node->hash_node);
+    lv_free(name_node);
+}
+
+static font_rec_node_t* font_manager_search_rec_node(font_manager_t* manager, lv_font_t* font)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(font);
+
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&manager->rec_hash, font_hash_ptr(font), node)
+    {
+        font_rec_node_t* rec_node = FONT_HASH_ENTRY(node, font_rec_node_t, hash_node);
+        if (font == &rec_node->font) {
+            LV_LOG_INFO("font: %p(%" LV_PRId32 ") matched", font, font->line_height);
+            return rec_node;
+        }
+    }
+
+    return NULL;
+}
+
+static font_refer_node_t* font_manager_search_refer_node(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+{
+    LV_ASSERT_NULL(manager);
+    LV_ASSERT_NULL(ft_info);
+
+    /* a name that was never interned can't have a refer_node */
+    font_name_node_t* name_node = font_manager_search_name_node(manager, ft_info->name, font_hash_str(ft_info->name));
+    if (!name_node) {
+        return NULL;
+    }
+
+    const char* name = name_node->name;
+    uint32_t hash = font_manager_refer_hash(name, ft_info->size, ft_info->style);
+
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&manager->refer_hash, hash, node)
+    {
+        font_refer_node_t* refer_node = FONT_HASH_ENTRY(node, font_refer_node_t, hash_node);
+        if (refer_node->ft_info.name == name
+            && refer_node->ft_info.size == ft_info->size
+            && refer_node->ft_info.style == ft_info->style) {
+            LV_LOG_INFO("font: %s(%d) matched", ft_info->name, ft_info->size);
+            return refer_node;
+        }
+    }
+
+    return NULL;
+}
+
+static lv_font_t* font_manager_create_font_warpper(font_manager_t* manager, const lv_freetype_info_t* ft_info, const char* path,
+    size_t* mem_size)
+{
+    lv_font_t* font = NULL;
+    *mem_size = 0;
+#if UIKIT_FONT_USE_EMOJI
+    /* match emoji */
+    if (IS_EMOJI_NAME(ft_info->name)) {
+        if (!manager->emoji_manager) {
+            LV_LOG_WARN("emoji manager not ready");
+            return NULL;
+        }
+
+        /* the emoji packs are shared with the glyph callbacks */
+        lv_mutex_lock(&manager->ft_lock);
+        lv_font_t* emoji_font = font_emoji_manager_create_font(manager->emoji_manager, ft_info->name, ft_info->size);
+        lv_mutex_unlock(&manager->ft_lock);
+        if (!emoji_font) {
+            LV_LOG_INFO("emoji %s(%d) create failed",
+                ft_info->name,
+                ft_info->size);
+            return NULL;
+        }
+        return emoji_font;
+    }
+#endif /* UIKIT_FONT_USE_EMOJI */
+
+#if UIKIT_FONT_USE_SDF
+    /* no freetype font per size, the face is opened once at the reference size */
+    if (IS_SDF_STYLE(ft_info->style)) {
+        if (!manager->sdf_cache) {
+            LV_LOG_WARN("SDF cache not ready");
+            return NULL;
+        }
+
+        /* the reference face may be opened, its file is mapped before ft_lock */
+        char sdf_path[PATH_MAX];
+        if (!path) {
+            if (!font_manager_resolve_path(manager, ft_info->name, sdf_path, sizeof(sdf_path))) {
+                return NULL;
+            }
+            path = sdf_path;
+        }
+        void* file = font_manager_acquire_file(manager, path);
+
+        lv_mutex_lock(&manager->ft_lock);
+        lv_font_t* sdf_font = font_sdf_cache_create_font(manager->sdf_cache, ft_info->name, path, ft_info->size,
+            ft_info->style & ~VG_FONT_STYLE_SDF);
+        lv_mutex_unlock(&manager->ft_lock);
+
+        font_manager_release_file(manager, file);
+        if (!sdf_font) {
+            LV_LOG_INFO("SDF font %s(%d) create failed", ft_info->name, ft_info->size);
+        }
+        return sdf_font;
+    }
+#endif /* UIKIT_FONT_USE_SDF */
+
+    /* create freetype font */
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    font = font_cache_manager_get_reuse(manager->cache_manager, ft_info, mem_size);
+    /* get reuse font from cache */
+    if (font) {
+        font_manager_set_cached(manager, font, false);
+        return font;
+    }
+    /* cache miss */
+#endif /* UIKIT_FONT_CACHE_SIZE */
+    /* resolve full file path, unless the caller did */
+    char path_buf[PATH_MAX];
+    if (!path) {
+        if (!font_manager_resolve_path(manager, ft_info->name, path_buf, sizeof(path_buf))) {
+            return NULL;
+        }
+        path = path_buf;
+    }
+
+    FONT_PROFILER_BEGIN_TAG("lv_freetype_font_create");
+    uint32_t start_tick = lv_tick_get();
+
+    /* the file is mapped first, only freetype itself runs under ft_lock */
+    void* file = font_manager_acquire_file(manager, path);
+
+    lv_mutex_lock(&manager->ft_lock);
+    font = font_manager_open_freetype(manager, path, ft_info, CONFIG_UIKIT_FONT_CREATE_TYPE, mem_size);
+    lv_mutex_unlock(&manager->ft_lock);
+
+    font_manager_release_file(manager, file);
+
+    uint32_t elaps = lv_tick_elaps(start_tick);
+    FONT_PROFILER_END_TAG("lv_freetype_font_create");
+
+    font_manager_record_open(manager, elaps, font != NULL);
+
+    if (!font) {
+        LV_LOG_ERROR("Freetype font init failed, name: %s, weight: %d, style: %d",
+            ft_info->name, ft_info->size, ft_info->style);
+        return NULL;
+    }
+
+    LV_LOG_INFO("font: %s(%d) mem size: %" LV_PRIu32, ft_info->name, ft_info->size, (uint32_t)*mem_size);
+    return font;
+}
+
+static lv_font_t* font_manager_open_freetype(font_manager_t* manager, const char* path, const lv_freetype_info_t* ft_info,
+    lv_freetype_font_render_mode_t render_mode, size_t* mem_size)
+{
+    /* VG_FONT_STYLE_SDF is not a freetype style, it is ignored without the SDF cache */
+    uint16_t style = ft_info->style & ~VG_FONT_STYLE_SDF;
+
+    /* lv_freetype shares a face per path and style, the first open pays for it */
+    font_face_node_t* face = NULL;
+    font_face_node_t** face_p;
+    _LV_LL_READ(&manager->face_ll, face_p)
+    {
+        if ((*face_p)->style == style && strcmp((*face_p)->path, path) == 0) {
+            face = *face_p;
+            break;
+        }
+    }
+
+    font_ft_node_t* ft_node = _lv_ll_ins_head(&manager->ft_font_ll);
+    LV_ASSERT_MALLOC(ft_node);
+    if (!ft_node) {
+        LV_LOG_ERROR("malloc failed for font_ft_node_t");
+        return NULL;
+    }
+    lv_memzero(ft_node, sizeof(font_ft_node_t));
+
+    if (!face) {
+        size_t path_len = strlen(path) + 1;
+        face = lv_malloc(sizeof(font_face_node_t) + path_len);
+        LV_ASSERT_MALLOC(face);
+        face_p = face ? _lv_ll_ins_head(&manager->face_ll) : NULL;
+        LV_ASSERT_MALLOC(face_p);
+        if (!face_p) {
+            LV_LOG_ERROR("malloc failed for font_face_node_t");
+            lv_free(face);
+            _lv_ll_remove(&manager->ft_font_ll, ft_node);
+            lv_free(ft_node);
+            return NULL;
+        }
+        lv_memzero(face, sizeof(font_face_node_t));
+        face->style = style;
+        lv_memcpy(face->path, path, path_len);
+        *face_p = face;
+    }
+
+    const char* open_path = path;
+#if UIKIT_FONT_USE_FILE_MAP
+    /* the file manager shares the mapped file between the faces */
+    char map_path[PATH_MAX];
+    if (manager->file_manager && font_file_manager_make_path(manager->file_manager, path, map_path, sizeof(map_path))) {
+        open_path = map_path;
+    }
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+
+    /* the memory object is only reachable from a face, the first open finds it and is redone counted */
+    if (!manager->ft_memory) {
+        lv_font_t* probe_font = lv_freetype_font_create(open_path, render_mode, ft_info->size, style);
+        if (probe_font) {
+            manager->ft_memory = font_utils_get_ft_memory(probe_font);
+            lv_freetype_font_delete(probe_font);
+        }
+    }
+
+    /* freetype only allocates under ft_lock, the count holds this open alone */
+    if (manager->ft_memory) {
+        font_utils_ft_mem_count_begin(manager->ft_memory);
+    }
+    lv_font_t* font = lv_freetype_font_create(open_path, render_mode, ft_info->size, style);
+    size_t open_size = manager->ft_memory ? font_utils_ft_mem_count_end() : 0;
+
+    if (!font) {
+        _lv_ll_remove(&manager->ft_font_ll, ft_node);
+        lv_free(ft_node);
+        if (face->ref_cnt == 0) {
+            font_manager_remove_face(manager, face);
+        }
+        return NULL;
+    }
+
+    ft_node->font = font;
+    ft_node->face = face;
+
+    /* the face and the first size can't be told apart, both go to the face */
+    bool was_cache_only = face->ref_cnt > 0 && face->ref_cnt == face->cache_cnt;
+    if (face->ref_cnt == 0) {
+        face->mem_size = open_size;
+        open_size = 0;
+        LV_LOG_INFO("face: %s style %d size: %" LV_PRIu32, path, style, (uint32_t)face->mem_size);
+    }
+    face->ref_cnt++;
+    font_manager_charge_face(manager, face, was_cache_only);
+
+    if (mem_size) {
+        *mem_size = open_size;
+    }
+    return font;
+}
+
+static void font_manager_close_freetype(font_manager_t* manager, lv_font_t* font)
+{
+    font_ft_node_t* ft_node = font_manager_find_ft_node(manager, font);
+    if (ft_node) {
+        font_face_node_t* face = ft_node->face;
+        bool was_cache_only = face->ref_cnt == face->cache_cnt;
+        face->ref_cnt--;
+        if (ft_node->is_cached) {
+            face->cache_cnt--;
+        }
+
+        _lv_ll_remove(&manager->ft_font_ll, ft_node);
+        lv_free(ft_node);
+
+        font_manager_charge_face(manager, face, was_cache_only);
+
+        if (face->ref_cnt == 0) {
+            font_manager_remove_face(manager, face);
+        }
+    }
+
+    lv_freetype_font_delete(font);
+}
+
+static void font_manager_remove_face(font_manager_t* manager, font_face_node_t* face)
+{
+    font_face_node_t** face_p;
+    _LV_LL_READ(&manager->face_ll, face_p)
+    {
+        if (*face_p == face) {
+            _lv_ll_remove(&manager->face_ll, face_p);
+            lv_free(face_p);
+            break;
+        }
+    }
+
+    LV_LOG_INFO("face: %s style %d closed", face->path, face->style);
+    lv_free(face);
+}
+
+static font_ft_node_t* font_manager_find_ft_node(font_manager_t* manager, const lv_font_t* font)
+{
+    font_ft_node_t* ft_node;
+    _LV_LL_READ(&manager->ft_font_ll, ft_node)
+    {
+        if (ft_node->font == font) {
+            return ft_node;
+        }
+    }
+
+    return NULL;
+}
+
+static void font_manager_charge_face(font_manager_t* manager, const font_face_node_t* face, bool was_cache_only)
+{
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    /* once only cached fonts hold a face, evicting them frees it: the cache pays for it */
+    bool is_cache_only = face->ref_cnt > 0 && face->ref_cnt == face->cache_cnt;
+    if (is_cache_only == was_cache_only) {
+        return;
+    }
+
+    if (is_cache_only) {
+        manager->cache_face_mem_size += face->mem_size;
+    } else {
+        manager->cache_face_mem_size -= face->mem_size;
+    }
+
+    font_cache_manager_set_shared_mem_size(manager->cache_manager, manager->cache_face_mem_size);
+#else
+    LV_UNUSED(manager);
+    LV_UNUSED(face);
+    LV_UNUSED(was_cache_only);
+#endif /* UIKIT_FONT_CACHE_SIZE */
+}
+
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+
+static void font_manager_set_cached(font_manager_t* manager, lv_font_t* font, bool is_cached)
+{
+    lv_mutex_lock(&manager->ft_lock);
+
+    font_ft_node_t* ft_node = font_manager_find_ft_node(manager, font);
+    if (ft_node && ft_node->is_cached != is_cached) {
+        font_face_node_t* face = ft_node->face;
+        bool was_cache_only = face->ref_cnt == face->cache_cnt;
+        ft_node->is_cached = is_cached;
+        face->cache_cnt += is_cached ? 1 : -1;
+        font_manager_charge_face(manager, face, was_cache_only);
+    }
+
+    lv_mutex_unlock(&manager->ft_lock);
+}
+
+#endif /* UIKIT_FONT_CACHE_SIZE */
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0) || UIKIT_FONT_USE_SDF
+
+static lv_font_t* font_manager_open_ref_font(font_manager_t* manager, const char* name, const char* path,
+    uint16_t size, uint16_t style, lv_freetype_font_render_mode_t render_mode)
+{
+    lv_freetype_info_t ft_info;
+    lv_memzero(&ft_info, sizeof(ft_info));
+    ft_info.name = name;
+    ft_info.size = size;
+    ft_info.style = style;
+
+    /* called by the outline and SDF caches under ft_lock, the caller mapped the file */
+    uint32_t start_tick = lv_tick_get();
+    lv_font_t* font = font_manager_open_freetype(manager, path, &ft_info, render_mode, NULL);
+    font_manager_record_open(manager, lv_tick_elaps(start_tick), font != NULL);
+
+    return font;
+}
+
+static void font_manager_close_ref_font_cb(void* user_data, lv_font_t* font)
+{
+    /* called by the outline and SDF caches under ft_lock */
+    font_manager_close_freetype(user_data, font);
+}
+
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE || UIKIT_FONT_USE_SDF */
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+
+static lv_font_t* font_manager_outline_open_cb(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style)
+{
+    return font_manager_open_ref_font(user_data, name, path, size, style, CONFIG_UIKIT_FONT_CREATE_TYPE);
+}
+
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#if UIKIT_FONT_USE_SDF
+
+static lv_font_t* font_manager_sdf_open_cb(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style)
+{
+    /* the fields are computed from coverage bitmaps, whatever the create type */
+    return font_manager_open_ref_font(user_data, name, path, size, style, LV_FREETYPE_FONT_RENDER_MODE_BITMAP);
+}
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+static bool font_manager_is_sdf_family(font_manager_t* manager, const char* name)
+{
+    if (!font_cfg_is_loaded(&manager->font_cfg)) {
+        return false;
+    }
+
+    const font_cfg_family_t* font_family = font_cfg_find_family(&manager->font_cfg, name);
+    return font_family && (font_family->flags & FONT_CFG_FAMILY_FLAG_SDF);
+}
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if UIKIT_FONT_USE_FONT_FAMILY && (UIKIT_FONT_FAMILY_MAP_SIZE > 0)
+
+static lv_font_t* font_manager_composite_open_cb(void* user_data, const char* name, uint16_t size, uint16_t style)
+{
+    lv_freetype_info_t ft_info;
+    lv_memzero(&ft_info, sizeof(ft_info));
+    ft_info.name = name;
+    ft_info.size = size;
+    ft_info.style = style;
+
+    /* called on the worker, never from a glyph callback */
+    return font_manager_create_font(user_data, &ft_info);
+}
+
+static void font_manager_composite_close_cb(void* user_data, lv_font_t* font)
+{
+    font_manager_delete_font(user_data, font);
+}
+
+static void font_manager_composite_job_cb(void* user_data, bool cancelled)
+{
+    /* cancelled, font_manager_composite_done_cb drops the mark */
+    if (cancelled) {
+        return;
+    }
+
+    lv_font_t* font = user_data;
+    font_composite_open_next(font);
+    font_manager_post_done(font_composite_get_user_data(font), font);
+}
+
+static void font_manager_composite_done_cb(void* user_data, bool cancelled)
+{
+    lv_font_t* font = user_data;
+    font_manager_t* manager = font_composite_get_user_data(font);
+    font_composite_publish(font, cancelled);
+
+    /* one member is opened at a time, the others wanted meanwhile go next */
+    if (!cancelled) {
+        font_manager_composite_want_cb(manager);
+    }
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+    /* the texts are keyed by the record fonts, a new member changes their
+     * metrics and the glyphs the composite resolves
+     */
+    if (!cancelled) {
+        lv_mutex_lock(&manager->rec_lock);
+        if (manager->text_cache) {
+            font_text_cache_clear(manager->text_cache);
+        }
+        lv_mutex_unlock(&manager->rec_lock);
+    }
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+}
+
+static void font_manager_composite_want_cb(void* user_data)
+{
+    font_manager_t* manager = user_data;
+
+    /* on a draw thread, picked up after the refresh */
+    lv_mutex_lock(&manager->ui_lock);
+    manager->is_composite_wanted = true;
+    lv_mutex_unlock(&manager->ui_lock);
+}
+
+static void font_manager_open_wanted(font_manager_t* manager)
+{
+    lv_mutex_lock(&manager->ui_lock);
+    bool is_wanted = manager->is_composite_wanted;
+    manager->is_composite_wanted = false;
+    lv_mutex_unlock(&manager->ui_lock);
+
+    if (!is_wanted) {
+        return;
+    }
+
+    /* every composite that waits, the lock isn't held while posting */
+    while (true) {
+        lv_font_t* font = NULL;
+
+        lv_mutex_lock(&manager->rec_lock);
+        lv_font_t** font_p;
+        _LV_LL_READ(&manager->composite_ll, font_p)
+        {
+            if (font_composite_start_open(*font_p)) {
+                font = *font_p;
+                break;
+            }
+        }
+        lv_mutex_unlock(&manager->rec_lock);
+
+        if (!font) {
+            break;
+        }
+
+        /* the member file is opened on the worker, off the draw path */
+        if (!font_manager_post_ui_job(manager, font_manager_composite_job_cb, font_manager_composite_done_cb, font)) {
+            font_composite_publish(font, true);
+        }
+    }
+}
+
+static void font_manager_composite_timer_cb(lv_timer_t* timer)
+{
+    font_manager_open_wanted(lv_timer_get_user_data(timer));
+}
+
+static void font_manager_composite_refr_cb(lv_event_t* e)
+{
+    font_manager_t* manager = lv_event_get_user_data(e);
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+        LV_LOG_WARN("display deleted, the glyph misses are polled");
+        manager->composite_disp = NULL;
+        if (manager->composite_timer) {
+            lv_timer_resume(manager->composite_timer);
+        }
+        return;
+    }
+
+    font_manager_open_wanted(manager);
+}
+
+static lv_font_t* font_manager_create_font_composite(font_manager_t* manager, const font_cfg_family_t* font_family,
+    const lv_freetype_info_t* ft_info)
+{
+    uint32_t fallback_cnt = LV_MIN(font_family->fallback_cnt, FONT_COMPOSITE_MEMBER_MAX);
+    if (fallback_cnt == 0) {
+        return NULL;
+    }
+
+    font_composite_member_cfg_t* member_arr = lv_malloc(fallback_cnt * sizeof(font_composite_member_cfg_t));
+    LV_ASSERT_MALLOC(member_arr);
+    if (!member_arr) {
+        LV_LOG_ERROR("malloc failed for %" LV_PRIu32 " fallbacks", fallback_cnt);
+        return NULL;
+    }
+
+    for (uint32_t fallback_index = 0; fallback_index < fallback_cnt; fallback_index++) {
+        font_composite_member_cfg_t* member = &member_arr[fallback_index];
+        member->name = font_cfg_get_fallback(&manager->font_cfg, font_family, fallback_index);
+        member->range_arr = font_cfg_get_fallback_ranges(&manager->font_cfg, font_family, fallback_index,
+            &member->range_cnt);
+    }
+
+    /* a fallback is opened on the worker after the first glyph in its ranges */
+    lv_font_t* composite = font_composite_create(member_arr, fallback_cnt, ft_info->size, ft_info->style,
+        UIKIT_FONT_FAMILY_MAP_SIZE, font_manager_composite_open_cb, font_manager_composite_close_cb,
+        font_manager_composite_want_cb, manager);
+
+    lv_free(member_arr);
+
+    if (!composite) {
+        return NULL;
+    }
+
+    lv_mutex_lock(&manager->rec_lock);
+    lv_font_t** font_p = _lv_ll_ins_tail(&manager->composite_ll);
+    LV_ASSERT_MALLOC(font_p);
+    if (font_p) {
+        *font_p = composite;
+    }
+    lv_mutex_unlock(&manager->rec_lock);
+
+    if (!font_p) {
+        LV_LOG_ERROR("malloc failed for composite font");
+        font_composite_delete(composite);
+        return NULL;
+    }
+
+    return composite;
+}
+
+static void font_manager_delete_font_composite(font_manager_t* manager, lv_font_t* font)
+{
+    lv_mutex_lock(&manager->rec_lock);
+    lv_font_t** font_p;
+    _LV_LL_READ(&manager->composite_ll, font_p)
+    {
+        if (*font_p == font) {
+            _lv_ll_remove(&manager->composite_ll, font_p);
+            lv_free(font_p);
+            break;
+        }
+    }
+    lv_mutex_unlock(&manager->rec_lock);
+
+    font_composite_delete(font);
+}
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY && UIKIT_FONT_FAMILY_MAP_SIZE */
+
+static void* font_manager_acquire_file(font_manager_t* manager, const char* path)
+{
+#if UIKIT_FONT_USE_FILE_MAP
+    /* freetype finds the file mapped and reads it from memory */
+    if (manager->file_manager) {
+        return font_file_manager_acquire(manager->file_manager, path);
+    }
+#else
+    LV_UNUSED(manager);
+    LV_UNUSED(path);
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+    return NULL;
+}
+
+static void font_manager_release_file(font_manager_t* manager, void* file)
+{
+#if UIKIT_FONT_USE_FILE_MAP
+    if (file) {
+        font_file_manager_release(manager->file_manager, file);
+    }
+#else
+    LV_UNUSED(manager);
+    LV_UNUSED(file);
+#endif /* UIKIT_FONT_USE_FILE_MAP */
+}
+
+static void font_manager_close_freetype_cb(void* user_data, lv_font_t* font)
+{
+    font_manager_t* manager = user_data;
+    lv_mutex_lock(&manager->ft_lock);
+    font_manager_close_freetype(manager, font);
+    lv_mutex_unlock(&manager->ft_lock);
+}
+
+static void font_manager_flush_glyph_cache(font_manager_t* manager)
+{
+    /* A draw unit holds the lv_freetype draw data from the bitmap callback
+     * to the release callback, only while a refresh draws, and the refreshes
+     * run under the LVGL lock. Every other user takes and releases its
+     * entries under ft_lock. With both held no entry is referenced, so the
+     * caches can be dropped under the open fonts.
+     */
+    lv_lock();
+    lv_mutex_lock(&manager->refer_lock);
+
+    uint32_t flush_cnt = 0;
+    font_refer_node_t* refer_node;
+    _LV_LL_READ(&manager->refer_ll, refer_node)
+    {
+        if (!font_manager_is_freetype_node(refer_node)) {
+            continue;
+        }
+
+        /* shared by the sizes of a face, dropping it again costs nothing */
+        const lv_freetype_font_dsc_t* dsc = refer_node->font_p->dsc;
+        lv_mutex_lock(&manager->ft_lock);
+        lv_cache_drop_all(dsc->cache_node->glyph_cache, (void*)dsc);
+        lv_cache_drop_all(dsc->cache_node->draw_data_cache, (void*)dsc);
+        lv_mutex_unlock(&manager->ft_lock);
+        flush_cnt++;
+    }
+
+    lv_mutex_unlock(&manager->refer_lock);
+    lv_unlock();
+
+    LV_LOG_INFO("glyph cache of %" LV_PRIu32 " fonts flushed", flush_cnt);
+}
+
+static void font_manager_ui_timer_cb(lv_timer_t* timer)
+{
+    font_manager_t* manager = lv_timer_get_user_data(timer);
+
+    /* taken out first, a callback may post new jobs or delete the manager */
+    lv_ll_t ready_ll;
+    _lv_ll_init(&ready_ll, sizeof(font_manager_done_t));
+
+    lv_mutex_lock(&manager->ui_lock);
+    font_manager_done_t* done = _lv_ll_get_head(&manager->done_ll);
+    while (done) {
+        font_manager_done_t* next = _lv_ll_get_next(&manager->done_ll, done);
+        if (done->is_ready) {
+            _lv_ll_chg_list(&manager->done_ll, &ready_ll, done, false);
+        }
+        done = next;
+    }
+    bool is_idle = _lv_ll_is_empty(&manager->done_ll);
+    lv_mutex_unlock(&manager->ui_lock);
+
+    /* resumed by the next job */
+    if (is_idle) {
+        lv_timer_pause(timer);
+    }
+
+    while ((done = _lv_ll_get_head(&ready_ll)) != NULL) {
+        font_manager_done_t done_tmp = *done;
+        _lv_ll_remove(&ready_ll, done);
+        lv_free(done);
+        done_tmp.done_cb(done_tmp.user_data, false);
+    }
+}
+
+static void font_manager_cancel_done(font_manager_t* manager)
+{
+    while (true) {
+        lv_mutex_lock(&manager->ui_lock);
+        font_manager_done_t* done = _lv_ll_get_head(&manager->done_ll);
+        font_manager_done_t done_tmp;
+        if (done) {
+            done_tmp = *done;
+            _lv_ll_remove(&manager->done_ll, done);
+            lv_free(done);
+        }
+        lv_mutex_unlock(&manager->ui_lock);
+
+        if (!done) {
+            break;
+        }
+
+        done_tmp.done_cb(done_tmp.user_data, true);
+    }
+}
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+static uint32_t font_manager_measure_text(font_manager_t* manager, const font_text_key_t* key, uint32_t epoch,
+    lv_point_t* size, uint32_t* line_start, uint32_t line_max)
+{
+    uint32_t stack_arr[FONT_MANAGER_TEXT_STACK_LINE_CNT];
+    uint32_t line_cnt = font_utils_get_text_lines(key->font, key->text, key->letter_space, key->line_space,
+        key->max_width, key->flag, size, stack_arr, FONT_MANAGER_TEXT_STACK_LINE_CNT);
+    const uint32_t* line_arr = stack_arr;
+
+    /* many lines, walk the text again into a big enough buffer */
+    uint32_t* heap_arr = NULL;
+    if (line_cnt > FONT_MANAGER_TEXT_STACK_LINE_CNT) {
+        heap_arr = lv_malloc(line_cnt * sizeof(uint32_t));
+        if (heap_arr) {
+            font_utils_get_text_lines(key->font, key->text, key->letter_space, key->line_space,
+                key->max_width, key->flag, size, heap_arr, line_cnt);
+        }
+        line_arr = heap_arr;
+    }
+
+    if (line_arr) {
+        lv_mutex_lock(&manager->rec_lock);
+        font_text_cache_insert(manager->text_cache, key, epoch, size, line_arr, line_cnt);
+        lv_mutex_unlock(&manager->rec_lock);
+
+        if (line_start) {
+            lv_memcpy(line_start, line_arr, LV_MIN(line_cnt, line_max) * sizeof(uint32_t));
+        }
+    } else if (line_start) {
+        LV_LOG_WARN("malloc failed for %" LV_PRIu32 " lines, not cached", line_cnt);
+        font_utils_get_text_lines(key->font, key->text, key->letter_space, key->line_space,
+            key->max_width, key->flag, size, line_start, line_max);
+    }
+
+    if (heap_arr) {
+        lv_free(heap_arr);
+    }
+
+    return line_cnt;
+}
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+static void font_manager_record_open(font_manager_t* manager, uint32_t elaps, bool success)
+{
+    /* bucket i counts opens under 2^i ms */
+    uint32_t bucket = 0;
+    while (bucket < VG_FONT_LATENCY_BUCKET_CNT - 1 && elaps >= (1U << bucket)) {
+        bucket++;
+    }
+
+    lv_mutex_lock(&manager->stats_lock);
+    manager->open_cnt++;
+    manager->open_fail_cnt += success ? 0 : 1;
+    manager->open_time_sum += elaps;
+    manager->open_time_max = LV_MAX(manager->open_time_max, elaps);
+    manager->open_latency_hist[bucket]++;
+    lv_mutex_unlock(&manager->stats_lock);
+}
+
+static bool font_manager_is_freetype_node(const font_refer_node_t* refer_node)
+{
+#if UIKIT_FONT_USE_SDF
+    if (IS_SDF_STYLE(refer_node->ft_info.style)) {
+        return false;
+    }
+#endif /* UIKIT_FONT_USE_SDF */
+
+#if UIKIT_FONT_USE_EMOJI
+    return !IS_EMOJI_NAME(refer_node->ft_info.name);
+#else
+    LV_UNUSED(refer_node);
+    return true;
+#endif /* UIKIT_FONT_USE_EMOJI */
 }
 
-static void font_manager_delete_font_warpper(font_manager_t* manager, font_refer_node_t* refer_node)
+static void font_manager_delete_font_warpper(font_manager_t* manager, lv_font_t* font,
+    const lv_freetype_info_t* ft_info, size_t mem_size, bool is_preload)
 {
+#if UIKIT_FONT_USE_SDF
+    /* nothing to reuse, a new size costs no file access */
+    if (IS_SDF_STYLE(ft_info->style)) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_sdf_cache_delete_font(manager->sdf_cache, font);
+        lv_mutex_unlock(&manager->ft_lock);
+        return;
+    }
+#endif /* UIKIT_FONT_USE_SDF */
+
 #if UIKIT_FONT_USE_EMOJI
-    if (IS_EMOJI_NAME(refer_node->ft_info.name)) {
+    if (IS_EMOJI_NAME(ft_info->name)) {
         if (manager->emoji_manager) {
-            font_emoji_manager_delete_font(manager->emoji_manager, refer_node->font_p);
+            lv_mutex_lock(&manager->ft_lock);
+            font_emoji_manager_delete_font(manager->emoji_manager, font);
+            lv_mutex_unlock(&manager->ft_lock);
         }
     } else
 #endif /* UIKIT_FONT_USE_EMOJI */
     {
 #if (UIKIT_FONT_CACHE_SIZE > 0)
-        font_cache_manager_set_reuse(manager->cache_manager, refer_node->font_p, &refer_node->ft_info);
+        font_manager_set_cached(manager, font, true);
+        if (is_preload) {
+            font_cache_manager_set_preload(manager->cache_manager, font, ft_info, mem_size);
+        } else {
+            font_cache_manager_set_reuse(manager->cache_manager, font, ft_info, mem_size);
+        }
 #else
-        lv_freetype_font_delete(refer_node->font_p);
+        LV_UNUSED(mem_size);
+        LV_UNUSED(is_preload);
+        font_manager_close_freetype_cb(manager, font);
 #endif /* UIKIT_FONT_CACHE_SIZE */
     }
 }
 
-static font_refer_node_t* font_manager_request_font(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+static font_refer_node_t* font_manager_request_font(font_manager_t* manager, const lv_freetype_info_t* ft_info, const char* path)
 {
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(ft_info);
 
+    lv_mutex_lock(&manager->refer_lock);
+
     /* check refer_node is existed */
     font_refer_node_t* refer_node = font_manager_search_refer_node(manager, ft_info);
     if (refer_node) {
         refer_node->ref_cnt++;
+        manager->refer_hit_cnt++;
         LV_LOG_INFO("refer_node existed, ref_cnt = %d", refer_node->ref_cnt);
+        lv_mutex_unlock(&manager->refer_lock);
         return refer_node;
     }
 
-    lv_font_t* font = font_manager_create_font_warpper(manager, ft_info);
+    lv_mutex_unlock(&manager->refer_lock);
+
+    /* open the font unlocked, it may read the font file */
+    size_t mem_size;
+    lv_font_t* font = font_manager_create_font_warpper(manager, ft_info, path, &mem_size);
     if (!font) {
         return NULL;
     }
 
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    font_atlas_t* atlas = NULL;
+    char path_buf[PATH_MAX];
+    if (!IS_EMOJI_NAME(ft_info->name) && !IS_SDF_STYLE(ft_info->style)) {
+        if (!path && font_manager_resolve_path(manager, ft_info->name, path_buf, sizeof(path_buf))) {
+            path = path_buf;
+        }
+        if (path) {
+            atlas = font_atlas_open(ft_info->name, path, ft_info->size, ft_info->style);
+        }
+    }
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    font_usage_font_t* usage_font = NULL;
+    if (manager->usage && !IS_EMOJI_NAME(ft_info->name) && !IS_SDF_STYLE(ft_info->style)) {
+        lv_mutex_lock(&manager->ft_lock);
+        usage_font = font_usage_get_font(manager->usage, ft_info);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+    lv_mutex_lock(&manager->refer_lock);
+
+    /* another thread may have opened the same font meanwhile, share its node */
+    refer_node = font_manager_search_refer_node(manager, ft_info);
+    if (refer_node) {
+        refer_node->ref_cnt++;
+        LV_LOG_INFO("refer_node raced, ref_cnt = %d", refer_node->ref_cnt);
+        lv_mutex_unlock(&manager->refer_lock);
+        goto discard;
+    }
+
+    const char* name = font_manager_intern_name(manager, ft_info->name);
+    if (!name) {
+        lv_mutex_unlock(&manager->refer_lock);
+        goto discard;
+    }
+
     /* add refer_node to refer_ll */
     refer_node = _lv_ll_ins_head(&manager->refer_ll);
     LV_ASSERT_MALLOC(refer_node);
+    if (!refer_node) {
+        LV_LOG_ERROR("malloc failed for font_refer_node_t");
+        font_manager_release_name(manager, name);
+        lv_mutex_unlock(&manager->refer_lock);
+        goto discard;
+    }
     lv_memzero(refer_node, sizeof(font_refer_node_t));
 
-    strncpy(refer_node->name, ft_info->name, sizeof(refer_node->name));
-    refer_node->name[sizeof(refer_node->name) - 1] = '\0';
-
     /* copy font data */
     refer_node->font_p = font;
     refer_node->ft_info = *ft_info;
-    refer_node->ft_info.name = refer_node->name;
+    refer_node->ft_info.name = name;
+    refer_node->mem_size = mem_size;
     refer_node->ref_cnt = 1;
 
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    refer_node->atlas = atlas;
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    refer_node->glyph_store = font_manager_is_freetype_node(refer_node) ? manager->glyph_store : NULL;
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    refer_node->usage = usage_font ? manager->usage : NULL;
+    refer_node->usage_font = usage_font;
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+    refer_node->ft_lock = &manager->ft_lock;
+    font_manager_init_glyph_hooks(refer_node);
+
+    /* index by (name, size, style) */
+    font_hash_insert(&manager->refer_hash, &refer_node->hash_node,
+        font_manager_refer_hash(name, ft_info->size, ft_info->style));
+
+    lv_mutex_unlock(&manager->refer_lock);
+
     LV_LOG_INFO("success");
     return refer_node;
+
+discard:
+    /* the font goes back to the reuse cache, refer_node is the raced one or NULL */
+    font_manager_delete_font_warpper(manager, font, ft_info, mem_size, false);
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    if (atlas) {
+        font_atlas_close(atlas);
+    }
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+    return refer_node;
+}
+
+static lv_font_t* font_manager_add_rec(font_manager_t* manager, font_refer_node_t* refer_node)
+{
+    lv_mutex_lock(&manager->rec_lock);
+
+    /* Add font record node */
+    font_rec_node_t* rec_node = _lv_ll_ins_head(&manager->rec_ll);
+    LV_ASSERT_MALLOC(rec_node);
+    if (!rec_node) {
+        lv_mutex_unlock(&manager->rec_lock);
+        LV_LOG_ERROR("malloc failed for font_rec_node_t");
+        font_manager_drop_font(manager, refer_node);
+        return NULL;
+    }
+    lv_memzero(rec_node, sizeof(font_rec_node_t));
+
+    /* copy freetype_font data */
+    rec_node->font = *refer_node->font_p;
+
+    /* record reference node */
+    rec_node->refer_node_p = refer_node;
+
+    /* draw units call the glyph callbacks without lv_lock, they run under ft_lock */
+    rec_node->font.get_glyph_dsc = font_manager_locked_get_glyph_dsc_cb;
+    rec_node->font.get_glyph_bitmap = font_manager_locked_get_glyph_bitmap_cb;
+    rec_node->font.release_glyph = refer_node->release_glyph_cb ? font_manager_locked_release_glyph_cb : NULL;
+
+    /* index by font address */
+    font_hash_insert(&manager->rec_hash, &rec_node->hash_node, font_hash_ptr(&rec_node->font));
+
+    lv_mutex_unlock(&manager->rec_lock);
+
+#if UIKIT_FONT_USE_ASCII_METRICS
+    font_manager_init_ascii_metrics(manager, rec_node);
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+
+    LV_LOG_INFO("success");
+    return &rec_node->font;
+}
+
+static const lv_freetype_info_t* font_manager_adjust_info(font_manager_t* manager, const lv_freetype_info_t* ft_info,
+    lv_freetype_info_t* buf)
+{
+#if UIKIT_FONT_USE_SDF && UIKIT_FONT_USE_FONT_FAMILY
+    /* a font-family can ask for distance fields at every size */
+    if (!IS_SDF_STYLE(ft_info->style) && font_manager_is_sdf_family(manager, ft_info->name)) {
+        *buf = *ft_info;
+        buf->style |= VG_FONT_STYLE_SDF;
+        return buf;
+    }
+#else
+    LV_UNUSED(manager);
+    LV_UNUSED(buf);
+#endif /* UIKIT_FONT_USE_SDF && UIKIT_FONT_USE_FONT_FAMILY */
+
+    return ft_info;
+}
+
+static int font_manager_batch_compare(const lv_freetype_info_t* a, const lv_freetype_info_t* b)
+{
+    int ret = strcmp(a->name, b->name);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (a->size != b->size) {
+        return a->size < b->size ? -1 : 1;
+    }
+
+    if (a->style != b->style) {
+        return a->style < b->style ? -1 : 1;
+    }
+
+    return 0;
 }
 
 static bool font_manager_drop_font(font_manager_t* manager, font_refer_node_t* refer_node)
@@ -588,22 +2746,503 @@ static bool font_manager_drop_font(font_manager_t* manager, font_refer_node_t* r
     LV_ASSERT_NULL(manager);
     LV_ASSERT_NULL(refer_node);
 
+    lv_mutex_lock(&manager->refer_lock);
+
     refer_node->ref_cnt--;
 
     /* If ref_cnt is > 0, no need to delete font */
     if (refer_node->ref_cnt > 0) {
         LV_LOG_INFO("refer_node existed, ref_cnt = %d", refer_node->ref_cnt);
+        lv_mutex_unlock(&manager->refer_lock);
         return true;
     }
 
+    /* unlink refer_node, the next request opens the font again or hits the cache */
+    font_hash_remove(&manager->refer_hash, &refer_node->hash_node);
+    _lv_ll_remove(&manager->refer_ll, refer_node);
+
+    lv_mutex_unlock(&manager->refer_lock);
+
     /* if if ref_cnt is about to be 0, free font resource */
-    font_manager_delete_font_warpper(manager, refer_node);
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    bool is_preload = refer_node->is_warm;
+#else
+    bool is_preload = false;
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+    font_manager_delete_font_warpper(manager, refer_node->font_p, &refer_node->ft_info, refer_node->mem_size, is_preload);
     refer_node->font_p = NULL;
 
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    if (refer_node->atlas) {
+        font_atlas_close(refer_node->atlas);
+        refer_node->atlas = NULL;
+    }
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if UIKIT_FONT_USE_ASCII_METRICS
+    if (refer_node->ascii_arr) {
+        lv_free(refer_node->ascii_arr);
+        refer_node->ascii_arr = NULL;
+    }
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    /* keyed by the node address, the next node may reuse it */
+    if (refer_node->glyph_store) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_glyph_store_drop_font(refer_node->glyph_store, refer_node);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
     /* free refer_node */
-    _lv_ll_remove(&manager->refer_ll, refer_node);
+    lv_mutex_lock(&manager->refer_lock);
+    font_manager_release_name(manager, refer_node->ft_info.name);
+    lv_mutex_unlock(&manager->refer_lock);
+
     lv_free(refer_node);
 
     LV_LOG_INFO("success");
     return true;
 }
+
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+
+static void font_manager_preload_font(font_manager_t* manager, const lv_freetype_info_t* ft_info)
+{
+    /* emoji fonts are not cached */
+    if (IS_EMOJI_NAME(ft_info->name)) {
+        LV_LOG_INFO("skip emoji font: %s", ft_info->name);
+        return;
+    }
+
+    /* neither are SDF fonts, they open no file per size */
+    if (IS_SDF_STYLE(ft_info->style)) {
+        LV_LOG_INFO("skip SDF font: %s(%d)", ft_info->name, ft_info->size);
+        return;
+    }
+
+    /* already in use */
+    lv_mutex_lock(&manager->refer_lock);
+    bool is_referenced = font_manager_search_refer_node(manager, ft_info) != NULL;
+    lv_mutex_unlock(&manager->refer_lock);
+
+    if (is_referenced) {
+        LV_LOG_INFO("font: %s(%d) is referenced", ft_info->name, ft_info->size);
+        return;
+    }
+
+    /* a cache hit returns the font too, putting it back refreshes it */
+    size_t mem_size;
+    lv_font_t* font = font_manager_create_font_warpper(manager, ft_info, NULL, &mem_size);
+    if (!font) {
+        return;
+    }
+
+    font_manager_set_cached(manager, font, true);
+    font_cache_manager_set_preload(manager->cache_manager, font, ft_info, mem_size);
+    LV_LOG_INFO("font: %s(%d) preloaded", ft_info->name, ft_info->size);
+}
+
+#endif /* UIKIT_FONT_CACHE_SIZE */
+
+static void font_manager_preload_job_cb(void* user_data, bool cancelled)
+{
+    font_preload_job_t* job = user_data;
+
+#if (UIKIT_FONT_CACHE_SIZE > 0)
+    if (!cancelled) {
+        /* only the freetype calls take ft_lock, the UI keeps rendering meanwhile */
+        font_manager_preload_font(job->manager, &job->ft_info);
+    }
+#else
+    LV_UNUSED(cancelled);
+#endif /* UIKIT_FONT_CACHE_SIZE */
+
+    lv_free(job);
+}
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+
+static bool font_manager_atlas_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+
+    const font_atlas_glyph_t* glyph = font_atlas_find_glyph(refer_node->atlas, letter);
+    if (!glyph) {
+        /* atlas miss, the freetype callbacks work on the copied font */
+        return refer_node->font_p->get_glyph_dsc(font, dsc, letter, letter_next);
+    }
+
+    dsc->resolved_font = font;
+    dsc->adv_w = glyph->adv_w;
+    dsc->box_w = glyph->box_w;
+    dsc->box_h = glyph->box_h;
+    dsc->ofs_x = glyph->ofs_x;
+    dsc->ofs_y = glyph->ofs_y;
+    dsc->bpp = 8;
+    dsc->is_placeholder = false;
+    dsc->glyph_index = letter;
+    dsc->entry = NULL;
+    return true;
+}
+
+static const void* font_manager_atlas_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(dsc->resolved_font)->refer_node_p;
+
+    const font_atlas_glyph_t* glyph = font_atlas_find_glyph(refer_node->atlas, letter);
+    if (!glyph) {
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+        if (refer_node->glyph_store) {
+            return font_manager_store_get_glyph_bitmap_cb(dsc, letter, draw_buf);
+        }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+        return refer_node->font_p->get_glyph_bitmap(dsc, letter, draw_buf);
+    }
+
+    const uint8_t* src = font_atlas_get_bitmap(refer_node->atlas, glyph);
+    if (!src || !draw_buf) {
+        return NULL;
+    }
+
+    /* copy the A8 bitmap line by line, the draw buffer may be wider */
+    uint32_t stride = draw_buf->header.stride;
+    uint8_t* dest = draw_buf->data;
+    for (uint32_t y = 0; y < glyph->box_h; y++) {
+        lv_memcpy(dest, src, glyph->box_w);
+        dest += stride;
+        src += glyph->box_w;
+    }
+
+    return draw_buf;
+}
+
+static void font_manager_atlas_release_glyph_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc)
+{
+    /* atlas glyphs are not in the freetype cache */
+    if (!dsc->entry) {
+        return;
+    }
+
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+    if (refer_node->font_p->release_glyph) {
+        refer_node->font_p->release_glyph(font, dsc);
+    }
+}
+
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if UIKIT_FONT_USE_ASCII_METRICS
+
+static bool font_manager_base_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    if (refer_node->atlas) {
+        return font_manager_atlas_get_glyph_dsc_cb(font, dsc, letter, letter_next);
+    }
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+    /* the freetype callbacks work on the copied font */
+    return refer_node->font_p->get_glyph_dsc(font, dsc, letter, letter_next);
+}
+
+static bool font_manager_ascii_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+    const font_ascii_glyph_t* ascii_arr = refer_node->ascii_arr;
+    if (!ascii_arr || letter >= FONT_ASCII_GLYPH_CNT || !ascii_arr[letter].is_valid) {
+        return font_manager_base_get_glyph_dsc(font, dsc, letter, letter_next);
+    }
+
+    /* the table holds unkerned advances */
+    if (letter_next != 0 && refer_node->ascii_has_kerning && font->kerning != LV_FONT_KERNING_NONE) {
+        return font_manager_base_get_glyph_dsc(font, dsc, letter, letter_next);
+    }
+
+    const font_ascii_glyph_t* glyph = &ascii_arr[letter];
+    dsc->resolved_font = font;
+    dsc->adv_w = glyph->adv_w;
+    dsc->box_w = glyph->box_w;
+    dsc->box_h = glyph->box_h;
+    dsc->ofs_x = glyph->ofs_x;
+    dsc->ofs_y = glyph->ofs_y;
+    dsc->bpp = glyph->bpp;
+    dsc->is_placeholder = false;
+    dsc->glyph_index = glyph->glyph_index;
+    dsc->entry = NULL;
+    return true;
+}
+
+static font_ascii_glyph_t* font_manager_build_ascii_metrics(const lv_font_t* font)
+{
+    size_t arr_size = FONT_ASCII_GLYPH_CNT * sizeof(font_ascii_glyph_t);
+    font_ascii_glyph_t* ascii_arr = lv_malloc(arr_size);
+    LV_ASSERT_MALLOC(ascii_arr);
+    if (!ascii_arr) {
+        LV_LOG_ERROR("malloc failed for ASCII glyph table");
+        return NULL;
+    }
+    lv_memzero(ascii_arr, arr_size);
+
+    for (uint32_t letter = FONT_ASCII_FIRST_PRINTABLE; letter <= FONT_ASCII_LAST_PRINTABLE; letter++) {
+        lv_font_glyph_dsc_t dsc;
+        lv_memzero(&dsc, sizeof(dsc));
+        if (!font_manager_base_get_glyph_dsc(font, &dsc, letter, 0) || dsc.is_placeholder) {
+            continue;
+        }
+
+        font_ascii_glyph_t* glyph = &ascii_arr[letter];
+        glyph->adv_w = dsc.adv_w;
+        glyph->box_w = dsc.box_w;
+        glyph->box_h = dsc.box_h;
+        glyph->ofs_x = dsc.ofs_x;
+        glyph->ofs_y = dsc.ofs_y;
+        glyph->bpp = dsc.bpp;
+        glyph->glyph_index = dsc.glyph_index;
+        glyph->is_valid = true;
+
+        /* no glyph is kept referenced by the table */
+        const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+        if (dsc.entry && refer_node->release_glyph_cb) {
+            refer_node->release_glyph_cb(font, &dsc);
+        }
+    }
+
+    return ascii_arr;
+}
+
+static void font_manager_init_ascii_metrics(font_manager_t* manager, font_rec_node_t* rec_node)
+{
+    font_refer_node_t* refer_node = rec_node->refer_node_p;
+    if (!font_manager_is_freetype_node(refer_node)) {
+        return;
+    }
+
+    /* built once per freetype font, by the first record, through the hooks below the table */
+    lv_mutex_lock(&manager->ft_lock);
+    if (!refer_node->ascii_checked) {
+        const lv_freetype_font_dsc_t* dsc = refer_node->font_p->dsc;
+        FT_Face face = dsc->cache_node->face;
+        refer_node->ascii_has_kerning = face && FT_HAS_KERNING(face);
+        refer_node->ascii_arr = font_manager_build_ascii_metrics(&rec_node->font);
+        refer_node->ascii_checked = true;
+    }
+    lv_mutex_unlock(&manager->ft_lock);
+}
+
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+
+static const void* font_manager_store_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(dsc->resolved_font)->refer_node_p;
+    font_glyph_store_t* glyph_store = refer_node->glyph_store;
+
+    if (dsc->bpp != 8) {
+        return refer_node->font_p->get_glyph_bitmap(dsc, letter, draw_buf);
+    }
+
+    if (draw_buf && font_glyph_store_get(glyph_store, refer_node, dsc->glyph_index, dsc->box_w, dsc->box_h, draw_buf)) {
+        return draw_buf;
+    }
+
+    /* rasterized by freetype, the compressed copy serves the next draws */
+    const lv_draw_buf_t* bitmap = refer_node->font_p->get_glyph_bitmap(dsc, letter, draw_buf);
+    if (bitmap && bitmap->data) {
+        font_glyph_store_put(glyph_store, refer_node, dsc->glyph_index, bitmap->data, bitmap->header.stride,
+            dsc->box_w, dsc->box_h);
+    }
+
+    return bitmap;
+}
+
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+
+static const void* font_manager_usage_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(dsc->resolved_font)->refer_node_p;
+    font_usage_record(refer_node->usage, refer_node->usage_font, letter);
+    return refer_node->usage_bitmap_cb(dsc, letter, draw_buf);
+}
+
+static void font_manager_warm_glyph(const lv_font_t* font, uint32_t letter)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+
+    /* called under ft_lock, the hooks below the recorder are called directly */
+    lv_font_glyph_dsc_t dsc;
+    lv_memzero(&dsc, sizeof(dsc));
+    if (!refer_node->glyph_dsc_cb(font, &dsc, letter, 0)) {
+        return;
+    }
+    dsc.resolved_font = font;
+
+    if (!dsc.is_placeholder && dsc.box_w > 0 && dsc.box_h > 0) {
+        lv_draw_buf_t* draw_buf = lv_draw_buf_create(dsc.box_w, dsc.box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+        if (draw_buf) {
+            /* behind the recorder, the warm-up is not a use */
+            if (refer_node->usage_bitmap_cb) {
+                refer_node->usage_bitmap_cb(&dsc, letter, draw_buf);
+            } else {
+                refer_node->glyph_bitmap_cb(&dsc, letter, draw_buf);
+            }
+            lv_draw_buf_destroy(draw_buf);
+        }
+    }
+
+    /* the glyph stays in the caches, not referenced */
+    if (dsc.entry && refer_node->release_glyph_cb) {
+        refer_node->release_glyph_cb(font, &dsc);
+    }
+}
+
+static void font_manager_warm_load_job_cb(void* user_data, bool cancelled)
+{
+    font_manager_t* manager = user_data;
+    if (cancelled) {
+        return;
+    }
+
+    uint32_t item_cnt;
+    font_usage_item_t* item_arr = font_usage_load(UIKIT_FONT_USAGE_PROFILE_PATH, &item_cnt);
+    if (!item_arr) {
+        return;
+    }
+
+    /* the warmed fonts are held by the font cache, more would evict each other */
+    if (item_cnt > UIKIT_FONT_CACHE_SIZE) {
+        LV_LOG_INFO("profile: %" LV_PRIu32 " fonts, warm up the first %d", item_cnt, UIKIT_FONT_CACHE_SIZE);
+        item_cnt = UIKIT_FONT_CACHE_SIZE;
+    }
+
+    /* one job per font, so the UI thread fallback runs one font per period */
+    for (uint32_t i = 0; i < item_cnt; i++) {
+        const font_usage_item_t* item = &item_arr[i];
+        size_t letter_arr_size = item->letter_cnt * sizeof(uint32_t);
+        size_t name_len = strlen(item->ft_info.name) + 1;
+        font_warm_job_t* job = lv_malloc(sizeof(font_warm_job_t) + letter_arr_size + name_len);
+        LV_ASSERT_MALLOC(job);
+        if (!job) {
+            LV_LOG_ERROR("malloc failed for font_warm_job_t");
+            break;
+        }
+
+        char* name = (char*)(job->letter_arr + item->letter_cnt);
+        lv_memcpy(name, item->ft_info.name, name_len);
+        lv_memcpy(job->letter_arr, item->letter_arr, letter_arr_size);
+        job->manager = manager;
+        job->ft_info = item->ft_info;
+        job->ft_info.name = name;
+        job->letter_cnt = item->letter_cnt;
+
+        if (!font_manager_post_job(manager, font_manager_warm_font_job_cb, job)) {
+            lv_free(job);
+            break;
+        }
+    }
+
+    lv_free(item_arr);
+}
+
+static void font_manager_warm_font_job_cb(void* user_data, bool cancelled)
+{
+    font_warm_job_t* job = user_data;
+    font_manager_t* manager = job->manager;
+
+    /* opened like any font, the file is mapped before ft_lock is taken */
+    lv_font_t* font = cancelled ? NULL : font_manager_create_font(manager, &job->ft_info);
+    if (!font) {
+        lv_free(job);
+        return;
+    }
+
+    /* one glyph per ft_lock, no LVGL lock, the UI keeps rendering meanwhile */
+    for (uint32_t i = 0; i < job->letter_cnt; i++) {
+        lv_mutex_lock(&manager->ft_lock);
+        font_manager_warm_glyph(font, job->letter_arr[i]);
+        lv_mutex_unlock(&manager->ft_lock);
+    }
+
+    /* dropped like a preload, the glyph caches stay with the font in the protected cache list */
+    lv_mutex_lock(&manager->refer_lock);
+    FONT_REC_NODE(font)->refer_node_p->is_warm = true;
+    lv_mutex_unlock(&manager->refer_lock);
+    font_manager_delete_font(manager, font);
+
+    LV_LOG_INFO("font: %s(%d) warmed up, %" LV_PRIu32 " glyphs",
+        job->ft_info.name, job->ft_info.size, job->letter_cnt);
+    lv_free(job);
+}
+
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+static void font_manager_init_glyph_hooks(font_refer_node_t* refer_node)
+{
+    /* the freetype callbacks work on the copied font */
+    const lv_font_t* font = refer_node->font_p;
+    refer_node->glyph_dsc_cb = font->get_glyph_dsc;
+    refer_node->glyph_bitmap_cb = font->get_glyph_bitmap;
+    refer_node->release_glyph_cb = font->release_glyph;
+
+#if (UIKIT_FONT_GLYPH_STORE_SIZE > 0)
+    /* an atlas serves its glyphs first and falls back to the store */
+    if (refer_node->glyph_store) {
+        refer_node->glyph_bitmap_cb = font_manager_store_get_glyph_bitmap_cb;
+    }
+#endif /* UIKIT_FONT_GLYPH_STORE_SIZE */
+
+#if UIKIT_FONT_USE_GLYPH_ATLAS
+    if (refer_node->atlas) {
+        refer_node->glyph_dsc_cb = font_manager_atlas_get_glyph_dsc_cb;
+        refer_node->glyph_bitmap_cb = font_manager_atlas_get_glyph_bitmap_cb;
+        refer_node->release_glyph_cb = font_manager_atlas_release_glyph_cb;
+    }
+#endif /* UIKIT_FONT_USE_GLYPH_ATLAS */
+
+#if UIKIT_FONT_USE_ASCII_METRICS
+    /* bitmaps still come from the atlas or freetype */
+    if (font_manager_is_freetype_node(refer_node)) {
+        refer_node->glyph_dsc_cb = font_manager_ascii_get_glyph_dsc_cb;
+    }
+#endif /* UIKIT_FONT_USE_ASCII_METRICS */
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+    /* outermost, it sees every glyph drawn whatever serves it */
+    if (refer_node->usage_font) {
+        refer_node->usage_bitmap_cb = refer_node->glyph_bitmap_cb;
+        refer_node->glyph_bitmap_cb = font_manager_usage_get_glyph_bitmap_cb;
+    }
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+}
+
+static bool font_manager_locked_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+    lv_mutex_lock(refer_node->ft_lock);
+    bool retval = refer_node->glyph_dsc_cb(font, dsc, letter, letter_next);
+    lv_mutex_unlock(refer_node->ft_lock);
+    return retval;
+}
+
+static const void* font_manager_locked_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(dsc->resolved_font)->refer_node_p;
+    lv_mutex_lock(refer_node->ft_lock);
+    const void* retval = refer_node->glyph_bitmap_cb(dsc, letter, draw_buf);
+    lv_mutex_unlock(refer_node->ft_lock);
+    return retval;
+}
+
+static void font_manager_locked_release_glyph_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc)
+{
+    const font_refer_node_t* refer_node = FONT_REC_NODE(font)->refer_node_p;
+    lv_mutex_lock(refer_node->ft_lock);
+    refer_node->release_glyph_cb(font, dsc);
+    lv_mutex_unlock(refer_node->ft_lock);
+}
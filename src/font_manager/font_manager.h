@@ -14,7 +14,9 @@ extern "C" {
  *********************/
 
 #include "font_config.h"
+#include "font_worker.h"
 #include "uikit/uikit_conf.h"
+#include "uikit/uikit_font_manager.h"
 #include <lvgl/lvgl.h>
 
 /*********************
@@ -40,7 +42,9 @@ typedef struct _font_path_t font_path_t;
 font_manager_t* font_manager_create(void);
 
 /**
- * Delete main font manager.
+ * Delete main font manager. No job can be posted once it is called, the
+ * running job is waited for, the results not handed back yet are cancelled.
+ * It can be called with or without the LVGL lock, the jobs never take it.
  * @param manager pointer to main font manager.
  * @return return true if the deletion was successful.
  */
@@ -78,6 +82,19 @@ bool font_manager_remove_path(font_manager_t* manager, font_path_t* handle);
  */
 lv_font_t* font_manager_create_font(font_manager_t* manager, const lv_freetype_info_t* ft_info);
 
+/**
+ * Create several fonts in one pass. The requests are grouped by name, each
+ * name resolves its path once and identical requests share the first one's
+ * font, the fonts are deleted one by one with font_manager_delete_font.
+ * @param manager pointer to main font manager.
+ * @param ft_info_arr font info array.
+ * @param font_arr return the created fonts in the order of ft_info_arr, NULL on failure.
+ * @param cnt number of fonts.
+ * @return return the number of fonts created.
+ */
+size_t font_manager_create_font_batch(font_manager_t* manager, const lv_freetype_info_t* ft_info_arr,
+    lv_font_t** font_arr, size_t cnt);
+
 /**
  * Delete font.
  * @param manager pointer to main font manager.
@@ -86,20 +103,150 @@ lv_font_t* font_manager_create_font(font_manager_t* manager, const lv_freetype_i
  */
 bool font_manager_delete_font(font_manager_t* manager, lv_font_t* font);
 
+/**
+ * Create fonts on the background worker and park them in the reuse cache,
+ * so that later font_manager_create_font calls don't touch the file system.
+ * Under the 2Q policy they skip probation, up to the cache size survive.
+ * @param manager pointer to main font manager.
+ * @param ft_info_arr font info array, copied before return.
+ * @param cnt number of fonts.
+ * @return return the number of fonts queued.
+ */
+size_t font_manager_preload(font_manager_t* manager, const lv_freetype_info_t* ft_info_arr, size_t cnt);
+
+/**
+ * Get the outline of a glyph from the shared outline cache.
+ * @param manager pointer to main font manager.
+ * @param font font created by font_manager_create_font.
+ * @param letter unicode letter.
+ * @param outline return the outline, scaled to the font size.
+ * @return return true if the glyph has an outline.
+ */
+bool font_manager_get_glyph_outline(font_manager_t* manager, const lv_font_t* font, uint32_t letter,
+    vg_font_outline_t* outline);
+
+/**
+ * Release an outline got by font_manager_get_glyph_outline.
+ * @param manager pointer to main font manager.
+ * @param outline the outline.
+ */
+void font_manager_release_glyph_outline(font_manager_t* manager, vg_font_outline_t* outline);
+
+/**
+ * Run a job on the background worker, the worker is created on first use.
+ * @param manager pointer to main font manager.
+ * @param cb job callback, called once, cancelled if the manager is deleted first.
+ * @param user_data custom parameter.
+ * @return return true if the job was queued.
+ */
+bool font_manager_post_job(font_manager_t* manager, font_worker_job_cb_t cb, void* user_data);
+
+/**
+ * Run a job on the background worker and hand its result back to the UI thread.
+ * The job calls font_manager_post_done when finished, done_cb then runs from an
+ * LVGL timer. If the manager is deleted first, done_cb is called with cancelled
+ * set from the deleting thread, the job itself is cancelled if it didn't run.
+ * It takes the LVGL lock briefly, no font manager lock may be held.
+ * @param manager pointer to main font manager.
+ * @param cb job callback, user_data is owned by done_cb.
+ * @param done_cb result callback, called once.
+ * @param user_data custom parameter of both callbacks.
+ * @return return true if the job was queued.
+ */
+bool font_manager_post_ui_job(font_manager_t* manager, font_worker_job_cb_t cb, font_worker_job_cb_t done_cb,
+    void* user_data);
+
+/**
+ * Hand the result of a job posted by font_manager_post_ui_job back to the UI thread.
+ * @param manager pointer to main font manager.
+ * @param user_data the parameter the job was posted with.
+ */
+void font_manager_post_done(font_manager_t* manager, void* user_data);
+
+/**
+ * Set the memory budget of the font reuse cache.
+ * @param manager pointer to main font manager.
+ * @param max_mem_size memory budget in bytes, 0 means unlimited.
+ */
+void font_manager_set_cache_mem_budget(font_manager_t* manager, size_t max_mem_size);
+
+/**
+ * Set the replacement policy of the font reuse cache.
+ * @param manager pointer to main font manager.
+ * @param policy replacement policy.
+ */
+void font_manager_set_cache_policy(font_manager_t* manager, vg_font_cache_policy_t policy);
+
+/**
+ * Get the memory held by the font reuse cache.
+ * @param manager pointer to main font manager.
+ * @param cur_size return the current usage in bytes, can be NULL.
+ * @param peak_size return the peak usage in bytes, can be NULL.
+ */
+void font_manager_get_cache_mem_usage(font_manager_t* manager, size_t* cur_size, size_t* peak_size);
+
+/**
+ * Get the font manager statistics.
+ * @param manager pointer to main font manager.
+ * @param stats return the statistics.
+ */
+void font_manager_get_stats(font_manager_t* manager, vg_font_stats_t* stats);
+
+/**
+ * Measure a text like lv_text_get_size and report where its lines start.
+ * The results of fonts created by font_manager_create_font are cached.
+ * @param manager pointer to main font manager.
+ * @param font pointer to font.
+ * @param text text to measure.
+ * @param letter_space letter space.
+ * @param line_space line space.
+ * @param max_width max width of a line.
+ * @param flag text flags.
+ * @param size return the text size.
+ * @param line_start return the byte offset of each line, can be NULL.
+ * @param line_max size of line_start.
+ * @return number of lines, can be greater than line_max.
+ */
+uint32_t font_manager_get_text_lines(font_manager_t* manager, const lv_font_t* font, const char* text,
+    int32_t letter_space, int32_t line_space, int32_t max_width, lv_text_flag_t flag,
+    lv_point_t* size, uint32_t* line_start, uint32_t line_max);
+
+/**
+ * Release font memory, fonts in use stay valid.
+ * @param manager pointer to main font manager.
+ * @param level how much to release.
+ */
+void font_manager_trim(font_manager_t* manager, vg_font_trim_level_t level);
+
+/**
+ * Open the fonts of the usage profile on the worker and render their letters
+ * into the caches, the fonts then wait in the font cache like preloaded ones.
+ * @param manager pointer to main font manager.
+ */
+void font_manager_warm_up(font_manager_t* manager);
+
+/**
+ * Save the usage profile, nothing is written if no glyph was recorded since the last save.
+ * @param manager pointer to main font manager.
+ * @return return true if the profile is saved or up to date.
+ */
+bool font_manager_save_usage_profile(font_manager_t* manager);
+
 #if UIKIT_FONT_USE_FONT_FAMILY
 
 /**
  * Create font-family.
  * @param manager pointer to main font manager.
  * @param ft_info fallback font information.
- * @return point to the first font of font-family
+ * @return point to the font serving the fallbacks: a composite font of all of
+ * them, or the first of their fallback chain without UIKIT_FONT_FAMILY_MAP_SIZE.
  */
 lv_font_t* font_manager_create_font_family(font_manager_t* manager, const lv_freetype_info_t* ft_info);
 
 /**
  * Delete font-family.
  * @param manager pointer to main font manager.
- * @param font point to the first font of font-family.
+ * @param font point to the font returned by font_manager_create_font_family.
  */
 void font_manager_delete_font_family(font_manager_t* manager, lv_font_t* font);
 
@@ -0,0 +1,585 @@
+/**
+ * @file font_outline.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_outline.h"
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+
+#include "font_hash.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_OUTLINE_GLYPH_HASH_SIZE 64
+
+/* initial capture buffer, grown for complex glyphs */
+#define FONT_OUTLINE_CAPTURE_OP_CNT 64
+#define FONT_OUTLINE_CAPTURE_POINT_CNT 128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_outline_face_t font_outline_face_t;
+
+typedef struct _font_outline_glyph_t {
+    font_hash_node_t hash_node; /* glyph_hash node of the face, keyed by letter */
+    struct _font_outline_glyph_t* prev; /* LRU order over all faces, most recently used at the head */
+    struct _font_outline_glyph_t* next;
+    font_outline_face_t* face;
+    uint32_t letter;
+    int ref_cnt; /* outlines handed out */
+    uint32_t op_cnt;
+    uint32_t point_cnt;
+    size_t mem_size;
+    int16_t point_arr[]; /* point_cnt x, y pairs, followed by op_cnt ops */
+} font_outline_glyph_t;
+
+struct _font_outline_face_t {
+    lv_font_t* ref_font; /* private font at the reference size */
+    font_hash_t glyph_hash;
+    uint16_t style;
+    char name[];
+};
+
+typedef struct _font_outline_cache_t {
+    lv_ll_t face_ll; /* font_outline_face_t* */
+    font_outline_glyph_t* head;
+    font_outline_glyph_t* tail;
+    uint16_t ref_size;
+    font_outline_open_cb_t open_cb;
+    font_outline_close_cb_t close_cb;
+    void* user_data;
+    font_outline_cache_stats_t stats;
+
+    /* outline events of the glyph being captured */
+    bool is_capturing;
+    bool is_overflow;
+    uint8_t* op_buf;
+    uint32_t op_cnt;
+    uint32_t op_cap;
+    int16_t* point_buf;
+    uint32_t point_cnt;
+    uint32_t point_cap;
+} font_outline_cache_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static font_outline_face_t* font_outline_get_face(font_outline_cache_t* cache, const char* name, const char* path,
+    uint16_t style);
+static void font_outline_close_face(font_outline_cache_t* cache, font_outline_face_t* face);
+static font_outline_glyph_t* font_outline_capture(font_outline_cache_t* cache, font_outline_face_t* face,
+    uint32_t letter, bool* is_silent);
+static bool font_outline_reopen_face(font_outline_cache_t* cache, font_outline_face_t* face, const char* path);
+static void font_outline_evict(font_outline_cache_t* cache, size_t mem_size, const font_outline_face_t* keep_face);
+static void font_outline_remove_glyph(font_outline_cache_t* cache, font_outline_glyph_t* glyph);
+static void font_outline_link_head(font_outline_cache_t* cache, font_outline_glyph_t* glyph);
+static void font_outline_unlink(font_outline_cache_t* cache, font_outline_glyph_t* glyph);
+static void font_outline_event_cb(lv_event_t* e);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/* lv_freetype outline events can't be removed, the handler outlives the cache */
+static font_outline_cache_t* font_outline_active_cache;
+static bool font_outline_event_registered;
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define FONT_OUTLINE_GLYPH_OPS(glyph) ((uint8_t*)((glyph)->point_arr + (glyph)->point_cnt * 2))
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_outline_cache_t* font_outline_cache_create(size_t max_size, uint16_t ref_size,
+    font_outline_open_cb_t open_cb, font_outline_close_cb_t close_cb, void* user_data)
+{
+    LV_ASSERT_NULL(open_cb);
+    LV_ASSERT_NULL(close_cb);
+
+    if (font_outline_active_cache) {
+        LV_LOG_WARN("only one outline cache is supported");
+        return NULL;
+    }
+
+    font_outline_cache_t* cache = lv_malloc(sizeof(font_outline_cache_t));
+    LV_ASSERT_MALLOC(cache);
+    if (!cache) {
+        LV_LOG_ERROR("malloc failed for font_outline_cache_t");
+        return NULL;
+    }
+    lv_memzero(cache, sizeof(font_outline_cache_t));
+
+    _lv_ll_init(&cache->face_ll, sizeof(font_outline_face_t*));
+    cache->ref_size = ref_size;
+    cache->open_cb = open_cb;
+    cache->close_cb = close_cb;
+    cache->user_data = user_data;
+    cache->stats.max_size = max_size;
+
+    if (!font_outline_event_registered) {
+        if (lv_freetype_outline_add_event(font_outline_event_cb, LV_EVENT_ALL, NULL) != LV_RESULT_OK) {
+            LV_LOG_ERROR("outline event register failed");
+            lv_free(cache);
+            return NULL;
+        }
+        font_outline_event_registered = true;
+    }
+
+    font_outline_active_cache = cache;
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32 ", ref_size: %d", (uint32_t)max_size, ref_size);
+    return cache;
+}
+
+void font_outline_cache_delete(font_outline_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_outline_cache_clear(cache);
+    if (cache->head) {
+        LV_LOG_ERROR("%" LV_PRIu32 " outlines still in use", cache->stats.glyph_cnt);
+        while (cache->tail) {
+            font_outline_remove_glyph(cache, cache->tail);
+        }
+        font_outline_cache_clear(cache);
+    }
+
+    font_outline_active_cache = NULL;
+
+    lv_free(cache->op_buf);
+    lv_free(cache->point_buf);
+    lv_free(cache);
+
+    LV_LOG_INFO("success");
+}
+
+bool font_outline_cache_get(font_outline_cache_t* cache, const char* name, const char* path, uint16_t style,
+    uint32_t letter, vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(name);
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(outline);
+
+    font_outline_face_t* face = font_outline_get_face(cache, name, path, style);
+    if (!face) {
+        return false;
+    }
+
+    font_outline_glyph_t* glyph = NULL;
+    uint32_t letter_hash = font_hash_mix(FONT_HASH_INIT, letter);
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&face->glyph_hash, letter_hash, node)
+    {
+        font_outline_glyph_t* cur = FONT_HASH_ENTRY(node, font_outline_glyph_t, hash_node);
+        if (cur->letter == letter) {
+            glyph = cur;
+            break;
+        }
+    }
+
+    if (glyph) {
+        cache->stats.hit_cnt++;
+        if (glyph != cache->head) {
+            font_outline_unlink(cache, glyph);
+            font_outline_link_head(cache, glyph);
+        }
+    } else {
+        cache->stats.miss_cnt++;
+
+        /* an evicted glyph is still in the freetype cache of the reference
+         * font, which then sends no events; a fresh font loads it again
+         */
+        bool is_silent = false;
+        glyph = font_outline_capture(cache, face, letter, &is_silent);
+        if (!glyph && is_silent && font_outline_reopen_face(cache, face, path)) {
+            glyph = font_outline_capture(cache, face, letter, &is_silent);
+        }
+
+        if (!glyph) {
+            /* nothing cached for this face yet, don't keep its font open */
+            if (font_hash_get_count(&face->glyph_hash) == 0) {
+                font_outline_close_face(cache, face);
+            }
+            return false;
+        }
+    }
+
+    glyph->ref_cnt++;
+
+    outline->op_arr = FONT_OUTLINE_GLYPH_OPS(glyph);
+    outline->op_cnt = glyph->op_cnt;
+    outline->point_arr = glyph->point_arr;
+    outline->point_cnt = glyph->point_cnt;
+    outline->scale = 1 << 16;
+    outline->handle = glyph;
+    return true;
+}
+
+void font_outline_cache_release(font_outline_cache_t* cache, vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(outline);
+
+    font_outline_glyph_t* glyph = outline->handle;
+    if (!glyph) {
+        return;
+    }
+
+    LV_ASSERT(glyph->ref_cnt > 0);
+    glyph->ref_cnt--;
+    lv_memzero(outline, sizeof(vg_font_outline_t));
+
+    /* evicted while in use */
+    if (cache->stats.cur_size > cache->stats.max_size) {
+        font_outline_evict(cache, 0, NULL);
+    }
+}
+
+size_t font_outline_cache_clear(font_outline_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    size_t cur_size = cache->stats.cur_size;
+
+    font_outline_glyph_t* glyph = cache->tail;
+    while (glyph) {
+        font_outline_glyph_t* prev = glyph->prev;
+        if (glyph->ref_cnt == 0) {
+            font_outline_remove_glyph(cache, glyph);
+        }
+        glyph = prev;
+    }
+
+    font_outline_face_t** face_p = _lv_ll_get_head(&cache->face_ll);
+    while (face_p) {
+        font_outline_face_t** next_p = _lv_ll_get_next(&cache->face_ll, face_p);
+        if (font_hash_get_count(&(*face_p)->glyph_hash) == 0) {
+            font_outline_close_face(cache, *face_p);
+        }
+        face_p = next_p;
+    }
+
+    return cur_size - cache->stats.cur_size;
+}
+
+void font_outline_cache_get_stats(const font_outline_cache_t* cache, font_outline_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(stats);
+
+    *stats = cache->stats;
+    stats->face_cnt = _lv_ll_get_len(&cache->face_ll);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static font_outline_face_t* font_outline_get_face(font_outline_cache_t* cache, const char* name, const char* path,
+    uint16_t style)
+{
+    font_outline_face_t** face_p;
+    _LV_LL_READ(&cache->face_ll, face_p)
+    {
+        if ((*face_p)->style == style && strcmp((*face_p)->name, name) == 0) {
+            return *face_p;
+        }
+    }
+
+    lv_font_t* ref_font = cache->open_cb(cache->user_data, name, path, cache->ref_size, style);
+    if (!ref_font) {
+        LV_LOG_WARN("font: %s(%d) can't be opened", name, cache->ref_size);
+        return NULL;
+    }
+
+    size_t name_len = strlen(name) + 1;
+    font_outline_face_t* face = lv_malloc(sizeof(font_outline_face_t) + name_len);
+    LV_ASSERT_MALLOC(face);
+    if (!face) {
+        LV_LOG_ERROR("malloc failed for font_outline_face_t");
+        cache->close_cb(cache->user_data, ref_font);
+        return NULL;
+    }
+    lv_memzero(face, sizeof(font_outline_face_t));
+
+    face_p = _lv_ll_ins_head(&cache->face_ll);
+    LV_ASSERT_MALLOC(face_p);
+    if (!face_p || !font_hash_init(&face->glyph_hash, FONT_OUTLINE_GLYPH_HASH_SIZE)) {
+        LV_LOG_ERROR("malloc failed for face node");
+        if (face_p) {
+            _lv_ll_remove(&cache->face_ll, face_p);
+            lv_free(face_p);
+        }
+        cache->close_cb(cache->user_data, ref_font);
+        lv_free(face);
+        return NULL;
+    }
+
+    face->ref_font = ref_font;
+    face->style = style;
+    lv_memcpy(face->name, name, name_len);
+    *face_p = face;
+
+    LV_LOG_INFO("face: %s style %d opened", name, style);
+    return face;
+}
+
+static bool font_outline_reopen_face(font_outline_cache_t* cache, font_outline_face_t* face, const char* path)
+{
+    lv_font_t* ref_font = cache->open_cb(cache->user_data, face->name, path, cache->ref_size, face->style);
+    if (!ref_font) {
+        LV_LOG_WARN("font: %s(%d) can't be reopened", face->name, cache->ref_size);
+        return false;
+    }
+
+    cache->close_cb(cache->user_data, face->ref_font);
+    face->ref_font = ref_font;
+
+    LV_LOG_INFO("face: %s style %d reopened", face->name, face->style);
+    return true;
+}
+
+static void font_outline_close_face(font_outline_cache_t* cache, font_outline_face_t* face)
+{
+    LV_ASSERT(font_hash_get_count(&face->glyph_hash) == 0);
+
+    font_outline_face_t** face_p;
+    _LV_LL_READ(&cache->face_ll, face_p)
+    {
+        if (*face_p == face) {
+            _lv_ll_remove(&cache->face_ll, face_p);
+            lv_free(face_p);
+            break;
+        }
+    }
+
+    LV_LOG_INFO("face: %s style %d closed", face->name, face->style);
+
+    cache->close_cb(cache->user_data, face->ref_font);
+    font_hash_deinit(&face->glyph_hash);
+    lv_free(face);
+}
+
+static bool font_outline_reserve(void** buf, uint32_t* cap, uint32_t need, size_t item_size, uint32_t init_cap)
+{
+    if (need <= *cap) {
+        return true;
+    }
+
+    uint32_t new_cap = LV_MAX(*cap * 2, init_cap);
+    new_cap = LV_MAX(new_cap, need);
+    void* new_buf = lv_realloc(*buf, new_cap * item_size);
+    if (!new_buf) {
+        return false;
+    }
+
+    *buf = new_buf;
+    *cap = new_cap;
+    return true;
+}
+
+static void font_outline_push_op(font_outline_cache_t* cache, vg_font_outline_op_t op)
+{
+    if (!font_outline_reserve((void**)&cache->op_buf, &cache->op_cap, cache->op_cnt + 1, sizeof(uint8_t),
+            FONT_OUTLINE_CAPTURE_OP_CNT)) {
+        cache->is_overflow = true;
+        return;
+    }
+
+    cache->op_buf[cache->op_cnt++] = op;
+}
+
+static void font_outline_push_point(font_outline_cache_t* cache, const lv_freetype_outline_vector_t* point)
+{
+    if (point->x < INT16_MIN || point->x > INT16_MAX || point->y < INT16_MIN || point->y > INT16_MAX
+        || !font_outline_reserve((void**)&cache->point_buf, &cache->point_cap, cache->point_cnt + 1,
+            sizeof(int16_t) * 2, FONT_OUTLINE_CAPTURE_POINT_CNT)) {
+        cache->is_overflow = true;
+        return;
+    }
+
+    cache->point_buf[cache->point_cnt * 2] = point->x;
+    cache->point_buf[cache->point_cnt * 2 + 1] = point->y;
+    cache->point_cnt++;
+}
+
+static font_outline_glyph_t* font_outline_capture(font_outline_cache_t* cache, font_outline_face_t* face,
+    uint32_t letter, bool* is_silent)
+{
+    *is_silent = false;
+
+    lv_font_glyph_dsc_t dsc;
+    lv_memzero(&dsc, sizeof(dsc));
+    if (!lv_font_get_glyph_dsc(face->ref_font, &dsc, letter, 0) || dsc.is_placeholder) {
+        return NULL;
+    }
+
+    /* lv_freetype sends the outline events while it loads the glyph */
+    cache->is_capturing = true;
+    cache->is_overflow = false;
+    cache->op_cnt = 0;
+    cache->point_cnt = 0;
+
+    if (lv_font_get_glyph_bitmap(&dsc, letter, NULL)) {
+        lv_font_glyph_release_draw_data(&dsc);
+    }
+
+    cache->is_capturing = false;
+
+    /* a visible glyph always has a contour */
+    if (cache->op_cnt == 0 && dsc.box_w > 0 && dsc.box_h > 0) {
+        *is_silent = true;
+        return NULL;
+    }
+
+    if (cache->is_overflow || cache->op_cnt == 0) {
+        LV_LOG_INFO("letter 0x%" LV_PRIx32 " of %s not captured, overflow: %d", letter, face->name,
+            cache->is_overflow);
+        return NULL;
+    }
+
+    size_t point_size = cache->point_cnt * sizeof(int16_t) * 2;
+    size_t mem_size = sizeof(font_outline_glyph_t) + point_size + cache->op_cnt;
+    if (mem_size > cache->stats.max_size) {
+        LV_LOG_WARN("letter 0x%" LV_PRIx32 " outline too large: %" LV_PRIu32, letter, (uint32_t)mem_size);
+        return NULL;
+    }
+
+    font_outline_evict(cache, mem_size, face);
+
+    font_outline_glyph_t* glyph = lv_malloc(mem_size);
+    LV_ASSERT_MALLOC(glyph);
+    if (!glyph) {
+        LV_LOG_ERROR("malloc failed for font_outline_glyph_t");
+        return NULL;
+    }
+    lv_memzero(glyph, sizeof(font_outline_glyph_t));
+
+    glyph->face = face;
+    glyph->letter = letter;
+    glyph->op_cnt = cache->op_cnt;
+    glyph->point_cnt = cache->point_cnt;
+    glyph->mem_size = mem_size;
+    lv_memcpy(glyph->point_arr, cache->point_buf, point_size);
+    lv_memcpy(FONT_OUTLINE_GLYPH_OPS(glyph), cache->op_buf, cache->op_cnt);
+
+    font_hash_insert(&face->glyph_hash, &glyph->hash_node, font_hash_mix(FONT_HASH_INIT, letter));
+    font_outline_link_head(cache, glyph);
+
+    cache->stats.glyph_cnt++;
+    cache->stats.cur_size += mem_size;
+    return glyph;
+}
+
+static void font_outline_evict(font_outline_cache_t* cache, size_t mem_size, const font_outline_face_t* keep_face)
+{
+    font_outline_glyph_t* glyph = cache->tail;
+    while (glyph && cache->stats.cur_size + mem_size > cache->stats.max_size) {
+        font_outline_glyph_t* prev = glyph->prev;
+        if (glyph->ref_cnt == 0) {
+            font_outline_face_t* face = glyph->face;
+            font_outline_remove_glyph(cache, glyph);
+            if (face != keep_face && font_hash_get_count(&face->glyph_hash) == 0) {
+                font_outline_close_face(cache, face);
+            }
+        }
+        glyph = prev;
+    }
+}
+
+static void font_outline_remove_glyph(font_outline_cache_t* cache, font_outline_glyph_t* glyph)
+{
+    cache->stats.cur_size -= glyph->mem_size;
+    cache->stats.glyph_cnt--;
+
+    font_hash_remove(&glyph->face->glyph_hash, &glyph->hash_node);
+    font_outline_unlink(cache, glyph);
+    lv_free(glyph);
+}
+
+static void font_outline_link_head(font_outline_cache_t* cache, font_outline_glyph_t* glyph)
+{
+    glyph->prev = NULL;
+    glyph->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = glyph;
+    } else {
+        cache->tail = glyph;
+    }
+    cache->head = glyph;
+}
+
+static void font_outline_unlink(font_outline_cache_t* cache, font_outline_glyph_t* glyph)
+{
+    if (glyph->prev) {
+        glyph->prev->next = glyph->next;
+    } else {
+        cache->head = glyph->next;
+    }
+
+    if (glyph->next) {
+        glyph->next->prev = glyph->prev;
+    } else {
+        cache->tail = glyph->prev;
+    }
+
+    glyph->prev = NULL;
+    glyph->next = NULL;
+}
+
+static void font_outline_event_cb(lv_event_t* e)
+{
+    /* the outline object belongs to the draw unit, only the points are recorded */
+    font_outline_cache_t* cache = font_outline_active_cache;
+    if (!cache || !cache->is_capturing || lv_event_get_code(e) != LV_EVENT_INSERT) {
+        return;
+    }
+
+    const lv_freetype_outline_event_param_t* param = lv_event_get_param(e);
+    switch (param->type) {
+    case LV_FREETYPE_OUTLINE_MOVE_TO:
+        font_outline_push_op(cache, VG_FONT_OUTLINE_OP_MOVE);
+        font_outline_push_point(cache, &param->to);
+        break;
+    case LV_FREETYPE_OUTLINE_LINE_TO:
+        font_outline_push_op(cache, VG_FONT_OUTLINE_OP_LINE);
+        font_outline_push_point(cache, &param->to);
+        break;
+    case LV_FREETYPE_OUTLINE_CONIC_TO:
+        font_outline_push_op(cache, VG_FONT_OUTLINE_OP_QUAD);
+        font_outline_push_point(cache, &param->control1);
+        font_outline_push_point(cache, &param->to);
+        break;
+    case LV_FREETYPE_OUTLINE_CUBIC_TO:
+        font_outline_push_op(cache, VG_FONT_OUTLINE_OP_CUBIC);
+        font_outline_push_point(cache, &param->control1);
+        font_outline_push_point(cache, &param->control2);
+        font_outline_push_point(cache, &param->to);
+        break;
+    case LV_FREETYPE_OUTLINE_END:
+        font_outline_push_op(cache, VG_FONT_OUTLINE_OP_END);
+        break;
+    default:
+        LV_LOG_WARN("unknown outline type: %d", param->type);
+        cache->is_overflow = true;
+        break;
+    }
+}
+
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
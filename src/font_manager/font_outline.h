@@ -0,0 +1,130 @@
+/**
+ * @file font_outline.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_OUTLINE_H
+#define FONT_MANAGER_FONT_OUTLINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include "uikit/uikit_font_manager.h"
+#include <lvgl/lvgl.h>
+
+#if (UIKIT_FONT_OUTLINE_CACHE_SIZE > 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_outline_cache_t font_outline_cache_t;
+
+/**
+ * Open the private reference font of a face.
+ * @param user_data custom parameter.
+ * @param name font name.
+ * @param path font file path, resolved by the caller of font_outline_cache_get.
+ * @param size reference size.
+ * @param style font style.
+ * @return outline mode freetype font, NULL on failure.
+ */
+typedef lv_font_t* (*font_outline_open_cb_t)(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style);
+
+/**
+ * Close a font opened by font_outline_open_cb_t.
+ * @param user_data custom parameter.
+ * @param font the font.
+ */
+typedef void (*font_outline_close_cb_t)(void* user_data, lv_font_t* font);
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t glyph_cnt;
+    uint32_t face_cnt;
+    size_t cur_size;
+    size_t max_size;
+} font_outline_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create the shared outline cache. Outlines are captured from the freetype
+ * outline events of a private font per face, and stored quantized at the
+ * reference size. The cache isn't thread safe, the font manager calls it
+ * under its freetype lock.
+ * @param max_size maximum bytes of outlines to hold.
+ * @param ref_size reference size.
+ * @param open_cb open the reference font of a face.
+ * @param close_cb close the reference font of a face.
+ * @param user_data custom parameter of the callbacks.
+ * @return pointer to outline cache.
+ */
+font_outline_cache_t* font_outline_cache_create(size_t max_size, uint16_t ref_size,
+    font_outline_open_cb_t open_cb, font_outline_close_cb_t close_cb, void* user_data);
+
+/**
+ * Delete the outline cache, all outlines must be released.
+ * @param cache pointer to outline cache.
+ */
+void font_outline_cache_delete(font_outline_cache_t* cache);
+
+/**
+ * Get the outline of a glyph, captured on the first request.
+ * @param cache pointer to outline cache.
+ * @param name font name.
+ * @param path font file path, opened if the face isn't.
+ * @param style font style.
+ * @param letter unicode letter.
+ * @param outline return the outline, scale is left to the caller.
+ * @return true if the glyph has an outline.
+ */
+bool font_outline_cache_get(font_outline_cache_t* cache, const char* name, const char* path, uint16_t style,
+    uint32_t letter, vg_font_outline_t* outline);
+
+/**
+ * Release an outline got by font_outline_cache_get.
+ * @param cache pointer to outline cache.
+ * @param outline the outline.
+ */
+void font_outline_cache_release(font_outline_cache_t* cache, vg_font_outline_t* outline);
+
+/**
+ * Drop the outlines that are not in use, and close the faces left empty.
+ * @param cache pointer to outline cache.
+ * @return bytes released.
+ */
+size_t font_outline_cache_clear(font_outline_cache_t* cache);
+
+/**
+ * Get the cache statistics.
+ * @param cache pointer to outline cache.
+ * @param stats return the statistics.
+ */
+void font_outline_cache_get_stats(const font_outline_cache_t* cache, font_outline_cache_stats_t* stats);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_OUTLINE_CACHE_SIZE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_OUTLINE_H */
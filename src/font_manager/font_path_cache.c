@@ -0,0 +1,187 @@
+/**
+ * @file font_path_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_path_cache.h"
+#include "font_hash.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_PATH_CACHE_BUCKET_CNT 32
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    font_hash_node_t hash_node;
+    const char* path; /* points into name[], NULL if absent */
+    char name[]; /* name, followed by the path */
+} font_path_node_t;
+
+typedef struct _font_path_cache_t {
+    font_hash_t hash;
+    bool is_scanned;
+    bool is_complete;
+} font_path_cache_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static font_path_node_t* font_path_cache_search(font_path_cache_t* cache, const char* name);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_path_cache_t* font_path_cache_create(void)
+{
+    font_path_cache_t* cache = lv_malloc(sizeof(font_path_cache_t));
+    LV_ASSERT_MALLOC(cache);
+    if (!cache) {
+        LV_LOG_ERROR("malloc failed for font_path_cache_t");
+        return NULL;
+    }
+    lv_memzero(cache, sizeof(font_path_cache_t));
+
+    if (!font_hash_init(&cache->hash, FONT_PATH_CACHE_BUCKET_CNT)) {
+        lv_free(cache);
+        return NULL;
+    }
+
+    LV_LOG_INFO("cache: %p create", cache);
+    return cache;
+}
+
+void font_path_cache_delete(font_path_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_path_cache_clear(cache);
+    font_hash_deinit(&cache->hash);
+    lv_free(cache);
+
+    LV_LOG_INFO("cache: %p delete", cache);
+}
+
+void font_path_cache_clear(font_path_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    for (uint32_t i = 0; i < cache->hash.bucket_cnt; i++) {
+        font_hash_node_t* node = cache->hash.buckets[i];
+        while (node) {
+            font_hash_node_t* next = node->next;
+            lv_free(FONT_HASH_ENTRY(node, font_path_node_t, hash_node));
+            node = next;
+        }
+        cache->hash.buckets[i] = NULL;
+    }
+
+    cache->hash.node_cnt = 0;
+    cache->is_scanned = false;
+    cache->is_complete = false;
+}
+
+font_path_cache_res_t font_path_cache_get(font_path_cache_t* cache, const char* name, const char** path)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(name);
+    LV_ASSERT_NULL(path);
+
+    font_path_node_t* node = font_path_cache_search(cache, name);
+    if (!node) {
+        *path = NULL;
+        return FONT_PATH_CACHE_MISS;
+    }
+
+    *path = node->path;
+    return node->path ? FONT_PATH_CACHE_FOUND : FONT_PATH_CACHE_ABSENT;
+}
+
+const char* font_path_cache_set(font_path_cache_t* cache, const char* name, const char* path)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(name);
+
+    font_path_node_t* node = font_path_cache_search(cache, name);
+    if (node) {
+        font_hash_remove(&cache->hash, &node->hash_node);
+        lv_free(node);
+    }
+
+    size_t name_size = strlen(name) + 1;
+    size_t path_size = path ? strlen(path) + 1 : 0;
+
+    node = lv_malloc(sizeof(font_path_node_t) + name_size + path_size);
+    LV_ASSERT_MALLOC(node);
+    if (!node) {
+        LV_LOG_ERROR("malloc failed for font_path_node_t");
+        return NULL;
+    }
+
+    lv_memcpy(node->name, name, name_size);
+    node->path = NULL;
+    if (path) {
+        char* path_buf = node->name + name_size;
+        lv_memcpy(path_buf, path, path_size);
+        node->path = path_buf;
+    }
+
+    font_hash_insert(&cache->hash, &node->hash_node, font_hash_str(name));
+    return node->path;
+}
+
+void font_path_cache_set_complete(font_path_cache_t* cache, bool complete)
+{
+    LV_ASSERT_NULL(cache);
+    cache->is_scanned = true;
+    cache->is_complete = complete;
+}
+
+bool font_path_cache_is_complete(const font_path_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+    return cache->is_complete;
+}
+
+bool font_path_cache_is_scanned(const font_path_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+    return cache->is_scanned;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static font_path_node_t* font_path_cache_search(font_path_cache_t* cache, const char* name)
+{
+    font_hash_node_t* hash_node;
+    FONT_HASH_FOREACH(&cache->hash, font_hash_str(name), hash_node)
+    {
+        font_path_node_t* node = FONT_HASH_ENTRY(hash_node, font_path_node_t, hash_node);
+        if (strcmp(node->name, name) == 0) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file font_path_cache.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_PATH_CACHE_H
+#define FONT_MANAGER_FONT_PATH_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include <lvgl/lvgl.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_path_cache_t font_path_cache_t;
+
+typedef enum {
+    FONT_PATH_CACHE_MISS = 0, /* name not resolved yet */
+    FONT_PATH_CACHE_FOUND, /* font file exists */
+    FONT_PATH_CACHE_ABSENT, /* font file doesn't exist */
+} font_path_cache_res_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a font path cache.
+ * @return pointer to font path cache.
+ */
+font_path_cache_t* font_path_cache_create(void);
+
+/**
+ * Delete a font path cache.
+ * @param cache pointer to font path cache.
+ */
+void font_path_cache_delete(font_path_cache_t* cache);
+
+/**
+ * Drop all resolved names.
+ * @param cache pointer to font path cache.
+ */
+void font_path_cache_clear(font_path_cache_t* cache);
+
+/**
+ * Look up a font name.
+ * @param cache pointer to font path cache.
+ * @param name font name.
+ * @param path return the font file path when found, valid until the cache is cleared.
+ * @return lookup result.
+ */
+font_path_cache_res_t font_path_cache_get(font_path_cache_t* cache, const char* name, const char** path);
+
+/**
+ * Record the resolved path of a font name.
+ * @param cache pointer to font path cache.
+ * @param name font name.
+ * @param path font file path, NULL if the font file doesn't exist.
+ * @return the cached path, NULL if absent or out of memory.
+ */
+const char* font_path_cache_set(font_path_cache_t* cache, const char* name, const char* path);
+
+/**
+ * Mark whether the cache holds every font of the base directory.
+ * When complete, a name that misses the cache has no font file in the base directory.
+ * @param cache pointer to font path cache.
+ * @param complete true if the base directory was scanned.
+ */
+void font_path_cache_set_complete(font_path_cache_t* cache, bool complete);
+
+/**
+ * Check whether the cache holds every font of the base directory.
+ * @param cache pointer to font path cache.
+ * @return return true if the base directory was scanned.
+ */
+bool font_path_cache_is_complete(const font_path_cache_t* cache);
+
+/**
+ * Check whether the base directory was scanned since the last clear.
+ * @param cache pointer to font path cache.
+ * @return return true if a scan was attempted.
+ */
+bool font_path_cache_is_scanned(const font_path_cache_t* cache);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_PATH_CACHE_H */
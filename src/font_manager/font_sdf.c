@@ -0,0 +1,782 @@
+/**
+ * @file font_sdf.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_sdf.h"
+
+#if UIKIT_FONT_USE_SDF
+
+#include "font_hash.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_SDF_GLYPH_HASH_SIZE 64
+
+/* squared distance of a pixel that hasn't met an edge yet */
+#define FONT_SDF_INF 1e20f
+
+/* field value of an edge, inside is above */
+#define FONT_SDF_EDGE 128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_sdf_face_t font_sdf_face_t;
+
+typedef struct _font_sdf_glyph_t {
+    font_hash_node_t hash_node; /* glyph_hash node of the face, keyed by letter */
+    struct _font_sdf_glyph_t* prev; /* LRU order over all faces, most recently used at the head */
+    struct _font_sdf_glyph_t* next;
+    font_sdf_face_t* face;
+    uint32_t letter;
+    uint16_t adv_w; /* metrics at the reference size */
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint16_t sdf_w; /* box plus the spread on each side, 0 for a blank glyph */
+    uint16_t sdf_h;
+    size_t mem_size;
+    uint8_t sdf[]; /* sdf_w x sdf_h distance field */
+} font_sdf_glyph_t;
+
+struct _font_sdf_face_t {
+    lv_font_t* ref_font; /* private font at the reference size, open with the face */
+    font_hash_t glyph_hash;
+    int font_cnt; /* fonts that sample this face */
+    int32_t line_height; /* metrics of the reference font */
+    int32_t base_line;
+    int8_t underline_position;
+    int8_t underline_thickness;
+    uint16_t style;
+    char name[];
+};
+
+/* font of one size, the font manager copies the lv_font_t, dsc leads back here */
+typedef struct {
+    lv_font_t font;
+    font_sdf_cache_t* cache;
+    font_sdf_face_t* face;
+    int32_t scale; /* font size / reference size, 16.16 fixed point */
+} font_sdf_font_t;
+
+typedef struct _font_sdf_cache_t {
+    lv_ll_t face_ll; /* font_sdf_face_t* */
+    font_sdf_glyph_t* head;
+    font_sdf_glyph_t* tail;
+    uint16_t ref_size;
+    uint8_t spread;
+    font_sdf_open_cb_t open_cb;
+    font_sdf_close_cb_t close_cb;
+    void* user_data;
+    font_sdf_cache_stats_t stats;
+} font_sdf_cache_t;
+
+/* glyph box of a font size, in pixels from the pen position, y up */
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+} font_sdf_box_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static font_sdf_face_t* font_sdf_get_face(font_sdf_cache_t* cache, const char* name, const char* path, uint16_t style);
+static bool font_sdf_open_ref_font(font_sdf_cache_t* cache, font_sdf_face_t* face, const char* path);
+static void font_sdf_close_face(font_sdf_cache_t* cache, font_sdf_face_t* face);
+static font_sdf_glyph_t* font_sdf_get_glyph(font_sdf_cache_t* cache, font_sdf_face_t* face, uint32_t letter);
+static font_sdf_glyph_t* font_sdf_capture(font_sdf_cache_t* cache, font_sdf_face_t* face, uint32_t letter);
+static bool font_sdf_build_field(const font_sdf_cache_t* cache, font_sdf_glyph_t* glyph, const lv_draw_buf_t* bitmap);
+static void font_sdf_render(const font_sdf_cache_t* cache, const font_sdf_glyph_t* glyph, int32_t scale,
+    const lv_font_glyph_dsc_t* dsc, lv_draw_buf_t* draw_buf);
+static int32_t font_sdf_scale_round(int32_t value, int32_t scale);
+static void font_sdf_get_box(const font_sdf_glyph_t* glyph, int32_t scale, font_sdf_box_t* box);
+static void font_sdf_evict(font_sdf_cache_t* cache, size_t mem_size);
+static void font_sdf_remove_glyph(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph);
+static void font_sdf_link_head(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph);
+static void font_sdf_unlink(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph);
+static bool font_sdf_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next);
+static const void* font_sdf_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_sdf_cache_t* font_sdf_cache_create(size_t max_size, uint16_t ref_size, uint8_t spread,
+    font_sdf_open_cb_t open_cb, font_sdf_close_cb_t close_cb, void* user_data)
+{
+    LV_ASSERT_NULL(open_cb);
+    LV_ASSERT_NULL(close_cb);
+    LV_ASSERT(ref_size > 0);
+    LV_ASSERT(spread > 0);
+
+    font_sdf_cache_t* cache = lv_malloc(sizeof(font_sdf_cache_t));
+    LV_ASSERT_MALLOC(cache);
+    if (!cache) {
+        LV_LOG_ERROR("malloc failed for font_sdf_cache_t");
+        return NULL;
+    }
+    lv_memzero(cache, sizeof(font_sdf_cache_t));
+
+    _lv_ll_init(&cache->face_ll, sizeof(font_sdf_face_t*));
+    cache->ref_size = ref_size;
+    cache->spread = spread;
+    cache->open_cb = open_cb;
+    cache->close_cb = close_cb;
+    cache->user_data = user_data;
+    cache->stats.max_size = max_size;
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32 ", ref_size: %d, spread: %d", (uint32_t)max_size, ref_size, spread);
+    return cache;
+}
+
+void font_sdf_cache_delete(font_sdf_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_sdf_face_t** face_p = _lv_ll_get_head(&cache->face_ll);
+    if (face_p) {
+        LV_LOG_ERROR("%" LV_PRIu32 " faces still in use", _lv_ll_get_len(&cache->face_ll));
+    }
+
+    while (face_p) {
+        font_sdf_face_t** next_p = _lv_ll_get_next(&cache->face_ll, face_p);
+        font_sdf_close_face(cache, *face_p);
+        face_p = next_p;
+    }
+
+    lv_free(cache);
+
+    LV_LOG_INFO("success");
+}
+
+lv_font_t* font_sdf_cache_create_font(font_sdf_cache_t* cache, const char* name, const char* path, uint16_t size,
+    uint16_t style)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(name);
+    LV_ASSERT_NULL(path);
+
+    font_sdf_face_t* face = font_sdf_get_face(cache, name, path, style);
+    if (!face) {
+        return NULL;
+    }
+
+    font_sdf_font_t* sdf_font = lv_malloc(sizeof(font_sdf_font_t));
+    LV_ASSERT_MALLOC(sdf_font);
+    if (!sdf_font) {
+        LV_LOG_ERROR("malloc failed for font_sdf_font_t");
+        if (face->font_cnt == 0) {
+            font_sdf_close_face(cache, face);
+        }
+        return NULL;
+    }
+    lv_memzero(sdf_font, sizeof(font_sdf_font_t));
+
+    int32_t scale = ((int32_t)size << 16) / cache->ref_size;
+    sdf_font->cache = cache;
+    sdf_font->face = face;
+    sdf_font->scale = scale;
+
+    lv_font_t* font = &sdf_font->font;
+    font->get_glyph_dsc = font_sdf_get_glyph_dsc_cb;
+    font->get_glyph_bitmap = font_sdf_get_glyph_bitmap_cb;
+    font->line_height = font_sdf_scale_round(face->line_height, scale);
+    font->base_line = font_sdf_scale_round(face->base_line, scale);
+    font->underline_position = LV_CLAMP(INT8_MIN, font_sdf_scale_round(face->underline_position, scale), INT8_MAX);
+    font->underline_thickness = LV_CLAMP(1, font_sdf_scale_round(face->underline_thickness, scale), INT8_MAX);
+    font->subpx = LV_FONT_SUBPX_NONE;
+    font->dsc = sdf_font;
+
+    face->font_cnt++;
+
+    LV_LOG_INFO("font: %s(%d) style %d created", name, size, style);
+    return font;
+}
+
+void font_sdf_cache_delete_font(font_sdf_cache_t* cache, lv_font_t* font)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(font);
+
+    font_sdf_font_t* sdf_font = (font_sdf_font_t*)font->dsc;
+    LV_ASSERT(sdf_font && &sdf_font->font == font);
+
+    font_sdf_face_t* face = sdf_font->face;
+    LV_ASSERT(face->font_cnt > 0);
+    if (--face->font_cnt == 0) {
+        font_sdf_close_face(cache, face);
+    }
+
+    lv_free(sdf_font);
+}
+
+size_t font_sdf_cache_clear(font_sdf_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    size_t cur_size = cache->stats.cur_size;
+
+    /* the reference fonts stay open, a glyph miss can't open a file */
+    while (cache->tail) {
+        font_sdf_remove_glyph(cache, cache->tail);
+    }
+
+    return cur_size - cache->stats.cur_size;
+}
+
+void font_sdf_cache_get_stats(const font_sdf_cache_t* cache, font_sdf_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(stats);
+
+    *stats = cache->stats;
+    stats->face_cnt = _lv_ll_get_len(&cache->face_ll);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static font_sdf_face_t* font_sdf_get_face(font_sdf_cache_t* cache, const char* name, const char* path, uint16_t style)
+{
+    font_sdf_face_t** face_p;
+    _LV_LL_READ(&cache->face_ll, face_p)
+    {
+        if ((*face_p)->style == style && strcmp((*face_p)->name, name) == 0) {
+            return *face_p;
+        }
+    }
+
+    size_t name_len = strlen(name) + 1;
+    font_sdf_face_t* face = lv_malloc(sizeof(font_sdf_face_t) + name_len);
+    LV_ASSERT_MALLOC(face);
+    if (!face) {
+        LV_LOG_ERROR("malloc failed for font_sdf_face_t");
+        return NULL;
+    }
+    lv_memzero(face, sizeof(font_sdf_face_t));
+
+    face->style = style;
+    lv_memcpy(face->name, name, name_len);
+
+    /* the metrics of every size are scaled from the reference font */
+    if (!font_sdf_open_ref_font(cache, face, path)) {
+        lv_free(face);
+        return NULL;
+    }
+
+    face->line_height = face->ref_font->line_height;
+    face->base_line = face->ref_font->base_line;
+    face->underline_position = face->ref_font->underline_position;
+    face->underline_thickness = face->ref_font->underline_thickness;
+
+    face_p = _lv_ll_ins_head(&cache->face_ll);
+    LV_ASSERT_MALLOC(face_p);
+    if (!face_p || !font_hash_init(&face->glyph_hash, FONT_SDF_GLYPH_HASH_SIZE)) {
+        LV_LOG_ERROR("malloc failed for face node");
+        if (face_p) {
+            _lv_ll_remove(&cache->face_ll, face_p);
+            lv_free(face_p);
+        }
+        cache->close_cb(cache->user_data, face->ref_font);
+        lv_free(face);
+        return NULL;
+    }
+
+    *face_p = face;
+
+    LV_LOG_INFO("face: %s style %d opened", name, style);
+    return face;
+}
+
+static bool font_sdf_open_ref_font(font_sdf_cache_t* cache, font_sdf_face_t* face, const char* path)
+{
+    face->ref_font = cache->open_cb(cache->user_data, face->name, path, cache->ref_size, face->style);
+    if (!face->ref_font) {
+        LV_LOG_WARN("font: %s(%d) can't be opened", face->name, cache->ref_size);
+        return false;
+    }
+
+    return true;
+}
+
+static void font_sdf_close_face(font_sdf_cache_t* cache, font_sdf_face_t* face)
+{
+    font_sdf_glyph_t* glyph = cache->tail;
+    while (glyph) {
+        font_sdf_glyph_t* prev = glyph->prev;
+        if (glyph->face == face) {
+            font_sdf_remove_glyph(cache, glyph);
+        }
+        glyph = prev;
+    }
+
+    font_sdf_face_t** face_p;
+    _LV_LL_READ(&cache->face_ll, face_p)
+    {
+        if (*face_p == face) {
+            _lv_ll_remove(&cache->face_ll, face_p);
+            lv_free(face_p);
+            break;
+        }
+    }
+
+    LV_LOG_INFO("face: %s style %d closed", face->name, face->style);
+
+    cache->close_cb(cache->user_data, face->ref_font);
+    font_hash_deinit(&face->glyph_hash);
+    lv_free(face);
+}
+
+static font_sdf_glyph_t* font_sdf_get_glyph(font_sdf_cache_t* cache, font_sdf_face_t* face, uint32_t letter)
+{
+    uint32_t letter_hash = font_hash_mix(FONT_HASH_INIT, letter);
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&face->glyph_hash, letter_hash, node)
+    {
+        font_sdf_glyph_t* glyph = FONT_HASH_ENTRY(node, font_sdf_glyph_t, hash_node);
+        if (glyph->letter == letter) {
+            cache->stats.hit_cnt++;
+            if (glyph != cache->head) {
+                font_sdf_unlink(cache, glyph);
+                font_sdf_link_head(cache, glyph);
+            }
+            return glyph;
+        }
+    }
+
+    cache->stats.miss_cnt++;
+    return font_sdf_capture(cache, face, letter);
+}
+
+static font_sdf_glyph_t* font_sdf_capture(font_sdf_cache_t* cache, font_sdf_face_t* face, uint32_t letter)
+{
+    lv_font_glyph_dsc_t dsc;
+    lv_memzero(&dsc, sizeof(dsc));
+    if (!lv_font_get_glyph_dsc(face->ref_font, &dsc, letter, 0) || dsc.is_placeholder) {
+        return NULL;
+    }
+
+    /* blank glyphs like the space only keep their metrics */
+    uint32_t sdf_w = 0;
+    uint32_t sdf_h = 0;
+    if (dsc.box_w > 0 && dsc.box_h > 0) {
+        sdf_w = dsc.box_w + cache->spread * 2;
+        sdf_h = dsc.box_h + cache->spread * 2;
+    }
+
+    size_t mem_size = sizeof(font_sdf_glyph_t) + sdf_w * sdf_h;
+    if (mem_size > cache->stats.max_size || sdf_w > UINT16_MAX || sdf_h > UINT16_MAX) {
+        LV_LOG_WARN("letter 0x%" LV_PRIx32 " field too large: %" LV_PRIu32, letter, (uint32_t)mem_size);
+        return NULL;
+    }
+
+    font_sdf_evict(cache, mem_size);
+
+    font_sdf_glyph_t* glyph = lv_malloc(mem_size);
+    LV_ASSERT_MALLOC(glyph);
+    if (!glyph) {
+        LV_LOG_ERROR("malloc failed for font_sdf_glyph_t");
+        return NULL;
+    }
+    lv_memzero(glyph, sizeof(font_sdf_glyph_t));
+
+    glyph->face = face;
+    glyph->letter = letter;
+    glyph->adv_w = dsc.adv_w;
+    glyph->box_w = dsc.box_w;
+    glyph->box_h = dsc.box_h;
+    glyph->ofs_x = dsc.ofs_x;
+    glyph->ofs_y = dsc.ofs_y;
+    glyph->sdf_w = sdf_w;
+    glyph->sdf_h = sdf_h;
+    glyph->mem_size = mem_size;
+
+    if (sdf_w > 0) {
+        const lv_draw_buf_t* bitmap = lv_font_get_glyph_bitmap(&dsc, letter, NULL);
+        bool is_built = bitmap && dsc.bpp == 8 && font_sdf_build_field(cache, glyph, bitmap);
+        if (bitmap) {
+            lv_font_glyph_release_draw_data(&dsc);
+        }
+
+        if (!is_built) {
+            LV_LOG_WARN("letter 0x%" LV_PRIx32 " of %s not rasterized, bpp: %d", letter, face->name, dsc.bpp);
+            lv_free(glyph);
+            return NULL;
+        }
+    }
+
+    font_hash_insert(&face->glyph_hash, &glyph->hash_node, font_hash_mix(FONT_HASH_INIT, letter));
+    font_sdf_link_head(cache, glyph);
+
+    cache->stats.glyph_cnt++;
+    cache->stats.cur_size += mem_size;
+    return glyph;
+}
+
+/* Felzenszwalb and Huttenlocher, squared distance transform of a line */
+static void font_sdf_edt_1d(const float* f, float* d, int32_t* v, float* z, int32_t n)
+{
+    int32_t k = 0;
+    v[0] = 0;
+    z[0] = -FONT_SDF_INF;
+    z[1] = FONT_SDF_INF;
+
+    for (int32_t q = 1; q < n; q++) {
+        float s;
+        while (true) {
+            int32_t r = v[k];
+            s = ((f[q] + q * q) - (f[r] + r * r)) / (2 * (q - r));
+            if (k == 0 || s > z[k]) {
+                break;
+            }
+            k--;
+        }
+
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FONT_SDF_INF;
+    }
+
+    k = 0;
+    for (int32_t q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        int32_t r = v[k];
+        d[q] = (q - r) * (q - r) + f[r];
+    }
+}
+
+static void font_sdf_edt_2d(float* grid, int32_t w, int32_t h, float* f, float* d, int32_t* v, float* z)
+{
+    for (int32_t x = 0; x < w; x++) {
+        for (int32_t y = 0; y < h; y++) {
+            f[y] = grid[y * w + x];
+        }
+        font_sdf_edt_1d(f, d, v, z, h);
+        for (int32_t y = 0; y < h; y++) {
+            grid[y * w + x] = d[y];
+        }
+    }
+
+    for (int32_t y = 0; y < h; y++) {
+        float* row = grid + y * w;
+        lv_memcpy(f, row, w * sizeof(float));
+        font_sdf_edt_1d(f, row, v, z, w);
+    }
+}
+
+static uint32_t font_sdf_isqrt(uint32_t x)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+/* distance in pixels, 1/256 precision, capped at limit */
+static float font_sdf_distance(float dist_sq, float limit)
+{
+    if (dist_sq >= limit * limit) {
+        return limit;
+    }
+
+    return font_sdf_isqrt((uint32_t)(dist_sq * 65536.0f)) / 256.0f;
+}
+
+static bool font_sdf_build_field(const font_sdf_cache_t* cache, font_sdf_glyph_t* glyph, const lv_draw_buf_t* bitmap)
+{
+    int32_t w = glyph->sdf_w;
+    int32_t h = glyph->sdf_h;
+    int32_t n = w * h;
+    int32_t len = LV_MAX(w, h);
+    int32_t spread = cache->spread;
+
+    /* distance to the shape and distance to the background, then the line buffers */
+    size_t buf_size = (n * 2 + len * 3 + 1) * sizeof(float) + len * sizeof(int32_t);
+    float* buf = lv_malloc(buf_size);
+    LV_ASSERT_MALLOC(buf);
+    if (!buf) {
+        LV_LOG_ERROR("malloc failed for %" LV_PRIu32 " bytes of field buffer", (uint32_t)buf_size);
+        return false;
+    }
+
+    float* grid_out = buf;
+    float* grid_in = grid_out + n;
+    float* f = grid_in + n;
+    float* d = f + len;
+    float* z = d + len;
+    int32_t* v = (int32_t*)(z + len + 1);
+
+    for (int32_t i = 0; i < n; i++) {
+        grid_out[i] = FONT_SDF_INF;
+        grid_in[i] = 0;
+    }
+
+    /* anti-aliased pixels put the edge inside the pixel, TinySDF style */
+    int32_t box_w = LV_MIN(glyph->box_w, bitmap->header.w);
+    int32_t box_h = LV_MIN(glyph->box_h, bitmap->header.h);
+    for (int32_t y = 0; y < box_h; y++) {
+        const uint8_t* src = bitmap->data + y * bitmap->header.stride;
+        int32_t index = (y + spread) * w + spread;
+        for (int32_t x = 0; x < box_w; x++, index++) {
+            uint8_t cover = src[x];
+            if (cover == 0) {
+                continue;
+            }
+
+            if (cover == 0xFF) {
+                grid_out[index] = 0;
+                grid_in[index] = FONT_SDF_INF;
+                continue;
+            }
+
+            float a = cover / 255.0f;
+            grid_out[index] = a < 0.5f ? (0.5f - a) * (0.5f - a) : 0;
+            grid_in[index] = a > 0.5f ? (a - 0.5f) * (a - 0.5f) : 0;
+        }
+    }
+
+    font_sdf_edt_2d(grid_out, w, h, f, d, v, z);
+    font_sdf_edt_2d(grid_in, w, h, f, d, v, z);
+
+    /* the edge is at FONT_SDF_EDGE, the spread maps to the rest of the byte */
+    float limit = spread + 1;
+    float gain = 127.0f / spread;
+    for (int32_t i = 0; i < n; i++) {
+        float dist = font_sdf_distance(grid_in[i], limit) - font_sdf_distance(grid_out[i], limit);
+        int32_t value = FONT_SDF_EDGE + (int32_t)(dist * gain + (dist < 0 ? -0.5f : 0.5f));
+        glyph->sdf[i] = LV_CLAMP(0, value, 0xFF);
+    }
+
+    lv_free(buf);
+    return true;
+}
+
+static int32_t font_sdf_floor(float value)
+{
+    int32_t i = (int32_t)value;
+    return value < i ? i - 1 : i;
+}
+
+static int32_t font_sdf_get_texel(const font_sdf_glyph_t* glyph, int32_t x, int32_t y)
+{
+    if (x < 0 || y < 0 || x >= glyph->sdf_w || y >= glyph->sdf_h) {
+        return 0;
+    }
+
+    return glyph->sdf[y * glyph->sdf_w + x];
+}
+
+static float font_sdf_sample(const font_sdf_glyph_t* glyph, float x, float y)
+{
+    int32_t x0 = font_sdf_floor(x);
+    int32_t y0 = font_sdf_floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    int32_t v00 = font_sdf_get_texel(glyph, x0, y0);
+    int32_t v10 = font_sdf_get_texel(glyph, x0 + 1, y0);
+    int32_t v01 = font_sdf_get_texel(glyph, x0, y0 + 1);
+    int32_t v11 = font_sdf_get_texel(glyph, x0 + 1, y0 + 1);
+
+    float top = v00 + (v10 - v00) * fx;
+    float bottom = v01 + (v11 - v01) * fx;
+    return top + (bottom - top) * fy;
+}
+
+static void font_sdf_render(const font_sdf_cache_t* cache, const font_sdf_glyph_t* glyph, int32_t scale,
+    const lv_font_glyph_dsc_t* dsc, lv_draw_buf_t* draw_buf)
+{
+    font_sdf_box_t box;
+    font_sdf_get_box(glyph, scale, &box);
+
+    int32_t w = LV_MIN3(box.w, (int32_t)dsc->box_w, (int32_t)draw_buf->header.w);
+    int32_t h = LV_MIN3(box.h, (int32_t)dsc->box_h, (int32_t)draw_buf->header.h);
+
+    /* a pixel of the font size covers 1 / scale pixels of the field */
+    float ratio = (float)scale / (1 << 16);
+    float step = 1.0f / ratio;
+    float spread = cache->spread;
+
+    /* the pixel centers in field coordinates, y down from the field top */
+    float x_start = (box.x + 0.5f) * step - glyph->ofs_x + spread - 0.5f;
+    float y_start = (glyph->ofs_y + glyph->box_h) - (box.y + box.h - 0.5f) * step + spread - 0.5f;
+
+    /* one pixel of the font size ramps from clear to opaque across the edge */
+    float gain = spread * ratio * 255.0f / 127.0f;
+
+    uint32_t stride = draw_buf->header.stride;
+    uint8_t* dest = draw_buf->data;
+    float sy = y_start;
+    for (int32_t y = 0; y < h; y++) {
+        float sx = x_start;
+        for (int32_t x = 0; x < w; x++) {
+            float alpha = 127.5f + (font_sdf_sample(glyph, sx, sy) - FONT_SDF_EDGE) * gain;
+            dest[x] = alpha <= 0 ? 0 : (alpha >= 255.0f ? 0xFF : (uint8_t)alpha);
+            sx += step;
+        }
+        dest += stride;
+        sy += step;
+    }
+}
+
+static int32_t font_sdf_scale_floor(int32_t value, int32_t scale)
+{
+    int64_t product = (int64_t)value * scale;
+    return product >= 0 ? (int32_t)(product >> 16) : -(int32_t)((-product + 0xFFFF) >> 16);
+}
+
+static int32_t font_sdf_scale_ceil(int32_t value, int32_t scale)
+{
+    return -font_sdf_scale_floor(-value, scale);
+}
+
+static int32_t font_sdf_scale_round(int32_t value, int32_t scale)
+{
+    int64_t product = (int64_t)value * scale;
+    return product >= 0 ? (int32_t)((product + 0x8000) >> 16) : -(int32_t)((-product + 0x8000) >> 16);
+}
+
+static void font_sdf_get_box(const font_sdf_glyph_t* glyph, int32_t scale, font_sdf_box_t* box)
+{
+    if (glyph->sdf_w == 0) {
+        lv_memzero(box, sizeof(font_sdf_box_t));
+        return;
+    }
+
+    /* the scaled box snapped outwards to whole pixels */
+    box->x = font_sdf_scale_floor(glyph->ofs_x, scale);
+    box->y = font_sdf_scale_floor(glyph->ofs_y, scale);
+    box->w = font_sdf_scale_ceil(glyph->ofs_x + glyph->box_w, scale) - box->x;
+    box->h = font_sdf_scale_ceil(glyph->ofs_y + glyph->box_h, scale) - box->y;
+}
+
+static void font_sdf_evict(font_sdf_cache_t* cache, size_t mem_size)
+{
+    while (cache->tail && cache->stats.cur_size + mem_size > cache->stats.max_size) {
+        font_sdf_remove_glyph(cache, cache->tail);
+    }
+}
+
+static void font_sdf_remove_glyph(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph)
+{
+    cache->stats.cur_size -= glyph->mem_size;
+    cache->stats.glyph_cnt--;
+
+    font_hash_remove(&glyph->face->glyph_hash, &glyph->hash_node);
+    font_sdf_unlink(cache, glyph);
+    lv_free(glyph);
+}
+
+static void font_sdf_link_head(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph)
+{
+    glyph->prev = NULL;
+    glyph->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = glyph;
+    } else {
+        cache->tail = glyph;
+    }
+    cache->head = glyph;
+}
+
+static void font_sdf_unlink(font_sdf_cache_t* cache, font_sdf_glyph_t* glyph)
+{
+    if (glyph->prev) {
+        glyph->prev->next = glyph->next;
+    } else {
+        cache->head = glyph->next;
+    }
+
+    if (glyph->next) {
+        glyph->next->prev = glyph->prev;
+    } else {
+        cache->tail = glyph->prev;
+    }
+
+    glyph->prev = NULL;
+    glyph->next = NULL;
+}
+
+static bool font_sdf_get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letter_next)
+{
+    /* advances come from the reference size, no kerning */
+    LV_UNUSED(letter_next);
+
+    const font_sdf_font_t* sdf_font = font->dsc;
+    const font_sdf_glyph_t* glyph = font_sdf_get_glyph(sdf_font->cache, sdf_font->face, letter);
+    if (!glyph) {
+        return false;
+    }
+
+    font_sdf_box_t box;
+    font_sdf_get_box(glyph, sdf_font->scale, &box);
+
+    dsc->resolved_font = font;
+    dsc->adv_w = font_sdf_scale_round(glyph->adv_w, sdf_font->scale);
+    dsc->box_w = box.w;
+    dsc->box_h = box.h;
+    dsc->ofs_x = box.x;
+    dsc->ofs_y = box.y;
+    dsc->bpp = 8;
+    dsc->is_placeholder = false;
+    dsc->glyph_index = letter;
+    dsc->entry = NULL;
+    return true;
+}
+
+static const void* font_sdf_get_glyph_bitmap_cb(lv_font_glyph_dsc_t* dsc, uint32_t letter, lv_draw_buf_t* draw_buf)
+{
+    if (!draw_buf) {
+        return NULL;
+    }
+
+    /* evicted since the metrics were read, rasterized again */
+    const font_sdf_font_t* sdf_font = dsc->resolved_font->dsc;
+    const font_sdf_glyph_t* glyph = font_sdf_get_glyph(sdf_font->cache, sdf_font->face, letter);
+    if (!glyph || glyph->sdf_w == 0) {
+        return NULL;
+    }
+
+    font_sdf_render(sdf_font->cache, glyph, sdf_font->scale, dsc, draw_buf);
+    return draw_buf;
+}
+
+#endif /* UIKIT_FONT_USE_SDF */
@@ -0,0 +1,133 @@
+/**
+ * @file font_sdf.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_SDF_H
+#define FONT_MANAGER_FONT_SDF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_SDF
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_sdf_cache_t font_sdf_cache_t;
+
+/**
+ * Open the private reference font of a face.
+ * @param user_data custom parameter.
+ * @param name font name.
+ * @param path font file path, resolved by the caller of font_sdf_cache_create_font.
+ * @param size reference size.
+ * @param style font style.
+ * @return bitmap mode freetype font, NULL on failure.
+ */
+typedef lv_font_t* (*font_sdf_open_cb_t)(void* user_data, const char* name, const char* path, uint16_t size,
+    uint16_t style);
+
+/**
+ * Close a font opened by font_sdf_open_cb_t.
+ * @param user_data custom parameter.
+ * @param font the font.
+ */
+typedef void (*font_sdf_close_cb_t)(void* user_data, lv_font_t* font);
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t glyph_cnt;
+    uint32_t face_cnt;
+    size_t cur_size;
+    size_t max_size;
+} font_sdf_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create the SDF glyph cache. Each glyph of a face is rasterized once by a
+ * private bitmap font at the reference size and kept as a signed distance
+ * field, the fonts of every size sample it. The cache isn't thread safe, the
+ * font manager calls the functions and the glyph callbacks of the fonts under
+ * its freetype lock. The reference font is opened with its face only, never
+ * by a glyph callback.
+ * @param max_size maximum bytes of distance fields to hold.
+ * @param ref_size reference size.
+ * @param spread distance in reference pixels covered by the field on each side of an edge.
+ * @param open_cb open the reference font of a face.
+ * @param close_cb close the reference font of a face.
+ * @param user_data custom parameter of the callbacks.
+ * @return pointer to SDF cache.
+ */
+font_sdf_cache_t* font_sdf_cache_create(size_t max_size, uint16_t ref_size, uint8_t spread,
+    font_sdf_open_cb_t open_cb, font_sdf_close_cb_t close_cb, void* user_data);
+
+/**
+ * Delete the SDF cache, all fonts must be deleted.
+ * @param cache pointer to SDF cache.
+ */
+void font_sdf_cache_delete(font_sdf_cache_t* cache);
+
+/**
+ * Create a font that renders the glyphs of a face from the cache.
+ * @param cache pointer to SDF cache.
+ * @param name font name.
+ * @param path font file path, opened if the face isn't.
+ * @param size font size.
+ * @param style font style.
+ * @return pointer to font, NULL if the face can't be opened.
+ */
+lv_font_t* font_sdf_cache_create_font(font_sdf_cache_t* cache, const char* name, const char* path, uint16_t size,
+    uint16_t style);
+
+/**
+ * Delete a font created by font_sdf_cache_create_font, the face is closed
+ * with its last font.
+ * @param cache pointer to SDF cache.
+ * @param font pointer to font.
+ */
+void font_sdf_cache_delete_font(font_sdf_cache_t* cache, lv_font_t* font);
+
+/**
+ * Drop all the distance fields, the reference fonts stay open for the next
+ * glyph miss.
+ * @param cache pointer to SDF cache.
+ * @return bytes released.
+ */
+size_t font_sdf_cache_clear(font_sdf_cache_t* cache);
+
+/**
+ * Get the cache statistics.
+ * @param cache pointer to SDF cache.
+ * @param stats return the statistics.
+ */
+void font_sdf_cache_get_stats(const font_sdf_cache_t* cache, font_sdf_cache_stats_t* stats);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_SDF */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_SDF_H */
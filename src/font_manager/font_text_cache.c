@@ -0,0 +1,339 @@
+/**
+ * @file font_text_cache.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_text_cache.h"
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+
+#include "font_hash.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define FONT_TEXT_CACHE_HASH_SIZE 64
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_text_entry_t {
+    font_hash_node_t hash_node; /* keyed by (font, text, max_width) */
+    struct _font_text_entry_t* prev; /* LRU order, most recently used at the head */
+    struct _font_text_entry_t* next;
+    const lv_font_t* font;
+    int32_t letter_space;
+    int32_t line_space;
+    int32_t max_width;
+    lv_text_flag_t flag;
+    lv_point_t size;
+    uint32_t line_cnt;
+    uint32_t text_len;
+    size_t mem_size;
+    uint32_t line_start[]; /* line_cnt offsets, followed by the text */
+} font_text_entry_t;
+
+typedef struct _font_text_cache_t {
+    font_hash_t entry_hash;
+    font_text_entry_t* head;
+    font_text_entry_t* tail;
+    font_text_cache_stats_t stats;
+    uint32_t epoch; /* bumped by font_text_cache_drop_font and font_text_cache_clear */
+} font_text_cache_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static uint32_t font_text_cache_hash(const font_text_key_t* key, uint32_t text_len);
+static font_text_entry_t* font_text_cache_search(font_text_cache_t* cache, const font_text_key_t* key,
+    uint32_t key_hash, uint32_t text_len);
+static void font_text_cache_normalize(const font_text_key_t* key, font_text_key_t* norm_key);
+static void font_text_cache_add(font_text_cache_t* cache, const font_text_key_t* key, uint32_t key_hash,
+    uint32_t text_len, const lv_point_t* size, const uint32_t* line_arr, uint32_t line_cnt);
+static void font_text_cache_remove(font_text_cache_t* cache, font_text_entry_t* entry);
+static void font_text_cache_link_head(font_text_cache_t* cache, font_text_entry_t* entry);
+static void font_text_cache_unlink(font_text_cache_t* cache, font_text_entry_t* entry);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_text_cache_t* font_text_cache_create(size_t max_size)
+{
+    font_text_cache_t* cache = lv_malloc(sizeof(font_text_cache_t));
+    LV_ASSERT_MALLOC(cache);
+    if (!cache) {
+        LV_LOG_ERROR("malloc failed for font_text_cache_t");
+        return NULL;
+    }
+    lv_memzero(cache, sizeof(font_text_cache_t));
+
+    if (!font_hash_init(&cache->entry_hash, FONT_TEXT_CACHE_HASH_SIZE)) {
+        lv_free(cache);
+        return NULL;
+    }
+
+    cache->stats.max_size = max_size;
+
+    LV_LOG_INFO("success, max_size: %" LV_PRIu32, (uint32_t)max_size);
+    return cache;
+}
+
+void font_text_cache_delete(font_text_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    font_text_cache_clear(cache);
+    font_hash_deinit(&cache->entry_hash);
+    lv_free(cache);
+}
+
+bool font_text_cache_lookup(font_text_cache_t* cache, const font_text_key_t* key, lv_point_t* size,
+    uint32_t* line_start, uint32_t line_max, uint32_t* line_cnt)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(key);
+    LV_ASSERT_NULL(key->font);
+    LV_ASSERT_NULL(key->text);
+    LV_ASSERT_NULL(size);
+    LV_ASSERT_NULL(line_cnt);
+
+    font_text_key_t norm_key;
+    font_text_cache_normalize(key, &norm_key);
+
+    uint32_t text_len = strlen(norm_key.text);
+    uint32_t key_hash = font_text_cache_hash(&norm_key, text_len);
+
+    font_text_entry_t* entry = font_text_cache_search(cache, &norm_key, key_hash, text_len);
+    if (!entry) {
+        cache->stats.miss_cnt++;
+        return false;
+    }
+
+    cache->stats.hit_cnt++;
+    if (entry != cache->head) {
+        font_text_cache_unlink(cache, entry);
+        font_text_cache_link_head(cache, entry);
+    }
+
+    *size = entry->size;
+    *line_cnt = entry->line_cnt;
+
+    if (line_start) {
+        lv_memcpy(line_start, entry->line_start, LV_MIN(entry->line_cnt, line_max) * sizeof(uint32_t));
+    }
+
+    return true;
+}
+
+void font_text_cache_insert(font_text_cache_t* cache, const font_text_key_t* key, uint32_t epoch,
+    const lv_point_t* size, const uint32_t* line_arr, uint32_t line_cnt)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(key);
+    LV_ASSERT_NULL(size);
+    LV_ASSERT_NULL(line_arr);
+
+    /* measured with the old members or by a deleted font at the same address */
+    if (epoch != cache->epoch) {
+        return;
+    }
+
+    font_text_key_t norm_key;
+    font_text_cache_normalize(key, &norm_key);
+
+    uint32_t text_len = strlen(norm_key.text);
+    uint32_t key_hash = font_text_cache_hash(&norm_key, text_len);
+
+    /* another thread measured it meanwhile */
+    if (font_text_cache_search(cache, &norm_key, key_hash, text_len)) {
+        return;
+    }
+
+    font_text_cache_add(cache, &norm_key, key_hash, text_len, size, line_arr, line_cnt);
+}
+
+uint32_t font_text_cache_get_epoch(const font_text_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    return cache->epoch;
+}
+
+void font_text_cache_drop_font(font_text_cache_t* cache, const lv_font_t* font)
+{
+    LV_ASSERT_NULL(cache);
+
+    cache->epoch++;
+
+    font_text_entry_t* entry = cache->head;
+    while (entry) {
+        font_text_entry_t* next = entry->next;
+        if (entry->font == font) {
+            font_text_cache_remove(cache, entry);
+        }
+        entry = next;
+    }
+}
+
+void font_text_cache_clear(font_text_cache_t* cache)
+{
+    LV_ASSERT_NULL(cache);
+
+    cache->epoch++;
+
+    while (cache->tail) {
+        font_text_cache_remove(cache, cache->tail);
+    }
+}
+
+void font_text_cache_get_stats(const font_text_cache_t* cache, font_text_cache_stats_t* stats)
+{
+    LV_ASSERT_NULL(cache);
+    LV_ASSERT_NULL(stats);
+
+    *stats = cache->stats;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t font_text_cache_hash(const font_text_key_t* key, uint32_t text_len)
+{
+    uint32_t hash = font_hash_data(FONT_HASH_INIT, key->text, text_len);
+    hash = font_hash_mix(hash, font_hash_ptr(key->font));
+    return font_hash_mix(hash, key->max_width);
+}
+
+static font_text_entry_t* font_text_cache_search(font_text_cache_t* cache, const font_text_key_t* key,
+    uint32_t key_hash, uint32_t text_len)
+{
+    font_hash_node_t* node;
+    FONT_HASH_FOREACH(&cache->entry_hash, key_hash, node)
+    {
+        font_text_entry_t* entry = FONT_HASH_ENTRY(node, font_text_entry_t, hash_node);
+        const char* text = (const char*)(entry->line_start + entry->line_cnt);
+        if (entry->font == key->font
+            && entry->max_width == key->max_width
+            && entry->letter_space == key->letter_space
+            && entry->line_space == key->line_space
+            && entry->flag == key->flag
+            && entry->text_len == text_len
+            && memcmp(text, key->text, text_len) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void font_text_cache_normalize(const font_text_key_t* key, font_text_key_t* norm_key)
+{
+    /* the width doesn't matter when the text isn't wrapped */
+    *norm_key = *key;
+    if (norm_key->flag & LV_TEXT_FLAG_EXPAND) {
+        norm_key->max_width = LV_COORD_MAX;
+    }
+}
+
+static void font_text_cache_add(font_text_cache_t* cache, const font_text_key_t* key, uint32_t key_hash,
+    uint32_t text_len, const lv_point_t* size, const uint32_t* line_arr, uint32_t line_cnt)
+{
+    size_t line_size = line_cnt * sizeof(uint32_t);
+    size_t mem_size = sizeof(font_text_entry_t) + line_size + text_len + 1;
+
+    /* a long text would flush the cache alone */
+    if (mem_size > cache->stats.max_size / 4) {
+        return;
+    }
+
+    while (cache->tail && cache->stats.cur_size + mem_size > cache->stats.max_size) {
+        font_text_cache_remove(cache, cache->tail);
+        cache->stats.evict_cnt++;
+    }
+
+    font_text_entry_t* entry = lv_malloc(mem_size);
+    LV_ASSERT_MALLOC(entry);
+    if (!entry) {
+        LV_LOG_ERROR("malloc failed for font_text_entry_t");
+        return;
+    }
+    lv_memzero(entry, sizeof(font_text_entry_t));
+
+    entry->font = key->font;
+    entry->letter_space = key->letter_space;
+    entry->line_space = key->line_space;
+    entry->max_width = key->max_width;
+    entry->flag = key->flag;
+    entry->size = *size;
+    entry->line_cnt = line_cnt;
+    entry->text_len = text_len;
+    entry->mem_size = mem_size;
+    lv_memcpy(entry->line_start, line_arr, line_size);
+    lv_memcpy(entry->line_start + line_cnt, key->text, text_len + 1);
+
+    font_hash_insert(&cache->entry_hash, &entry->hash_node, key_hash);
+    font_text_cache_link_head(cache, entry);
+
+    cache->stats.entry_cnt++;
+    cache->stats.cur_size += mem_size;
+}
+
+static void font_text_cache_remove(font_text_cache_t* cache, font_text_entry_t* entry)
+{
+    cache->stats.cur_size -= entry->mem_size;
+    cache->stats.entry_cnt--;
+
+    font_hash_remove(&cache->entry_hash, &entry->hash_node);
+    font_text_cache_unlink(cache, entry);
+    lv_free(entry);
+}
+
+static void font_text_cache_link_head(font_text_cache_t* cache, font_text_entry_t* entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+static void font_text_cache_unlink(font_text_cache_t* cache, font_text_entry_t* entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
@@ -0,0 +1,131 @@
+/**
+ * @file font_text_cache.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_TEXT_CACHE_H
+#define FONT_MANAGER_FONT_TEXT_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+#if (UIKIT_FONT_TEXT_CACHE_SIZE > 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_text_cache_t font_text_cache_t;
+
+/* measurement parameters, same as lv_text_get_size */
+typedef struct {
+    const lv_font_t* font;
+    const char* text;
+    int32_t letter_space;
+    int32_t line_space;
+    int32_t max_width;
+    lv_text_flag_t flag;
+} font_text_key_t;
+
+typedef struct {
+    uint32_t hit_cnt;
+    uint32_t miss_cnt;
+    uint32_t evict_cnt;
+    uint32_t entry_cnt;
+    size_t cur_size;
+    size_t max_size;
+} font_text_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a text metrics cache, the caller serializes the calls.
+ * @param max_size maximum bytes to hold.
+ * @return pointer to text metrics cache.
+ */
+font_text_cache_t* font_text_cache_create(size_t max_size);
+
+/**
+ * Delete a text metrics cache.
+ * @param cache pointer to text metrics cache.
+ */
+void font_text_cache_delete(font_text_cache_t* cache);
+
+/**
+ * Look up a measured text.
+ * @param cache pointer to text metrics cache.
+ * @param key measurement parameters.
+ * @param size return the text size, same as lv_text_get_size.
+ * @param line_start return the byte offset of each line, can be NULL.
+ * @param line_max size of line_start.
+ * @param line_cnt return the number of lines, can be greater than line_max.
+ * @return true if found, false if the text has to be measured.
+ */
+bool font_text_cache_lookup(font_text_cache_t* cache, const font_text_key_t* key, lv_point_t* size,
+    uint32_t* line_start, uint32_t line_max, uint32_t* line_cnt);
+
+/**
+ * Add a text measured after a failed lookup.
+ * @param cache pointer to text metrics cache.
+ * @param key measurement parameters.
+ * @param epoch font_text_cache_get_epoch before the text was measured, the
+ *              result is dropped if a font was invalidated meanwhile.
+ * @param size the text size.
+ * @param line_arr byte offset of each line.
+ * @param line_cnt number of lines in line_arr.
+ */
+void font_text_cache_insert(font_text_cache_t* cache, const font_text_key_t* key, uint32_t epoch,
+    const lv_point_t* size, const uint32_t* line_arr, uint32_t line_cnt);
+
+/**
+ * Get the invalidation counter, bumped whenever results are dropped.
+ * @param cache pointer to text metrics cache.
+ * @return the counter.
+ */
+uint32_t font_text_cache_get_epoch(const font_text_cache_t* cache);
+
+/**
+ * Drop the results of a font, call it before the font is deleted.
+ * @param cache pointer to text metrics cache.
+ * @param font pointer to the font.
+ */
+void font_text_cache_drop_font(font_text_cache_t* cache, const lv_font_t* font);
+
+/**
+ * Drop all results.
+ * @param cache pointer to text metrics cache.
+ */
+void font_text_cache_clear(font_text_cache_t* cache);
+
+/**
+ * Get the cache statistics.
+ * @param cache pointer to text metrics cache.
+ * @param stats return the statistics.
+ */
+void font_text_cache_get_stats(const font_text_cache_t* cache, font_text_cache_stats_t* stats);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_TEXT_CACHE_SIZE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_TEXT_CACHE_H */
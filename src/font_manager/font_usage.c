@@ -0,0 +1,472 @@
+/**
+ * @file font_usage.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_usage.h"
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+
+#include "font_hash.h"
+#include "font_utils.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* glyph entry: letter << 8 | font slot, 0 is a free entry */
+#define FONT_USAGE_SLOT_BITS 8
+#define FONT_USAGE_SLOT_MAX 254
+#define FONT_USAGE_LETTER_MAX 0x10FFFF
+
+/* a LEB128 letter delta takes up to 3 bytes */
+#define FONT_USAGE_VARINT_MAX 3
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+struct _font_usage_font_t {
+    lv_freetype_info_t ft_info; /* name points to name_buf */
+    uint32_t letter_cnt;
+    uint8_t slot; /* index in font_arr + 1 */
+    char name_buf[];
+};
+
+typedef struct _font_usage_t {
+    font_usage_font_t** font_arr;
+    uint32_t font_cnt;
+    uint32_t font_max;
+    uint32_t* glyph_arr; /* open addressing, 1 << glyph_bits entries */
+    uint32_t glyph_bits;
+    uint32_t glyph_cnt;
+    uint32_t glyph_max;
+} font_usage_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static uint32_t font_usage_collect(const font_usage_t* usage, uint8_t slot, uint32_t* letter_arr);
+static int font_usage_letter_cmp(const void* a, const void* b);
+static uint8_t* font_usage_put_u16(uint8_t* p, uint16_t value);
+static uint8_t* font_usage_put_u32(uint8_t* p, uint32_t value);
+static uint16_t font_usage_get_u16(const uint8_t* p);
+static uint32_t font_usage_get_u32(const uint8_t* p);
+static bool font_usage_parse(const uint8_t* body, size_t body_size, uint32_t font_cnt, font_usage_item_t* item_arr,
+    uint32_t* letter_buf, char* name_buf, uint32_t* letter_total, size_t* name_total);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/* Fibonacci hashing on the top bits, neighbouring codepoints land apart */
+#define FONT_USAGE_HASH(entry, bits) (((entry) * 2654435761u) >> (32 - (bits)))
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_usage_t* font_usage_create(uint32_t font_max, uint32_t glyph_max)
+{
+    font_max = LV_CLAMP(1, font_max, FONT_USAGE_SLOT_MAX);
+    glyph_max = LV_CLAMP(1, glyph_max, UINT16_MAX);
+
+    /* at most half full, the lookups stop at the first free entry */
+    uint32_t glyph_bits = 4;
+    while ((1u << glyph_bits) < glyph_max * 2) {
+        glyph_bits++;
+    }
+
+    size_t font_arr_size = font_max * sizeof(font_usage_font_t*);
+    size_t glyph_arr_size = (1u << glyph_bits) * sizeof(uint32_t);
+    font_usage_t* usage = lv_malloc(sizeof(font_usage_t) + font_arr_size + glyph_arr_size);
+    LV_ASSERT_MALLOC(usage);
+    if (!usage) {
+        LV_LOG_ERROR("malloc failed for font_usage_t");
+        return NULL;
+    }
+    lv_memzero(usage, sizeof(font_usage_t) + font_arr_size + glyph_arr_size);
+
+    usage->font_arr = (font_usage_font_t**)(usage + 1);
+    usage->font_max = font_max;
+    usage->glyph_arr = (uint32_t*)((uint8_t*)usage->font_arr + font_arr_size);
+    usage->glyph_bits = glyph_bits;
+    usage->glyph_max = glyph_max;
+
+    LV_LOG_INFO("success, font_max: %" LV_PRIu32 ", glyph_max: %" LV_PRIu32, font_max, glyph_max);
+    return usage;
+}
+
+void font_usage_delete(font_usage_t* usage)
+{
+    LV_ASSERT_NULL(usage);
+
+    for (uint32_t i = 0; i < usage->font_cnt; i++) {
+        lv_free(usage->font_arr[i]);
+    }
+
+    lv_free(usage);
+}
+
+font_usage_font_t* font_usage_get_font(font_usage_t* usage, const lv_freetype_info_t* ft_info)
+{
+    LV_ASSERT_NULL(usage);
+    LV_ASSERT_NULL(ft_info);
+
+    for (uint32_t i = 0; i < usage->font_cnt; i++) {
+        font_usage_font_t* font = usage->font_arr[i];
+        if (font->ft_info.size == ft_info->size && font->ft_info.style == ft_info->style
+            && strcmp(font->ft_info.name, ft_info->name) == 0) {
+            return font;
+        }
+    }
+
+    size_t name_len = strlen(ft_info->name);
+    if (usage->font_cnt >= usage->font_max || name_len > UINT8_MAX) {
+        LV_LOG_INFO("font %s(%d) not recorded", ft_info->name, ft_info->size);
+        return NULL;
+    }
+
+    font_usage_font_t* font = lv_malloc(sizeof(font_usage_font_t) + name_len + 1);
+    LV_ASSERT_MALLOC(font);
+    if (!font) {
+        LV_LOG_ERROR("malloc failed for font_usage_font_t");
+        return NULL;
+    }
+    lv_memzero(font, sizeof(font_usage_font_t));
+
+    lv_memcpy(font->name_buf, ft_info->name, name_len + 1);
+    font->ft_info = *ft_info;
+    font->ft_info.name = font->name_buf;
+    font->slot = (uint8_t)(usage->font_cnt + 1);
+
+    usage->font_arr[usage->font_cnt++] = font;
+    return font;
+}
+
+void font_usage_record(font_usage_t* usage, font_usage_font_t* font, uint32_t letter)
+{
+    LV_ASSERT_NULL(usage);
+    LV_ASSERT_NULL(font);
+
+    if (letter > FONT_USAGE_LETTER_MAX) {
+        return;
+    }
+
+    uint32_t entry = letter << FONT_USAGE_SLOT_BITS | font->slot;
+    uint32_t mask = (1u << usage->glyph_bits) - 1;
+    uint32_t i = FONT_USAGE_HASH(entry, usage->glyph_bits);
+    while (usage->glyph_arr[i] != 0) {
+        if (usage->glyph_arr[i] == entry) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* the first glyphs of the boot are the ones worth warming up */
+    if (usage->glyph_cnt >= usage->glyph_max) {
+        return;
+    }
+
+    usage->glyph_arr[i] = entry;
+    usage->glyph_cnt++;
+    font->letter_cnt++;
+}
+
+uint32_t font_usage_get_glyph_cnt(const font_usage_t* usage)
+{
+    LV_ASSERT_NULL(usage);
+    return usage->glyph_cnt;
+}
+
+uint8_t* font_usage_serialize(font_usage_t* usage, size_t* size)
+{
+    LV_ASSERT_NULL(usage);
+    LV_ASSERT_NULL(size);
+
+    /* upper bound, records and letters */
+    size_t max_size = sizeof(font_usage_header_t) + usage->glyph_cnt * FONT_USAGE_VARINT_MAX;
+    for (uint32_t i = 0; i < usage->font_cnt; i++) {
+        max_size += 1 + strlen(usage->font_arr[i]->ft_info.name) + 3 * sizeof(uint16_t);
+    }
+
+    uint8_t* data = lv_malloc(max_size);
+    uint32_t* letter_arr = lv_malloc(LV_MAX(usage->glyph_cnt, 1) * sizeof(uint32_t));
+    LV_ASSERT_MALLOC(data);
+    LV_ASSERT_MALLOC(letter_arr);
+    if (!data || !letter_arr) {
+        LV_LOG_ERROR("malloc failed for profile data");
+        lv_free(data);
+        lv_free(letter_arr);
+        return NULL;
+    }
+
+    uint8_t* body = data + sizeof(font_usage_header_t);
+    uint8_t* p = body;
+    uint16_t font_cnt = 0;
+
+    for (uint32_t i = 0; i < usage->font_cnt; i++) {
+        const font_usage_font_t* font = usage->font_arr[i];
+        if (font->letter_cnt == 0) {
+            continue;
+        }
+
+        uint32_t letter_cnt = font_usage_collect(usage, font->slot, letter_arr);
+        qsort(letter_arr, letter_cnt, sizeof(uint32_t), font_usage_letter_cmp);
+
+        size_t name_len = strlen(font->ft_info.name);
+        *p++ = (uint8_t)name_len;
+        lv_memcpy(p, font->ft_info.name, name_len);
+        p += name_len;
+        p = font_usage_put_u16(p, font->ft_info.size);
+        p = font_usage_put_u16(p, font->ft_info.style);
+        p = font_usage_put_u16(p, (uint16_t)letter_cnt);
+
+        uint32_t prev = 0;
+        for (uint32_t j = 0; j < letter_cnt; j++) {
+            uint32_t delta = letter_arr[j] - prev;
+            prev = letter_arr[j];
+            do {
+                uint8_t byte = delta & 0x7F;
+                delta >>= 7;
+                *p++ = delta ? (byte | 0x80) : byte;
+            } while (delta);
+        }
+
+        font_cnt++;
+    }
+
+    lv_free(letter_arr);
+
+    uint32_t body_size = (uint32_t)(p - body);
+    uint8_t* h = data;
+    h = font_usage_put_u32(h, FONT_USAGE_MAGIC);
+    h = font_usage_put_u16(h, FONT_USAGE_VERSION);
+    h = font_usage_put_u16(h, font_cnt);
+    h = font_usage_put_u32(h, body_size);
+    font_usage_put_u32(h, font_hash_data(FONT_HASH_INIT, body, body_size));
+
+    *size = sizeof(font_usage_header_t) + body_size;
+
+    LV_LOG_INFO("%d fonts, %" LV_PRIu32 " glyphs, %" LV_PRIu32 " bytes", font_cnt, usage->glyph_cnt, (uint32_t)*size);
+    return data;
+}
+
+bool font_usage_write(const char* path, const uint8_t* data, size_t size)
+{
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(data);
+
+    char tmp_path[PATH_MAX];
+    int len = lv_snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (len >= (int)sizeof(tmp_path)) {
+        LV_LOG_WARN("path truncation detected, len = %d", len);
+        return false;
+    }
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        LV_LOG_WARN("open %s failed", tmp_path);
+        return false;
+    }
+
+    bool is_ok = write(fd, data, size) == (ssize_t)size;
+    is_ok = fsync(fd) == 0 && is_ok;
+    close(fd);
+
+    if (!is_ok || rename(tmp_path, path) != 0) {
+        LV_LOG_WARN("write %s failed", path);
+        unlink(tmp_path);
+        return false;
+    }
+
+    LV_LOG_INFO("profile: %s saved, %" LV_PRIu32 " bytes", path, (uint32_t)size);
+    return true;
+}
+
+font_usage_item_t* font_usage_load(const char* path, uint32_t* item_cnt)
+{
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(item_cnt);
+    *item_cnt = 0;
+
+    if (access(path, F_OK) != 0) {
+        LV_LOG_INFO("no profile: %s", path);
+        return NULL;
+    }
+
+    const uint8_t* data;
+    size_t data_size;
+    bool is_mapped;
+    if (!font_utils_file_map(path, &data, &data_size, &is_mapped)) {
+        return NULL;
+    }
+
+    font_usage_item_t* item_arr = NULL;
+    const uint8_t* body = data + sizeof(font_usage_header_t);
+    uint32_t font_cnt = 0;
+    uint32_t body_size = 0;
+    if (data_size >= sizeof(font_usage_header_t)) {
+        font_cnt = font_usage_get_u16(data + offsetof(font_usage_header_t, font_cnt));
+        body_size = font_usage_get_u32(data + offsetof(font_usage_header_t, body_size));
+    }
+
+    uint32_t letter_total = 0;
+    size_t name_total = 0;
+    if (data_size < sizeof(font_usage_header_t)
+        || font_usage_get_u32(data) != FONT_USAGE_MAGIC
+        || font_usage_get_u16(data + offsetof(font_usage_header_t, version)) != FONT_USAGE_VERSION
+        || body_size != data_size - sizeof(font_usage_header_t)
+        || font_usage_get_u32(data + offsetof(font_usage_header_t, checksum)) != font_hash_data(FONT_HASH_INIT, body, body_size)
+        || !font_usage_parse(body, body_size, font_cnt, NULL, NULL, NULL, &letter_total, &name_total)) {
+        LV_LOG_WARN("profile: %s is invalid", path);
+        goto unmap;
+    }
+
+    /* the items, then the letters and the names */
+    size_t item_arr_size = font_cnt * sizeof(font_usage_item_t);
+    size_t letter_arr_size = letter_total * sizeof(uint32_t);
+    item_arr = lv_malloc(LV_MAX(item_arr_size + letter_arr_size + name_total, 1));
+    LV_ASSERT_MALLOC(item_arr);
+    if (!item_arr) {
+        LV_LOG_ERROR("malloc failed for profile items");
+        goto unmap;
+    }
+    lv_memzero(item_arr, item_arr_size);
+
+    uint32_t* letter_buf = (uint32_t*)(item_arr + font_cnt);
+    char* name_buf = (char*)(letter_buf + letter_total);
+    font_usage_parse(body, body_size, font_cnt, item_arr, letter_buf, name_buf, &letter_total, &name_total);
+    *item_cnt = font_cnt;
+
+    LV_LOG_INFO("profile: %s load OK, %" LV_PRIu32 " fonts", path, font_cnt);
+
+unmap:
+    font_utils_file_unmap(data, data_size, is_mapped);
+    return item_arr;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t font_usage_collect(const font_usage_t* usage, uint8_t slot, uint32_t* letter_arr)
+{
+    uint32_t cnt = 0;
+    uint32_t glyph_cap = 1u << usage->glyph_bits;
+    for (uint32_t i = 0; i < glyph_cap; i++) {
+        uint32_t entry = usage->glyph_arr[i];
+        if (entry != 0 && (entry & 0xFF) == slot) {
+            letter_arr[cnt++] = entry >> FONT_USAGE_SLOT_BITS;
+        }
+    }
+
+    return cnt;
+}
+
+static int font_usage_letter_cmp(const void* a, const void* b)
+{
+    uint32_t letter_a = *(const uint32_t*)a;
+    uint32_t letter_b = *(const uint32_t*)b;
+    return letter_a < letter_b ? -1 : letter_a > letter_b;
+}
+
+static uint8_t* font_usage_put_u16(uint8_t* p, uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+static uint8_t* font_usage_put_u32(uint8_t* p, uint32_t value)
+{
+    p = font_usage_put_u16(p, value & 0xFFFF);
+    return font_usage_put_u16(p, value >> 16);
+}
+
+static uint16_t font_usage_get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t font_usage_get_u32(const uint8_t* p)
+{
+    return font_usage_get_u16(p) | (uint32_t)font_usage_get_u16(p + 2) << 16;
+}
+
+static bool font_usage_parse(const uint8_t* body, size_t body_size, uint32_t font_cnt, font_usage_item_t* item_arr,
+    uint32_t* letter_buf, char* name_buf, uint32_t* letter_total, size_t* name_total)
+{
+    /* item_arr, letter_buf and name_buf are NULL to check the body and count the letters and names */
+    const uint8_t* p = body;
+    const uint8_t* end = body + body_size;
+    *letter_total = 0;
+    *name_total = 0;
+
+    for (uint32_t i = 0; i < font_cnt; i++) {
+        if (end - p < 1 || end - p < 1 + p[0] + 3 * (ptrdiff_t)sizeof(uint16_t)) {
+            return false;
+        }
+
+        uint8_t name_len = *p++;
+        const char* name = (const char*)p;
+        p += name_len;
+        uint16_t size = font_usage_get_u16(p);
+        uint16_t style = font_usage_get_u16(p + 2);
+        uint16_t letter_cnt = font_usage_get_u16(p + 4);
+        p += 3 * sizeof(uint16_t);
+
+        if (item_arr) {
+            font_usage_item_t* item = &item_arr[i];
+            char* item_name = name_buf + *name_total;
+            lv_memcpy(item_name, name, name_len);
+            item_name[name_len] = '\0';
+            item->ft_info.name = item_name;
+            item->ft_info.size = size;
+            item->ft_info.style = style;
+            item->letter_arr = letter_buf + *letter_total;
+            item->letter_cnt = letter_cnt;
+        }
+
+        uint32_t letter = 0;
+        for (uint32_t j = 0; j < letter_cnt; j++) {
+            uint32_t delta = 0;
+            for (uint32_t shift = 0;; shift += 7) {
+                if (p >= end || shift >= 7 * FONT_USAGE_VARINT_MAX) {
+                    return false;
+                }
+                uint8_t byte = *p++;
+                delta |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+            }
+
+            letter += delta;
+            if (letter_buf) {
+                letter_buf[*letter_total + j] = letter;
+            }
+        }
+
+        *letter_total += letter_cnt;
+        *name_total += name_len + 1;
+    }
+
+    return p == end;
+}
+
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
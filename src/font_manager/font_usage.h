@@ -0,0 +1,133 @@
+/**
+ * @file font_usage.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_USAGE_H
+#define FONT_MANAGER_FONT_USAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include "font_utils.h"
+#include <lvgl/lvgl.h>
+
+#if UIKIT_FONT_USE_USAGE_PROFILE
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* "UFUP" */
+#define FONT_USAGE_MAGIC 0x50554655
+#define FONT_USAGE_VERSION 1
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* file header, little endian, followed by one record per font:
+ * name length (u8), name, size (u16), style (u16), letter count (u16),
+ * then the letters in ascending order, each as the LEB128 delta to the previous one
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t font_cnt;
+    uint32_t body_size;
+    uint32_t checksum; /* font_hash_data of the body */
+} font_usage_header_t;
+
+typedef struct _font_usage_t font_usage_t;
+typedef struct _font_usage_font_t font_usage_font_t;
+
+/* a font of a loaded profile */
+typedef struct {
+    lv_freetype_info_t ft_info;
+    const uint32_t* letter_arr; /* ascending */
+    uint32_t letter_cnt;
+} font_usage_item_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a usage recorder, the caller serializes the calls.
+ * @param font_max maximum number of fonts to record, up to 254.
+ * @param glyph_max maximum number of glyphs to record over all fonts.
+ * @return pointer to usage recorder.
+ */
+font_usage_t* font_usage_create(uint32_t font_max, uint32_t glyph_max);
+
+/**
+ * Delete a usage recorder.
+ * @param usage pointer to usage recorder.
+ */
+void font_usage_delete(font_usage_t* usage);
+
+/**
+ * Get the record of a font, it lives as long as the recorder.
+ * @param usage pointer to usage recorder.
+ * @param ft_info font info.
+ * @return pointer to the font record, NULL if the recorder is full.
+ */
+font_usage_font_t* font_usage_get_font(font_usage_t* usage, const lv_freetype_info_t* ft_info);
+
+/**
+ * Record a letter drawn with a font, nothing is done once the recorder is full.
+ * @param usage pointer to usage recorder.
+ * @param font pointer to the font record.
+ * @param letter unicode letter.
+ */
+void font_usage_record(font_usage_t* usage, font_usage_font_t* font, uint32_t letter);
+
+/**
+ * Get the number of glyphs recorded, it only grows.
+ * @param usage pointer to usage recorder.
+ * @return glyph count.
+ */
+uint32_t font_usage_get_glyph_cnt(const font_usage_t* usage);
+
+/**
+ * Build the profile file of the recorded usage, the fonts without letters are skipped.
+ * @param usage pointer to usage recorder.
+ * @param size return the file size.
+ * @return the file data to free with lv_free, NULL on failure.
+ */
+uint8_t* font_usage_serialize(font_usage_t* usage, size_t* size);
+
+/**
+ * Write a profile file, through a temporary file so that a power loss keeps the old one.
+ * @param path profile file path.
+ * @param data the file data.
+ * @param size the file size.
+ * @return return true on success.
+ */
+bool font_usage_write(const char* path, const uint8_t* data, size_t size);
+
+/**
+ * Load a profile file.
+ * @param path profile file path.
+ * @param item_cnt return the number of fonts.
+ * @return the fonts in one block to free with lv_free, NULL if there is no valid profile.
+ */
+font_usage_item_t* font_usage_load(const char* path, uint32_t* item_cnt);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* UIKIT_FONT_USE_USAGE_PROFILE */
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_USAGE_H */
@@ -7,23 +7,29 @@
  *      INCLUDES
  *********************/
 #include "font_utils.h"
+#include "font_cfg.h"
 #include <cJSON.h>
 #include <lvgl/lvgl.h>
+#include <lvgl/src/libs/freetype/lv_freetype_private.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /*********************
  *      DEFINES
  *********************/
 
-#define JSON_GET_VALUE_STRING(cjson_obj, value_dest, name)          \
-    do {                                                            \
-        cJSON* it = cJSON_GetObjectItem((cjson_obj), name);         \
-        if (!it) {                                                  \
-            LV_LOG_WARN("can't get valuestring item: " name);       \
-            goto failed;                                            \
-        }                                                           \
-        strncpy((value_dest), it->valuestring, sizeof(value_dest)); \
-        (value_dest)[sizeof(value_dest) - 1] = '\0';                \
+#define JSON_GET_VALUE_STR_OFFSET(cjson_obj, str_table, value_dest, name)      \
+    do {                                                                       \
+        cJSON* it = cJSON_GetObjectItem((cjson_obj), name);                    \
+        if (!cJSON_IsString(it)) {                                             \
+            LV_LOG_WARN("can't get valuestring item: " name);                  \
+            goto failed;                                                       \
+        }                                                                      \
+        (value_dest) = font_utils_str_table_add((str_table), it->valuestring); \
     } while (0)
 
 #define JSON_GET_VALUE_INT(cjson_obj, value_dest, name)     \
@@ -48,9 +54,13 @@
 #define JSON_ITEM_STR_UNICODE_RANGE "unicode-range"
 #define JSON_ITEM_STR_BEGIN "begin"
 #define JSON_ITEM_STR_END "end"
+#define JSON_ITEM_STR_SEQUENCES "sequences"
+#define JSON_ITEM_STR_CODEPOINTS "codepoints"
+#define JSON_ITEM_STR_IMAGE "image"
 
 #define JSON_ITEM_STR_FONT_FAMILY "font-family"
 #define JSON_ITEM_STR_FALLBACK "fallback"
+#define JSON_ITEM_STR_SDF "sdf"
 
 /**********************
  *      TYPEDEFS
@@ -61,14 +71,72 @@ typedef struct _font_utils_json_obj_t {
     char* json_buffer;
 } font_utils_json_obj_t;
 
+/* string table under construction */
+typedef struct {
+    char* buf;
+    size_t size;
+} font_utils_str_table_t;
+
+/* emoji sequence under construction */
+typedef struct {
+    const uint32_t* unicode_arr;
+    uint32_t unicode_cnt;
+    uint32_t image; /* string offset */
+} font_utils_seq_t;
+
+/* sequence trie under construction */
+typedef struct {
+    font_cfg_seq_t* node_arr;
+    uint32_t node_cnt;
+} font_utils_seq_trie_t;
+
+/* block freetype took while counting */
+typedef struct {
+    void* block;
+    long size;
+} font_utils_ft_block_t;
+
+/* freetype memory hook, set under the freetype lock while counting */
+typedef struct {
+    FT_Memory memory;
+    FT_Alloc_Func alloc;
+    FT_Free_Func free;
+    FT_Realloc_Func realloc;
+    font_utils_ft_block_t* block_arr;
+    uint32_t block_cnt;
+    uint32_t block_max;
+    long used;
+} font_utils_ft_mem_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
+#if UIKIT_FONT_USE_FONT_FAMILY
+static size_t font_utils_json_str_size(cJSON* cjson_obj, const char* name);
+static uint32_t font_utils_str_table_add(font_utils_str_table_t* str_table, const char* str);
+static uint32_t font_utils_json_range_cnt(cJSON* cjson_obj);
+static uint32_t font_utils_json_seq_size(cJSON* cjson_obj, size_t* str_size);
+static bool font_utils_json_compile_range(cJSON* cjson_obj, font_cfg_range_t* range_arr, uint32_t* range_cnt);
+static bool font_utils_json_compile_seq(cJSON* cjson_obj, font_utils_str_table_t* str_table,
+    font_utils_seq_trie_t* trie, font_cfg_emoji_t* emoji);
+static int font_utils_range_cmp(const void* a, const void* b);
+static int font_utils_seq_cmp(const void* a, const void* b);
+static void font_utils_seq_trie_build(font_utils_seq_trie_t* trie, const font_utils_seq_t* seq_arr, uint32_t seq_cnt,
+    uint32_t depth, uint32_t* child_index, uint32_t* child_cnt);
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+static void* font_utils_ft_alloc(FT_Memory memory, long size);
+static void font_utils_ft_free(FT_Memory memory, void* block);
+static void* font_utils_ft_realloc(FT_Memory memory, long cur_size, long new_size, void* block);
+static void font_utils_ft_mem_track(void* block, long size);
+static void font_utils_ft_mem_untrack(void* block);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
 
+static font_utils_ft_mem_t ft_mem;
+
 /**********************
  *      MACROS
  **********************/
@@ -175,55 +243,117 @@ void font_utils_json_obj_delete(font_utils_json_obj_t* json_obj)
     lv_free(json_obj);
 }
 
-font_emoji_config_t* font_utils_json_get_emoji_config(font_utils_json_obj_t* json_obj)
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+uint8_t* font_utils_json_compile_cfg(font_utils_json_obj_t* json_obj, size_t* size)
 {
     LV_ASSERT_NULL(json_obj);
+    LV_ASSERT_NULL(size);
     cJSON* cjson = json_obj->cjson;
 
     cJSON* emoji_list_arr = cJSON_GetObjectItem(cjson, JSON_ITEM_STR_EMOJI_LIST);
-    int emoji_list_arr_size = cJSON_GetArraySize(emoji_list_arr);
+    cJSON* font_family_arr = cJSON_GetObjectItem(cjson, JSON_ITEM_STR_FONT_FAMILY);
+    uint32_t emoji_cnt = cJSON_GetArraySize(emoji_list_arr);
+    uint32_t family_cnt = cJSON_GetArraySize(font_family_arr);
 
-    /* check array */
-    if (!emoji_list_arr_size) {
+    if (!emoji_cnt) {
         LV_LOG_WARN(JSON_ITEM_STR_EMOJI_LIST " is empty");
-        return NULL;
     }
 
-    /* create font_emoji_config */
-    font_emoji_config_t* config = lv_malloc(sizeof(font_emoji_config_t));
-    LV_ASSERT_MALLOC(config);
-    if (!config) {
-        LV_LOG_ERROR("malloc failed for font_emoji_config_t");
-        return NULL;
+    if (!family_cnt) {
+        LV_LOG_WARN(JSON_ITEM_STR_FONT_FAMILY " is empty");
     }
-    lv_memzero(config, sizeof(font_emoji_config_t));
 
-    /* create emoji_arr */
-    config->emoji_arr = lv_malloc(sizeof(font_emoji_t) * emoji_list_arr_size);
-    LV_ASSERT_MALLOC(config->emoji_arr);
-    if (!config->emoji_arr) {
-        LV_LOG_ERROR("malloc failed for config->emoji_arr");
-        goto failed;
-    }
-    lv_memzero(config->emoji_arr, sizeof(font_emoji_t) * emoji_list_arr_size);
-    config->emoji_arr_size = emoji_list_arr_size;
+    /* first pass: measure the tables, the trie never has more nodes than codepoints */
+    uint32_t fallback_cnt = 0;
+    uint32_t range_cnt = 0;
+    uint32_t seq_cnt = 0;
+    size_t str_size = 0;
 
-    /* set item */
-    for (int i = 0; i < emoji_list_arr_size; i++) {
+    for (uint32_t i = 0; i < emoji_cnt; i++) {
         cJSON* item = cJSON_GetArrayItem(emoji_list_arr, i);
-        font_emoji_t* emoji = &config->emoji_arr[i];
+        str_size += font_utils_json_str_size(item, JSON_ITEM_STR_FONT_NAME)
+            + font_utils_json_str_size(item, JSON_ITEM_STR_PATH)
+            + font_utils_json_str_size(item, JSON_ITEM_STR_EXT);
+        range_cnt += font_utils_json_range_cnt(cJSON_GetObjectItem(item, JSON_ITEM_STR_UNICODE_RANGE));
+        seq_cnt += font_utils_json_seq_size(cJSON_GetObjectItem(item, JSON_ITEM_STR_SEQUENCES), &str_size);
+    }
 
-        JSON_GET_VALUE_STRING(item, emoji->font_name, JSON_ITEM_STR_FONT_NAME);
+    for (uint32_t i = 0; i < family_cnt; i++) {
+        cJSON* item = cJSON_GetArrayItem(font_family_arr, i);
+        str_size += font_utils_json_str_size(item, JSON_ITEM_STR_FONT_NAME);
 
-        JSON_GET_VALUE_STRING(item, emoji->path, JSON_ITEM_STR_PATH);
-        emoji->path_len = strlen(emoji->path);
+        cJSON* fallback_arr = cJSON_GetObjectItem(item, JSON_ITEM_STR_FALLBACK);
+        int fallback_arr_size = cJSON_GetArraySize(fallback_arr);
+        for (int j = 0; j < fallback_arr_size; j++) {
+            /* a name, or an object with the name and the unicode ranges it covers */
+            cJSON* fallback_item = cJSON_GetArrayItem(fallback_arr, j);
+            if (cJSON_IsString(fallback_item)) {
+                str_size += strlen(fallback_item->valuestring) + 1;
+            } else {
+                str_size += font_utils_json_str_size(fallback_item, JSON_ITEM_STR_FONT_NAME);
+                range_cnt += font_utils_json_range_cnt(cJSON_GetObjectItem(fallback_item, JSON_ITEM_STR_UNICODE_RANGE));
+            }
+        }
+        fallback_cnt += fallback_arr_size;
+    }
 
-        JSON_GET_VALUE_STRING(item, emoji->ext, JSON_ITEM_STR_EXT);
-        emoji->ext_len = strlen(emoji->ext);
+    size_t emoji_offset = sizeof(font_cfg_header_t);
+    size_t family_offset = emoji_offset + sizeof(font_cfg_emoji_t) * emoji_cnt;
+    size_t fallback_offset = family_offset + sizeof(font_cfg_family_t) * family_cnt;
+    size_t cover_offset = fallback_offset + sizeof(uint32_t) * fallback_cnt;
+    size_t range_offset = cover_offset + sizeof(font_cfg_cover_t) * fallback_cnt;
+    size_t seq_offset = range_offset + sizeof(font_cfg_range_t) * range_cnt;
+    size_t str_offset = seq_offset + sizeof(font_cfg_seq_t) * seq_cnt;
+    size_t data_size = str_offset + str_size;
+
+    uint8_t* data = lv_malloc(data_size);
+    LV_ASSERT_MALLOC(data);
+    if (!data) {
+        LV_LOG_ERROR("malloc failed for font config image");
+        return NULL;
+    }
+    lv_memzero(data, data_size);
+
+    font_cfg_header_t* header = (font_cfg_header_t*)data;
+    header->magic = FONT_CFG_MAGIC;
+    header->version = FONT_CFG_VERSION;
+    header->header_size = sizeof(font_cfg_header_t);
+    header->emoji_cnt = emoji_cnt;
+    header->emoji_offset = emoji_offset;
+    header->family_cnt = family_cnt;
+    header->family_offset = family_offset;
+    header->fallback_cnt = fallback_cnt;
+    header->fallback_offset = fallback_offset;
+    header->cover_offset = cover_offset;
+    header->range_offset = range_offset;
+    header->seq_offset = seq_offset;
+    header->str_offset = str_offset;
+    header->str_size = str_size;
+
+    /* second pass: fill the tables */
+    font_utils_str_table_t str_table = { (char*)data + str_offset, 0 };
+
+    font_cfg_emoji_t* emoji_arr = (font_cfg_emoji_t*)(data + emoji_offset);
+    font_cfg_range_t* range_table = (font_cfg_range_t*)(data + range_offset);
+    font_utils_seq_trie_t seq_trie = { (font_cfg_seq_t*)(data + seq_offset), 0 };
+    uint32_t range_index = 0;
+    for (uint32_t i = 0; i < emoji_cnt; i++) {
+        cJSON* item = cJSON_GetArrayItem(emoji_list_arr, i);
+        font_cfg_emoji_t* emoji = &emoji_arr[i];
+        int value;
+
+        JSON_GET_VALUE_STR_OFFSET(item, &str_table, emoji->font_name, JSON_ITEM_STR_FONT_NAME);
+        JSON_GET_VALUE_STR_OFFSET(item, &str_table, emoji->path, JSON_ITEM_STR_PATH);
+        JSON_GET_VALUE_STR_OFFSET(item, &str_table, emoji->ext, JSON_ITEM_STR_EXT);
+        emoji->path_len = strlen(str_table.buf + emoji->path);
+        emoji->ext_len = strlen(str_table.buf + emoji->ext);
 
         cJSON* match_size = cJSON_GetObjectItem(item, JSON_ITEM_STR_MATCH_SIZE);
-        JSON_GET_VALUE_INT(match_size, emoji->match_size.min, JSON_ITEM_STR_MIN);
-        JSON_GET_VALUE_INT(match_size, emoji->match_size.max, JSON_ITEM_STR_MAX);
+        JSON_GET_VALUE_INT(match_size, value, JSON_ITEM_STR_MIN);
+        emoji->match_size.min = value;
+        JSON_GET_VALUE_INT(match_size, value, JSON_ITEM_STR_MAX);
+        emoji->match_size.max = value;
 
         /* check match_size */
         if (emoji->match_size.min > emoji->match_size.max) {
@@ -231,152 +361,557 @@ font_emoji_config_t* font_utils_json_get_emoji_config(font_utils_json_obj_t* jso
                 emoji->match_size.min, emoji->match_size.max);
         }
 
-        cJSON* unicode_range = cJSON_GetObjectItem(item, JSON_ITEM_STR_UNICODE_RANGE);
-        JSON_GET_VALUE_INT(unicode_range, emoji->unicode_range.begin, JSON_ITEM_STR_BEGIN);
-        JSON_GET_VALUE_INT(unicode_range, emoji->unicode_range.end, JSON_ITEM_STR_END);
+        /* merged ranges take no more slots than measured, unused slots stay at the end */
+        emoji->range_index = range_index;
+        if (!font_utils_json_compile_range(cJSON_GetObjectItem(item, JSON_ITEM_STR_UNICODE_RANGE),
+                &range_table[range_index], &emoji->range_cnt)) {
+            goto failed;
+        }
+        range_index += emoji->range_cnt;
 
-        /* check unicode_range */
-        if (emoji->unicode_range.begin > emoji->unicode_range.end) {
-            LV_LOG_WARN("unicode_range.begin(%" LV_PRIu32 ") > unicode_range.end(%" LV_PRIu32 ")",
-                emoji->unicode_range.begin, emoji->unicode_range.end);
+        if (!font_utils_json_compile_seq(cJSON_GetObjectItem(item, JSON_ITEM_STR_SEQUENCES),
+                &str_table, &seq_trie, emoji)) {
+            goto failed;
         }
     }
 
-    return config;
+    header->seq_cnt = seq_trie.node_cnt;
 
-failed:
-    if (config) {
-        font_utils_json_emoji_config_free(config);
+    font_cfg_family_t* family_arr = (font_cfg_family_t*)(data + family_offset);
+    uint32_t* fallback_table = (uint32_t*)(data + fallback_offset);
+    font_cfg_cover_t* cover_table = (font_cfg_cover_t*)(data + cover_offset);
+    uint32_t fallback_index = 0;
+    for (uint32_t i = 0; i < family_cnt; i++) {
+        cJSON* item = cJSON_GetArrayItem(font_family_arr, i);
+        font_cfg_family_t* font_family = &family_arr[i];
+
+        JSON_GET_VALUE_STR_OFFSET(item, &str_table, font_family->font_name, JSON_ITEM_STR_FONT_NAME);
+
+        cJSON* fallback_arr = cJSON_GetObjectItem(item, JSON_ITEM_STR_FALLBACK);
+        int fallback_arr_size = cJSON_GetArraySize(fallback_arr);
+
+        /* check fallback array */
+        if (!fallback_arr_size) {
+            LV_LOG_ERROR(JSON_ITEM_STR_FALLBACK " is empty");
+            goto failed;
+        }
+
+        font_family->fallback_index = fallback_index;
+        font_family->fallback_cnt = fallback_arr_size;
+        font_family->flags = cJSON_IsTrue(cJSON_GetObjectItem(item, JSON_ITEM_STR_SDF)) ? FONT_CFG_FAMILY_FLAG_SDF : 0;
+
+        for (int j = 0; j < fallback_arr_size; j++) {
+            cJSON* fallback_item = cJSON_GetArrayItem(fallback_arr, j);
+            font_cfg_cover_t* cover = &cover_table[fallback_index];
+            if (cJSON_IsString(fallback_item)) {
+                fallback_table[fallback_index++] = font_utils_str_table_add(&str_table, fallback_item->valuestring);
+                continue;
+            }
+
+            if (!cJSON_IsObject(fallback_item)) {
+                LV_LOG_ERROR("can't get fallback_item [%d]", j);
+                goto failed;
+            }
+
+            JSON_GET_VALUE_STR_OFFSET(fallback_item, &str_table, fallback_table[fallback_index],
+                JSON_ITEM_STR_FONT_NAME);
+
+            /* without ranges the fallback is asked for any unicode */
+            cover->range_index = range_index;
+            cJSON* range_obj = cJSON_GetObjectItem(fallback_item, JSON_ITEM_STR_UNICODE_RANGE);
+            if (range_obj && !font_utils_json_compile_range(range_obj, &range_table[range_index], &cover->range_cnt)) {
+                goto failed;
+            }
+            range_index += cover->range_cnt;
+            fallback_index++;
+        }
     }
+
+    header->range_cnt = range_index;
+
+    LV_ASSERT(str_table.size == str_size);
+
+    *size = data_size;
+    return data;
+
+failed:
+    lv_free(data);
     return NULL;
 }
 
-font_family_config_t* font_utils_json_get_font_family_config(font_utils_json_obj_t* json_obj)
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+bool font_utils_ft_info_is_equal(const lv_freetype_info_t* ft_info_1, const lv_freetype_info_t* ft_info_2)
 {
-    LV_ASSERT_NULL(json_obj);
-    cJSON* cjson = json_obj->cjson;
+    LV_ASSERT_NULL(ft_info_1);
+    LV_ASSERT_NULL(ft_info_2);
 
-    cJSON* font_family_arr = cJSON_GetObjectItem(cjson, JSON_ITEM_STR_FONT_FAMILY);
-    int font_family_arr_size = cJSON_GetArraySize(font_family_arr);
+    bool is_equal = (ft_info_1->size == ft_info_2->size
+        && ft_info_1->style == ft_info_2->style
+        && strcmp(ft_info_1->name, ft_info_2->name) == 0);
 
-    /* check array */
-    if (!font_family_arr_size) {
-        LV_LOG_WARN("font-family is empty");
-        return NULL;
+    return is_equal;
+}
+
+void* font_utils_get_ft_memory(const lv_font_t* font)
+{
+    LV_ASSERT_NULL(font);
+    const lv_freetype_font_dsc_t* dsc = font->dsc;
+    FT_Face face = dsc->cache_node->face;
+    return face ? face->memory : NULL;
+}
+
+void font_utils_ft_mem_count_begin(void* ft_memory)
+{
+    LV_ASSERT_NULL(ft_memory);
+    LV_ASSERT(ft_mem.memory == NULL);
+
+    /* only freetype goes through the hook, allocations of other threads aren't seen */
+    FT_Memory memory = ft_memory;
+    ft_mem.memory = memory;
+    ft_mem.alloc = memory->alloc;
+    ft_mem.free = memory->free;
+    ft_mem.realloc = memory->realloc;
+    ft_mem.block_cnt = 0;
+    ft_mem.used = 0;
+
+    memory->alloc = font_utils_ft_alloc;
+    memory->free = font_utils_ft_free;
+    memory->realloc = font_utils_ft_realloc;
+}
+
+size_t font_utils_ft_mem_count_end(void)
+{
+    LV_ASSERT_NULL(ft_mem.memory);
+
+    FT_Memory memory = ft_mem.memory;
+    memory->alloc = ft_mem.alloc;
+    memory->free = ft_mem.free;
+    memory->realloc = ft_mem.realloc;
+    ft_mem.memory = NULL;
+
+    lv_free(ft_mem.block_arr);
+    ft_mem.block_arr = NULL;
+    ft_mem.block_cnt = 0;
+    ft_mem.block_max = 0;
+
+    /* negative when freetype released more older blocks than it took */
+    return ft_mem.used > 0 ? (size_t)ft_mem.used : 0;
+}
+
+uint32_t font_utils_get_text_lines(const lv_font_t* font, const char* text, int32_t letter_space, int32_t line_space,
+    int32_t max_width, lv_text_flag_t flag, lv_point_t* size, uint32_t* line_start, uint32_t line_max)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT_NULL(text);
+    LV_ASSERT_NULL(size);
+
+    /* same walk as lv_text_get_size, which doesn't report the line breaks */
+    if (flag & LV_TEXT_FLAG_EXPAND) {
+        max_width = LV_COORD_MAX;
     }
 
-    /* create font_family_config */
-    font_family_config_t* config = lv_malloc(sizeof(font_family_config_t));
-    LV_ASSERT_MALLOC(config);
-    if (!config) {
-        LV_LOG_ERROR("malloc failed for font_family_config_t");
-        return NULL;
+    int32_t letter_height = lv_font_get_line_height(font);
+    uint32_t ofs = 0;
+    uint32_t line_cnt = 0;
+
+    size->x = 0;
+    size->y = 0;
+
+    while (text[ofs] != '\0') {
+        uint32_t line_len = _lv_text_get_next_line(&text[ofs], font, letter_space, max_width, NULL, flag);
+
+        if ((int64_t)size->y + letter_height + line_space > LV_MAX_OF(int32_t)) {
+            break;
+        }
+
+        size->y += letter_height + line_space;
+
+        int32_t line_width = lv_text_get_width(&text[ofs], line_len, font, letter_space);
+        size->x = LV_MAX(line_width, size->x);
+
+        if (line_start && line_cnt < line_max) {
+            line_start[line_cnt] = ofs;
+        }
+
+        line_cnt++;
+        ofs += line_len;
+    }
+
+    /* the text is one line taller if the last character is '\n' or '\r' */
+    if (ofs != 0 && (text[ofs - 1] == '\n' || text[ofs - 1] == '\r')) {
+        size->y += letter_height + line_space;
+    }
+
+    /* remove the last line space, or set the height of an empty text */
+    if (size->y == 0) {
+        size->y = letter_height;
+    } else {
+        size->y -= line_space;
+    }
+
+    return line_cnt;
+}
+
+bool font_utils_file_map(const char* path, const uint8_t** data, size_t* size, bool* is_mapped)
+{
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(data);
+    LV_ASSERT_NULL(size);
+    LV_ASSERT_NULL(is_mapped);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LV_LOG_INFO("can't open file: %s", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        LV_LOG_ERROR("bad file size: %s", path);
+        close(fd);
+        return false;
+    }
+
+    *size = st.st_size;
+
+    /* map the file, pages are loaded on demand */
+    void* addr = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr != MAP_FAILED) {
+        *data = addr;
+        *is_mapped = true;
+        close(fd);
+        return true;
+    }
+
+    /* file system without mmap support, read it */
+    LV_LOG_INFO("mmap failed, read file: %s", path);
+
+    uint8_t* buf = lv_malloc(*size);
+    LV_ASSERT_MALLOC(buf);
+    if (!buf) {
+        LV_LOG_ERROR("malloc failed for file data");
+        close(fd);
+        return false;
     }
-    lv_memzero(config, sizeof(font_family_config_t));
 
-    /* create font_family_arr */
-    config->font_family_arr = lv_malloc(sizeof(font_family_t) * font_family_arr_size);
-    LV_ASSERT_MALLOC(config->font_family_arr);
-    if (!config->font_family_arr) {
-        LV_LOG_ERROR("malloc failed for config->font_family_arr");
+    ssize_t br = read(fd, buf, *size);
+    close(fd);
+    if (br != (ssize_t)*size) {
+        LV_LOG_ERROR("read file failed: %s", path);
+        lv_free(buf);
+        return false;
+    }
+
+    *data = buf;
+    *is_mapped = false;
+    return true;
+}
+
+void font_utils_file_unmap(const uint8_t* data, size_t size, bool is_mapped)
+{
+    LV_ASSERT_NULL(data);
+
+    if (is_mapped) {
+        munmap((void*)data, size);
+    } else {
+        lv_free((void*)data);
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#if UIKIT_FONT_USE_FONT_FAMILY
+
+static size_t font_utils_json_str_size(cJSON* cjson_obj, const char* name)
+{
+    cJSON* it = cJSON_GetObjectItem(cjson_obj, name);
+    return cJSON_IsString(it) ? strlen(it->valuestring) + 1 : 0;
+}
+
+static uint32_t font_utils_str_table_add(font_utils_str_table_t* str_table, const char* str)
+{
+    size_t len = strlen(str) + 1;
+    uint32_t offset = str_table->size;
+    lv_memcpy(str_table->buf + offset, str, len);
+    str_table->size += len;
+    return offset;
+}
+
+static uint32_t font_utils_json_range_cnt(cJSON* cjson_obj)
+{
+    /* a single {begin, end} object, or an array of them */
+    if (cJSON_IsArray(cjson_obj)) {
+        return cJSON_GetArraySize(cjson_obj);
+    }
+
+    return cJSON_IsObject(cjson_obj) ? 1 : 0;
+}
+
+static uint32_t font_utils_json_seq_size(cJSON* cjson_obj, size_t* str_size)
+{
+    uint32_t unicode_cnt = 0;
+    int seq_arr_size = cJSON_GetArraySize(cjson_obj);
+    for (int i = 0; i < seq_arr_size; i++) {
+        cJSON* item = cJSON_GetArrayItem(cjson_obj, i);
+        int codepoint_cnt = cJSON_GetArraySize(cJSON_GetObjectItem(item, JSON_ITEM_STR_CODEPOINTS));
+
+        /* sequences without codepoints are ignored */
+        if (codepoint_cnt) {
+            unicode_cnt += codepoint_cnt;
+            *str_size += font_utils_json_str_size(item, JSON_ITEM_STR_IMAGE);
+        }
+    }
+
+    return unicode_cnt;
+}
+
+static bool font_utils_json_compile_range(cJSON* cjson_obj, font_cfg_range_t* range_arr, uint32_t* range_cnt)
+{
+    uint32_t cnt = font_utils_json_range_cnt(cjson_obj);
+    uint32_t valid_cnt = 0;
+    int value;
+
+    if (!cnt) {
+        LV_LOG_WARN("can't get item: " JSON_ITEM_STR_UNICODE_RANGE);
         goto failed;
     }
-    lv_memzero(config->font_family_arr, sizeof(font_family_t) * font_family_arr_size);
-    config->font_family_arr_size = font_family_arr_size;
 
-    /* set item */
-    for (int font_index = 0; font_index < font_family_arr_size; font_index++) {
-        cJSON* item = cJSON_GetArrayItem(font_family_arr, font_index);
-        if (!item) {
-            LV_LOG_ERROR("can't get font_family_arr item[%d]", font_index);
-            goto failed;
+    for (uint32_t i = 0; i < cnt; i++) {
+        cJSON* item = cJSON_IsArray(cjson_obj) ? cJSON_GetArrayItem(cjson_obj, i) : cjson_obj;
+        font_cfg_range_t* range = &range_arr[valid_cnt];
+
+        JSON_GET_VALUE_INT(item, value, JSON_ITEM_STR_BEGIN);
+        range->begin = value;
+        JSON_GET_VALUE_INT(item, value, JSON_ITEM_STR_END);
+        range->end = value;
+
+        /* check unicode_range */
+        if (range->begin > range->end) {
+            LV_LOG_WARN("unicode_range.begin(%" LV_PRIu32 ") > unicode_range.end(%" LV_PRIu32 "), ignored",
+                range->begin, range->end);
+            continue;
         }
-        font_family_t* font_family = &config->font_family_arr[font_index];
 
-        JSON_GET_VALUE_STRING(item, font_family->font_name, JSON_ITEM_STR_FONT_NAME);
+        valid_cnt++;
+    }
 
-        cJSON* fallback_arr = cJSON_GetObjectItem(item, JSON_ITEM_STR_FALLBACK);
-        int fallback_arr_size = cJSON_GetArraySize(fallback_arr);
+    /* sort and merge, so the ranges can be binary searched */
+    qsort(range_arr, valid_cnt, sizeof(font_cfg_range_t), font_utils_range_cmp);
 
-        /* check fallback array */
-        if (!fallback_arr_size) {
-            LV_LOG_ERROR(JSON_ITEM_STR_FALLBACK " is empty");
-            goto failed;
+    uint32_t merged_cnt = 0;
+    for (uint32_t i = 0; i < valid_cnt; i++) {
+        font_cfg_range_t* last = merged_cnt ? &range_arr[merged_cnt - 1] : NULL;
+        if (last && (uint64_t)range_arr[i].begin <= (uint64_t)last->end + 1) {
+            last->end = LV_MAX(last->end, range_arr[i].end);
+        } else {
+            range_arr[merged_cnt++] = range_arr[i];
         }
+    }
 
-        /* create fallback_arr */
-        font_family->fallback_arr = lv_malloc(sizeof(font_family_fallback_t) * fallback_arr_size);
-        LV_ASSERT_MALLOC(font_family->fallback_arr);
-        if (!font_family->fallback_arr) {
-            LV_LOG_ERROR("malloc failed for font_family->fallback_arr");
-            goto failed;
+    *range_cnt = merged_cnt;
+    return true;
+
+failed:
+    return false;
+}
+
+static bool font_utils_json_compile_seq(cJSON* cjson_obj, font_utils_str_table_t* str_table,
+    font_utils_seq_trie_t* trie, font_cfg_emoji_t* emoji)
+{
+    size_t str_size = 0;
+    uint32_t unicode_cnt = font_utils_json_seq_size(cjson_obj, &str_size);
+    uint32_t seq_cnt = cJSON_GetArraySize(cjson_obj);
+    font_utils_seq_t* seq_arr = NULL;
+    uint32_t* unicode_buf = NULL;
+    uint32_t valid_cnt = 0;
+    bool retval = false;
+
+    emoji->seq_index = trie->node_cnt;
+    emoji->seq_cnt = 0;
+
+    if (!seq_cnt) {
+        return true;
+    }
+
+    seq_arr = lv_malloc(sizeof(font_utils_seq_t) * seq_cnt);
+    unicode_buf = lv_malloc(sizeof(uint32_t) * LV_MAX(unicode_cnt, 1));
+    LV_ASSERT_MALLOC(seq_arr);
+    LV_ASSERT_MALLOC(unicode_buf);
+    if (!seq_arr || !unicode_buf) {
+        LV_LOG_ERROR("malloc failed for emoji sequences");
+        goto failed;
+    }
+
+    uint32_t* unicode_ptr = unicode_buf;
+    for (uint32_t i = 0; i < seq_cnt; i++) {
+        cJSON* item = cJSON_GetArrayItem(cjson_obj, i);
+        cJSON* codepoints = cJSON_GetObjectItem(item, JSON_ITEM_STR_CODEPOINTS);
+        int codepoint_cnt = cJSON_GetArraySize(codepoints);
+        font_utils_seq_t* seq = &seq_arr[valid_cnt];
+
+        if (!codepoint_cnt) {
+            LV_LOG_WARN("sequence[%" LV_PRIu32 "] has no " JSON_ITEM_STR_CODEPOINTS ", ignored", i);
+            continue;
         }
-        lv_memzero(font_family->fallback_arr, sizeof(font_family_fallback_t) * fallback_arr_size);
-        font_family->fallback_arr_size = fallback_arr_size;
-
-        /* set fallback */
-        for (int fallback_index = 0; fallback_index < fallback_arr_size; fallback_index++) {
-            cJSON* fallback_item = cJSON_GetArrayItem(fallback_arr, fallback_index);
-            if (!fallback_item) {
-                LV_LOG_ERROR("can't get fallback_item [%d]", fallback_index);
-                goto failed;
-            }
 
-            font_family_fallback_t* fallback = &font_family->fallback_arr[fallback_index];
-            strncpy(fallback->font_name, fallback_item->valuestring, sizeof(fallback->font_name) - 1);
-            fallback->font_name[sizeof(fallback->font_name) - 1] = '\0';
+        JSON_GET_VALUE_STR_OFFSET(item, str_table, seq->image, JSON_ITEM_STR_IMAGE);
+
+        seq->unicode_arr = unicode_ptr;
+        seq->unicode_cnt = codepoint_cnt;
+        for (int j = 0; j < codepoint_cnt; j++) {
+            *unicode_ptr++ = cJSON_GetArrayItem(codepoints, j)->valueint;
         }
+
+        valid_cnt++;
     }
 
-    return config;
+    /* sorted sequences share their prefixes with their neighbors */
+    qsort(seq_arr, valid_cnt, sizeof(font_utils_seq_t), font_utils_seq_cmp);
+    font_utils_seq_trie_build(trie, seq_arr, valid_cnt, 0, &emoji->seq_index, &emoji->seq_cnt);
+    retval = true;
 
 failed:
-    if (config) {
-        font_utils_json_font_family_free(config);
+    lv_free(unicode_buf);
+    lv_free(seq_arr);
+    return retval;
+}
+
+static int font_utils_range_cmp(const void* a, const void* b)
+{
+    const font_cfg_range_t* range_a = a;
+    const font_cfg_range_t* range_b = b;
+
+    if (range_a->begin != range_b->begin) {
+        return range_a->begin < range_b->begin ? -1 : 1;
     }
-    return NULL;
+
+    return 0;
 }
 
-void font_utils_json_emoji_config_free(font_emoji_config_t* config)
+static int font_utils_seq_cmp(const void* a, const void* b)
 {
-    LV_ASSERT_NULL(config);
-    if (config->emoji_arr) {
-        lv_free(config->emoji_arr);
-        config->emoji_arr = NULL;
+    const font_utils_seq_t* seq_a = a;
+    const font_utils_seq_t* seq_b = b;
+    uint32_t cnt = LV_MIN(seq_a->unicode_cnt, seq_b->unicode_cnt);
+
+    for (uint32_t i = 0; i < cnt; i++) {
+        if (seq_a->unicode_arr[i] != seq_b->unicode_arr[i]) {
+            return seq_a->unicode_arr[i] < seq_b->unicode_arr[i] ? -1 : 1;
+        }
     }
-    lv_free(config);
+
+    /* a prefix sorts first */
+    if (seq_a->unicode_cnt != seq_b->unicode_cnt) {
+        return seq_a->unicode_cnt < seq_b->unicode_cnt ? -1 : 1;
+    }
+
+    return 0;
 }
 
-void font_utils_json_font_family_free(font_family_config_t* config)
+static void font_utils_seq_trie_build(font_utils_seq_trie_t* trie, const font_utils_seq_t* seq_arr, uint32_t seq_cnt,
+    uint32_t depth, uint32_t* child_index, uint32_t* child_cnt)
 {
-    LV_ASSERT_NULL(config);
-    if (config->font_family_arr) {
-        for (int i = 0; i < config->font_family_arr_size; i++) {
-            font_family_t* font_family = &config->font_family_arr[i];
-
-            if (font_family->fallback_arr) {
-                lv_free(font_family->fallback_arr);
-                font_family->fallback_arr = NULL;
+    /* seq_arr is sorted, shares a prefix of depth codepoints and every sequence is longer than depth */
+    uint32_t cnt = 0;
+    for (uint32_t i = 0; i < seq_cnt; i++) {
+        if (i == 0 || seq_arr[i].unicode_arr[depth] != seq_arr[i - 1].unicode_arr[depth]) {
+            cnt++;
+        }
+    }
+
+    /* the children of a node are contiguous, allocate the whole level before descending */
+    uint32_t index = trie->node_cnt;
+    trie->node_cnt += cnt;
+    *child_index = index;
+    *child_cnt = cnt;
+
+    uint32_t begin = 0;
+    while (begin < seq_cnt) {
+        uint32_t unicode = seq_arr[begin].unicode_arr[depth];
+        uint32_t end = begin;
+        while (end < seq_cnt && seq_arr[end].unicode_arr[depth] == unicode) {
+            end++;
+        }
+
+        font_cfg_seq_t* node = &trie->node_arr[index++];
+        node->unicode = unicode;
+        node->image = FONT_CFG_SEQ_NO_IMAGE;
+
+        /* the sequence ending here sorts first in its group */
+        uint32_t next = begin;
+        while (next < end && seq_arr[next].unicode_cnt == depth + 1) {
+            if (node->image != FONT_CFG_SEQ_NO_IMAGE) {
+                LV_LOG_WARN("duplicate sequence ending with U+%" LV_PRIX32 ", ignored", unicode);
+            } else {
+                node->image = seq_arr[next].image;
             }
+            next++;
         }
-        lv_free(config->font_family_arr);
-        config->font_family_arr = NULL;
+
+        font_utils_seq_trie_build(trie, &seq_arr[next], end - next, depth + 1, &node->child_index, &node->child_cnt);
+        begin = end;
     }
-    lv_free(config);
 }
 
-bool font_utils_ft_info_is_equal(const lv_freetype_info_t* ft_info_1, const lv_freetype_info_t* ft_info_2)
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+static void* font_utils_ft_alloc(FT_Memory memory, long size)
 {
-    LV_ASSERT_NULL(ft_info_1);
-    LV_ASSERT_NULL(ft_info_2);
+    void* block = ft_mem.alloc(memory, size);
+    if (block) {
+        ft_mem.used += size;
+        font_utils_ft_mem_track(block, size);
+    }
+    return block;
+}
 
-    bool is_equal = (ft_info_1->size == ft_info_2->size
-        && ft_info_1->style == ft_info_2->style
-        && strcmp(ft_info_1->name, ft_info_2->name) == 0);
+static void font_utils_ft_free(FT_Memory memory, void* block)
+{
+    font_utils_ft_mem_untrack(block);
+    ft_mem.free(memory, block);
+}
 
-    return is_equal;
+static void* font_utils_ft_realloc(FT_Memory memory, long cur_size, long new_size, void* block)
+{
+    void* new_block = ft_mem.realloc(memory, cur_size, new_size, block);
+    if (new_block) {
+        font_utils_ft_mem_untrack(block);
+        ft_mem.used += new_size - cur_size;
+        font_utils_ft_mem_track(new_block, new_size);
+    }
+    return new_block;
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
+static void font_utils_ft_mem_track(void* block, long size)
+{
+    if (ft_mem.block_cnt == ft_mem.block_max) {
+        uint32_t block_max = LV_MAX(ft_mem.block_max * 2, 64);
+        font_utils_ft_block_t* block_arr = lv_realloc(ft_mem.block_arr, block_max * sizeof(font_utils_ft_block_t));
+        if (!block_arr) {
+            /* still counted, freeing it later is missed */
+            LV_LOG_WARN("realloc failed for font_utils_ft_block_t");
+            return;
+        }
+        ft_mem.block_arr = block_arr;
+        ft_mem.block_max = block_max;
+    }
+
+    ft_mem.block_arr[ft_mem.block_cnt].block = block;
+    ft_mem.block_arr[ft_mem.block_cnt].size = size;
+    ft_mem.block_cnt++;
+}
+
+static void font_utils_ft_mem_untrack(void* block)
+{
+    /* blocks taken before the count began are not counted, only the ones taken during it */
+    for (uint32_t i = ft_mem.block_cnt; i > 0; i--) {
+        if (ft_mem.block_arr[i - 1].block == block) {
+            ft_mem.used -= ft_mem.block_arr[i - 1].size;
+            ft_mem.block_arr[i - 1] = ft_mem.block_arr[--ft_mem.block_cnt];
+            return;
+        }
+    }
+}
@@ -31,46 +31,6 @@ typedef struct _lv_freetype_info_t {
 
 typedef struct _font_utils_json_obj_t font_utils_json_obj_t;
 
-typedef struct {
-    char font_name[UIKIT_FONT_NAME_MAX];
-    char ext[UIKIT_FONT_EXT_MAX];
-    char path[PATH_MAX];
-
-    uint16_t path_len;
-    uint16_t ext_len;
-
-    struct
-    {
-        uint16_t min;
-        uint16_t max;
-    } match_size;
-    struct
-    {
-        uint32_t begin;
-        uint32_t end;
-    } unicode_range;
-} font_emoji_t;
-
-typedef struct {
-    font_emoji_t* emoji_arr;
-    int emoji_arr_size;
-} font_emoji_config_t;
-
-typedef struct {
-    char font_name[UIKIT_FONT_NAME_MAX];
-} font_family_fallback_t;
-
-typedef struct {
-    char font_name[UIKIT_FONT_NAME_MAX];
-    font_family_fallback_t* fallback_arr;
-    int fallback_arr_size;
-} font_family_t;
-
-typedef struct {
-    font_family_t* font_family_arr;
-    int font_family_arr_size;
-} font_family_config_t;
-
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -88,39 +48,78 @@ font_utils_json_obj_t* font_utils_json_obj_create(const char* file_path);
  */
 void font_utils_json_obj_delete(font_utils_json_obj_t* json_obj);
 
+#if UIKIT_FONT_USE_FONT_FAMILY
+
 /**
- * Get the parsed emoji configuration data structure.
+ * Compile the parsed json into a font configuration image, see font_cfg.h.
  * @param json_obj pointer to json parsing object.
- * @return pointer to emoji configuration data structure.
+ * @param size return the image size.
+ * @return pointer to the image, free it with lv_free.
  */
-font_emoji_config_t* font_utils_json_get_emoji_config(font_utils_json_obj_t* json_obj);
+uint8_t* font_utils_json_compile_cfg(font_utils_json_obj_t* json_obj, size_t* size);
+
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
 
 /**
- * Get the parsed font-family configuration data structure.
- * @param json_obj pointer to json parsing object.
- * @return pointer to font-family configuration data structure.
+ * Compare font information.
+ * @param ft_info_1 font information 1.
+ * @param ft_info_2 font information 2.
+ * @return return true if the fonts are equal.
  */
-font_family_config_t* font_utils_json_get_font_family_config(font_utils_json_obj_t* json_obj);
+bool font_utils_ft_info_is_equal(const lv_freetype_info_t* ft_info_1, const lv_freetype_info_t* ft_info_2);
 
 /**
- * Free the parsed emoji configuration data structure.
- * @param config pointer to emoji configuration data structure.
+ * Get the freetype memory object of a freetype font, the faces of a library share it.
+ * @param font pointer to lv_freetype font.
+ * @return the FT_Memory, NULL if the font has no face.
  */
-void font_utils_json_emoji_config_free(font_emoji_config_t* config);
+void* font_utils_get_ft_memory(const lv_font_t* font);
 
 /**
- * Free the parsed font-family configuration data structure.
- * @param config pointer to font-family configuration data structure.
+ * Start counting the heap freetype takes through a memory object, call it under the freetype lock.
+ * @param ft_memory the FT_Memory, see font_utils_get_ft_memory.
  */
-void font_utils_json_font_family_free(font_family_config_t* config);
+void font_utils_ft_mem_count_begin(void* ft_memory);
 
 /**
- * Compare font information.
- * @param ft_info_1 font information 1.
- * @param ft_info_2 font information 2.
- * @return return true if the fonts are equal.
+ * Stop counting the heap freetype takes.
+ * @return bytes taken since font_utils_ft_mem_count_begin and still held.
  */
-bool font_utils_ft_info_is_equal(const lv_freetype_info_t* ft_info_1, const lv_freetype_info_t* ft_info_2);
+size_t font_utils_ft_mem_count_end(void);
+
+/**
+ * Measure a text like lv_text_get_size, and report where its lines start.
+ * @param font pointer to font.
+ * @param text text to measure.
+ * @param letter_space letter space.
+ * @param line_space line space.
+ * @param max_width max width of a line.
+ * @param flag text flags.
+ * @param size return the text size.
+ * @param line_start return the byte offset of each line, can be NULL.
+ * @param line_max size of line_start.
+ * @return number of lines, can be greater than line_max.
+ */
+uint32_t font_utils_get_text_lines(const lv_font_t* font, const char* text, int32_t letter_space, int32_t line_space,
+    int32_t max_width, lv_text_flag_t flag, lv_point_t* size, uint32_t* line_start, uint32_t line_max);
+
+/**
+ * Map a whole file read-only, the file is read into memory if mmap is not supported.
+ * @param path file path.
+ * @param data return pointer to the file data.
+ * @param size return the file size.
+ * @param is_mapped return true if the file is mapped.
+ * @return return true on success.
+ */
+bool font_utils_file_map(const char* path, const uint8_t** data, size_t* size, bool* is_mapped);
+
+/**
+ * Release a file mapped by font_utils_file_map.
+ * @param data pointer to the file data.
+ * @param size the file size.
+ * @param is_mapped true if the file is mapped.
+ */
+void font_utils_file_unmap(const uint8_t* data, size_t size, bool is_mapped);
 
 /**********************
  *      MACROS
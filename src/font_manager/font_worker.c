@@ -0,0 +1,219 @@
+/**
+ * @file font_worker.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_worker.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* job period when running on the UI thread */
+#define FONT_WORKER_TIMER_PERIOD 10
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    font_worker_job_cb_t cb;
+    void* user_data;
+} font_worker_job_t;
+
+typedef struct _font_worker_t {
+    lv_ll_t job_ll; /* pending jobs, protected by lock */
+    lv_mutex_t lock;
+    lv_thread_sync_t sync; /* wake up the thread */
+    lv_thread_t thread;
+    lv_timer_t* timer; /* used when no thread is available */
+    bool is_threaded;
+    bool is_exiting;
+} font_worker_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool font_worker_pop(font_worker_t* worker, font_worker_job_t* job);
+static void font_worker_thread_cb(void* user_data);
+static void font_worker_timer_cb(lv_timer_t* timer);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+font_worker_t* font_worker_create(void)
+{
+    font_worker_t* worker = lv_malloc(sizeof(font_worker_t));
+    LV_ASSERT_MALLOC(worker);
+    if (!worker) {
+        LV_LOG_ERROR("malloc failed for font_worker_t");
+        return NULL;
+    }
+    lv_memzero(worker, sizeof(font_worker_t));
+
+    _lv_ll_init(&worker->job_ll, sizeof(font_worker_job_t));
+    lv_mutex_init(&worker->lock);
+    lv_thread_sync_init(&worker->sync);
+
+    lv_result_t res = lv_thread_init(
+        &worker->thread,
+        LV_THREAD_PRIO_LOW,
+        font_worker_thread_cb,
+        UIKIT_FONT_WORKER_STACKSIZE,
+        worker);
+
+    if (res == LV_RESULT_OK) {
+        worker->is_threaded = true;
+    } else {
+        LV_LOG_WARN("thread create failed, run jobs on the UI thread");
+        worker->timer = lv_timer_create(font_worker_timer_cb, FONT_WORKER_TIMER_PERIOD, worker);
+        LV_ASSERT_MALLOC(worker->timer);
+        if (!worker->timer) {
+            lv_thread_sync_delete(&worker->sync);
+            lv_mutex_delete(&worker->lock);
+            lv_free(worker);
+            return NULL;
+        }
+    }
+
+    LV_LOG_INFO("success, threaded: %d", worker->is_threaded);
+    return worker;
+}
+
+void font_worker_delete(font_worker_t* worker)
+{
+    LV_ASSERT_NULL(worker);
+
+    lv_mutex_lock(&worker->lock);
+    worker->is_exiting = true;
+    lv_mutex_unlock(&worker->lock);
+
+    if (worker->is_threaded) {
+        /* wait for the running job */
+        lv_thread_sync_signal(&worker->sync);
+        lv_thread_delete(&worker->thread);
+    } else {
+        lv_timer_delete(worker->timer);
+    }
+
+    /* cancel pending jobs */
+    font_worker_job_t job;
+    while (font_worker_pop(worker, &job)) {
+        job.cb(job.user_data, true);
+    }
+
+    lv_thread_sync_delete(&worker->sync);
+    lv_mutex_delete(&worker->lock);
+    lv_free(worker);
+
+    LV_LOG_INFO("success");
+}
+
+bool font_worker_post(font_worker_t* worker, font_worker_job_cb_t cb, void* user_data)
+{
+    LV_ASSERT_NULL(worker);
+    LV_ASSERT_NULL(cb);
+
+    lv_mutex_lock(&worker->lock);
+
+    if (worker->is_exiting) {
+        lv_mutex_unlock(&worker->lock);
+        LV_LOG_WARN("worker is exiting");
+        return false;
+    }
+
+    font_worker_job_t* job = _lv_ll_ins_tail(&worker->job_ll);
+    LV_ASSERT_MALLOC(job);
+    if (job) {
+        job->cb = cb;
+        job->user_data = user_data;
+    }
+
+    lv_mutex_unlock(&worker->lock);
+
+    if (!job) {
+        LV_LOG_ERROR("malloc failed for font_worker_job_t");
+        return false;
+    }
+
+    if (worker->is_threaded) {
+        lv_thread_sync_signal(&worker->sync);
+    }
+
+    return true;
+}
+
+bool font_worker_is_threaded(const font_worker_t* worker)
+{
+    LV_ASSERT_NULL(worker);
+    return worker->is_threaded;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool font_worker_pop(font_worker_t* worker, font_worker_job_t* job)
+{
+    lv_mutex_lock(&worker->lock);
+
+    font_worker_job_t* head = _lv_ll_get_head(&worker->job_ll);
+    if (head) {
+        *job = *head;
+        _lv_ll_remove(&worker->job_ll, head);
+        lv_free(head);
+    }
+
+    lv_mutex_unlock(&worker->lock);
+
+    return head != NULL;
+}
+
+static void font_worker_thread_cb(void* user_data)
+{
+    font_worker_t* worker = user_data;
+
+    while (true) {
+        lv_mutex_lock(&worker->lock);
+        bool is_exiting = worker->is_exiting;
+        lv_mutex_unlock(&worker->lock);
+
+        if (is_exiting) {
+            break;
+        }
+
+        font_worker_job_t job;
+        if (font_worker_pop(worker, &job)) {
+            job.cb(job.user_data, false);
+            continue;
+        }
+
+        lv_thread_sync_wait(&worker->sync);
+    }
+
+    LV_LOG_INFO("thread exit");
+}
+
+static void font_worker_timer_cb(lv_timer_t* timer)
+{
+    font_worker_t* worker = lv_timer_get_user_data(timer);
+
+    font_worker_job_t job;
+    if (font_worker_pop(worker, &job)) {
+        job.cb(job.user_data, false);
+    }
+}
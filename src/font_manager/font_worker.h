@@ -0,0 +1,79 @@
+/**
+ * @file font_worker.h
+ *
+ */
+
+#ifndef FONT_MANAGER_FONT_WORKER_H
+#define FONT_MANAGER_FONT_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "font_config.h"
+#include <lvgl/lvgl.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _font_worker_t font_worker_t;
+
+/**
+ * Job callback.
+ * @param user_data custom parameter.
+ * @param cancelled true if the worker is being deleted, the job should only free its resource.
+ */
+typedef void (*font_worker_job_cb_t)(void* user_data, bool cancelled);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a font worker. Jobs run on a background thread, or on the UI thread
+ * one job per timer period if the OS layer can't create threads.
+ * @return pointer to font worker.
+ */
+font_worker_t* font_worker_create(void);
+
+/**
+ * Delete a font worker. Waits for the running job, pending jobs are cancelled.
+ * The jobs must not take the LVGL lock, it may be held by the caller.
+ * @param worker pointer to font worker.
+ */
+void font_worker_delete(font_worker_t* worker);
+
+/**
+ * Post a job to the worker.
+ * @param worker pointer to font worker.
+ * @param cb job callback.
+ * @param user_data custom parameter.
+ * @return return true if the job was queued.
+ */
+bool font_worker_post(font_worker_t* worker, font_worker_job_cb_t cb, void* user_data);
+
+/**
+ * Check whether the jobs are executed on a background thread.
+ * @param worker pointer to font worker.
+ * @return return true if a background thread is used.
+ */
+bool font_worker_is_threaded(const font_worker_t* worker);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* FONT_MANAGER_FONT_WORKER_H */
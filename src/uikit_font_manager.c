@@ -27,11 +27,22 @@
  *      TYPEDEFS
  **********************/
 
+/* vg_font_create_async request */
+typedef struct {
+    lv_freetype_info_t ft_info;
+    vg_font_create_cb_t cb;
+    void* user_data;
+    lv_font_t* font;
+    char name[]; /* name buffer */
+} vg_font_async_job_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
 static lv_font_t* vg_font_create_core(lv_freetype_info_t* newfont);
+static void vg_font_create_job_cb(void* user_data, bool cancelled);
+static void vg_font_create_done_cb(void* user_data, bool cancelled);
 
 /**********************
  *  STATIC VARIABLES
@@ -55,18 +66,21 @@ void vg_font_init(void)
     /* Create font manager */
     g_font_manager = font_manager_create();
 
+    const char* base_path = UIKIT_FONT_LIB_PATH "/font";
+
     /* check old config temporary for miwear: CONFIG_FONT_LIB_PATH */
 #ifdef CONFIG_FONT_LIB_PATH
-    /* Set font base path */
     if (strcmp(CONFIG_FONT_LIB_PATH, "/data/") != 0) {
         LV_LOG_WARN("You are using obsolete config FONT_LIB_PATH (%s). Please switch to UIKIT_FONT_LIB_PATH", CONFIG_FONT_LIB_PATH);
-        font_manager_set_base_path(g_font_manager, CONFIG_FONT_LIB_PATH "/font");
-        return;
+        base_path = CONFIG_FONT_LIB_PATH "/font";
     }
 #endif
 
     /* Set font base path */
-    font_manager_set_base_path(g_font_manager, UIKIT_FONT_LIB_PATH "/font");
+    font_manager_set_base_path(g_font_manager, base_path);
+
+    /* Open the fonts of the last runs in the background */
+    font_manager_warm_up(g_font_manager);
 }
 
 void vg_font_deinit(void)
@@ -95,8 +109,109 @@ bool vg_font_remove_path(vg_font_path_handle_t handle)
     return font_manager_remove_path(g_font_manager, handle);
 }
 
+size_t vg_font_preload(const vg_font_preload_item_t* list, size_t n)
+{
+    LV_ASSERT_NULL(list);
+    if (!list || n == 0) {
+        return 0;
+    }
+
+    vg_font_init();
+
+    lv_freetype_info_t* ft_info_arr = lv_malloc(sizeof(lv_freetype_info_t) * n);
+    LV_ASSERT_MALLOC(ft_info_arr);
+    if (!ft_info_arr) {
+        LV_LOG_ERROR("malloc failed for ft_info_arr");
+        return 0;
+    }
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (list[i].name == NULL || list[i].size == 0) {
+            LV_LOG_WARN("item[%" LV_PRIu32 "] param error", (uint32_t)i);
+            continue;
+        }
+
+        lv_freetype_info_t* ft_info = &ft_info_arr[cnt++];
+        lv_memzero(ft_info, sizeof(lv_freetype_info_t));
+        ft_info->name = list[i].name;
+        ft_info->size = list[i].size;
+        ft_info->style = list[i].style;
+    }
+
+    size_t queued = font_manager_preload(g_font_manager, ft_info_arr, cnt);
+    lv_free(ft_info_arr);
+
+    return queued;
+}
+
+void vg_font_set_cache_mem_budget(size_t size)
+{
+    vg_font_init();
+    font_manager_set_cache_mem_budget(g_font_manager, size);
+}
+
+void vg_font_set_cache_policy(vg_font_cache_policy_t policy)
+{
+    vg_font_init();
+    font_manager_set_cache_policy(g_font_manager, policy);
+}
+
+void vg_font_get_cache_mem_usage(size_t* cur_size, size_t* peak_size)
+{
+    vg_font_init();
+    font_manager_get_cache_mem_usage(g_font_manager, cur_size, peak_size);
+}
+
+void vg_font_get_stats(vg_font_stats_t* stats)
+{
+    LV_ASSERT_NULL(stats);
+    vg_font_init();
+    font_manager_get_stats(g_font_manager, stats);
+}
+
+void vg_font_get_text_size(lv_point_t* size_res, const char* text, const lv_font_t* font, int32_t letter_space,
+    int32_t line_space, int32_t max_width, lv_text_flag_t flag)
+{
+    vg_font_get_text_lines(size_res, text, font, letter_space, line_space, max_width, flag, NULL, 0);
+}
+
+uint32_t vg_font_get_text_lines(lv_point_t* size_res, const char* text, const lv_font_t* font, int32_t letter_space,
+    int32_t line_space, int32_t max_width, lv_text_flag_t flag, uint32_t* line_start, uint32_t line_max)
+{
+    lv_point_t size;
+    if (!size_res) {
+        size_res = &size;
+    }
+
+    /* same as lv_text_get_size */
+    if (!text || !font) {
+        size_res->x = 0;
+        size_res->y = 0;
+        return 0;
+    }
+
+    vg_font_init();
+    return font_manager_get_text_lines(g_font_manager, font, text, letter_space, line_space, max_width, flag,
+        size_res, line_start, line_max);
+}
+
+void vg_font_trim(vg_font_trim_level_t level)
+{
+    vg_font_init();
+    font_manager_trim(g_font_manager, level);
+}
+
+bool vg_font_save_usage_profile(void)
+{
+    vg_font_init();
+    return font_manager_save_usage_profile(g_font_manager);
+}
+
 lv_font_t* vg_font_create(const char* name, uint16_t size, uint16_t style)
 {
+    FONT_PROFILER_BEGIN;
+
     lv_freetype_info_t newfont;
     lv_memzero(&newfont, sizeof(newfont));
     newfont.name = name;
@@ -112,9 +227,184 @@ lv_font_t* vg_font_create(const char* name, uint16_t size, uint16_t style)
 #endif /* CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT */
     }
 
+    FONT_PROFILER_END;
     return font;
 }
 
+size_t vg_font_create_batch(const vg_font_request_t* reqs, lv_font_t** out, size_t n)
+{
+    LV_ASSERT_NULL(reqs);
+    LV_ASSERT_NULL(out);
+    if (!reqs || !out || n == 0) {
+        return 0;
+    }
+
+    vg_font_init();
+
+    FONT_PROFILER_BEGIN;
+
+    lv_freetype_info_t* ft_info_arr = lv_malloc(sizeof(lv_freetype_info_t) * n);
+    LV_ASSERT_MALLOC(ft_info_arr);
+    if (!ft_info_arr) {
+        LV_LOG_ERROR("malloc failed for ft_info_arr");
+        FONT_PROFILER_END;
+        return 0;
+    }
+    lv_memzero(ft_info_arr, sizeof(lv_freetype_info_t) * n);
+
+    /* invalid requests keep a NULL name and are skipped by the manager */
+    for (size_t i = 0; i < n; i++) {
+        ft_info_arr[i].name = reqs[i].name;
+        ft_info_arr[i].size = reqs[i].size;
+        ft_info_arr[i].style = reqs[i].style;
+    }
+
+    uint32_t start = lv_tick_get();
+    LV_UNUSED(start);
+
+    size_t cnt = font_manager_create_font_batch(g_font_manager, ft_info_arr, out, n);
+
+    for (size_t i = 0; i < n; i++) {
+#if UIKIT_FONT_USE_FONT_FAMILY
+        if (out[i]) {
+            lv_font_t* font_family = font_manager_create_font_family(g_font_manager, &ft_info_arr[i]);
+            if (font_family) {
+                out[i]->fallback = font_family;
+            }
+        }
+#endif /* UIKIT_FONT_USE_FONT_FAMILY */
+
+        if (!out[i]) {
+#ifdef CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT
+            LV_LOG_WARN("req[%" LV_PRIu32 "] use LV_FONT_DEFAULT(%p)", (uint32_t)i, LV_FONT_DEFAULT);
+            out[i] = (lv_font_t*)LV_FONT_DEFAULT;
+#endif /* CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT */
+        }
+    }
+
+    lv_free(ft_info_arr);
+
+    LV_LOG_INFO("%" LV_PRIu32 "/%" LV_PRIu32 " fonts create success, cost %" LV_PRIu32 "ms", (uint32_t)cnt, (uint32_t)n,
+        lv_tick_elaps(start));
+
+    FONT_PROFILER_END;
+    return cnt;
+}
+
+bool vg_font_create_async(const char* name, uint16_t size, uint16_t style, vg_font_create_cb_t cb, void* user_data)
+{
+    LV_ASSERT_NULL(cb);
+    if (name == NULL || size == 0 || cb == NULL) {
+        LV_LOG_ERROR("param error");
+        return false;
+    }
+
+    vg_font_init();
+
+    size_t name_len = strlen(name) + 1;
+    vg_font_async_job_t* job = lv_malloc(sizeof(vg_font_async_job_t) + name_len);
+    LV_ASSERT_MALLOC(job);
+    if (!job) {
+        LV_LOG_ERROR("malloc failed for vg_font_async_job_t");
+        return false;
+    }
+    lv_memzero(job, sizeof(vg_font_async_job_t));
+
+    lv_memcpy(job->name, name, name_len);
+    job->ft_info.name = job->name;
+    job->ft_info.size = size;
+    job->ft_info.style = style;
+    job->cb = cb;
+    job->user_data = user_data;
+
+    if (!font_manager_post_ui_job(g_font_manager, vg_font_create_job_cb, vg_font_create_done_cb, job)) {
+        LV_LOG_WARN("%s(%d) not queued", name, size);
+        lv_free(job);
+        return false;
+    }
+
+    LV_LOG_INFO("%s(%d) queued", name, size);
+    return true;
+}
+
+bool vg_font_get_glyph_outline(const lv_font_t* font, uint32_t letter, vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(font);
+    LV_ASSERT_NULL(outline);
+    vg_font_init();
+    return font_manager_get_glyph_outline(g_font_manager, font, letter, outline);
+}
+
+void vg_font_release_glyph_outline(vg_font_outline_t* outline)
+{
+    LV_ASSERT_NULL(outline);
+    font_manager_release_glyph_outline(g_font_manager, outline);
+}
+
+#if LV_USE_VECTOR_GRAPHIC
+void vg_font_outline_to_path(const vg_font_outline_t* outline, lv_vector_path_t* path, const lv_fpoint_t* pos)
+{
+    LV_ASSERT_NULL(outline);
+    LV_ASSERT_NULL(path);
+    LV_ASSERT_NULL(pos);
+
+    /* 26.6 pixels at the reference size, y up */
+    float scale = (float)outline->scale / (1 << 16) / 64;
+    const int16_t* point = outline->point_arr;
+    lv_fpoint_t pt[3];
+    bool is_open = false;
+
+    for (uint32_t i = 0; i < outline->op_cnt; i++) {
+        uint32_t point_cnt = 0;
+        switch (outline->op_arr[i]) {
+        case VG_FONT_OUTLINE_OP_MOVE:
+        case VG_FONT_OUTLINE_OP_LINE:
+            point_cnt = 1;
+            break;
+        case VG_FONT_OUTLINE_OP_QUAD:
+            point_cnt = 2;
+            break;
+        case VG_FONT_OUTLINE_OP_CUBIC:
+            point_cnt = 3;
+            break;
+        default:
+            break;
+        }
+
+        for (uint32_t j = 0; j < point_cnt; j++) {
+            pt[j].x = pos->x + point[0] * scale;
+            pt[j].y = pos->y - point[1] * scale;
+            point += 2;
+        }
+
+        switch (outline->op_arr[i]) {
+        case VG_FONT_OUTLINE_OP_MOVE:
+            if (is_open) {
+                lv_vector_path_close(path);
+            }
+            lv_vector_path_move_to(path, &pt[0]);
+            is_open = true;
+            break;
+        case VG_FONT_OUTLINE_OP_LINE:
+            lv_vector_path_line_to(path, &pt[0]);
+            break;
+        case VG_FONT_OUTLINE_OP_QUAD:
+            lv_vector_path_quad_to(path, &pt[0], &pt[1]);
+            break;
+        case VG_FONT_OUTLINE_OP_CUBIC:
+            lv_vector_path_cubic_to(path, &pt[0], &pt[1], &pt[2]);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (is_open) {
+        lv_vector_path_close(path);
+    }
+}
+#endif /* LV_USE_VECTOR_GRAPHIC */
+
 void vg_font_destroy(lv_font_t* delfont)
 {
     if (delfont == NULL) {
@@ -129,6 +419,8 @@ void vg_font_destroy(lv_font_t* delfont)
     }
 #endif /* CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT */
 
+    FONT_PROFILER_BEGIN;
+
 #if UIKIT_FONT_USE_FONT_FAMILY
     lv_font_t* font_family = (lv_font_t*)delfont->fallback;
     if (font_family) {
@@ -141,6 +433,7 @@ void vg_font_destroy(lv_font_t* delfont)
 
     font_manager_delete_font(g_font_manager, delfont);
 
+    FONT_PROFILER_END;
     LV_LOG_INFO("font[%p] destroy success", delfont);
 }
 
@@ -181,4 +474,40 @@ static lv_font_t* vg_font_create_core(lv_freetype_info_t* newfont)
     return font;
 }
 
+static void vg_font_create_job_cb(void* user_data, bool cancelled)
+{
+    /* the manager is being deleted, vg_font_create_done_cb answers the request */
+    if (cancelled) {
+        return;
+    }
+
+    /* no LVGL lock: the file is mapped unlocked and only freetype takes
+     * the manager's ft_lock, the UI keeps rendering meanwhile
+     */
+    vg_font_async_job_t* job = user_data;
+    job->font = vg_font_create_core(&job->ft_info);
+    font_manager_post_done(g_font_manager, job);
+}
+
+static void vg_font_create_done_cb(void* user_data, bool cancelled)
+{
+    vg_font_async_job_t* job = user_data;
+
+    /* the manager is being deleted, the font can't outlive it */
+    if (cancelled && job->font) {
+        vg_font_destroy(job->font);
+        job->font = NULL;
+    }
+
+#ifdef CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT
+    if (!job->font) {
+        job->font = (lv_font_t*)LV_FONT_DEFAULT;
+    }
+#endif /* CONFIG_UIKIT_FONT_USE_LV_FONT_DEFAULT */
+
+    LV_LOG_INFO("font[%p]: %s(%d) delivered", job->font, job->ft_info.name, job->ft_info.size);
+    job->cb(job->font, job->user_data);
+    lv_free(job);
+}
+
 #endif /* UIKIT_FONT_MANAGER */
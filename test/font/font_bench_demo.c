@@ -0,0 +1,513 @@
+/**
+ * @file font_bench_demo.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <lvgl/lvgl.h>
+
+#include "font_bench_demo.h"
+#include "uikit/uikit.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (UIKIT_FONT_MANAGER != 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define BENCH_MAX_FONT_CNT 8
+#define BENCH_MAX_CACHE_CNT 8
+#define BENCH_MAX_SIZE_CNT 8
+#define BENCH_LIST_MAX 256
+
+#define BENCH_DEF_CACHE_LIST "0"
+#define BENCH_DEF_SIZE_LIST "16,24,32,48"
+#define BENCH_DEF_LOOP_CNT 2000
+
+/* fonts held at the same time during the create/destroy run */
+#define BENCH_SLOT_CNT 16
+
+/* rasterized glyphs: printable ASCII and the first CJK ideographs */
+#define BENCH_ASCII_FIRST 0x21
+#define BENCH_ASCII_LAST 0x7E
+#define BENCH_CJK_FIRST 0x4E00
+#define BENCH_CJK_CNT 64
+
+/* passes over cached glyphs, a single pass is too short for the tick */
+#define BENCH_WARM_PASS_CNT 8
+
+#ifdef CONFIG_UIKIT_FONT_CACHE_MEM_SIZE
+#define BENCH_CACHE_MEM_BUDGET CONFIG_UIKIT_FONT_CACHE_MEM_SIZE
+#else
+#define BENCH_CACHE_MEM_BUDGET 0
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef enum {
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON,
+} bench_format_t;
+
+typedef struct {
+    uint16_t size;
+    uint32_t glyph_cnt; /* glyphs with a bitmap */
+    uint32_t cold_rate; /* glyphs per second after the glyph caches are flushed */
+    uint32_t warm_rate; /* glyphs per second from the glyph caches */
+} bench_size_result_t;
+
+typedef struct {
+    const char* font_name;
+    uint32_t cache_kb;
+    uint32_t create_cnt;
+    uint32_t destroy_cnt;
+    uint32_t fail_cnt;
+    uint32_t elaps; /* ms */
+    uint32_t op_rate; /* creates and destroys per second */
+    uint32_t refer_hit_cnt;
+    uint32_t cache_hit_cnt;
+    uint32_t cache_miss_cnt;
+    uint32_t cache_evict_cnt;
+    uint32_t hit_permille; /* creates served without opening the font file */
+    size_t peak_heap; /* above the heap in use before the run */
+    size_t peak_cache;
+    int size_cnt;
+    bench_size_result_t size_arr[BENCH_MAX_SIZE_CNT];
+} bench_result_t;
+
+typedef struct {
+    char font_list[BENCH_LIST_MAX];
+    char* font_arr[BENCH_MAX_FONT_CNT];
+    int font_cnt;
+    uint32_t cache_kb_arr[BENCH_MAX_CACHE_CNT];
+    int cache_cnt;
+    uint16_t size_arr[BENCH_MAX_SIZE_CNT];
+    int size_cnt;
+    int loop_cnt;
+
+    FILE* out;
+    bench_format_t format;
+    int result_cnt; /* results written */
+
+    uint32_t seed;
+    lv_font_t* slot_arr[BENCH_SLOT_CNT];
+    size_t base_heap;
+    size_t peak_heap;
+    size_t peak_cache;
+} bench_ctx_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool bench_parse_args(bench_ctx_t* ctx, char* info[], int size);
+static void bench_run(bench_ctx_t* ctx, const char* font_name, uint32_t cache_kb, bench_result_t* result);
+static void bench_write_begin(bench_ctx_t* ctx);
+static void bench_write_result(bench_ctx_t* ctx, const bench_result_t* result);
+static void bench_write_end(bench_ctx_t* ctx);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static const uint16_t font_style_arr[] = {
+    LV_FREETYPE_FONT_STYLE_NORMAL,
+    LV_FREETYPE_FONT_STYLE_ITALIC,
+    LV_FREETYPE_FONT_STYLE_BOLD,
+};
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define BENCH_RATE(cnt, ms) ((uint32_t)((uint64_t)(cnt) * 1000 / LV_MAX(ms, 1)))
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void uikit_demo_font_bench(char* info[], int size, void* param)
+{
+    LV_UNUSED(param);
+
+    if (size < 2) {
+        LV_LOG_ERROR("Usage: uikit_demo font_bench <font names> [cache budgets KB] [font sizes] "
+                     "[loop count] [output file]");
+        return;
+    }
+
+    bench_ctx_t* ctx = lv_malloc(sizeof(bench_ctx_t));
+    LV_ASSERT_MALLOC(ctx);
+    if (!ctx) {
+        LV_LOG_ERROR("malloc failed for bench_ctx_t");
+        return;
+    }
+    lv_memzero(ctx, sizeof(bench_ctx_t));
+
+    if (!bench_parse_args(ctx, info, size)) {
+        lv_free(ctx);
+        return;
+    }
+
+    const char* out_path = size > 5 ? info[5] : NULL;
+    ctx->out = stdout;
+    if (out_path) {
+        ctx->out = fopen(out_path, "w");
+        if (!ctx->out) {
+            LV_LOG_ERROR("can't open output file: %s", out_path);
+            lv_free(ctx);
+            return;
+        }
+
+        size_t path_len = strlen(out_path);
+        if (path_len > 5 && strcmp(out_path + path_len - 5, ".json") == 0) {
+            ctx->format = BENCH_FORMAT_JSON;
+        }
+    }
+
+    LV_LOG_USER("fonts: %d, cache budgets: %d, sizes: %d, loops: %d, output: %s",
+        ctx->font_cnt, ctx->cache_cnt, ctx->size_cnt, ctx->loop_cnt, out_path ? out_path : "stdout");
+
+    bench_result_t* result = lv_malloc(sizeof(bench_result_t));
+    LV_ASSERT_MALLOC(result);
+    if (!result) {
+        LV_LOG_ERROR("malloc failed for bench_result_t");
+        goto failed;
+    }
+
+    bench_write_begin(ctx);
+
+    for (int i = 0; i < ctx->cache_cnt; i++) {
+        for (int j = 0; j < ctx->font_cnt; j++) {
+            bench_run(ctx, ctx->font_arr[j], ctx->cache_kb_arr[i], result);
+            bench_write_result(ctx, result);
+
+            LV_LOG_USER("%s cache %" LV_PRIu32 "KB: %" LV_PRIu32 " ops/s, hit %" LV_PRIu32 "/1000, "
+                        "peak heap %" LV_PRIu32 ", peak cache %" LV_PRIu32,
+                result->font_name, result->cache_kb, result->op_rate, result->hit_permille,
+                (uint32_t)result->peak_heap, (uint32_t)result->peak_cache);
+        }
+    }
+
+    bench_write_end(ctx);
+    lv_free(result);
+
+    /* leave the manager as configured */
+    vg_font_set_cache_mem_budget(BENCH_CACHE_MEM_BUDGET);
+
+    LV_LOG_USER("font bench done");
+
+failed:
+    if (ctx->out != stdout) {
+        fclose(ctx->out);
+    }
+    lv_free(ctx);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static int bench_split_list(char* list, char* item_arr[], int item_max)
+{
+    int cnt = 0;
+    char* save_ptr = NULL;
+    for (char* item = strtok_r(list, ",", &save_ptr); item && cnt < item_max; item = strtok_r(NULL, ",", &save_ptr)) {
+        item_arr[cnt++] = item;
+    }
+    return cnt;
+}
+
+static bool bench_parse_args(bench_ctx_t* ctx, char* info[], int size)
+{
+    char list[BENCH_LIST_MAX];
+    char* item_arr[LV_MAX(BENCH_MAX_CACHE_CNT, BENCH_MAX_SIZE_CNT)];
+
+    lv_snprintf(ctx->font_list, sizeof(ctx->font_list), "%s", info[1]);
+    ctx->font_cnt = bench_split_list(ctx->font_list, ctx->font_arr, BENCH_MAX_FONT_CNT);
+
+    lv_snprintf(list, sizeof(list), "%s", size > 2 ? info[2] : BENCH_DEF_CACHE_LIST);
+    ctx->cache_cnt = bench_split_list(list, item_arr, BENCH_MAX_CACHE_CNT);
+    for (int i = 0; i < ctx->cache_cnt; i++) {
+        ctx->cache_kb_arr[i] = strtoul(item_arr[i], NULL, 0);
+    }
+
+    lv_snprintf(list, sizeof(list), "%s", size > 3 ? info[3] : BENCH_DEF_SIZE_LIST);
+    ctx->size_cnt = bench_split_list(list, item_arr, BENCH_MAX_SIZE_CNT);
+    for (int i = 0; i < ctx->size_cnt; i++) {
+        ctx->size_arr[i] = atoi(item_arr[i]);
+    }
+
+    ctx->loop_cnt = size > 4 ? atoi(info[4]) : BENCH_DEF_LOOP_CNT;
+    ctx->loop_cnt = LV_MAX(ctx->loop_cnt, 1);
+    ctx->seed = lv_rand(1, UINT32_MAX);
+
+    if (ctx->font_cnt == 0 || ctx->cache_cnt == 0 || ctx->size_cnt == 0) {
+        LV_LOG_ERROR("empty font, cache budget or size list");
+        return false;
+    }
+
+    return true;
+}
+
+static uint32_t bench_rand(bench_ctx_t* ctx, uint32_t max)
+{
+    /* xorshift32, the sequence doesn't depend on lv_rand users */
+    uint32_t x = ctx->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ctx->seed = x;
+    return x % max;
+}
+
+static size_t bench_get_heap_used(void)
+{
+    /* freetype allocates from the system heap */
+    struct mallinfo info = mallinfo();
+    size_t used = info.uordblks;
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    used += mon.total_size - mon.free_size;
+#endif
+
+    return used;
+}
+
+static void bench_sample_mem(bench_ctx_t* ctx)
+{
+    size_t heap_used = bench_get_heap_used();
+    if (heap_used > ctx->base_heap) {
+        ctx->peak_heap = LV_MAX(ctx->peak_heap, heap_used - ctx->base_heap);
+    }
+
+    size_t cache_size;
+    vg_font_get_cache_mem_usage(&cache_size, NULL);
+    ctx->peak_cache = LV_MAX(ctx->peak_cache, cache_size);
+}
+
+static void bench_create_destroy(bench_ctx_t* ctx, const char* font_name, bench_result_t* result)
+{
+    uint32_t start_tick = lv_tick_get();
+
+    for (int i = 0; i < ctx->loop_cnt; i++) {
+        uint32_t slot = bench_rand(ctx, BENCH_SLOT_CNT);
+        if (ctx->slot_arr[slot]) {
+            vg_font_destroy(ctx->slot_arr[slot]);
+            ctx->slot_arr[slot] = NULL;
+            result->destroy_cnt++;
+            continue;
+        }
+
+        uint16_t size = ctx->size_arr[bench_rand(ctx, ctx->size_cnt)];
+        uint16_t style = font_style_arr[bench_rand(ctx, sizeof(font_style_arr) / sizeof(font_style_arr[0]))];
+
+        lv_font_t* font = vg_font_create(font_name, size, style);
+        result->create_cnt++;
+
+        if (!font || font == LV_FONT_DEFAULT || font->line_height <= 0) {
+            result->fail_cnt++;
+            continue;
+        }
+
+        ctx->slot_arr[slot] = font;
+        bench_sample_mem(ctx);
+    }
+
+    for (int i = 0; i < BENCH_SLOT_CNT; i++) {
+        if (ctx->slot_arr[i]) {
+            vg_font_destroy(ctx->slot_arr[i]);
+            ctx->slot_arr[i] = NULL;
+            result->destroy_cnt++;
+        }
+    }
+
+    result->elaps = lv_tick_elaps(start_tick);
+    result->op_rate = BENCH_RATE(result->create_cnt + result->destroy_cnt, result->elaps);
+}
+
+static uint32_t bench_raster_pass(const lv_font_t* font, lv_draw_buf_t* draw_buf)
+{
+    uint32_t glyph_cnt = 0;
+
+    for (uint32_t i = 0; i <= BENCH_ASCII_LAST - BENCH_ASCII_FIRST + BENCH_CJK_CNT; i++) {
+        uint32_t letter = BENCH_ASCII_FIRST + i;
+        if (letter > BENCH_ASCII_LAST) {
+            letter = BENCH_CJK_FIRST + letter - BENCH_ASCII_LAST - 1;
+        }
+
+        lv_font_glyph_dsc_t glyph_dsc;
+        lv_memzero(&glyph_dsc, sizeof(glyph_dsc));
+        if (!lv_font_get_glyph_dsc(font, &glyph_dsc, letter, '\0') || glyph_dsc.is_placeholder) {
+            continue;
+        }
+
+        /* bitmap fonts write into the buffer, keep them inside it */
+        if (glyph_dsc.box_w == 0 || glyph_dsc.box_h == 0
+            || glyph_dsc.box_w > draw_buf->header.w || glyph_dsc.box_h > draw_buf->header.h) {
+            continue;
+        }
+
+        if (lv_font_get_glyph_bitmap(&glyph_dsc, letter, draw_buf)) {
+            glyph_cnt++;
+        }
+        lv_font_glyph_release_draw_data(&glyph_dsc);
+    }
+
+    return glyph_cnt;
+}
+
+static void bench_raster(bench_ctx_t* ctx, const char* font_name, uint16_t size, bench_size_result_t* size_result)
+{
+    lv_memzero(size_result, sizeof(bench_size_result_t));
+    size_result->size = size;
+
+    lv_font_t* font = vg_font_create(font_name, size, LV_FREETYPE_FONT_STYLE_NORMAL);
+    if (!font || font == LV_FONT_DEFAULT) {
+        LV_LOG_WARN("%s(%d) create failed", font_name, size);
+        return;
+    }
+
+    lv_draw_buf_t* draw_buf = lv_draw_buf_create(size * 2, size * 2, LV_COLOR_FORMAT_A8, 0);
+    if (!draw_buf) {
+        LV_LOG_ERROR("draw buf create failed");
+        vg_font_destroy(font);
+        return;
+    }
+
+    /* drop the glyphs cached by earlier runs, the cold pass loads and renders each one */
+    vg_font_trim(VG_FONT_TRIM_LEVEL_GLYPH);
+
+    uint32_t start_tick = lv_tick_get();
+    size_result->glyph_cnt = bench_raster_pass(font, draw_buf);
+    size_result->cold_rate = BENCH_RATE(size_result->glyph_cnt, lv_tick_elaps(start_tick));
+    bench_sample_mem(ctx);
+
+    uint32_t warm_cnt = 0;
+    start_tick = lv_tick_get();
+    for (int i = 0; i < BENCH_WARM_PASS_CNT; i++) {
+        warm_cnt += bench_raster_pass(font, draw_buf);
+    }
+    size_result->warm_rate = BENCH_RATE(warm_cnt, lv_tick_elaps(start_tick));
+
+    lv_draw_buf_destroy(draw_buf);
+    vg_font_destroy(font);
+}
+
+static void bench_run(bench_ctx_t* ctx, const char* font_name, uint32_t cache_kb, bench_result_t* result)
+{
+    lv_memzero(result, sizeof(bench_result_t));
+    result->font_name = font_name;
+    result->cache_kb = cache_kb;
+
+    /* every run starts from an empty font cache */
+    vg_font_set_cache_mem_budget((size_t)cache_kb * 1024);
+    vg_font_trim(VG_FONT_TRIM_LEVEL_CACHE);
+
+    ctx->base_heap = bench_get_heap_used();
+    ctx->peak_heap = 0;
+    ctx->peak_cache = 0;
+
+    vg_font_stats_t start_stats;
+    vg_font_get_stats(&start_stats);
+
+    bench_create_destroy(ctx, font_name, result);
+
+    vg_font_stats_t stats;
+    vg_font_get_stats(&stats);
+    result->refer_hit_cnt = stats.refer_hit_cnt - start_stats.refer_hit_cnt;
+    result->cache_hit_cnt = stats.cache_hit_cnt - start_stats.cache_hit_cnt;
+    result->cache_miss_cnt = stats.cache_miss_cnt - start_stats.cache_miss_cnt;
+    result->cache_evict_cnt = stats.cache_evict_cnt - start_stats.cache_evict_cnt;
+    if (result->create_cnt) {
+        uint64_t hit_cnt = result->refer_hit_cnt + result->cache_hit_cnt;
+        result->hit_permille = (uint32_t)(hit_cnt * 1000 / result->create_cnt);
+    }
+
+    for (int i = 0; i < ctx->size_cnt; i++) {
+        bench_raster(ctx, font_name, ctx->size_arr[i], &result->size_arr[i]);
+    }
+    result->size_cnt = ctx->size_cnt;
+
+    result->peak_heap = ctx->peak_heap;
+    result->peak_cache = ctx->peak_cache;
+}
+
+static void bench_write_begin(bench_ctx_t* ctx)
+{
+    if (ctx->format == BENCH_FORMAT_JSON) {
+        fprintf(ctx->out, "[\n");
+        return;
+    }
+
+    fprintf(ctx->out, "font,cache_kb,loops,create_cnt,destroy_cnt,fail_cnt,elaps_ms,ops_per_s,"
+                      "refer_hit,cache_hit,cache_miss,cache_evict,hit_ratio,peak_heap,peak_cache,"
+                      "size,glyph_cnt,raster_cold_per_s,raster_warm_per_s\n");
+}
+
+static void bench_write_result(bench_ctx_t* ctx, const bench_result_t* result)
+{
+    FILE* out = ctx->out;
+
+    if (ctx->format == BENCH_FORMAT_CSV) {
+        /* one row per font size, the run columns are repeated */
+        for (int i = 0; i < result->size_cnt; i++) {
+            const bench_size_result_t* size_result = &result->size_arr[i];
+            fprintf(out, "%s,%" LV_PRIu32 ",%d,%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32
+                         ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32
+                         ",%" LV_PRIu32 ".%03" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%d,%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 "\n",
+                result->font_name, result->cache_kb, ctx->loop_cnt, result->create_cnt, result->destroy_cnt,
+                result->fail_cnt, result->elaps, result->op_rate, result->refer_hit_cnt, result->cache_hit_cnt,
+                result->cache_miss_cnt, result->cache_evict_cnt, result->hit_permille / 1000,
+                result->hit_permille % 1000, (uint32_t)result->peak_heap, (uint32_t)result->peak_cache, size_result->size,
+                size_result->glyph_cnt, size_result->cold_rate, size_result->warm_rate);
+        }
+
+        fflush(out);
+        return;
+    }
+
+    fprintf(out, "%s  {\"font\": \"%s\", \"cache_kb\": %" LV_PRIu32 ", \"loops\": %d, "
+                 "\"create_cnt\": %" LV_PRIu32 ", \"destroy_cnt\": %" LV_PRIu32 ", \"fail_cnt\": %" LV_PRIu32 ", "
+                 "\"elaps_ms\": %" LV_PRIu32 ", \"ops_per_s\": %" LV_PRIu32 ", "
+                 "\"refer_hit\": %" LV_PRIu32 ", \"cache_hit\": %" LV_PRIu32 ", \"cache_miss\": %" LV_PRIu32 ", "
+                 "\"cache_evict\": %" LV_PRIu32 ", \"hit_ratio\": %" LV_PRIu32 ".%03" LV_PRIu32 ", "
+                 "\"peak_heap\": %" LV_PRIu32 ", \"peak_cache\": %" LV_PRIu32 ",\n   \"sizes\": [",
+        ctx->result_cnt ? ",\n" : "", result->font_name, result->cache_kb, ctx->loop_cnt, result->create_cnt,
+        result->destroy_cnt, result->fail_cnt, result->elaps, result->op_rate, result->refer_hit_cnt,
+        result->cache_hit_cnt, result->cache_miss_cnt, result->cache_evict_cnt, result->hit_permille / 1000,
+        result->hit_permille % 1000, (uint32_t)result->peak_heap, (uint32_t)result->peak_cache);
+
+    for (int i = 0; i < result->size_cnt; i++) {
+        const bench_size_result_t* size_result = &result->size_arr[i];
+        fprintf(out, "%s\n    {\"size\": %d, \"glyph_cnt\": %" LV_PRIu32 ", \"raster_cold_per_s\": %" LV_PRIu32
+                     ", \"raster_warm_per_s\": %" LV_PRIu32 "}",
+            i ? "," : "", size_result->size, size_result->glyph_cnt, size_result->cold_rate,
+            size_result->warm_rate);
+    }
+
+    fprintf(out, "]}");
+    fflush(out);
+    ctx->result_cnt++;
+}
+
+static void bench_write_end(bench_ctx_t* ctx)
+{
+    if (ctx->format == BENCH_FORMAT_JSON) {
+        fprintf(ctx->out, "\n]\n");
+    }
+
+    fflush(ctx->out);
+}
+
+#endif /*UIKIT_FONT_MANAGER*/
@@ -0,0 +1,46 @@
+/**
+ * @file font_bench_demo.h
+ *
+ */
+
+#ifndef UIKIT_DEMO_FONT_BENCH_H
+#define UIKIT_DEMO_FONT_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Headless font manager benchmark, measures create/destroy throughput, cache hit
+ * ratio, peak heap and glyph rasterization rate of each font and cache budget.
+ * Lists are comma separated, cache budgets in KB (0 is unlimited), results are
+ * written as JSON if the output file ends with ".json", otherwise as CSV.
+ * Usage: uikit_demo font_bench <font names> [cache budgets] [font sizes] [loop count] [output file]
+ */
+void uikit_demo_font_bench(char* info[], int size, void* param);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* UIKIT_DEMO_FONT_BENCH_H */
@@ -0,0 +1,352 @@
+/**
+ * @file font_thread_stress_demo.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <lvgl/lvgl.h>
+
+#include "font_thread_stress_demo.h"
+#include "uikit/uikit.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if (UIKIT_FONT_MANAGER != 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define THREAD_STRESS_MAX_THREAD_CNT 8
+#define THREAD_STRESS_DEF_THREAD_CNT 4
+#define THREAD_STRESS_DEF_LOOP_CNT 1000
+#define THREAD_STRESS_STACKSIZE 8192
+#define THREAD_STRESS_NAME_MAX 64
+
+/* fonts held by each thread at the same time */
+#define THREAD_STRESS_SLOT_CNT 16
+
+/* UI thread churn and completion check period */
+#define THREAD_STRESS_TIMER_PERIOD 5
+
+/* a headless run still going after this long is taken as a deadlock */
+#define THREAD_STRESS_TIMEOUT (60 * 1000)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct _thread_stress_ctx_t thread_stress_ctx_t;
+
+typedef struct {
+    thread_stress_ctx_t* ctx;
+    lv_thread_t thread;
+    uint32_t seed; /* lv_rand is not thread safe */
+    uint32_t create_cnt;
+    uint32_t fail_cnt;
+    uint32_t draw_cnt;
+    lv_font_t* font_arr[THREAD_STRESS_SLOT_CNT];
+} thread_stress_worker_t;
+
+struct _thread_stress_ctx_t {
+    char font_name[THREAD_STRESS_NAME_MAX];
+    int thread_cnt;
+    int loop_cnt;
+    lv_mutex_t lock;
+    int done_cnt; /* protected by lock */
+    uint32_t start_tick;
+    lv_timer_t* timer;
+    thread_stress_worker_t ui_worker; /* churn on the UI thread, not started as a thread */
+    thread_stress_worker_t worker_arr[THREAD_STRESS_MAX_THREAD_CNT];
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static thread_stress_ctx_t* stress_start(const char* font_name, int thread_cnt, int loop_cnt);
+static bool stress_is_done(thread_stress_ctx_t* ctx);
+static void stress_ui_step(thread_stress_ctx_t* ctx);
+static bool stress_finish(thread_stress_ctx_t* ctx);
+static void stress_thread_cb(void* user_data);
+static void stress_timer_cb(lv_timer_t* timer);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/* few sizes and styles, so the threads keep hitting the same fonts */
+static const uint16_t font_size_arr[] = { 16, 20, 24, 32 };
+static const uint16_t font_style_arr[] = {
+    LV_FREETYPE_FONT_STYLE_NORMAL,
+    LV_FREETYPE_FONT_STYLE_ITALIC,
+    LV_FREETYPE_FONT_STYLE_BOLD,
+};
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void uikit_demo_font_thread_stress(char* info[], int size, void* param)
+{
+    LV_UNUSED(param);
+
+    if (size < 2) {
+        LV_LOG_ERROR("Usage: uikit_demo font_thread_stress <font name> [thread count] [loop count] [headless]");
+        return;
+    }
+
+    int thread_cnt = size > 2 ? atoi(info[2]) : THREAD_STRESS_DEF_THREAD_CNT;
+    int loop_cnt = size > 3 ? atoi(info[3]) : THREAD_STRESS_DEF_LOOP_CNT;
+
+    if (size > 4 && strcmp(info[4], "headless") == 0) {
+        bool retval = uikit_demo_font_thread_stress_run(info[1], thread_cnt, loop_cnt);
+        exit(retval ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    thread_stress_ctx_t* ctx = stress_start(info[1], thread_cnt, loop_cnt);
+    if (ctx) {
+        ctx->timer = lv_timer_create(stress_timer_cb, THREAD_STRESS_TIMER_PERIOD, ctx);
+    }
+}
+
+bool uikit_demo_font_thread_stress_run(const char* font_name, int thread_cnt, int loop_cnt)
+{
+    LV_ASSERT_NULL(font_name);
+
+    thread_stress_ctx_t* ctx = stress_start(font_name, thread_cnt, loop_cnt);
+    if (!ctx) {
+        return false;
+    }
+
+    /* the caller plays the UI thread, it draws glyphs under lv_lock meanwhile */
+    while (!stress_is_done(ctx)) {
+        if (lv_tick_elaps(ctx->start_tick) > THREAD_STRESS_TIMEOUT) {
+            /* the threads may still use the context, it is leaked */
+            LV_LOG_ERROR("font thread stress test timed out, FAILED");
+            return false;
+        }
+
+        lv_lock();
+        stress_ui_step(ctx);
+        lv_unlock();
+
+        usleep(THREAD_STRESS_TIMER_PERIOD * 1000);
+    }
+
+    lv_lock();
+    bool retval = stress_finish(ctx);
+    lv_unlock();
+
+    return retval;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static uint32_t stress_rand(thread_stress_worker_t* worker, uint32_t max)
+{
+    /* xorshift32 */
+    uint32_t x = worker->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->seed = x;
+    return x % max;
+}
+
+static void stress_step(thread_stress_worker_t* worker)
+{
+    uint32_t slot = stress_rand(worker, THREAD_STRESS_SLOT_CNT);
+    lv_font_t* font = worker->font_arr[slot];
+
+    if (font) {
+        vg_font_destroy(font);
+        worker->font_arr[slot] = NULL;
+        return;
+    }
+
+    uint16_t size = font_size_arr[stress_rand(worker, sizeof(font_size_arr) / sizeof(font_size_arr[0]))];
+    uint16_t style = font_style_arr[stress_rand(worker, sizeof(font_style_arr) / sizeof(font_style_arr[0]))];
+
+    font = vg_font_create(worker->ctx->font_name, size, style);
+    worker->create_cnt++;
+
+    if (!font || font == LV_FONT_DEFAULT || font->line_height <= 0) {
+        LV_LOG_WARN("%s(%d) style %d create failed", worker->ctx->font_name, size, style);
+        worker->fail_cnt++;
+        return;
+    }
+
+    worker->font_arr[slot] = font;
+}
+
+static void stress_draw_glyph(thread_stress_worker_t* worker)
+{
+    lv_font_t* font = worker->font_arr[stress_rand(worker, THREAD_STRESS_SLOT_CNT)];
+    if (!font) {
+        return;
+    }
+
+    /* the glyph callbacks run without lv_lock on the threads, as on a draw unit */
+    uint32_t letter = 'A' + stress_rand(worker, 26);
+    lv_font_glyph_dsc_t glyph_dsc;
+    lv_memzero(&glyph_dsc, sizeof(glyph_dsc));
+    if (!lv_font_get_glyph_dsc(font, &glyph_dsc, letter, '\0')) {
+        return;
+    }
+
+    if (!glyph_dsc.is_placeholder && glyph_dsc.box_w > 0 && glyph_dsc.box_h > 0) {
+        lv_draw_buf_t* draw_buf = lv_draw_buf_create(glyph_dsc.box_w, glyph_dsc.box_h, LV_COLOR_FORMAT_A8,
+            LV_STRIDE_AUTO);
+        if (draw_buf) {
+            lv_font_get_glyph_bitmap(&glyph_dsc, letter, draw_buf);
+            lv_draw_buf_destroy(draw_buf);
+            worker->draw_cnt++;
+        }
+    }
+
+    lv_font_glyph_release_draw_data(&glyph_dsc);
+}
+
+static void stress_release_all(thread_stress_worker_t* worker)
+{
+    for (int i = 0; i < THREAD_STRESS_SLOT_CNT; i++) {
+        if (worker->font_arr[i]) {
+            vg_font_destroy(worker->font_arr[i]);
+            worker->font_arr[i] = NULL;
+        }
+    }
+}
+
+static void stress_thread_cb(void* user_data)
+{
+    thread_stress_worker_t* worker = user_data;
+    thread_stress_ctx_t* ctx = worker->ctx;
+
+    for (int i = 0; i < ctx->loop_cnt; i++) {
+        stress_step(worker);
+        stress_draw_glyph(worker);
+    }
+
+    stress_release_all(worker);
+
+    lv_mutex_lock(&ctx->lock);
+    ctx->done_cnt++;
+    lv_mutex_unlock(&ctx->lock);
+}
+
+static thread_stress_ctx_t* stress_start(const char* font_name, int thread_cnt, int loop_cnt)
+{
+    thread_stress_ctx_t* ctx = lv_malloc(sizeof(thread_stress_ctx_t));
+    LV_ASSERT_MALLOC(ctx);
+    if (!ctx) {
+        LV_LOG_ERROR("malloc failed for thread_stress_ctx_t");
+        return NULL;
+    }
+    lv_memzero(ctx, sizeof(thread_stress_ctx_t));
+
+    lv_snprintf(ctx->font_name, sizeof(ctx->font_name), "%s", font_name);
+    ctx->thread_cnt = LV_CLAMP(1, thread_cnt, THREAD_STRESS_MAX_THREAD_CNT);
+    ctx->loop_cnt = LV_MAX(loop_cnt, 1);
+    lv_mutex_init(&ctx->lock);
+
+    ctx->ui_worker.ctx = ctx;
+    ctx->ui_worker.seed = lv_rand(1, UINT32_MAX);
+    ctx->start_tick = lv_tick_get();
+
+    LV_LOG_USER("font: %s, threads: %d, loops: %d", ctx->font_name, ctx->thread_cnt, ctx->loop_cnt);
+
+    for (int i = 0; i < ctx->thread_cnt; i++) {
+        thread_stress_worker_t* worker = &ctx->worker_arr[i];
+        worker->ctx = ctx;
+        worker->seed = lv_rand(1, UINT32_MAX);
+
+        lv_result_t res = lv_thread_init(
+            &worker->thread,
+            LV_THREAD_PRIO_MID,
+            stress_thread_cb,
+            THREAD_STRESS_STACKSIZE,
+            worker);
+        LV_ASSERT_MSG(res == LV_RESULT_OK, "thread create failed");
+    }
+
+    return ctx;
+}
+
+static bool stress_is_done(thread_stress_ctx_t* ctx)
+{
+    lv_mutex_lock(&ctx->lock);
+    bool is_done = ctx->done_cnt == ctx->thread_cnt;
+    lv_mutex_unlock(&ctx->lock);
+    return is_done;
+}
+
+static void stress_ui_step(thread_stress_ctx_t* ctx)
+{
+    /* keep the UI thread creating, drawing and destroying fonts meanwhile */
+    stress_step(&ctx->ui_worker);
+    stress_draw_glyph(&ctx->ui_worker);
+}
+
+static bool stress_finish(thread_stress_ctx_t* ctx)
+{
+    stress_release_all(&ctx->ui_worker);
+
+    uint32_t create_cnt = ctx->ui_worker.create_cnt;
+    uint32_t fail_cnt = ctx->ui_worker.fail_cnt;
+    uint32_t draw_cnt = ctx->ui_worker.draw_cnt;
+    for (int i = 0; i < ctx->thread_cnt; i++) {
+        thread_stress_worker_t* worker = &ctx->worker_arr[i];
+        lv_thread_delete(&worker->thread);
+        create_cnt += worker->create_cnt;
+        fail_cnt += worker->fail_cnt;
+        draw_cnt += worker->draw_cnt;
+    }
+
+    size_t cur_size;
+    size_t peak_size;
+    vg_font_get_cache_mem_usage(&cur_size, &peak_size);
+
+    LV_LOG_USER("%" LV_PRIu32 " fonts created, %" LV_PRIu32 " failed, %" LV_PRIu32 " glyphs drawn, "
+                "cost %" LV_PRIu32 "ms, cache cur: %" LV_PRIu32 ", peak: %" LV_PRIu32,
+        create_cnt, fail_cnt, draw_cnt, lv_tick_elaps(ctx->start_tick), (uint32_t)cur_size, (uint32_t)peak_size);
+
+    vg_font_stats_t stats;
+    vg_font_get_stats(&stats);
+    LV_LOG_USER("refer hit: %" LV_PRIu32 ", cache hit: %" LV_PRIu32 ", miss: %" LV_PRIu32 ", evict: %" LV_PRIu32
+                ", open: %" LV_PRIu32 ", max open time: %" LV_PRIu32 "ms, live fonts: %" LV_PRIu32,
+        stats.refer_hit_cnt, stats.cache_hit_cnt, stats.cache_miss_cnt, stats.cache_evict_cnt,
+        stats.open_cnt, stats.open_time_max, stats.refer_cnt);
+
+    /* every font was destroyed, none may be left referenced */
+    bool retval = fail_cnt == 0 && stats.refer_cnt == 0;
+    LV_LOG_USER("font thread stress test %s", retval ? "PASSED" : "FAILED");
+
+    lv_mutex_delete(&ctx->lock);
+    lv_free(ctx);
+    return retval;
+}
+
+static void stress_timer_cb(lv_timer_t* timer)
+{
+    thread_stress_ctx_t* ctx = lv_timer_get_user_data(timer);
+
+    if (!stress_is_done(ctx)) {
+        stress_ui_step(ctx);
+        return;
+    }
+
+    lv_timer_delete(timer);
+    stress_finish(ctx);
+}
+
+#endif /*UIKIT_FONT_MANAGER*/
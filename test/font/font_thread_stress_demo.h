@@ -0,0 +1,56 @@
+/**
+ * @file font_thread_stress_demo.h
+ *
+ */
+
+#ifndef UIKIT_DEMO_FONT_THREAD_STRESS_H
+#define UIKIT_DEMO_FONT_THREAD_STRESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include <stdbool.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create, draw and destroy fonts from several threads and the UI thread at once.
+ * Usage: uikit_demo font_thread_stress <font name> [thread count] [loop count] [headless]
+ * With "headless" the test runs to completion and the process exits with its result.
+ */
+void uikit_demo_font_thread_stress(char* info[], int size, void* param);
+
+/**
+ * Run the thread stress test on the calling thread, which plays the UI thread.
+ * Must be called without the LVGL lock and with no LVGL timer handler running.
+ * @param font_name font to create
+ * @param thread_cnt number of threads creating fonts besides the caller
+ * @param loop_cnt create or destroy steps per thread
+ * @return true if every font opened, nothing deadlocked and no font leaked
+ */
+bool uikit_demo_font_thread_stress_run(const char* font_name, int thread_cnt, int loop_cnt);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* UIKIT_DEMO_FONT_THREAD_STRESS_H */
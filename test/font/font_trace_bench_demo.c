@@ -0,0 +1,381 @@
+/**
+ * @file font_trace_bench_demo.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <lvgl/lvgl.h>
+
+#include "font_trace_bench_demo.h"
+#include "uikit/uikit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if (UIKIT_FONT_MANAGER != 0)
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define TRACE_NAME_MAX 32
+#define TRACE_LINE_MAX 128
+#define TRACE_DEF_LOOP_CNT 4
+
+/* fonts held at the same time, the trace can't hold more */
+#define TRACE_LIVE_MAX 64
+
+/* built-in trace: the main screen is visited a few times between two pages,
+ * each page opens its own sizes once
+ */
+#define TRACE_GEN_PAGE_CNT 16
+#define TRACE_GEN_VISIT_CNT 3
+#define TRACE_GEN_SCAN_CNT 12
+#define TRACE_GEN_SCAN_FIRST 40
+#define TRACE_GEN_SCAN_RANGE 80
+
+#ifdef CONFIG_UIKIT_FONT_CACHE_POLICY
+#define TRACE_DEF_POLICY CONFIG_UIKIT_FONT_CACHE_POLICY
+#else
+#define TRACE_DEF_POLICY VG_FONT_CACHE_POLICY_2Q
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    char name[TRACE_NAME_MAX];
+    uint16_t size;
+    uint16_t style;
+    bool is_create;
+} trace_op_t;
+
+typedef struct {
+    const trace_op_t* op; /* the create request, key of the font */
+    lv_font_t* font;
+} trace_live_t;
+
+typedef struct {
+    uint32_t create_cnt;
+    uint32_t destroy_cnt;
+    uint32_t fail_cnt; /* failed creates and destroys without a create */
+    uint32_t elaps; /* ms */
+    uint32_t refer_hit_cnt;
+    uint32_t cache_hit_cnt;
+    uint32_t cache_miss_cnt;
+    uint32_t cache_evict_cnt;
+    uint32_t cache_promote_cnt;
+    uint32_t open_cnt;
+    uint32_t hit_permille; /* cache hits of the creates that no open font served */
+} trace_result_t;
+
+typedef struct {
+    trace_op_t* op_arr;
+    uint32_t op_cnt;
+    uint32_t op_cap;
+    int loop_cnt;
+
+    trace_live_t live_arr[TRACE_LIVE_MAX];
+    int live_cnt;
+} trace_ctx_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool trace_load(trace_ctx_t* ctx, const char* path);
+static bool trace_gen(trace_ctx_t* ctx, const char* font_name);
+static void trace_run(trace_ctx_t* ctx, vg_font_cache_policy_t policy, trace_result_t* result);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+static const struct {
+    uint16_t size;
+    uint16_t style;
+} main_font_arr[] = {
+    { 16, LV_FREETYPE_FONT_STYLE_NORMAL },
+    { 24, LV_FREETYPE_FONT_STYLE_NORMAL },
+    { 24, LV_FREETYPE_FONT_STYLE_BOLD },
+    { 32, LV_FREETYPE_FONT_STYLE_NORMAL },
+};
+
+static const vg_font_cache_policy_t policy_arr[] = {
+    VG_FONT_CACHE_POLICY_LRU,
+    VG_FONT_CACHE_POLICY_2Q,
+};
+
+static const char* const policy_name_arr[] = {
+    "lru",
+    "2q",
+};
+
+/**********************
+ *      MACROS
+ **********************/
+
+#define TRACE_ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void uikit_demo_font_trace_bench(char* info[], int size, void* param)
+{
+    LV_UNUSED(param);
+
+    if (size < 2) {
+        LV_LOG_ERROR("Usage: uikit_demo font_trace_bench <trace file|font name> [loop count]");
+        return;
+    }
+
+    trace_ctx_t* ctx = lv_malloc(sizeof(trace_ctx_t));
+    LV_ASSERT_MALLOC(ctx);
+    if (!ctx) {
+        LV_LOG_ERROR("malloc failed for trace_ctx_t");
+        return;
+    }
+    lv_memzero(ctx, sizeof(trace_ctx_t));
+
+    ctx->loop_cnt = size > 2 ? atoi(info[2]) : TRACE_DEF_LOOP_CNT;
+    ctx->loop_cnt = LV_MAX(ctx->loop_cnt, 1);
+
+    bool is_file = access(info[1], F_OK) == 0;
+    bool loaded = is_file ? trace_load(ctx, info[1]) : trace_gen(ctx, info[1]);
+    if (!loaded || ctx->op_cnt == 0) {
+        LV_LOG_ERROR("no request to replay");
+        goto failed;
+    }
+
+    LV_LOG_USER("%s trace: %" LV_PRIu32 " requests, loops: %d",
+        is_file ? info[1] : "built-in", ctx->op_cnt, ctx->loop_cnt);
+
+    printf("policy,loops,create_cnt,destroy_cnt,fail_cnt,elaps_ms,refer_hit,cache_hit,cache_miss,"
+           "cache_evict,cache_promote,open_cnt,hit_ratio\n");
+
+    for (size_t i = 0; i < TRACE_ARRAY_SIZE(policy_arr); i++) {
+        trace_result_t result;
+        trace_run(ctx, policy_arr[i], &result);
+
+        printf("%s,%d,%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32
+               ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ",%" LV_PRIu32 ".%03" LV_PRIu32 "\n",
+            policy_name_arr[i], ctx->loop_cnt, result.create_cnt, result.destroy_cnt, result.fail_cnt,
+            result.elaps, result.refer_hit_cnt, result.cache_hit_cnt, result.cache_miss_cnt,
+            result.cache_evict_cnt, result.cache_promote_cnt, result.open_cnt, result.hit_permille / 1000,
+            result.hit_permille % 1000);
+        fflush(stdout);
+
+        LV_LOG_USER("%s: cache hit %" LV_PRIu32 "/1000, %" LV_PRIu32 " fonts opened",
+            policy_name_arr[i], result.hit_permille, result.open_cnt);
+    }
+
+    /* leave the manager as configured */
+    vg_font_set_cache_policy(TRACE_DEF_POLICY);
+
+    LV_LOG_USER("font trace bench done");
+
+failed:
+    lv_free(ctx->op_arr);
+    lv_free(ctx);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool trace_add_op(trace_ctx_t* ctx, const char* name, uint16_t size, uint16_t style, bool is_create)
+{
+    if (ctx->op_cnt == ctx->op_cap) {
+        uint32_t op_cap = LV_MAX(ctx->op_cap * 2, 64);
+        trace_op_t* op_arr = lv_realloc(ctx->op_arr, op_cap * sizeof(trace_op_t));
+        LV_ASSERT_MALLOC(op_arr);
+        if (!op_arr) {
+            LV_LOG_ERROR("realloc failed for %" LV_PRIu32 " requests", op_cap);
+            return false;
+        }
+
+        ctx->op_arr = op_arr;
+        ctx->op_cap = op_cap;
+    }
+
+    trace_op_t* op = &ctx->op_arr[ctx->op_cnt++];
+    lv_memzero(op, sizeof(trace_op_t));
+    lv_snprintf(op->name, sizeof(op->name), "%s", name);
+    op->size = size;
+    op->style = style;
+    op->is_create = is_create;
+    return true;
+}
+
+static bool trace_load(trace_ctx_t* ctx, const char* path)
+{
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        LV_LOG_ERROR("can't open trace file: %s", path);
+        return false;
+    }
+
+    char line[TRACE_LINE_MAX];
+    int line_no = 0;
+    bool ret = true;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+
+        char op;
+        char name[TRACE_NAME_MAX];
+        unsigned int size;
+        unsigned int style = LV_FREETYPE_FONT_STYLE_NORMAL;
+
+        /* "%31s" matches TRACE_NAME_MAX */
+        int cnt = sscanf(line, " %c %31s %u %u", &op, name, &size, &style);
+        if (cnt <= 0 || op == '#') {
+            continue;
+        }
+
+        if (cnt < 3 || (op != '+' && op != '-')) {
+            LV_LOG_WARN("%s:%d: bad request skipped", path, line_no);
+            continue;
+        }
+
+        if (!trace_add_op(ctx, name, size, style, op == '+')) {
+            ret = false;
+            break;
+        }
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+static bool trace_gen(trace_ctx_t* ctx, const char* font_name)
+{
+    for (int page = 0; page < TRACE_GEN_PAGE_CNT; page++) {
+        for (int visit = 0; visit < TRACE_GEN_VISIT_CNT; visit++) {
+            for (size_t i = 0; i < TRACE_ARRAY_SIZE(main_font_arr); i++) {
+                if (!trace_add_op(ctx, font_name, main_font_arr[i].size, main_font_arr[i].style, true)) {
+                    return false;
+                }
+            }
+
+            for (size_t i = 0; i < TRACE_ARRAY_SIZE(main_font_arr); i++) {
+                if (!trace_add_op(ctx, font_name, main_font_arr[i].size, main_font_arr[i].style, false)) {
+                    return false;
+                }
+            }
+        }
+
+        /* the page holds all its sizes, then leaves */
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < TRACE_GEN_SCAN_CNT; i++) {
+                uint16_t size = TRACE_GEN_SCAN_FIRST + (page * TRACE_GEN_SCAN_CNT + i) % TRACE_GEN_SCAN_RANGE;
+                if (!trace_add_op(ctx, font_name, size, LV_FREETYPE_FONT_STYLE_NORMAL, pass == 0)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static void trace_release_all(trace_ctx_t* ctx, trace_result_t* result)
+{
+    while (ctx->live_cnt > 0) {
+        vg_font_destroy(ctx->live_arr[--ctx->live_cnt].font);
+        result->destroy_cnt++;
+    }
+}
+
+static void trace_destroy(trace_ctx_t* ctx, const trace_op_t* op, trace_result_t* result)
+{
+    /* the last font created with the same key */
+    for (int i = ctx->live_cnt - 1; i >= 0; i--) {
+        const trace_op_t* key = ctx->live_arr[i].op;
+        if (key->size != op->size || key->style != op->style || strcmp(key->name, op->name) != 0) {
+            continue;
+        }
+
+        vg_font_destroy(ctx->live_arr[i].font);
+        result->destroy_cnt++;
+
+        ctx->live_cnt--;
+        memmove(&ctx->live_arr[i], &ctx->live_arr[i + 1], (ctx->live_cnt - i) * sizeof(trace_live_t));
+        return;
+    }
+
+    result->fail_cnt++;
+}
+
+static void trace_replay(trace_ctx_t* ctx, trace_result_t* result)
+{
+    for (uint32_t i = 0; i < ctx->op_cnt; i++) {
+        const trace_op_t* op = &ctx->op_arr[i];
+        if (!op->is_create) {
+            trace_destroy(ctx, op, result);
+            continue;
+        }
+
+        lv_font_t* font = vg_font_create(op->name, op->size, op->style);
+        result->create_cnt++;
+
+        if (!font || font == LV_FONT_DEFAULT) {
+            result->fail_cnt++;
+            continue;
+        }
+
+        if (ctx->live_cnt == TRACE_LIVE_MAX) {
+            LV_LOG_WARN("more than %d fonts held, %s(%d) released", TRACE_LIVE_MAX, op->name, op->size);
+            vg_font_destroy(font);
+            result->destroy_cnt++;
+            continue;
+        }
+
+        ctx->live_arr[ctx->live_cnt].op = op;
+        ctx->live_arr[ctx->live_cnt].font = font;
+        ctx->live_cnt++;
+    }
+
+    /* every loop starts with no font held */
+    trace_release_all(ctx, result);
+}
+
+static void trace_run(trace_ctx_t* ctx, vg_font_cache_policy_t policy, trace_result_t* result)
+{
+    lv_memzero(result, sizeof(trace_result_t));
+
+    /* every policy starts from an empty font cache */
+    vg_font_set_cache_policy(policy);
+    vg_font_trim(VG_FONT_TRIM_LEVEL_CACHE);
+
+    vg_font_stats_t start_stats;
+    vg_font_get_stats(&start_stats);
+    uint32_t start_tick = lv_tick_get();
+
+    for (int i = 0; i < ctx->loop_cnt; i++) {
+        trace_replay(ctx, result);
+    }
+
+    result->elaps = lv_tick_elaps(start_tick);
+
+    vg_font_stats_t stats;
+    vg_font_get_stats(&stats);
+    result->refer_hit_cnt = stats.refer_hit_cnt - start_stats.refer_hit_cnt;
+    result->cache_hit_cnt = stats.cache_hit_cnt - start_stats.cache_hit_cnt;
+    result->cache_miss_cnt = stats.cache_miss_cnt - start_stats.cache_miss_cnt;
+    result->cache_evict_cnt = stats.cache_evict_cnt - start_stats.cache_evict_cnt;
+    result->cache_promote_cnt = stats.cache_promote_cnt - start_stats.cache_promote_cnt;
+    result->open_cnt = stats.open_cnt - start_stats.open_cnt;
+
+    uint32_t lookup_cnt = result->cache_hit_cnt + result->cache_miss_cnt;
+    if (lookup_cnt) {
+        result->hit_permille = (uint32_t)((uint64_t)result->cache_hit_cnt * 1000 / lookup_cnt);
+    }
+}
+
+#endif /*UIKIT_FONT_MANAGER*/
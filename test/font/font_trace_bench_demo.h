@@ -0,0 +1,48 @@
+/**
+ * @file font_trace_bench_demo.h
+ *
+ */
+
+#ifndef UIKIT_DEMO_FONT_TRACE_BENCH_H
+#define UIKIT_DEMO_FONT_TRACE_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Replay a font request trace once per font cache policy and compare the hit
+ * ratios. The trace is a text file with one request per line,
+ * "+ <name> <size> [style]" creates a font and "- <name> <size> [style]"
+ * destroys the last one created with the same key, '#' starts a comment. If
+ * the argument is not a file, it is the font name of a built-in trace: the
+ * fonts of a main screen are reused between pages using one-off sizes.
+ * Usage: uikit_demo font_trace_bench <trace file|font name> [loop count]
+ */
+void uikit_demo_font_trace_bench(char* info[], int size, void* param);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* UIKIT_DEMO_FONT_TRACE_BENCH_H */
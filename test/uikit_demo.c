@@ -31,6 +31,18 @@
 #include "creation/object_creation_test.h"
 #endif
 
+#ifdef CONFIG_UIKIT_DEMO_FONT_THREAD_STRESS
+#include "font/font_thread_stress_demo.h"
+#endif
+
+#ifdef CONFIG_UIKIT_DEMO_FONT_BENCH
+#include "font/font_bench_demo.h"
+#endif
+
+#ifdef CONFIG_UIKIT_DEMO_FONT_TRACE_BENCH
+#include "font/font_trace_bench_demo.h"
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -83,6 +95,18 @@ static const demo_entry_info_t demos_entry_info[] = {
     { "time_render_spangroup", .entry_cb = uikit_demo_time_render_spangroup },
 #endif
 
+#ifdef CONFIG_UIKIT_DEMO_FONT_THREAD_STRESS
+    { "font_thread_stress", .entry_cb = uikit_demo_font_thread_stress },
+#endif
+
+#ifdef CONFIG_UIKIT_DEMO_FONT_BENCH
+    { "font_bench", .entry_cb = uikit_demo_font_bench },
+#endif
+
+#ifdef CONFIG_UIKIT_DEMO_FONT_TRACE_BENCH
+    { "font_trace_bench", .entry_cb = uikit_demo_font_trace_bench },
+#endif
+
     { "", .entry_cb = NULL }
 };
 
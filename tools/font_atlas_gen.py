@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+############################################################################
+# frameworks/graphics/uikit/tools/font_atlas_gen.py
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+############################################################################
+
+"""Generate a pre-rasterized glyph atlas for the uikit font manager.
+
+The atlas is loaded by src/font_manager/font_atlas.c when the font
+<name>(<size>, <style>) is created, see CONFIG_UIKIT_FONT_USE_GLYPH_ATLAS.
+The file must be installed as <UIKIT_FONT_ATLAS_PATH>/<name>_<size>_<style>.atlas
+
+Example:
+    font_atlas_gen.py --font MiSans-Regular.ttf --size 18 \\
+        --text hot_chars.txt --range 0x20-0x7e -o out/
+
+Requires freetype-py (pip install freetype-py).
+"""
+
+import argparse
+import os
+import struct
+import sys
+from ctypes import byref
+
+import freetype
+
+# keep in sync with font_atlas.h
+ATLAS_MAGIC = 0x54414755
+ATLAS_VERSION = 1
+FINGERPRINT_CHUNK = 1024
+HEADER_FMT = "<IHHIHHhhIIII"
+GLYPH_FMT = "<IIHHHhhH"
+
+# keep in sync with lv_freetype_font_style_t
+STYLE_NORMAL = 0
+STYLE_ITALIC = 1
+STYLE_BOLD = 2
+
+# synthetic styles, same as lv_freetype
+ITALIC_SHEAR = 0x5800
+BOLD_STRENGTH = 1 << 6
+
+FNV_INIT = 2166136261
+FNV_PRIME = 16777619
+
+
+def fnv1a(data, h=FNV_INIT):
+    for b in data:
+        h ^= b
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def font_fingerprint(path):
+    """Same as font_atlas_get_fingerprint()"""
+    with open(path, "rb") as f:
+        data = f.read()
+    size = len(data) & 0xFFFFFFFF
+    chunk = min(size, FINGERPRINT_CHUNK)
+    h = fnv1a(struct.pack("<I", size))
+    h = fnv1a(data[:chunk], h)
+    h = fnv1a(data[size - chunk:], h)
+    return h
+
+
+def parse_style(text):
+    style = STYLE_NORMAL
+    for item in text.split("|"):
+        item = item.strip().lower()
+        if item in ("", "normal"):
+            continue
+        if item == "italic":
+            style |= STYLE_ITALIC
+        elif item == "bold":
+            style |= STYLE_BOLD
+        else:
+            raise argparse.ArgumentTypeError("unknown style: " + item)
+    return style
+
+
+def collect_chars(args):
+    chars = set()
+    for path in args.text or []:
+        with open(path, encoding="utf-8") as f:
+            chars.update(ord(c) for c in f.read() if c not in "\r\n")
+    for rng in args.range or []:
+        begin, _, end = rng.partition("-")
+        begin = int(begin, 0)
+        end = int(end, 0) if end else begin
+        chars.update(range(begin, end + 1))
+    return sorted(chars)
+
+
+def render_glyph(face, unicode, style):
+    index = face.get_char_index(unicode)
+    if index == 0:
+        return None
+
+    face.load_glyph(index, freetype.FT_LOAD_DEFAULT | freetype.FT_LOAD_NO_BITMAP)
+    slot = face.glyph
+    if style & STYLE_ITALIC:
+        matrix = freetype.Matrix(1 << 16, ITALIC_SHEAR, 0, 1 << 16)
+        freetype.FT_Outline_Transform(byref(slot.outline._FT_Outline), byref(matrix))
+    if style & STYLE_BOLD:
+        freetype.FT_Outline_Embolden(byref(slot.outline._FT_Outline), BOLD_STRENGTH)
+    slot.render(freetype.FT_RENDER_MODE_NORMAL)
+
+    bitmap = slot.bitmap
+    pixels = bytearray()
+    for y in range(bitmap.rows):
+        row = y * bitmap.pitch
+        pixels += bytes(bitmap.buffer[row:row + bitmap.width])
+
+    return {
+        "adv_w": (slot.advance.x + 32) >> 6,
+        "box_w": bitmap.width,
+        "box_h": bitmap.rows,
+        "ofs_x": slot.bitmap_left,
+        "ofs_y": slot.bitmap_top - bitmap.rows,
+        "bitmap": bytes(pixels),
+    }
+
+
+def build_atlas(font_path, size, style, chars):
+    face = freetype.Face(font_path)
+    face.set_pixel_sizes(0, size)
+
+    glyphs = []
+    bitmaps = bytearray()
+    missing = 0
+    for unicode in chars:
+        glyph = render_glyph(face, unicode, style)
+        if glyph is None:
+            missing += 1
+            continue
+        glyph["unicode"] = unicode
+        glyph["bitmap_offset"] = len(bitmaps)
+        bitmaps += glyph["bitmap"]
+        glyphs.append(glyph)
+
+    if missing:
+        print("warning: %d chars not in font" % missing, file=sys.stderr)
+
+    header_size = struct.calcsize(HEADER_FMT)
+    glyph_offset = (header_size + 3) & ~3
+    bitmap_offset = glyph_offset + len(glyphs) * struct.calcsize(GLYPH_FMT)
+
+    metrics = face.size
+    out = bytearray(
+        struct.pack(
+            HEADER_FMT,
+            ATLAS_MAGIC,
+            ATLAS_VERSION,
+            header_size,
+            font_fingerprint(font_path),
+            size,
+            style,
+            metrics.height >> 6,
+            -(metrics.descender >> 6),
+            len(glyphs),
+            glyph_offset,
+            bitmap_offset,
+            len(bitmaps),
+        )
+    )
+    out += bytes(glyph_offset - len(out))
+    for g in glyphs:
+        out += struct.pack(
+            GLYPH_FMT,
+            g["unicode"],
+            g["bitmap_offset"],
+            g["adv_w"],
+            g["box_w"],
+            g["box_h"],
+            g["ofs_x"],
+            g["ofs_y"],
+            0,
+        )
+    out += bitmaps
+    return out, len(glyphs)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--font", required=True, help="font file, must be the file installed on the device")
+    parser.add_argument("--name", help="font name used by vg_font_create, default: font file name")
+    parser.add_argument("--size", required=True, type=int, action="append", help="font size, can be repeated")
+    parser.add_argument("--style", default="normal", type=parse_style, help="normal, bold, italic or bold|italic")
+    parser.add_argument("--text", action="append", help="UTF-8 text file with the chars to rasterize")
+    parser.add_argument("--range", action="append", help="unicode range, eg: 0x20-0x7e")
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    args = parser.parse_args()
+
+    chars = collect_chars(args)
+    if not chars:
+        parser.error("no chars, use --text or --range")
+
+    name = args.name or os.path.splitext(os.path.basename(args.font))[0]
+    os.makedirs(args.output, exist_ok=True)
+
+    for size in args.size:
+        data, glyph_cnt = build_atlas(args.font, size, args.style, chars)
+        path = os.path.join(args.output, "%s_%d_%d.atlas" % (name, size, args.style))
+        with open(path, "wb") as f:
+            f.write(data)
+        print("%s: %d glyphs, %d bytes" % (path, glyph_cnt, len(data)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+############################################################################
+# frameworks/graphics/uikit/tools/font_cfg_gen.py
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+############################################################################
+
+"""Compile the uikit font_config.json into the binary font config.
+
+The binary config is mapped by src/font_manager/font_cfg.c at boot instead
+of parsing the json, it must be installed as CONFIG_UIKIT_FONT_CONFIG_BIN_PATH
+(default: /etc/font_config.bin). Regenerate it whenever the json changes.
+
+An emoji-list entry takes "unicode-range" as one {"begin", "end"} object
+or as an array of them, and optional "sequences" of
+{"codepoints": [...], "image": "<file name without ext>"} for emoji made
+of several codepoints.
+
+A font-family entry takes an optional "sdf": true to render the family
+and its fallbacks from distance fields (CONFIG_UIKIT_FONT_USE_SDF).
+A fallback is a font name, or {"font-name", "unicode-range"} so that only
+the codepoints in its ranges open it (CONFIG_UIKIT_FONT_FAMILY_MAP_SIZE).
+
+Example:
+    font_cfg_gen.py font_config.json -o font_config.bin
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# keep in sync with font_cfg.h
+CFG_MAGIC = 0x46434655
+CFG_VERSION = 4
+HEADER_FMT = "<IHHIIIIIIIIIIIII"
+EMOJI_FMT = "<IIIHHHHIIII"
+FAMILY_FMT = "<IIII"
+FAMILY_FLAG_SDF = 1 << 0
+COVER_FMT = "<II"
+RANGE_FMT = "<II"
+SEQ_FMT = "<IIII"
+SEQ_NO_IMAGE = 0xFFFFFFFF
+
+
+class StrTable:
+    """NUL-terminated string table, identical strings are stored once."""
+
+    def __init__(self):
+        self.data = bytearray()
+        self.index = {}
+
+    def add(self, s):
+        if s not in self.index:
+            self.index[s] = len(self.data)
+            self.data += s.encode("utf-8") + b"\0"
+        return self.index[s]
+
+
+def get_item(obj, key, where):
+    if key not in obj:
+        sys.exit("%s: missing '%s'" % (where, key))
+    return obj[key]
+
+
+def compile_ranges(unicode_range, where):
+    """Sort and merge the ranges, so they can be binary searched."""
+    if isinstance(unicode_range, dict):
+        unicode_range = [unicode_range]
+
+    ranges = []
+    for item in unicode_range:
+        begin = get_item(item, "begin", where)
+        end = get_item(item, "end", where)
+        if begin > end:
+            print("warning: %s: bad unicode-range %d-%d, ignored" % (where, begin, end))
+            continue
+        ranges.append((begin, end))
+
+    merged = []
+    for begin, end in sorted(ranges):
+        if merged and begin <= merged[-1][1] + 1:
+            merged[-1] = (merged[-1][0], max(merged[-1][1], end))
+        else:
+            merged.append((begin, end))
+    return merged
+
+
+def build_trie(nodes, seqs, depth):
+    """Append one trie level, children of a node are contiguous and sorted.
+
+    seqs are sorted, share a prefix of depth codepoints and are longer than it.
+    Returns (child_index, child_cnt).
+    """
+    groups = []
+    for codepoints, image in seqs:
+        if not groups or groups[-1][0] != codepoints[depth]:
+            groups.append((codepoints[depth], []))
+        groups[-1][1].append((codepoints, image))
+
+    child_index = len(nodes)
+    nodes.extend([None] * len(groups))
+    for i, (unicode, group) in enumerate(groups):
+        image = SEQ_NO_IMAGE
+        rest = []
+        for codepoints, seq_image in group:
+            if len(codepoints) > depth + 1:
+                rest.append((codepoints, seq_image))
+            elif image == SEQ_NO_IMAGE:
+                image = seq_image
+            else:
+                print("warning: duplicate sequence %s, ignored" % " ".join("%X" % c for c in codepoints))
+
+        index, cnt = build_trie(nodes, rest, depth + 1)
+        nodes[child_index + i] = (unicode, index, cnt, image)
+
+    return child_index, len(groups)
+
+
+def compile_cfg(cfg):
+    strs = StrTable()
+
+    emoji_data = bytearray()
+    range_data = bytearray()
+    range_cnt = 0
+    seq_nodes = []
+    emoji_list = cfg.get("emoji-list", [])
+    for i, emoji in enumerate(emoji_list):
+        where = "emoji-list[%d]" % i
+        path = get_item(emoji, "path", where)
+        ext = get_item(emoji, "ext", where)
+        match_size = get_item(emoji, "match-size", where)
+        ranges = compile_ranges(get_item(emoji, "unicode-range", where), where)
+
+        size_min = get_item(match_size, "min", where)
+        size_max = get_item(match_size, "max", where)
+        if size_min > size_max:
+            print("warning: %s: bad match-size" % where)
+
+        seqs = []
+        for j, seq in enumerate(emoji.get("sequences", [])):
+            seq_where = "%s.sequences[%d]" % (where, j)
+            codepoints = get_item(seq, "codepoints", seq_where)
+            if not codepoints:
+                print("warning: %s: no codepoints, ignored" % seq_where)
+                continue
+            seqs.append((list(codepoints), strs.add(get_item(seq, "image", seq_where))))
+
+        seq_index, seq_cnt = build_trie(seq_nodes, sorted(seqs), 0)
+
+        emoji_data += struct.pack(
+            EMOJI_FMT,
+            strs.add(get_item(emoji, "font-name", where)),
+            strs.add(path),
+            strs.add(ext),
+            len(path.encode("utf-8")),
+            len(ext.encode("utf-8")),
+            size_min,
+            size_max,
+            range_cnt,
+            len(ranges),
+            seq_index,
+            seq_cnt,
+        )
+
+        for begin, end in ranges:
+            range_data += struct.pack(RANGE_FMT, begin, end)
+        range_cnt += len(ranges)
+
+    family_data = bytearray()
+    fallback_data = bytearray()
+    cover_data = bytearray()
+    fallback_cnt = 0
+    family_list = cfg.get("font-family", [])
+    for i, family in enumerate(family_list):
+        where = "font-family[%d]" % i
+        fallback = get_item(family, "fallback", where)
+        if not fallback:
+            sys.exit("%s: fallback is empty" % where)
+
+        flags = 0
+        if family.get("sdf", False):
+            flags |= FAMILY_FLAG_SDF
+
+        family_data += struct.pack(
+            FAMILY_FMT,
+            strs.add(get_item(family, "font-name", where)),
+            fallback_cnt,
+            len(fallback),
+            flags,
+        )
+
+        for j, item in enumerate(fallback):
+            ranges = []
+            if isinstance(item, dict):
+                item_where = "%s.fallback[%d]" % (where, j)
+                name = get_item(item, "font-name", item_where)
+                if "unicode-range" in item:
+                    ranges = compile_ranges(item["unicode-range"], item_where)
+            else:
+                name = item
+
+            fallback_data += struct.pack("<I", strs.add(name))
+            cover_data += struct.pack(COVER_FMT, range_cnt, len(ranges))
+            for begin, end in ranges:
+                range_data += struct.pack(RANGE_FMT, begin, end)
+            range_cnt += len(ranges)
+        fallback_cnt += len(fallback)
+
+    emoji_offset = struct.calcsize(HEADER_FMT)
+    family_offset = emoji_offset + len(emoji_data)
+    fallback_offset = family_offset + len(family_data)
+    cover_offset = fallback_offset + len(fallback_data)
+    range_offset = cover_offset + len(cover_data)
+    seq_offset = range_offset + len(range_data)
+    seq_data = b"".join(struct.pack(SEQ_FMT, *node) for node in seq_nodes)
+    str_offset = seq_offset + len(seq_data)
+
+    header = struct.pack(
+        HEADER_FMT,
+        CFG_MAGIC,
+        CFG_VERSION,
+        struct.calcsize(HEADER_FMT),
+        len(emoji_list),
+        emoji_offset,
+        len(family_list),
+        family_offset,
+        fallback_cnt,
+        fallback_offset,
+        cover_offset,
+        range_cnt,
+        range_offset,
+        len(seq_nodes),
+        seq_offset,
+        str_offset,
+        len(strs.data),
+    )
+
+    return (
+        header + emoji_data + family_data + fallback_data + cover_data + range_data + seq_data + strs.data,
+        len(emoji_list),
+        len(family_list),
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="font_config.json")
+    parser.add_argument("-o", "--output", default="font_config.bin", help="output file")
+    args = parser.parse_args()
+
+    with open(args.input, encoding="utf-8") as f:
+        cfg = json.load(f)
+
+    data, emoji_cnt, family_cnt = compile_cfg(cfg)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("%s: %d emoji, %d font families, %d bytes" % (args.output, emoji_cnt, family_cnt, len(data)))
+
+
+if __name__ == "__main__":
+    main()
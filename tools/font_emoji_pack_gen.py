@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+############################################################################
+# frameworks/graphics/uikit/tools/font_emoji_pack_gen.py
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+############################################################################
+
+"""Pack per-codepoint emoji images into one pre-decoded emoji pack.
+
+The pack is loaded by src/font_manager/font_emoji_pack.c, see
+CONFIG_UIKIT_FONT_USE_EMOJI_PACK. For an emoji-list entry of the font
+config, install it as <path><font-name>.epk, eg: /data/emoji/Emoji.epk.
+Codepoints missing from the pack still load <path><codepoint><ext>.
+
+Example:
+    font_emoji_pack_gen.py --dir emoji_png/ --ext .png \\
+        --size 24 --size 32 -o Emoji.epk
+
+Requires Pillow (pip install Pillow).
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from PIL import Image
+
+# keep in sync with font_emoji_pack.h
+PACK_MAGIC = 0x4B504555
+PACK_VERSION = 1
+HEADER_FMT = "<IHHB3xIIII"
+VARIANT_FMT = "<HHII"
+GLYPH_FMT = "<IIHHHh"
+
+# keep in sync with lv_color_format_t
+COLOR_FORMAT_ARGB8888 = 0x10
+
+
+def collect_images(directory, ext):
+    images = {}
+    for file_name in os.listdir(directory):
+        base, file_ext = os.path.splitext(file_name)
+        if file_ext != ext or not base.isdigit():
+            continue
+        images[int(base)] = os.path.join(directory, file_name)
+    return dict(sorted(images.items()))
+
+
+def encode_argb8888(img, size):
+    """Scale to the emoji height and convert to lvgl ARGB8888 (B, G, R, A in memory)."""
+    img = img.convert("RGBA")
+    w = max(1, round(img.width * size / img.height))
+    img = img.resize((w, size), Image.LANCZOS)
+    r, g, b, a = img.split()
+    return Image.merge("RGBA", (b, g, r, a)).tobytes(), w, size, w * 4
+
+
+def build_pack(images, sizes):
+    sizes = sorted(set(sizes))
+    variant_cnt = len(sizes)
+    glyph_cnt = len(images)
+
+    header_size = struct.calcsize(HEADER_FMT)
+    variant_offset = header_size
+    glyph_table_offset = variant_offset + struct.calcsize(VARIANT_FMT) * variant_cnt
+    glyph_table_size = struct.calcsize(GLYPH_FMT) * glyph_cnt
+    data_offset = glyph_table_offset + glyph_table_size * variant_cnt
+
+    variants = bytearray()
+    glyphs = bytearray()
+    pixels = bytearray()
+
+    decoded = {unicode: Image.open(path) for unicode, path in images.items()}
+
+    for i, size in enumerate(sizes):
+        variants += struct.pack(VARIANT_FMT, size, 0, glyph_cnt, glyph_table_offset + glyph_table_size * i)
+        for unicode, img in decoded.items():
+            data, w, h, stride = encode_argb8888(img, size)
+            glyphs += struct.pack(GLYPH_FMT, unicode, len(pixels), w, h, stride, 0)
+            pixels += data
+            pixels += b"\0" * (-len(pixels) % 4)
+
+    header = struct.pack(
+        HEADER_FMT,
+        PACK_MAGIC,
+        PACK_VERSION,
+        header_size,
+        COLOR_FORMAT_ARGB8888,
+        variant_cnt,
+        variant_offset,
+        data_offset,
+        len(pixels),
+    )
+
+    return header + variants + glyphs + pixels
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--dir", required=True, help="directory with the <codepoint><ext> images")
+    parser.add_argument("--ext", default=".png", help="image file extension, default: .png")
+    parser.add_argument("--size", required=True, type=int, action="append", help="emoji height, can be repeated")
+    parser.add_argument("-o", "--output", required=True, help="output pack file")
+    args = parser.parse_args()
+
+    images = collect_images(args.dir, args.ext)
+    if not images:
+        sys.exit("no <codepoint>%s image in %s" % (args.ext, args.dir))
+
+    data = build_pack(images, args.size)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("%s: %d emoji, %d sizes, %d bytes" % (args.output, len(images), len(set(args.size)), len(data)))
+
+
+if __name__ == "__main__":
+    main()